@@ -17,17 +17,17 @@ public:
     explicit BacktestAdapter(StrategyEngine* engine, int shard_count = 4)
         : replayer_(shard_count), engine_(engine) {
 
-        // 设置回调函数，将数据转发到策略引擎
+        // 设置回调函数，登记证券 ID 后将数据转发到策略引擎
         replayer_.set_tick_callback([this](const MDStockStruct& stock) {
-            engine_->on_market_tick(stock);
+            engine_->on_market_tick(stock, engine_->intern_symbol(stock.htscsecurityid));
         });
 
         replayer_.set_order_callback([this](const MDOrderStruct& order) {
-            engine_->on_market_order(order);
+            engine_->on_market_order(order, engine_->intern_symbol(order.htscsecurityid));
         });
 
         replayer_.set_transaction_callback([this](const MDTransactionStruct& txn) {
-            engine_->on_market_transaction(txn);
+            engine_->on_market_transaction(txn, engine_->intern_symbol(txn.htscsecurityid));
         });
     }
 
@@ -129,6 +129,41 @@ struct EngineConfig {
     // 行情中断检测配置（单位：毫秒）
     int64_t interrupt_threshold_strategy_ms = 5000;    // 策略关注股票的中断阈值（默认5秒）
     int64_t interrupt_threshold_other_ms = 20000;      // 非策略股票的中断阈值（默认20秒）
+
+    // 订单簿快照配置（盘中重启时恢复订单簿）
+    std::string checkpoint_dir = "data/checkpoint";
+    int checkpoint_interval_sec = 0;                   // 写快照间隔（秒），0 表示不写
+    bool checkpoint_restore = false;                   // 启动时是否恢复当日快照
+
+    // 订单节点池内存配置
+    std::string pool_huge_pages = "none";              // none / thp / hugetlb (无预留大页时回退 thp)
+    bool pool_prefault = false;                        // 启动时预先缺页
+    bool compact_books_at_lunch = true;                // 午休时按队列顺序整理订单簿节点
+
+    // 启动追补：从 persist_data_dir 的当日落盘文件回放逐笔，重建重启前的订单簿
+    bool catchup_enabled = false;
+
+    // 主力资金流向分档阈值 (元，"中单,大单,特大单" 下限)，空表示不统计
+    std::string money_flow_thresholds;
+
+    // 证券代码表：启动时预先登记为整数 ID (盘中新代码首次出现时补登记)
+    std::string symbol_list_file = "ALLSYMBOLS.csv";
+
+    // 行情接入：mpmc = 各分片一个 moodycamel 队列；spsc = 网关线程 x 分片的 SPSC 环矩阵
+    std::string ingest_mode = "mpmc";
+    int ingest_producers = 10;                         // 网关推送线程数 (矩阵行数)
+    int ingest_ring_capacity = 4096;                   // 每个环的容量 (条)
+
+    // worker 空闲等待策略：yield / spin / spin_yield / park
+    std::string worker_wait = "yield";                 // 所有分片的默认策略
+    std::string worker_wait_shards;                    // 按分片覆盖，如 "0-3:spin,24-27:spin,40:park"
+    int worker_spin_limit = 2000;                      // spin_yield / park 让出或挂起前的自旋轮数
+
+    // 绑核 (CPU 列表如 "2-25" 或 "2,4,6")，留空不绑核
+    std::string cpu_sh_workers;                        // 上海 worker，按分片顺序
+    std::string cpu_sz_workers;                        // 深圳 worker，按分片顺序
+    std::string cpu_gateway;                           // 网关推送线程，按首次推送顺序
+    int cpu_persist_writer = -1;                       // 落盘 writer 线程，-1 不绑核
 };
 
 // ==========================================
@@ -206,6 +241,44 @@ inline EngineConfig parse_engine_config(const std::string& filepath) {
             config.interrupt_threshold_strategy_ms = std::stoll(value);
         } else if (key == "interrupt_threshold_other_ms") {
             config.interrupt_threshold_other_ms = std::stoll(value);
+        } else if (key == "checkpoint_dir") {
+            config.checkpoint_dir = value;
+        } else if (key == "checkpoint_interval_sec") {
+            config.checkpoint_interval_sec = std::stoi(value);
+        } else if (key == "checkpoint_restore") {
+            config.checkpoint_restore = (value == "true" || value == "1");
+        } else if (key == "pool_huge_pages") {
+            config.pool_huge_pages = value;
+        } else if (key == "pool_prefault") {
+            config.pool_prefault = (value == "true" || value == "1");
+        } else if (key == "compact_books_at_lunch") {
+            config.compact_books_at_lunch = (value == "true" || value == "1");
+        } else if (key == "catchup_enabled") {
+            config.catchup_enabled = (value == "true" || value == "1");
+        } else if (key == "money_flow_thresholds") {
+            config.money_flow_thresholds = value;
+        } else if (key == "symbol_list_file") {
+            config.symbol_list_file = value;
+        } else if (key == "ingest_mode") {
+            config.ingest_mode = value;
+        } else if (key == "ingest_producers") {
+            config.ingest_producers = std::stoi(value);
+        } else if (key == "ingest_ring_capacity") {
+            config.ingest_ring_capacity = std::stoi(value);
+        } else if (key == "worker_wait") {
+            config.worker_wait = value;
+        } else if (key == "worker_wait_shards") {
+            config.worker_wait_shards = value;
+        } else if (key == "worker_spin_limit") {
+            config.worker_spin_limit = std::stoi(value);
+        } else if (key == "cpu_sh_workers") {
+            config.cpu_sh_workers = value;
+        } else if (key == "cpu_sz_workers") {
+            config.cpu_sz_workers = value;
+        } else if (key == "cpu_gateway") {
+            config.cpu_gateway = value;
+        } else if (key == "cpu_persist_writer") {
+            config.cpu_persist_writer = std::stoi(value);
         }
     }
 
@@ -0,0 +1,360 @@
+#ifndef BOOK_CHECKPOINT_H
+#define BOOK_CHECKPOINT_H
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include "FastOrderBook.h"
+#include "ObjectPool.h"
+#include "utils/symbol_utils.h"
+
+#define LOG_MODULE "BookCheckpoint"
+#include "logger.h"
+
+// ============================================================================
+// ChannelWatermarks - 逐笔通道序号水位
+// ============================================================================
+// 记录每个 (channelno, 委托/成交) 已处理到的最大 applseqnum。
+// 委托流和成交流分开记录：两条流到达时可能相互穿插，混在一起比较会误判重复。
+// 单个分片涉及的通道很少 (个位数)，用线性数组即可。
+//
+class ChannelWatermarks {
+public:
+    enum Stream : int32_t {
+        ORDER = 0,
+        TRANSACTION = 1
+    };
+
+    struct Entry {
+        int32_t channel;
+        int32_t stream;
+        int64_t applseqnum;
+    };
+
+    static_assert(sizeof(Entry) == 16, "Entry size mismatch");
+
+    // 记录已处理序号 (取最大值)
+    void update(int32_t channel, Stream stream, int64_t applseqnum) {
+        Entry* e = find_entry(channel, stream);
+        if (e) {
+            if (applseqnum > e->applseqnum) e->applseqnum = applseqnum;
+        } else {
+            entries_.push_back(Entry{channel, stream, applseqnum});
+        }
+    }
+
+    // 是否已被快照覆盖 (序号 <= 水位)
+    bool covers(int32_t channel, Stream stream, int64_t applseqnum) const {
+        for (const auto& e : entries_) {
+            if (e.channel == channel && e.stream == stream) return applseqnum <= e.applseqnum;
+        }
+        return false;
+    }
+
+    bool empty() const { return entries_.empty(); }
+    void clear() { entries_.clear(); }
+    const std::vector<Entry>& entries() const { return entries_; }
+    void assign(const Entry* begin, size_t count) { entries_.assign(begin, begin + count); }
+
+private:
+    Entry* find_entry(int32_t channel, int32_t stream) {
+        for (auto& e : entries_) {
+            if (e.channel == channel && e.stream == stream) return &e;
+        }
+        return nullptr;
+    }
+
+    std::vector<Entry> entries_;
+};
+
+// ============================================================================
+// BookCheckpoint - 分片订单簿快照 (Warm Restart)
+// ============================================================================
+// 由 worker 线程在两条消息之间调用，天然处于消息流的一致点。
+// 保存逻辑内容而非内存镜像：每个订单簿的价格带 + 所有在册订单 (档位内按时间优先顺序)，
+// 恢复时按顺序逐个挂回，得到与快照时完全相同的队列。不依赖 ObjectPool 下标与内存布局。
+//
+// 文件格式 (每个分片一个文件，先写 .tmp 再 rename，保证不会读到写了一半的快照):
+//   [64 字节 Header]
+//   [watermark_count 个 ChannelWatermarks::Entry]
+//   [book_count 个 { BookRecord + order_count 个 OrderRecord }]
+//
+class BookCheckpoint {
+public:
+    static constexpr uint32_t MAGIC = 0x424B4331;   // "BKC1"
+    static constexpr uint16_t VERSION = 2;     // v2: Header 记录分片布局
+
+    struct alignas(64) Header {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t order_record_size;
+        int32_t shard_id;
+        int32_t mddate;             // 快照时最后一条消息的日期
+        int32_t mdtime;             // 快照时最后一条消息的时间
+        uint32_t book_count;
+        uint32_t watermark_count;
+        uint32_t _pad;
+        uint64_t order_count;       // 全部订单数
+        uint64_t payload_size;      // Header 之后的字节数
+        uint16_t sh_shard_count;    // 写快照时的分片布局：布局不同则证券归属分片不同，不能恢复
+        uint16_t sz_shard_count;
+        char reserved[12];
+    };
+    static_assert(sizeof(Header) == 64, "Header must be 64 bytes");
+
+    struct BookRecord {
+        char symbol[40];
+        uint32_t min_price;
+        uint32_t max_price;
+        uint64_t order_count;
+    };
+    static_assert(sizeof(BookRecord) == 56, "BookRecord size mismatch");
+
+    struct OrderRecord {
+        uint64_t seq;
+        uint32_t original_price;
+        uint32_t sort_price;        // 0 = 市价单队列
+        uint32_t volume;
+        uint8_t type;
+        uint8_t side;
+        uint8_t _pad[2];
+    };
+    static_assert(sizeof(OrderRecord) == 24, "OrderRecord size mismatch");
+
+    using BookMap = std::unordered_map<std::string, std::unique_ptr<FastOrderBook>>;
+    using BookList = std::vector<std::pair<const char*, const FastOrderBook*>>;   // (代码, 订单簿)，不持有
+
+    // 快照文件路径
+    static std::string path_for_shard(const std::string& dir, int shard_id) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "book_shard_%02d.ckpt", shard_id);
+        return dir + "/" + name;
+    }
+
+    /**
+     * @brief 保存分片内所有订单簿
+     * @return 成功返回 true
+     */
+    static bool save(const std::string& path, int shard_id, int32_t mddate, int32_t mdtime,
+                     const BookMap& books, const ChannelWatermarks& watermarks,
+                     const symbol_utils::ExchangeShardConfig& layout) {
+        BookList list;
+        list.reserve(books.size());
+        for (const auto& [symbol, book] : books) list.emplace_back(symbol.c_str(), book.get());
+        return save(path, shard_id, mddate, mdtime, list, watermarks, layout);
+    }
+
+    static bool save(const std::string& path, int shard_id, int32_t mddate, int32_t mdtime,
+                     const BookList& books, const ChannelWatermarks& watermarks,
+                     const symbol_utils::ExchangeShardConfig& layout) {
+        // 1. 计算大小
+        uint64_t order_count = 0;
+        for (const auto& [symbol, book] : books) order_count += book->order_count();
+
+        size_t payload = watermarks.entries().size() * sizeof(ChannelWatermarks::Entry) +
+                         books.size() * sizeof(BookRecord) +
+                         order_count * sizeof(OrderRecord);
+        size_t file_size = sizeof(Header) + payload;
+
+        // 2. 写临时文件
+        std::string tmp_path = path + ".tmp";
+        int fd = ::open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            LOG_M_ERROR("Failed to open checkpoint file: {} errno={}", tmp_path, errno);
+            return false;
+        }
+        if (::ftruncate(fd, static_cast<off_t>(file_size)) != 0) {
+            LOG_M_ERROR("ftruncate failed: {} errno={}", tmp_path, errno);
+            ::close(fd);
+            return false;
+        }
+        void* base = ::mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (base == MAP_FAILED) {
+            LOG_M_ERROR("mmap failed: {} errno={}", tmp_path, errno);
+            ::close(fd);
+            return false;
+        }
+
+        char* p = static_cast<char*>(base) + sizeof(Header);
+
+        // watermarks
+        size_t wm_bytes = watermarks.entries().size() * sizeof(ChannelWatermarks::Entry);
+        if (wm_bytes) std::memcpy(p, watermarks.entries().data(), wm_bytes);
+        p += wm_bytes;
+
+        // books
+        uint64_t written_orders = 0;
+        bool count_mismatch = false;
+        for (const auto& [symbol, book] : books) {
+            BookRecord rec{};
+            std::strncpy(rec.symbol, symbol, sizeof(rec.symbol) - 1);
+            rec.min_price = book->min_price();
+            rec.max_price = book->max_price();
+            rec.order_count = book->order_count();
+            std::memcpy(p, &rec, sizeof(rec));
+            p += sizeof(rec);
+
+            OrderRecord* out = reinterpret_cast<OrderRecord*>(p);
+            uint64_t n = 0, seen = 0;
+            book->for_each_order([&](const OrderView& node) {
+                // 只写登记数以内的订单 (文件大小按登记数预留)，多出的按不一致处理
+                if (seen++ >= rec.order_count) return;
+                OrderRecord& r = out[n++];
+                r.seq = node.seq;
+                r.original_price = node.original_price;
+                r.sort_price = node.sort_price;
+                r.volume = node.volume;
+                r.type = static_cast<uint8_t>(node.type);
+                r.side = static_cast<uint8_t>(node.side);
+                r._pad[0] = r._pad[1] = 0;
+            });
+            p += n * sizeof(OrderRecord);
+            written_orders += seen;
+            if (seen != rec.order_count) count_mismatch = true;
+        }
+
+        // 3. Header 最后写，magic 有效即表示内容完整
+        Header* h = static_cast<Header*>(base);
+        std::memset(h, 0, sizeof(Header));
+        h->version = VERSION;
+        h->order_record_size = sizeof(OrderRecord);
+        h->shard_id = shard_id;
+        h->mddate = mddate;
+        h->mdtime = mdtime;
+        h->book_count = static_cast<uint32_t>(books.size());
+        h->watermark_count = static_cast<uint32_t>(watermarks.entries().size());
+        h->order_count = written_orders;
+        h->payload_size = payload;
+        h->sh_shard_count = static_cast<uint16_t>(layout.sh_shard_count);
+        h->sz_shard_count = static_cast<uint16_t>(layout.sz_shard_count);
+        h->magic = MAGIC;
+
+        // 只发起回写不等待 (worker 线程上调用，不能同步刷盘)：tmp + rename 已防进程崩溃；
+        // 掉电/内核崩溃时最近一次快照可能丢失或不完整，恢复时由 Header 校验拒绝并回落到追补
+        bool ok = !count_mismatch;
+        ::msync(base, file_size, MS_ASYNC);
+        ::munmap(base, file_size);
+        ::close(fd);
+
+        if (!ok) {
+            LOG_M_ERROR("Checkpoint order count mismatch: shard={} expected={} written={}",
+                        shard_id, order_count, written_orders);
+            ::unlink(tmp_path.c_str());
+            return false;
+        }
+        if (::rename(tmp_path.c_str(), path.c_str()) != 0) {
+            LOG_M_ERROR("rename failed: {} -> {} errno={}", tmp_path, path, errno);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 加载快照并重建订单簿
+     * @param expected_mddate 只接受该交易日的快照 (0 = 不校验)
+     * @param books 输出：重建的订单簿 (使用 pool 分配节点)
+     * @param watermarks 输出：快照时的通道序号水位
+     * @param expected_layout 只接受该分片布局写出的快照 (nullptr = 不校验)
+     * @return 成功返回 true；文件不存在/日期或分片布局不符/格式错误返回 false，books 保持为空
+     */
+    static bool load(const std::string& path, int32_t expected_mddate, ObjectPool<OrderNode>& pool,
+                     BookMap& books, ChannelWatermarks& watermarks, Header* out_header = nullptr,
+                     const symbol_utils::ExchangeShardConfig* expected_layout = nullptr) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+            ::close(fd);
+            return false;
+        }
+        size_t file_size = static_cast<size_t>(st.st_size);
+        void* base = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (base == MAP_FAILED) {
+            LOG_M_ERROR("mmap failed: {} errno={}", path, errno);
+            return false;
+        }
+
+        bool ok = restore_from(static_cast<const char*>(base), file_size, expected_mddate, expected_layout,
+                               pool, books, watermarks, out_header);
+        ::munmap(base, file_size);
+
+        if (!ok) {
+            books.clear();
+            watermarks.clear();
+        }
+        return ok;
+    }
+
+private:
+    static bool restore_from(const char* base, size_t file_size, int32_t expected_mddate,
+                             const symbol_utils::ExchangeShardConfig* expected_layout,
+                             ObjectPool<OrderNode>& pool, BookMap& books,
+                             ChannelWatermarks& watermarks, Header* out_header) {
+        const Header* h = reinterpret_cast<const Header*>(base);
+        if (h->magic != MAGIC || h->version != VERSION || h->order_record_size != sizeof(OrderRecord) ||
+            sizeof(Header) + h->payload_size != file_size) {
+            LOG_M_WARNING("Invalid checkpoint header, ignored");
+            return false;
+        }
+        if (expected_mddate != 0 && h->mddate != expected_mddate) {
+            LOG_M_WARNING("Checkpoint date mismatch: file={} expected={}, ignored", h->mddate, expected_mddate);
+            return false;
+        }
+        if (expected_layout && (h->sh_shard_count != expected_layout->sh_shard_count ||
+                                h->sz_shard_count != expected_layout->sz_shard_count)) {
+            LOG_M_WARNING("Checkpoint shard layout mismatch: file={}+{} expected={}+{}, ignored",
+                          h->sh_shard_count, h->sz_shard_count,
+                          expected_layout->sh_shard_count, expected_layout->sz_shard_count);
+            return false;
+        }
+        if (out_header) *out_header = *h;
+
+        const char* p = base + sizeof(Header);
+        const char* end = base + file_size;
+
+        size_t wm_bytes = h->watermark_count * sizeof(ChannelWatermarks::Entry);
+        if (p + wm_bytes > end) return false;
+        watermarks.assign(reinterpret_cast<const ChannelWatermarks::Entry*>(p), h->watermark_count);
+        p += wm_bytes;
+
+        for (uint32_t b = 0; b < h->book_count; ++b) {
+            if (p + sizeof(BookRecord) > end) return false;
+            BookRecord rec;
+            std::memcpy(&rec, p, sizeof(rec));
+            p += sizeof(rec);
+            rec.symbol[sizeof(rec.symbol) - 1] = '\0';
+
+            if (p + rec.order_count * sizeof(OrderRecord) > end) return false;
+            auto book = std::make_unique<FastOrderBook>(0, pool, rec.min_price, rec.max_price,
+                                                        exchange_of(rec.symbol),
+                                                        symbol_utils::tick_size_for(rec.symbol));
+            const OrderRecord* orders = reinterpret_cast<const OrderRecord*>(p);
+            for (uint64_t i = 0; i < rec.order_count; ++i) {
+                const OrderRecord& r = orders[i];
+                if (!book->restore_order(r.seq, static_cast<OrderType>(r.type), static_cast<Side>(r.side),
+                                         r.original_price, r.sort_price, r.volume)) {
+                    LOG_M_ERROR("Failed to restore order: symbol={} seq={}", rec.symbol, r.seq);
+                    return false;
+                }
+            }
+            p += rec.order_count * sizeof(OrderRecord);
+            books[rec.symbol] = std::move(book);
+        }
+        return true;
+    }
+};
+
+#undef LOG_MODULE
+
+#endif // BOOK_CHECKPOINT_H
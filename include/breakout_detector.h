@@ -242,10 +242,11 @@ private:
         if (vol > 0) return vol;
 
         // 目标价无挂单，找比目标价高的最近有挂单的档位
-        auto ask_levels = book.get_ask_levels(10);
-        for (const auto& [price, volume] : ask_levels) {
-            if (price > target_price_ && volume > 0) {
-                return volume;  // 监控这个更高的档位
+        PriceVolume ask_levels[FastOrderBook::DEPTH_CACHE_LEVELS];
+        int n = book.get_ask_levels(ask_levels, FastOrderBook::DEPTH_CACHE_LEVELS);
+        for (int i = 0; i < n; ++i) {
+            if (ask_levels[i].first > target_price_ && ask_levels[i].second > 0) {
+                return ask_levels[i].second;  // 监控这个更高的档位
             }
         }
 
@@ -0,0 +1,269 @@
+#ifndef CATCHUP_REPLAYER_H
+#define CATCHUP_REPLAYER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "mmap_reader.h"
+#include "persist_layer.h"
+#include "book_checkpoint.h"
+#include "FastOrderBook.h"
+#include "ObjectPool.h"
+#include "utils/symbol_utils.h"
+
+#define LOG_MODULE "Catchup"
+#include "logger.h"
+
+// ============================================================================
+// CatchupReplayer - 启动时从 PersistLayer 落盘文件追补订单簿
+// ============================================================================
+// 盘中启动时，当日 orders.bin / transactions.bin / ticks.bin 已包含重启前的逐笔。
+// 每个 worker 在开始消费实时队列前调用 replay_shard()，实时消息在队列中缓存：
+//
+//   1. 分区：worker i 扫描每个文件的第 i 段，按 symbol 计算分片，
+//      把记录下标追加到 parts_[i][目标分片]；所有分片并行扫描，每条记录只算一次分片。
+//   2. 栅栏：等待全部分片完成分区。
+//   3. 回放：worker s 按段顺序拼接 parts_[*][s]，先用 Tick 的涨跌停价建簿，
+//      再按序合并委托流和成交流回放到本分片订单簿。
+//
+// 合并规则：同一通道比较 applseqnum (逐笔序号在通道内委托/成交统一编号)，
+// 不同通道之间的相对顺序不影响单只股票的订单簿，按 local_recv_timestamp 排。
+//
+// 衔接点：回放得到的 (通道, 流) 最大 applseqnum 写入 replayed 水位，
+// worker 切换到实时队列后用它丢弃已回放过的消息 (与快照恢复共用去重逻辑)。
+//
+class CatchupReplayer {
+public:
+    using BookMap = std::unordered_map<std::string, std::unique_ptr<FastOrderBook>>;
+
+    struct Stats {
+        uint64_t orders = 0;        // 回放的委托
+        uint64_t transactions = 0;  // 回放的成交/撤单
+        uint64_t skipped = 0;       // 已被快照覆盖而跳过的逐笔
+        uint64_t books_created = 0;
+        int32_t last_mddate = 0;    // 最后一条回放逐笔的行情日期/时间
+        int32_t last_mdtime = 0;
+        int64_t elapsed_ms = 0;
+    };
+
+    // @param day_dir  当日数据目录 (PersistLayer 的 data_dir/YYYY/MM/DD)
+    // @param config   分片配置，需与 StrategyEngine 一致
+    CatchupReplayer(const std::string& day_dir, const symbol_utils::ExchangeShardConfig& config)
+        : day_dir_(day_dir), config_(config), shard_count_(config.total_shards()) {}
+
+    // 目录路径: data_dir/YYYY/MM/DD
+    static std::string day_dir_for(const std::string& data_dir, const std::string& date) {
+        return data_dir + "/" + date.substr(0, 4) + "/" + date.substr(4, 2) + "/" + date.substr(6, 2);
+    }
+
+    // 打开落盘文件并确定截止点 (start() 前在主线程调用)
+    // 委托或成交文件缺失时返回 false，不做追补；Tick 文件缺失时仅能追补已有订单簿
+    bool open() {
+        bool ok = orders_.open((day_dir_ + "/orders.bin").c_str(), PersistLayer::MAGIC_ORDER) &&
+                  txns_.open((day_dir_ + "/transactions.bin").c_str(), PersistLayer::MAGIC_TRANSACTION);
+        if (!ok) {
+            LOG_M_WARNING("No persisted order/transaction files under {}, catch-up disabled", day_dir_);
+            orders_.close();
+            txns_.close();
+            return false;
+        }
+        if (!ticks_.open((day_dir_ + "/ticks.bin").c_str(), PersistLayer::MAGIC_TICK)) {
+            LOG_M_WARNING("No persisted tick file under {}, books are created from live ticks only", day_dir_);
+        }
+
+        parts_.assign(static_cast<size_t>(shard_count_), std::vector<ShardIndex>(static_cast<size_t>(shard_count_)));
+        partitioned_.store(0, std::memory_order_relaxed);
+        finished_.store(0, std::memory_order_relaxed);
+        LOG_M_INFO("Catch-up source {}: orders={} transactions={} ticks={}",
+                   day_dir_, orders_.size(), txns_.size(), ticks_.size());
+        return true;
+    }
+
+    bool is_open() const { return orders_.is_open(); }
+
+    // 新建订单簿开启主力资金流向统计 (与 worker 实时路径一致)
+    void set_money_flow(const MoneyFlowBuckets& buckets) { money_flow_ = buckets; }
+
+    // 由 shard_id 对应的 worker 调用；所有分片都必须调用一次 (分区阶段有栅栏)
+    // @param skip      已由快照恢复的水位，被覆盖的逐笔跳过 (可为空)
+    // @param replayed  输出：回放到的 (通道, 流) 最大序号
+    Stats replay_shard(int shard_id, ObjectPool<OrderNode>& pool, BookMap& books,
+                       const ChannelWatermarks& skip, ChannelWatermarks& replayed) {
+        Stats stats;
+        auto t0 = std::chrono::steady_clock::now();
+
+        partition(shard_id);
+        partitioned_.fetch_add(1, std::memory_order_acq_rel);
+        while (partitioned_.load(std::memory_order_acquire) < shard_count_) {
+            std::this_thread::yield();
+        }
+
+        create_books(shard_id, pool, books, stats);
+        replay_sequenced(shard_id, books, skip, replayed, stats);
+
+        // 本分片下标表用完即释放；最后一个完成的分片关闭映射
+        for (auto& part : parts_) {
+            ShardIndex().swap(part[static_cast<size_t>(shard_id)]);
+        }
+        if (finished_.fetch_add(1, std::memory_order_acq_rel) + 1 == shard_count_) {
+            orders_.close();
+            txns_.close();
+            ticks_.close();
+        }
+
+        stats.elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - t0).count();
+        return stats;
+    }
+
+private:
+    // 单个 (扫描段, 目标分片) 的记录下标 (单日记录数 < 2^32)
+    struct ShardIndex {
+        std::vector<uint32_t> orders;
+        std::vector<uint32_t> txns;
+        std::vector<uint32_t> ticks;
+
+        void swap(ShardIndex& o) noexcept {
+            orders.swap(o.orders);
+            txns.swap(o.txns);
+            ticks.swap(o.ticks);
+        }
+    };
+
+    template<typename T>
+    void partition_file(const MmapReader<T>& file, int segment,
+                        std::vector<uint32_t> ShardIndex::*field) {
+        size_t n = file.size();
+        size_t begin = n * static_cast<size_t>(segment) / static_cast<size_t>(shard_count_);
+        size_t end = n * static_cast<size_t>(segment + 1) / static_cast<size_t>(shard_count_);
+        auto& out = parts_[static_cast<size_t>(segment)];
+        for (size_t i = begin; i < end; ++i) {
+            int shard = symbol_utils::get_exchange_shard_id(file[i].htscsecurityid, config_);
+            (out[static_cast<size_t>(shard)].*field).push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    void partition(int segment) {
+        partition_file(orders_, segment, &ShardIndex::orders);
+        partition_file(txns_, segment, &ShardIndex::txns);
+        if (ticks_.is_open()) partition_file(ticks_, segment, &ShardIndex::ticks);
+    }
+
+    std::vector<uint32_t> gather(int shard_id, std::vector<uint32_t> ShardIndex::*field) const {
+        size_t total = 0;
+        for (const auto& part : parts_) total += (part[static_cast<size_t>(shard_id)].*field).size();
+        std::vector<uint32_t> out;
+        out.reserve(total);
+        for (const auto& part : parts_) {
+            const auto& v = part[static_cast<size_t>(shard_id)].*field;
+            out.insert(out.end(), v.begin(), v.end());
+        }
+        return out;
+    }
+
+    // 与 worker 实时路径一致：用首条 Tick 的涨跌停价建簿，涨跌停价无效时建无界订单簿
+    void create_books(int shard_id, ObjectPool<OrderNode>& pool, BookMap& books, Stats& stats) {
+        if (!ticks_.is_open()) return;
+        for (uint32_t i : gather(shard_id, &ShardIndex::ticks)) {
+            const MDStockStruct& tick = ticks_[i];
+            auto it = books.find(tick.htscsecurityid);
+            if (it != books.end()) continue;
+            uint32_t min_price = static_cast<uint32_t>(tick.minpx);
+            uint32_t max_price = static_cast<uint32_t>(tick.maxpx);
+            if (min_price == 0 || max_price <= min_price) {
+                min_price = 0;
+                max_price = 0;
+            }
+            auto book = std::make_unique<FastOrderBook>(
+                0, pool, min_price, max_price,
+                exchange_of(tick.htscsecurityid), symbol_utils::tick_size_for(tick.htscsecurityid));
+            if (money_flow_) book->enable_money_flow(*money_flow_);
+            books.emplace(tick.htscsecurityid, std::move(book));
+            ++stats.books_created;
+        }
+    }
+
+    // 委托 a 是否应排在成交 b 之前
+    static bool order_first(const MDOrderStruct& a, const MDTransactionStruct& b) {
+        if (a.channelno == b.channelno) return a.applseqnum < b.applseqnum;
+        return a.local_recv_timestamp <= b.local_recv_timestamp;
+    }
+
+    void replay_sequenced(int shard_id, BookMap& books, const ChannelWatermarks& skip,
+                          ChannelWatermarks& replayed, Stats& stats) {
+        std::vector<uint32_t> order_idx = gather(shard_id, &ShardIndex::orders);
+        std::vector<uint32_t> txn_idx = gather(shard_id, &ShardIndex::txns);
+        const bool check_skip = !skip.empty();
+
+        // 连续同一股票时复用查找结果
+        const char* last_symbol = nullptr;
+        FastOrderBook* last_book = nullptr;
+        auto find_book = [&](const char* symbol) -> FastOrderBook* {
+            if (last_symbol && std::strcmp(last_symbol, symbol) == 0) return last_book;
+            auto it = books.find(symbol);
+            last_symbol = symbol;
+            last_book = (it != books.end()) ? it->second.get() : nullptr;
+            return last_book;
+        };
+
+        size_t oi = 0, ti = 0;
+        while (oi < order_idx.size() || ti < txn_idx.size()) {
+            bool take_order = ti >= txn_idx.size() ||
+                (oi < order_idx.size() && order_first(orders_[order_idx[oi]], txns_[txn_idx[ti]]));
+            if (take_order) {
+                const MDOrderStruct& o = orders_[order_idx[oi++]];
+                if (check_skip && skip.covers(o.channelno, ChannelWatermarks::ORDER, o.applseqnum)) {
+                    ++stats.skipped;
+                    continue;
+                }
+                replayed.update(o.channelno, ChannelWatermarks::ORDER, o.applseqnum);
+                stats.last_mddate = o.mddate;
+                stats.last_mdtime = o.mdtime;
+                if (FastOrderBook* book = find_book(o.htscsecurityid)) {
+                    book->on_order(o);
+                    ++stats.orders;
+                }
+            } else {
+                const MDTransactionStruct& t = txns_[txn_idx[ti++]];
+                if (check_skip && skip.covers(t.channelno, ChannelWatermarks::TRANSACTION, t.applseqnum)) {
+                    ++stats.skipped;
+                    continue;
+                }
+                replayed.update(t.channelno, ChannelWatermarks::TRANSACTION, t.applseqnum);
+                stats.last_mddate = t.mddate;
+                stats.last_mdtime = t.mdtime;
+                if (FastOrderBook* book = find_book(t.htscsecurityid)) {
+                    book->on_transaction(t);
+                    ++stats.transactions;
+                }
+            }
+        }
+    }
+
+    std::string day_dir_;
+    symbol_utils::ExchangeShardConfig config_;
+    int shard_count_;
+
+    MmapReader<MDOrderStruct> orders_;
+    MmapReader<MDTransactionStruct> txns_;
+    MmapReader<MDStockStruct> ticks_;
+
+    // 新建订单簿的主力资金流向分档 (未设置则不统计)
+    std::optional<MoneyFlowBuckets> money_flow_;
+
+    // parts_[扫描段][目标分片]
+    std::vector<std::vector<ShardIndex>> parts_;
+    std::atomic<int> partitioned_{0};
+    std::atomic<int> finished_{0};
+};
+
+#undef LOG_MODULE
+
+#endif // CATCHUP_REPLAYER_H
@@ -108,7 +108,8 @@ public:
 
                     // 持久化 (入队，不阻塞)
                     if (persist_) persist_->log_tick(stock);
-                    engine_->on_market_tick(stock);
+                    // 在解码处登记证券 ID，引擎内按 ID 路由
+                    engine_->on_market_tick(stock, engine_->intern_symbol(stock.htscsecurityid));
                 }
                 break;
             }
@@ -126,7 +127,7 @@ public:
 
                     // 持久化 (入队，不阻塞)
                     if (persist_) persist_->log_order(order);
-                    engine_->on_market_order(order);
+                    engine_->on_market_order(order, engine_->intern_symbol(order.htscsecurityid));
                 }
                 break;
             }
@@ -144,7 +145,7 @@ public:
 
                     // 持久化 (入队，不阻塞)
                     if (persist_) persist_->log_transaction(transaction);
-                    engine_->on_market_transaction(transaction);
+                    engine_->on_market_transaction(transaction, engine_->intern_symbol(transaction.htscsecurityid));
                 }
                 break;
             }
@@ -559,7 +560,7 @@ private:
         convert_to_orderbook_snapshot_fast(snapshot, ob);
         // 持久化 (入队，不阻塞)
         if (persist_) persist_->log_snapshot(ob);
-        engine_->on_market_orderbook_snapshot(ob);
+        engine_->on_market_orderbook_snapshot(ob, engine_->intern_symbol(ob.htscsecurityid));
 
         // // 只打印 603277 的快照
         // if (std::strncmp(ob.htscsecurityid, "603277", 6) != 0) {
@@ -0,0 +1,121 @@
+#ifndef MMAP_READER_H
+#define MMAP_READER_H
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "mmap_writer.h"
+
+#define LOG_MODULE "MmapReader"
+#include "logger.h"
+
+// ============================================================================
+// MmapReader - MmapWriter 文件的只读映射
+// ============================================================================
+// 与 MmapWriter 格式一致: [64 字节 Header] + [N 条 Record]
+// 只读 MAP_SHARED 映射，可与正在写入的 PersistLayer 同时打开同一文件：
+// open() 时读取一次 record_count 作为本次可见的记录数 (截止点)，之后追加的记录不可见。
+//
+template<typename T>
+class MmapReader {
+public:
+    using Header = typename MmapWriter<T>::Header;
+    static constexpr size_t HEADER_SIZE = MmapWriter<T>::HEADER_SIZE;
+
+private:
+    int fd_ = -1;
+    void* base_ = nullptr;
+    size_t file_size_ = 0;
+    size_t count_ = 0;           // open() 时的记录数
+    const T* data_ = nullptr;
+    std::string path_;
+
+public:
+    MmapReader() = default;
+
+    ~MmapReader() {
+        close();
+    }
+
+    // 禁用拷贝
+    MmapReader(const MmapReader&) = delete;
+    MmapReader& operator=(const MmapReader&) = delete;
+
+    // 打开文件并校验 magic / struct_size
+    // @param path   文件路径
+    // @param magic  文件类型标识
+    // @return 成功返回 true
+    bool open(const char* path, uint32_t magic) {
+        close();
+        path_ = path;
+
+        fd_ = ::open(path, O_RDONLY);
+        if (fd_ < 0) {
+            LOG_M_WARNING("Failed to open file: {} errno={}", path, errno);
+            return false;
+        }
+
+        struct stat st;
+        if (::fstat(fd_, &st) != 0 || static_cast<size_t>(st.st_size) < HEADER_SIZE) {
+            LOG_M_ERROR("File too small: {}", path);
+            close();
+            return false;
+        }
+        file_size_ = static_cast<size_t>(st.st_size);
+
+        base_ = ::mmap(nullptr, file_size_, PROT_READ, MAP_SHARED, fd_, 0);
+        if (base_ == MAP_FAILED) {
+            LOG_M_ERROR("mmap failed: {} errno={}", path, errno);
+            base_ = nullptr;
+            close();
+            return false;
+        }
+
+        const Header* header = reinterpret_cast<const Header*>(base_);
+        if (header->magic != magic || header->struct_size != sizeof(T)) {
+            LOG_M_ERROR("Header mismatch: {} magic=0x{:08X} struct_size={} expected=0x{:08X}/{}",
+                        path, header->magic, header->struct_size, magic, sizeof(T));
+            close();
+            return false;
+        }
+
+        // 截止点：不超过文件实际容量
+        size_t count = static_cast<size_t>(header->record_count.load(std::memory_order_acquire));
+        size_t max_count = (file_size_ - HEADER_SIZE) / sizeof(T);
+        count_ = count < max_count ? count : max_count;
+        data_ = reinterpret_cast<const T*>(static_cast<const char*>(base_) + HEADER_SIZE);
+
+        // 顺序扫描为主
+        ::madvise(base_, file_size_, MADV_SEQUENTIAL);
+        return true;
+    }
+
+    void close() {
+        if (base_) {
+            ::munmap(base_, file_size_);
+            base_ = nullptr;
+            data_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        count_ = 0;
+    }
+
+    bool is_open() const { return base_ != nullptr; }
+
+    // open() 时可见的记录数
+    size_t size() const { return count_; }
+
+    const T* data() const { return data_; }
+    const T& operator[](size_t i) const { return data_[i]; }
+};
+
+#undef LOG_MODULE
+
+#endif // MMAP_READER_H
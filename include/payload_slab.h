@@ -0,0 +1,81 @@
+#ifndef PAYLOAD_SLAB_H
+#define PAYLOAD_SLAB_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "concurrentqueue.h"
+
+// ============================================================================
+// PayloadSlab - 大行情记录的分片内暂存槽 (多生产者取槽，分片 worker 归还)
+// ============================================================================
+// 队列消息只内联小记录 (逐笔委托/成交)；Tick (2216 字节) 与十档快照按指针引用本分片的槽位：
+//   生产者：acquire() 取空闲槽 -> 写入记录 -> 指针随消息入队
+//   消费者：处理完该消息后 release() 归还
+// 空闲槽为无锁队列；空闲槽耗尽时加锁追加一整块 (按需增长、不搬移、不回收)，
+// 槽位总数等于历史在途峰值。块内存由本对象持有，析构时统一释放
+// (停止时仍在队列中的消息无需逐条归还)。
+//
+// 归还走 worker 专用的显式生产者 (ProducerToken) + try_enqueue：只使用预分配并循环复用的队列块，
+// 热路径不分配内存；预分配耗尽 (空闲槽积压超过 free_reserve) 时才退回会分配的 enqueue 并计数。
+// 因此 release() 只能由同一个线程 (所属分片 worker) 调用。
+//
+template <typename T>
+class PayloadSlab {
+public:
+    static constexpr size_t DEFAULT_CHUNK = 64;
+    static constexpr size_t DEFAULT_FREE_RESERVE = 4096;   // 空闲队列预分配的指针数
+
+    explicit PayloadSlab(size_t chunk_slots = DEFAULT_CHUNK, size_t free_reserve = DEFAULT_FREE_RESERVE)
+        : chunk_slots_(chunk_slots ? chunk_slots : 1), free_(free_reserve), release_token_(free_) {}
+
+    PayloadSlab(const PayloadSlab&) = delete;
+    PayloadSlab& operator=(const PayloadSlab&) = delete;
+
+    // 取空闲槽 (任意生产者线程)
+    T* acquire() {
+        T* slot;
+        if (free_.try_dequeue(slot)) return slot;
+        return grow();
+    }
+
+    // 归还槽位 (仅限消费者线程，消息处理完后)
+    void release(T* slot) {
+        if (free_.try_enqueue(release_token_, slot)) return;
+        slow_releases_.fetch_add(1, std::memory_order_relaxed);
+        free_.enqueue(release_token_, slot);
+    }
+
+    // 预分配不足、归还时分配了队列块的次数 (监控用，稳态应为 0)
+    uint64_t slow_release_count() const { return slow_releases_.load(std::memory_order_relaxed); }
+
+    // 已分配槽位数 (在途峰值)
+    size_t capacity() const { return capacity_.load(std::memory_order_relaxed); }
+
+private:
+    // 追加一块：首个槽位直接返回，其余放入空闲队列
+    T* grow() {
+        std::lock_guard<std::mutex> lock(grow_mutex_);
+        chunks_.emplace_back(new T[chunk_slots_]);
+        T* chunk = chunks_.back().get();
+        std::vector<T*> rest;
+        rest.reserve(chunk_slots_ - 1);
+        for (size_t i = 1; i < chunk_slots_; ++i) rest.push_back(chunk + i);
+        free_.enqueue_bulk(rest.begin(), rest.size());
+        capacity_.fetch_add(chunk_slots_, std::memory_order_relaxed);
+        return chunk;
+    }
+
+    size_t chunk_slots_;
+    moodycamel::ConcurrentQueue<T*> free_;
+    moodycamel::ProducerToken release_token_;   // 消费者线程专用
+    std::mutex grow_mutex_;
+    std::vector<std::unique_ptr<T[]>> chunks_;   // 仅在 grow_mutex_ 内访问
+    std::atomic<size_t> capacity_{0};
+    std::atomic<uint64_t> slow_releases_{0};
+};
+
+#endif // PAYLOAD_SLAB_H
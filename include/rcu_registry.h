@@ -0,0 +1,110 @@
+#ifndef RCU_REGISTRY_H
+#define RCU_REGISTRY_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// RcuRegistry - 按分片发布的不可变 局部证券 ID -> 对象指针表 (RCU)
+// ============================================================================
+// 每个分片一个不可变快照 (按 SymbolTable 分配的分片内局部 ID 下标的平坦数组)，分片 worker 为唯一读者：
+//   读：snapshot() 一次 acquire load 取得当前快照，快照内的引用在下一个静止点前有效；
+//       每处理完一条消息调用 quiescent()，声明不再持有旧快照的引用。
+//   写：复制当前快照 -> 修改 -> release 发布 -> 全局纪元 +1 -> 等待所有在线读者
+//       越过新纪元的静止点 (宽限期) -> 释放旧快照。
+// 读端无锁、无共享写 (静止点只写本分片独占的缓存行)；写端 (运行时增删策略) 极少发生，
+// 由调用方串行化，宽限期最长为各 worker 处理一条消息的时间。
+// 未启动/已退出的读者处于离线状态 (纪元 0)，不阻塞宽限期。
+//
+template <typename T>
+class RcuRegistry {
+public:
+    using List = std::vector<T*>;
+    using Map = std::vector<List>;   // 下标 = 分片内局部 ID
+
+    explicit RcuRegistry(int shard_count) : shards_(static_cast<size_t>(shard_count)) {
+        for (auto& s : shards_) s.current.store(new Map(), std::memory_order_relaxed);
+    }
+
+    ~RcuRegistry() {
+        for (auto& s : shards_) delete s.current.load(std::memory_order_relaxed);
+    }
+
+    RcuRegistry(const RcuRegistry&) = delete;
+    RcuRegistry& operator=(const RcuRegistry&) = delete;
+
+    int shard_count() const { return static_cast<int>(shards_.size()); }
+
+    // ---- 读端 (分片 worker) ----
+
+    // 当前快照；引用在本读者下一次 quiescent()/offline() 前有效
+    const Map& snapshot(int shard) const {
+        return *shards_[static_cast<size_t>(shard)].current.load(std::memory_order_acquire);
+    }
+
+    // 局部 ID 的对象列表，超出快照范围返回 nullptr (列表可能为空)
+    const List* find(int shard, uint32_t local_id) const {
+        const Map& m = snapshot(shard);
+        return local_id < m.size() ? &m[local_id] : nullptr;
+    }
+
+    // 读者上线 (worker 启动时)：与写者的 "发布后检查读者" 构成 Dekker 式配对——
+    // 写者若看到本读者离线而不等待，本读者此后的 snapshot() 必然看到新快照
+    void online(int shard) {
+        shards_[static_cast<size_t>(shard)].seen.store(epoch_.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    // 静止点：此前取得的快照引用均已不再使用
+    void quiescent(int shard) {
+        auto& seen = shards_[static_cast<size_t>(shard)].seen;
+        uint64_t e = epoch_.load(std::memory_order_acquire);
+        if (seen.load(std::memory_order_relaxed) != e) seen.store(e, std::memory_order_release);
+    }
+
+    // 读者离线 (worker 退出时)
+    void offline(int shard) {
+        shards_[static_cast<size_t>(shard)].seen.store(0, std::memory_order_release);
+    }
+
+    // ---- 写端 (调用方串行化；非读者线程读取快照也须由同一把锁保护) ----
+
+    // 复制分片当前快照，交给 mutate 修改后发布，宽限期结束后释放旧快照
+    template <typename F>
+    void update(int shard, F&& mutate) {
+        auto& s = shards_[static_cast<size_t>(shard)];
+        Map* old_map = s.current.load(std::memory_order_relaxed);
+        std::unique_ptr<Map> next = std::make_unique<Map>(*old_map);
+        mutate(*next);
+        s.current.store(next.release(), std::memory_order_seq_cst);
+        synchronize();
+        delete old_map;
+    }
+
+    // 等待所有在线读者越过一个静止点：此后旧快照 (及其中已移除的对象) 不再被读者引用
+    void synchronize() {
+        uint64_t target = epoch_.fetch_add(1, std::memory_order_seq_cst) + 1;
+        for (auto& s : shards_) {
+            for (;;) {
+                uint64_t seen = s.seen.load(std::memory_order_seq_cst);
+                if (seen == 0 || seen >= target) break;
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    // 每个分片独占缓存行：读者写 seen 不与其他分片伪共享
+    struct alignas(64) Shard {
+        std::atomic<Map*> current{nullptr};
+        std::atomic<uint64_t> seen{0};   // 读者最近一次静止点看到的纪元，0 = 离线
+    };
+
+    std::vector<Shard> shards_;
+    std::atomic<uint64_t> epoch_{1};
+};
+
+#endif // RCU_REGISTRY_H
@@ -0,0 +1,79 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// ============================================================================
+// SpscRing - 有界单生产者单消费者环形队列
+// ============================================================================
+// 行情接入矩阵的一格：一个网关线程 -> 一个分片 worker。容量为 2 的幂，构造时一次分配，
+// 之后入队/出队不分配内存。
+//   生产者：写槽位 -> release 发布 tail
+//   消费者：acquire 读 tail -> 批量拷出 -> release 发布 head
+// head/tail 各占一条缓存行；双方各缓存对端位置，只有看似满 (或不够一批) 时才读取对端缓存行。
+// 满时 try_push 返回 false，由调用方决定背压策略。
+//
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) : mask_(round_up(capacity) - 1), buf_(new T[mask_ + 1]) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    size_t capacity() const { return mask_ + 1; }
+
+    // ---- 生产者 ----
+    bool try_push(const T& v) {
+        size_t t = tail_.load(std::memory_order_relaxed);
+        if (t - cached_head_ > mask_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (t - cached_head_ > mask_) return false;
+        }
+        buf_[t & mask_] = v;
+        tail_.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // ---- 消费者 ----
+    // 最多取出 max 条 (保持入队顺序)，返回实际条数
+    size_t pop_bulk(T* out, size_t max) {
+        size_t h = head_.load(std::memory_order_relaxed);
+        size_t avail = cached_tail_ - h;
+        if (avail < max) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            avail = cached_tail_ - h;
+            if (avail == 0) return 0;
+        }
+        size_t n = avail < max ? avail : max;
+        for (size_t i = 0; i < n; ++i) out[i] = buf_[(h + i) & mask_];
+        head_.store(h + n, std::memory_order_release);
+        return n;
+    }
+
+    // 近似长度 (监控用)
+    size_t size_approx() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+private:
+    static size_t round_up(size_t n) {
+        size_t c = 2;
+        while (c < n) c <<= 1;
+        return c;
+    }
+
+    // 消费者独占行
+    alignas(64) std::atomic<size_t> head_{0};
+    size_t cached_tail_ = 0;
+    // 生产者独占行
+    alignas(64) std::atomic<size_t> tail_{0};
+    size_t cached_head_ = 0;
+    // 只读
+    alignas(64) const size_t mask_;
+    const std::unique_ptr<T[]> buf_;
+};
+
+#endif // SPSC_RING_H
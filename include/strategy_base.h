@@ -30,11 +30,24 @@ public:
     // 成交数据回调
     virtual void on_transaction(const MDTransactionStruct& transaction, const FastOrderBook& book) {}
 
+    // 档位变动回调：本条逐笔消息引起的档位变动 (变动后状态)，在 on_order/on_transaction 之前调用
+    // 需要完整盘口时可调用 book.build_l2_snapshot() 合成 N 档快照
+    virtual void on_level_changes(const LevelChange* /*changes*/, size_t /*count*/, const FastOrderBook& /*book*/) {}
+
+    // 订单事件回调：关注范围内订单的挂入/成交/撤单 (先于 on_level_changes 调用)
+    // 关注范围在 on_book_ready 或之后通过 book_->watch_orders()/watch_side() 登记
+    virtual void on_order_events(const OrderEvent* /*events*/, size_t /*count*/, const FastOrderBook& /*book*/) {}
+
+    // 订单簿绑定回调：首次 Tick 时工作线程绑定本股票订单簿后调用 (工作线程内)
+    // 需要盘口流量指标 (不平衡度/微观价格/OFI) 的策略在此调用 book.enable_flow_metrics()
+    virtual void on_book_ready(FastOrderBook& /*book*/) {}
+
     // OrderBook 快照回调
     virtual void on_orderbook_snapshot(const MDOrderbookStruct& snapshot) {}
 
     // 控制消息回调（默认实现处理 ENABLE/DISABLE）
-    // 实现在 src/strategy_base.cpp
+    // 实现在 src/strategy_base.cpp；运行时移除策略前引擎会先发送 DISABLE (工作线程内)，
+    // 策略在此释放在订单簿上登记的关注 (on_stop 在控制线程调用，不能访问订单簿)
     virtual void on_control_message(const ControlMessage& msg);
 
     // 唯一标识符，用于移除策略
@@ -52,9 +65,18 @@ public:
     // 设置策略上下文（用于下单等操作）
     void set_context(StrategyContext* ctx) { ctx_ = ctx; }
 
+    // 绑定订单簿 (由工作线程在 on_tick 前调用)
+    void bind_book(FastOrderBook& book) {
+        if (book_ != &book) {
+            book_ = &book;
+            on_book_ready(book);
+        }
+    }
+
 protected:
     bool enabled_ = true;       // 默认启用
     StrategyContext* ctx_ = nullptr;  // 策略上下文
+    FastOrderBook* book_ = nullptr;   // 本股票订单簿 (工作线程内使用)
 
     // 下单方法（策略调用此方法发出交易信号）
     void place_order(const TradeSignal& signal);
@@ -11,16 +11,26 @@
 #include <unordered_map>
 #include <map>
 #include <memory>
-#include <variant>
+#include <optional>
 #include <array>
 #include <shared_mutex>
 #include <type_traits>
 #include <chrono>
+#include <filesystem>
 #include "concurrentqueue.h"
 #include "market_data_structs_aligned.h"
 #include "strategy_base.h"
 #include "strategy_ids.h"
 #include "utils/symbol_utils.h"
+#include "utils/time_util.h"
+#include "utils/cpu_affinity.h"
+#include "book_checkpoint.h"
+#include "catchup_replayer.h"
+#include "rcu_registry.h"
+#include "symbol_table.h"
+#include "payload_slab.h"
+#include "spsc_ring.h"
+#include "wait_policy.h"
 #include "logger.h"
 
 #define LOG_MODULE MOD_ENGINE
@@ -34,9 +44,11 @@ class StrategyContext;
 #if defined(__GNUC__) || defined(__clang__)
     #define MD_LIKELY(x)   __builtin_expect(!!(x), 1)
     #define MD_UNLIKELY(x) __builtin_expect(!!(x), 0)
+    #define MD_PREFETCH(p) __builtin_prefetch(p)
 #else
     #define MD_LIKELY(x)   (x)
     #define MD_UNLIKELY(x) (x)
+    #define MD_PREFETCH(p) ((void)(p))
 #endif
 
 // ==========================================
@@ -51,6 +63,7 @@ struct ControlMessage {
     uint32_t unique_id;      // 唯一 ID (stock_code << 9 | exchange << 8 | strategy_id)
     char symbol[48];         // 保留用于 shard 路由
     uint32_t param = 0;      // 通用参数（如 target_price，价格*10000的整数格式）
+    uint32_t ack_ticket = 0; // 非 0 时 worker 处理完后回写 (运行时移除策略时等待)
 
     static ControlMessage enable(const std::string& sym, const std::string& strat_name, uint32_t param_value = 0) {
         ControlMessage msg;
@@ -74,9 +87,70 @@ struct ControlMessage {
 };
 
 // ==========================================
-// 市场数据消息类型
+// 队列消息 (带标签的紧凑格式)
 // ==========================================
-using MarketMessage = std::variant<MDStockStruct, MDOrderStruct, MDTransactionStruct, MDOrderbookStruct, ControlMessage>;
+// symbol_id 为入口处登记的全局证券 ID (SymbolTable)，worker 按 ID 直接下标访问。
+// 逐笔委托/成交与控制消息内联；Tick (2216 字节) 与十档快照 (736 字节) 写入目标分片的
+// PayloadSlab 槽位、只传指针，worker 处理完归还。队列槽位按最大内联记录 (委托 144 字节) 计，
+// 最频繁的逐笔消息入队/出队只拷贝实际大小，而非 variant 的最大成员。
+struct QueueMessage {
+    enum class Kind : uint8_t {
+        TICK,           // tick -> PayloadSlab 槽位
+        ORDER,
+        TRANSACTION,
+        ORDERBOOK,      // orderbook -> PayloadSlab 槽位
+        CONTROL
+    };
+
+    uint32_t symbol_id;
+    Kind kind;
+    union {
+        MDStockStruct* tick;
+        MDOrderbookStruct* orderbook;
+        MDOrderStruct order;
+        MDTransactionStruct transaction;
+        ControlMessage control;
+    };
+
+    QueueMessage() : symbol_id(0), kind(Kind::TICK), tick(nullptr) {}
+
+    static QueueMessage make_tick(uint32_t id, MDStockStruct* slot) {
+        QueueMessage m(id, Kind::TICK);
+        m.tick = slot;
+        return m;
+    }
+    static QueueMessage make_orderbook(uint32_t id, MDOrderbookStruct* slot) {
+        QueueMessage m(id, Kind::ORDERBOOK);
+        m.orderbook = slot;
+        return m;
+    }
+    static QueueMessage make_order(uint32_t id, const MDOrderStruct& order) {
+        QueueMessage m(id, Kind::ORDER);
+        m.order = order;
+        return m;
+    }
+    static QueueMessage make_transaction(uint32_t id, const MDTransactionStruct& transaction) {
+        QueueMessage m(id, Kind::TRANSACTION);
+        m.transaction = transaction;
+        return m;
+    }
+    static QueueMessage make_control(uint32_t id, const ControlMessage& control) {
+        QueueMessage m(id, Kind::CONTROL);
+        m.control = control;
+        return m;
+    }
+
+private:
+    QueueMessage(uint32_t id, Kind k) : symbol_id(id), kind(k), tick(nullptr) {}
+};
+static_assert(std::is_trivially_copyable_v<QueueMessage>, "QueueMessage 须可按字节搬移");
+static_assert(sizeof(QueueMessage) <= sizeof(MDOrderStruct) + 8, "QueueMessage 只内联小记录");
+
+// 每个分片的大记录暂存槽 (生产者写入，分片 worker 归还)
+struct ShardSlabs {
+    PayloadSlab<MDStockStruct> ticks;
+    PayloadSlab<MDOrderbookStruct> orderbooks;
+};
 
 // ==========================================
 // 行情中断监控 - 状态结构
@@ -89,6 +163,13 @@ struct SymbolDataStatus {
     bool has_strategy = false; // 是否有策略关注此股票
 };
 
+// worker 分片内按局部证券 ID 下标的状态 (持有订单簿；快照/整理也按此表遍历)
+struct SymbolSlot {
+    const char* symbol = nullptr;       // 指向 SymbolTable 条目，始终有效
+    std::unique_ptr<FastOrderBook> book;
+    SymbolDataStatus status;
+};
+
 // ==========================================
 // Symbol Hash 函数
 // ==========================================
@@ -124,27 +205,67 @@ public:
 
 private:
     symbol_utils::ExchangeShardConfig config_;  // 交易所分片配置
-    std::vector<std::unique_ptr<moodycamel::ConcurrentQueue<MarketMessage>>> queues_;
+    std::vector<std::unique_ptr<moodycamel::ConcurrentQueue<QueueMessage>>> queues_;
+    std::vector<std::unique_ptr<ShardSlabs>> slabs_;   // 与 queues_ 一一对应
+
+    // SPSC 接入矩阵 (可选)：[shard_id * ingest_rows_ + 网关线程行号]，worker 轮询本分片一列
+    // 网关线程首次入队时领取行号；行号用尽的线程与控制消息仍走 queues_
+    int ingest_rows_ = 0;                                  // 0 = 仅 MPMC 队列
+    std::vector<std::unique_ptr<SpscRing<QueueMessage>>> rings_;
+    std::atomic<int> next_ingest_row_{0};
+    std::atomic<uint64_t> ring_full_count_{0};             // 环满等待次数 (背压)
+
+    // worker 空闲等待策略 (每分片一个，park 模式由生产者入队后唤醒) 与绑核
+    std::vector<std::unique_ptr<WorkerWaiter>> waiters_;
+    std::vector<int> worker_cpus_;                         // 下标 = shard_id，-1 / 缺省 = 不绑核
+    std::vector<int> gateway_cpus_;                        // 网关推送线程按首次入队顺序依次绑定
+    std::atomic<size_t> next_gateway_cpu_{0};
     std::vector<std::thread> workers_;
     std::atomic<bool> running_{true};
     std::atomic<bool> stopped_{false};
+    std::atomic<bool> workers_started_{false};
+    std::atomic<uint32_t> control_acked_{0};               // worker 最近处理完的 ack_ticket
+    uint32_t next_ack_ticket_ = 0;                         // registry_mutex_ 内递增
     std::atomic<StrategyContext*> current_ctx_{nullptr};  // 当前上下文（用于动态添加的策略）
 
     // 策略所有权管理：key = unique_id (uint32_t)
     std::unordered_map<uint32_t, std::unique_ptr<Strategy>> owned_strategies_;
 
-    // 策略注册表：[shard_id][symbol] -> 策略列表（快速查找用的裸指针）
-    // 注意：这里的 key 仍然是 symbol（用于市场数据路由）
-    using StrategyMap = std::unordered_map<std::string, std::vector<Strategy*>>;
-    std::vector<StrategyMap> registry_;
+    // 证券代码 -> 稠密 ID (全局 ID、分片、分片内局部 ID)，行情入口登记一次
+    SymbolTable symbols_;
+
+    // 策略注册表：[shard_id][局部 ID] -> 策略列表（快速查找用的裸指针）
+    // RCU 发布：worker 无锁读取本分片快照，写者复制-修改-发布，宽限期后释放旧快照
+    RcuRegistry<Strategy> registry_;
 
-    // 读写锁保护 registry_（支持运行时动态添加/删除策略）
+    // 读写锁串行化注册表写者并保护 owned_strategies_（worker 热路径不加锁）
     mutable std::shared_mutex registry_mutex_;
 
+    // 跨线程一档快照：symbol -> seqlock 记录 (worker 建簿时登记，只增不删，指针稳定)
+    std::unordered_map<std::string, std::unique_ptr<SeqlockTopOfBook>> tops_;
+    mutable std::shared_mutex tops_mutex_;
+
     // 行情中断检测阈值（毫秒）
     int64_t interrupt_threshold_strategy_ms_ = 5000;   // 策略关注股票
     int64_t interrupt_threshold_other_ms_ = 20000;     // 非策略股票
 
+    // 订单簿快照 (Warm Restart)
+    std::string checkpoint_dir_;
+    int checkpoint_interval_sec_ = 0;      // 0 = 不写快照
+    int32_t checkpoint_restore_date_ = 0;  // 非 0 = 启动时恢复该交易日的快照
+
+    // 启动追补：从 PersistLayer 当日落盘文件重建订单簿 (nullptr = 不追补)
+    std::unique_ptr<CatchupReplayer> catchup_;
+
+    // worker 订单节点池的大页/预缺页选项
+    ObjectPoolOptions pool_options_;
+
+    // 午休时整理订单簿节点 (按队列顺序重排到连续 slab)
+    bool compact_at_lunch_ = true;
+
+    // 主力资金流向分档 (未设置则不统计)；须在建簿时开启，以登记挂单的原始委托量
+    std::optional<MoneyFlowBuckets> money_flow_;
+
     // 共享的 thread_local token 数组（修复消息乱序bug）
     // 关键：所有 on_market_* 方法必须共享同一个 token 数组，
     // 否则同一线程的不同 token 会导致消息乱序！
@@ -157,9 +278,11 @@ private:
 public:
     // 构造函数：支持自定义分片配置
     explicit StrategyEngine(const symbol_utils::ExchangeShardConfig& config = symbol_utils::DEFAULT_EXCHANGE_CONFIG)
-        : config_(config), registry_(config.total_shards()) {
+        : config_(config), symbols_(config), registry_(config.total_shards()) {
         for (int i = 0; i < config_.total_shards(); ++i) {
-            queues_.push_back(std::make_unique<moodycamel::ConcurrentQueue<MarketMessage>>(65536));
+            queues_.push_back(std::make_unique<moodycamel::ConcurrentQueue<QueueMessage>>(65536));
+            slabs_.push_back(std::make_unique<ShardSlabs>());
+            waiters_.push_back(std::make_unique<WorkerWaiter>());
         }
     }
 
@@ -175,21 +298,91 @@ public:
         interrupt_threshold_other_ms_ = other_ms;
     }
 
+    // 设置订单簿快照（start() 前调用）
+    // dir: 快照目录，每个分片一个文件
+    // interval_sec: 写快照间隔（秒），0 表示不写
+    // restore_date: 启动时恢复该交易日 (YYYYMMDD) 的快照，0 表示不恢复
+    void set_checkpoint(const std::string& dir, int interval_sec, int32_t restore_date) {
+        checkpoint_dir_ = dir;
+        checkpoint_interval_sec_ = interval_sec;
+        checkpoint_restore_date_ = restore_date;
+    }
+
+    // 设置订单节点池内存选项（start() 前调用）
+    void set_pool_options(const ObjectPoolOptions& options) {
+        pool_options_ = options;
+    }
+
+    // 设置午休时是否整理订单簿节点（start() 前调用）
+    void set_book_compaction(bool enable) {
+        compact_at_lunch_ = enable;
+    }
+
+    // 设置启动追补（start() 前调用）
+    // day_dir: PersistLayer 当日目录 (data_dir/YYYY/MM/DD)，各 worker 先回放其中本分片的逐笔再消费实时队列
+    // @return 落盘文件可用返回 true
+    bool set_catchup(const std::string& day_dir) {
+        auto replayer = std::make_unique<CatchupReplayer>(day_dir, config_);
+        if (!replayer->open()) {
+            return false;
+        }
+        if (money_flow_) replayer->set_money_flow(*money_flow_);
+        catchup_ = std::move(replayer);
+        return true;
+    }
+
+    // 启用 SPSC 接入矩阵（start() 前、行情接入前调用）
+    // producers: 网关推送线程数 (矩阵行数)，超出的线程回退到 MPMC 队列
+    // ring_capacity: 每格容量 (条)，满时生产者等待 worker 消费，不丢弃不分配
+    void set_spsc_ingest(int producers, size_t ring_capacity) {
+        if (producers <= 0) return;
+        ingest_rows_ = producers;
+        rings_.clear();
+        rings_.reserve(static_cast<size_t>(config_.total_shards() * producers));
+        for (int i = 0; i < config_.total_shards() * producers; ++i) {
+            rings_.push_back(std::make_unique<SpscRing<QueueMessage>>(ring_capacity));
+        }
+        // MPMC 队列只承载控制消息与溢出线程，不再预分配大容量
+        for (auto& q : queues_) q = std::make_unique<moodycamel::ConcurrentQueue<QueueMessage>>(1024);
+        LOG_M_INFO("SPSC ingest: {} producers x {} shards, ring capacity {} ({} KB total)",
+                   producers, config_.total_shards(), rings_.front()->capacity(),
+                   rings_.size() * rings_.front()->capacity() * sizeof(QueueMessage) / 1024);
+    }
+
+    int spsc_ingest_rows() const { return ingest_rows_; }
+    uint64_t ring_full_count() const { return ring_full_count_.load(std::memory_order_relaxed); }
+
+    // ==========================================
+    // worker 等待策略与绑核
+    // ==========================================
+
+    // 设置分片 worker 的空闲等待策略（start() 前调用）
+    void set_worker_wait(int shard_id, WaitMode mode, uint32_t spin_limit = WorkerWaiter::DEFAULT_SPIN_LIMIT) {
+        if (shard_id < 0 || shard_id >= config_.total_shards()) return;
+        waiters_[shard_id]->configure(mode, spin_limit);
+    }
+
+    const WorkerWaiter& worker_waiter(int shard_id) const { return *waiters_[shard_id]; }
+
+    // 设置 worker 绑核（start() 前调用）：cpus[shard_id]，不足的分片不绑核
+    void set_worker_cpus(const std::vector<int>& cpus) { worker_cpus_ = cpus; }
+
+    // 设置网关推送线程绑核（行情接入前调用）：线程首次入队时按顺序领取，用尽后不绑核
+    void set_gateway_cpus(const std::vector<int>& cpus) { gateway_cpus_ = cpus; }
+
+    // 设置主力资金流向统计（start() 前调用），所有订单簿建簿时开启
+    void set_money_flow(const MoneyFlowBuckets& buckets) {
+        money_flow_ = buckets;
+        if (catchup_) catchup_->set_money_flow(buckets);
+    }
+
     ~StrategyEngine() {
         stop();
     }
 
-    // 辅助函数：从 MarketMessage 中提取 symbol
-    static const char* get_symbol(const MarketMessage& msg) {
-        return std::visit([](auto&& data) -> const char* {
-            using T = std::decay_t<decltype(data)>;
-            if constexpr (std::is_same_v<T, ControlMessage>) {
-                return data.symbol;
-            } else {
-                return data.htscsecurityid;
-            }
-        }, msg);
-    }
+    // 证券代码表（启动时预登记全市场代码；ID 在行情入口分配）
+    SymbolTable& symbol_table() { return symbols_; }
+    const SymbolTable& symbol_table() const { return symbols_; }
 
     // 注册策略（转移所有权）- 启动前调用
     // symbol: 股票代码（如 "600000.SH"）
@@ -209,14 +402,18 @@ public:
             return false;
         }
 
-        int shard_id = get_shard_id(symbol);
+        uint32_t symbol_id = symbols_.intern(symbol);
+        if (symbol_id == SymbolTable::INVALID_ID) {
+            LOG_M_ERROR("Symbol table full, cannot register strategy for {}", symbol);
+            return false;
+        }
         Strategy* raw_ptr = strat.get();
 
         // 1. 保存所有权（使用数字 key）
         owned_strategies_[key] = std::move(strat);
 
-        // 2. 注册裸指针到分片（按 symbol 路由市场数据）
-        registry_[shard_id][symbol].push_back(raw_ptr);
+        // 2. 注册裸指针到分片（按局部 ID 路由市场数据）
+        add_to_registry(symbols_.entry(symbol_id), raw_ptr);
         return true;
     }
 
@@ -242,14 +439,18 @@ public:
             return false;  // 已存在
         }
 
-        int shard_id = get_shard_id(symbol);
+        uint32_t symbol_id = symbols_.intern(symbol);
+        if (symbol_id == SymbolTable::INVALID_ID) {
+            LOG_M_ERROR("Symbol table full, cannot register strategy for {}", symbol);
+            return false;
+        }
         Strategy* raw_ptr = strat.get();
 
         // 保存所有权（使用数字 key）
         owned_strategies_[key] = std::move(strat);
 
-        // 注册裸指针到分片（按 symbol 路由）
-        registry_[shard_id][symbol].push_back(raw_ptr);
+        // 注册裸指针到分片（按局部 ID 路由），发布新快照
+        add_to_registry(symbols_.entry(symbol_id), raw_ptr);
 
         // 释放锁后设置上下文并调用 on_start()
         lock.unlock();
@@ -272,9 +473,24 @@ public:
     // 检查某个 symbol 是否有任意策略
     bool has_any_strategy(const std::string& symbol) const {
         std::shared_lock<std::shared_mutex> lock(registry_mutex_);
-        int shard_id = symbol_utils::get_exchange_shard_id(symbol.c_str(), config_);
-        auto it = registry_[shard_id].find(symbol);
-        return it != registry_[shard_id].end() && !it->second.empty();
+        uint32_t symbol_id = symbols_.find(symbol.c_str());
+        if (symbol_id == SymbolTable::INVALID_ID) return false;
+        const SymbolTable::Entry& entry = symbols_.entry(symbol_id);
+        const auto* list = registry_.find(entry.shard, entry.local_id);
+        return list && !list->empty();
+    }
+
+    // 读取某股票的一档快照（任意线程调用；仅在查表时持读锁，快照本身无锁读取）
+    // @return 尚未建簿返回 std::nullopt
+    std::optional<TopOfBook> query_top_of_book(const std::string& symbol) const {
+        const SeqlockTopOfBook* top = nullptr;
+        {
+            std::shared_lock<std::shared_mutex> lock(tops_mutex_);
+            auto it = tops_.find(symbol);
+            if (it != tops_.end()) top = it->second.get();
+        }
+        if (!top || !top->published()) return std::nullopt;
+        return top->read();
     }
 
     // 获取策略列表（返回 "symbol:strategy_name" 格式）
@@ -306,7 +522,21 @@ public:
             return;  // 不存在
         }
 
-        // 先调用 on_stop()（需要释放锁避免死锁）
+        // worker 运行中：先在工作线程内禁用 (策略释放订单簿上的关注等)，等处理完再移除
+        // 持写锁期间最多一条等待中的 ticket
+        if (workers_started_.load(std::memory_order_acquire)) {
+            ControlMessage ctrl = ControlMessage::disable(symbol, strategy_name);
+            ctrl.ack_ticket = ++next_ack_ticket_;
+            if (ctrl.ack_ticket == 0) ctrl.ack_ticket = ++next_ack_ticket_;
+            if (send_control_message(ctrl)) {
+                while (control_acked_.load(std::memory_order_acquire) != ctrl.ack_ticket &&
+                       running_.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        // 再调用 on_stop()（需要释放锁避免死锁）
         Strategy* strat = it->second.get();
         lock.unlock();
         if (strat) {
@@ -314,17 +544,19 @@ public:
         }
         lock.lock();
 
-        // 从 registry 移除（需要找到并删除对应的策略指针）
-        int shard_id = get_shard_id(symbol);
-        auto& strat_vec = registry_[shard_id][symbol];
-        strat_vec.erase(
-            std::remove(strat_vec.begin(), strat_vec.end(), strat),
-            strat_vec.end()
-        );
-
-        // 如果该 symbol 没有策略了，删除整个 entry
-        if (strat_vec.empty()) {
-            registry_[shard_id].erase(symbol);
+        // 从 registry 移除（需要找到并删除对应的策略指针）并发布新快照；
+        // update 返回时 worker 均已越过静止点，不再持有该策略指针，可以安全释放
+        uint32_t symbol_id = symbols_.find(symbol.c_str());
+        if (symbol_id != SymbolTable::INVALID_ID) {
+            const SymbolTable::Entry& entry = symbols_.entry(symbol_id);
+            registry_.update(entry.shard, [&](auto& m) {
+                if (entry.local_id >= m.size()) return;
+                auto& strat_vec = m[entry.local_id];
+                strat_vec.erase(
+                    std::remove(strat_vec.begin(), strat_vec.end(), strat),
+                    strat_vec.end()
+                );
+            });
         }
 
         // 释放所有权
@@ -349,11 +581,15 @@ public:
     // 策略启用/禁用控制
     // ==========================================
 
-    // 发送控制消息到对应的 Worker 队列
-    void send_control_message(const ControlMessage& ctrl) {
-        int shard_id = get_shard_id(ctrl.symbol);
+    // 发送控制消息到对应的 Worker 队列 (证券未能登记时返回 false)
+    bool send_control_message(const ControlMessage& ctrl) {
+        uint32_t symbol_id = intern_symbol(ctrl.symbol);
+        int shard_id = shard_of(symbol_id);
+        if (shard_id < 0) return false;
         auto* q = queues_[shard_id].get();
-        q->enqueue(MarketMessage{std::in_place_type<ControlMessage>, ctrl});
+        q->enqueue(QueueMessage::make_control(symbol_id, ctrl));
+        wake(shard_id);
+        return true;
     }
 
     // 启用策略（可选传入 param，如 target_price）
@@ -389,8 +625,8 @@ public:
         int total = 0;
 
         for (int i = 0; i < config_.total_shards(); ++i) {
-            for (auto& kv : registry_[i]) {
-                for (auto* strat : kv.second) {
+            for (const auto& list : registry_.snapshot(i)) {
+                for (auto* strat : list) {
                     strat->on_start();
                     strategy_counts[strat->strategy_type_id]++;
                     total++;
@@ -404,14 +640,26 @@ public:
             LOG_M_INFO("  - {}: {} instances", StrategyIds::id_to_name(id), count);
         }
 
+        if (checkpoint_interval_sec_ > 0) {
+            std::error_code ec;
+            std::filesystem::create_directories(checkpoint_dir_, ec);
+            LOG_M_INFO("Book checkpoint enabled: dir={} interval={}s", checkpoint_dir_, checkpoint_interval_sec_);
+        }
+
         // 启动 worker 线程
         LOG_M_INFO("Starting {} worker threads (SH: {}, SZ: {})",
                    config_.total_shards(), config_.sh_shard_count, config_.sz_shard_count);
+        std::map<std::string, int> wait_counts;
+        for (int i = 0; i < config_.total_shards(); ++i) wait_counts[wait_mode_name(waiters_[i]->mode())]++;
+        for (const auto& [mode, count] : wait_counts) {
+            LOG_M_INFO("  - wait={}: {} workers", mode, count);
+        }
         for (int i = 0; i < config_.total_shards(); ++i) {
             workers_.emplace_back([this, i]() {
                 this->worker_loop(i);
             });
         }
+        workers_started_.store(true, std::memory_order_release);
     }
 
     // 停止引擎
@@ -423,14 +671,15 @@ public:
         }
 
         running_ = false;
+        for (int i = 0; i < config_.total_shards(); ++i) wake(i);   // 挂起的 worker 立即退出
         for (auto& t : workers_) {
             if (t.joinable()) t.join();
         }
 
         // 调用所有策略的 on_stop()
         for (int i = 0; i < config_.total_shards(); ++i) {
-            for (auto& kv : registry_[i]) {
-                for (auto* strat : kv.second) {
+            for (const auto& list : registry_.snapshot(i)) {
+                for (auto* strat : list) {
                     strat->on_stop();
                 }
             }
@@ -441,79 +690,167 @@ public:
     // 市场数据接口 - 供外部适配器调用
     // ==========================================
     // 优化要点：
-    // 1. static thread_local Token 数组（每个线程每个 shard 独立）
-    // 2. MD_UNLIKELY 分支预测优化（初始化路径标记为冷路径）
-    // 3. std::in_place_type 就地构造 variant（避免临时对象）
-    void on_market_tick(const MDStockStruct& stock) {
-        int shard_id = get_shard_id(stock.htscsecurityid);
-        auto* q = queues_[shard_id].get();
-
-        auto& tokens = get_producer_tokens();
-
-        // 懒加载初始化（只有第一次为 true，标记为 unlikely）
-        if (MD_UNLIKELY(!tokens[shard_id])) {
-            tokens[shard_id] = std::make_unique<moodycamel::ProducerToken>(*q);
+    // 1. SPSC 接入矩阵：每个网关线程独占一行环形队列，无 CAS、无分配
+    // 2. 未启用矩阵 (或行号用尽) 时走 MPMC 队列 + static thread_local Token 数组
+    // 3. 逐笔委托/成交内联入队；Tick/十档快照先写入分片暂存槽，队列只传指针
+    // 4. 证券 ID 由适配器在解码处调用 intern_symbol() 取得并随消息传入，引擎内各阶段不再哈希代码字符串
+
+    // 登记证券 ID；代码表已满 (不应发生) 时返回 SymbolTable::INVALID_ID，对应消息被丢弃
+    uint32_t intern_symbol(const char* symbol) {
+        uint32_t symbol_id = symbols_.intern(symbol);
+        if (MD_UNLIKELY(symbol_id == SymbolTable::INVALID_ID)) {
+            static std::atomic<bool> warned{false};
+            if (!warned.exchange(true)) {
+                LOG_M_ERROR("Symbol table full (capacity={}), dropping messages for new symbols, first={}",
+                            symbols_.capacity(), symbol);
+            }
         }
-
-        // 就地构造 variant 并入队（避免先构造 MDStockStruct 再 move）
-        q->enqueue(*tokens[shard_id], MarketMessage{std::in_place_type<MDStockStruct>, stock});
+        return symbol_id;
     }
 
-    void on_market_order(const MDOrderStruct& order) {
-        enqueue_order_count_++;  // 调试计数
-
-        int shard_id = get_shard_id(order.htscsecurityid);
-        auto* q = queues_[shard_id].get();
+    void on_market_tick(const MDStockStruct& stock, uint32_t symbol_id) {
+        int shard_id = shard_of(symbol_id);
+        if (MD_UNLIKELY(shard_id < 0)) return;
 
-        auto& tokens = get_producer_tokens();
+        // Tick 体积大：拷贝进分片暂存槽，队列只传指针 (worker 处理完归还)
+        MDStockStruct* slot = slabs_[shard_id]->ticks.acquire();
+        *slot = stock;
+        enqueue(shard_id, QueueMessage::make_tick(symbol_id, slot));
+    }
 
-        if (MD_UNLIKELY(!tokens[shard_id])) {
-            tokens[shard_id] = std::make_unique<moodycamel::ProducerToken>(*q);
-        }
+    void on_market_order(const MDOrderStruct& order, uint32_t symbol_id) {
+        enqueue_order_count_++;  // 调试计数
 
-        q->enqueue(*tokens[shard_id], MarketMessage{std::in_place_type<MDOrderStruct>, order});
+        int shard_id = shard_of(symbol_id);
+        if (MD_UNLIKELY(shard_id < 0)) return;
+        enqueue(shard_id, QueueMessage::make_order(symbol_id, order));
     }
 
-    void on_market_transaction(const MDTransactionStruct& transaction) {
+    void on_market_transaction(const MDTransactionStruct& transaction, uint32_t symbol_id) {
         enqueue_txn_count_++;  // 调试计数
 
-        int shard_id = get_shard_id(transaction.htscsecurityid);
-        auto* q = queues_[shard_id].get();
+        int shard_id = shard_of(symbol_id);
+        if (MD_UNLIKELY(shard_id < 0)) return;
+        enqueue(shard_id, QueueMessage::make_transaction(symbol_id, transaction));
+    }
 
-        auto& tokens = get_producer_tokens();
+    void on_market_orderbook_snapshot(const MDOrderbookStruct& snapshot, uint32_t symbol_id) {
+        int shard_id = shard_of(symbol_id);
+        if (MD_UNLIKELY(shard_id < 0)) return;
 
-        if (MD_UNLIKELY(!tokens[shard_id])) {
-            tokens[shard_id] = std::make_unique<moodycamel::ProducerToken>(*q);
-        }
+        MDOrderbookStruct* slot = slabs_[shard_id]->orderbooks.acquire();
+        *slot = snapshot;
+        enqueue(shard_id, QueueMessage::make_orderbook(symbol_id, slot));
+    }
 
-        q->enqueue(*tokens[shard_id], MarketMessage{std::in_place_type<MDTransactionStruct>, transaction});
+private:
+    // 证券 ID 所属分片；未登记成功 (INVALID_ID) 返回 -1
+    int shard_of(uint32_t symbol_id) const {
+        if (MD_UNLIKELY(symbol_id == SymbolTable::INVALID_ID)) return -1;
+        return symbols_.entry(symbol_id).shard;
     }
 
-    void on_market_orderbook_snapshot(const MDOrderbookStruct& snapshot) {
-        int shard_id = get_shard_id(snapshot.htscsecurityid);
-        auto* q = queues_[shard_id].get();
+    // 行情入队：同一线程的消息始终进入同一条 FIFO (本线程那一行的环，或本线程的 ProducerToken 子队列)，
+    // 故同一推送线程上的通道顺序保持不变
+    void enqueue(int shard_id, const QueueMessage& m) {
+        int row = producer_row();
+        if (row >= 0) {
+            auto& ring = *rings_[static_cast<size_t>(shard_id * ingest_rows_ + row)];
+            if (MD_UNLIKELY(!ring.try_push(m))) {
+                // 环满：背压等待 worker 消费 (引擎停止后丢弃)
+                ring_full_count_.fetch_add(1, std::memory_order_relaxed);
+                wake(shard_id);
+                while (!ring.try_push(m)) {
+                    if (!running_.load(std::memory_order_relaxed)) return;
+                    std::this_thread::yield();
+                }
+            }
+        } else {
+            auto* q = queues_[shard_id].get();
+            auto& tokens = get_producer_tokens();
 
-        auto& tokens = get_producer_tokens();
+            // 懒加载初始化（只有第一次为 true，标记为 unlikely）
+            if (MD_UNLIKELY(!tokens[shard_id])) {
+                tokens[shard_id] = std::make_unique<moodycamel::ProducerToken>(*q);
+            }
+            q->enqueue(*tokens[shard_id], m);
+        }
+        wake(shard_id);
+    }
 
-        if (MD_UNLIKELY(!tokens[shard_id])) {
-            tokens[shard_id] = std::make_unique<moodycamel::ProducerToken>(*q);
+    // 唤醒挂起的 worker (仅 park 模式有开销)
+    void wake(int shard_id) {
+        WorkerWaiter& waiter = *waiters_[shard_id];
+        if (waiter.mode() == WaitMode::PARK) waiter.notify();
+    }
+
+    // 本线程在接入矩阵中的行号，-1 = 走 MPMC 队列 (未启用矩阵或行号用尽)
+    // 线程首次入队时登记：领取行号，并按 gateway_cpus_ 绑核
+    int producer_row() {
+        struct Producer {
+            const StrategyEngine* owner = nullptr;
+            int row = -1;
+        };
+        static thread_local Producer p;
+        if (MD_UNLIKELY(p.owner != this)) {
+            p.owner = this;
+            p.row = -1;
+            if (ingest_rows_ > 0) {
+                p.row = next_ingest_row_.fetch_add(1, std::memory_order_relaxed);
+                if (p.row >= ingest_rows_) {
+                    LOG_M_WARNING("SPSC ingest rows exhausted ({}), producer thread falls back to MPMC queue", ingest_rows_);
+                    p.row = -1;
+                }
+            }
+            size_t idx = next_gateway_cpu_.fetch_add(1, std::memory_order_relaxed);
+            if (idx < gateway_cpus_.size()) {
+                int cpu = gateway_cpus_[idx];
+                if (cpu_affinity::pin_current_thread(cpu)) {
+                    LOG_M_INFO("Gateway thread {} pinned to CPU {}", idx, cpu);
+                } else {
+                    LOG_M_WARNING("Failed to pin gateway thread {} to CPU {}", idx, cpu);
+                }
+            }
         }
+        return p.row;
+    }
 
-        q->enqueue(*tokens[shard_id], MarketMessage{std::in_place_type<MDOrderbookStruct>, snapshot});
+    // 本分片是否有待处理消息 (park 前复查)
+    bool has_pending(int shard_id) const {
+        for (int row = 0; row < ingest_rows_; ++row) {
+            if (rings_[static_cast<size_t>(shard_id * ingest_rows_ + row)]->size_approx() != 0) return true;
+        }
+        return queues_[shard_id]->size_approx() != 0;
     }
 
-private:
-    int get_shard_id(const char* symbol) const {
-        return symbol_utils::get_exchange_shard_id(symbol, config_);
+    // 取一批消息：先轮询本分片的环 (起点轮转，避免靠前的行长期优先)，再取 MPMC 队列
+    size_t dequeue_batch(int shard_id, moodycamel::ConcurrentQueue<QueueMessage>& q,
+                         moodycamel::ConsumerToken& c_token, QueueMessage* out, size_t max, int& next_row) {
+        size_t n = 0;
+        if (ingest_rows_ > 0) {
+            const auto* column = &rings_[static_cast<size_t>(shard_id * ingest_rows_)];
+            for (int i = 0; i < ingest_rows_ && n < max; ++i) {
+                int row = next_row + i;
+                if (row >= ingest_rows_) row -= ingest_rows_;
+                n += column[row]->pop_bulk(out + n, max - n);
+            }
+            if (++next_row >= ingest_rows_) next_row = 0;
+        }
+        if (n < max) n += q.try_dequeue_bulk(c_token, out + n, max - n);
+        return n;
     }
 
-    int get_shard_id(const std::string& symbol) const {
-        return symbol_utils::get_exchange_shard_id(symbol.c_str(), config_);
+    // 在分片注册表中为证券追加策略并发布新快照（调用方持 registry_mutex_ 或在启动前）
+    void add_to_registry(const SymbolTable::Entry& entry, Strategy* strat) {
+        registry_.update(entry.shard, [&](auto& m) {
+            if (m.size() <= entry.local_id) m.resize(entry.local_id + 1);
+            m[entry.local_id].push_back(strat);
+        });
     }
 
     // 行情中断检查函数
     void check_data_interruption(
-        std::unordered_map<std::string, SymbolDataStatus>& status_map,
+        std::vector<SymbolSlot>& slots,
         int shard_id,
         std::chrono::steady_clock::time_point& last_check_time
     ) {
@@ -541,7 +878,8 @@ private:
         int interrupted_count = 0;
         int total_count = 0;
 
-        for (auto& [symbol, status] : status_map) {
+        for (auto& slot : slots) {
+            auto& status = slot.status;
             if (!status.initialized) continue;
             total_count++;
 
@@ -572,7 +910,7 @@ private:
                 int ls = static_cast<int>((last_recv_ms % 60000) / 1000);
                 int lms = static_cast<int>(last_recv_ms % 1000);
                 LOG_M_WARNING("行情中断: symbol={}, gap={}ms, shard={}, 上次mdtime={}, 上次local_time={:02d}:{:02d}:{:02d}.{:03d}",
-                             symbol, gap_ms, shard_id, status.last_mdtime, lh, lm, ls, lms);
+                             slot.symbol, gap_ms, shard_id, status.last_mdtime, lh, lm, ls, lms);
             }
         }
 
@@ -583,47 +921,279 @@ private:
         }
     }
 
+    // 午休 (11:30-13:00) 行情静止时整理一次本分片所有订单簿：
+    // 上午的挂单/撤单使各档位队列节点散落在 slab 各处，按队列顺序重排后恢复遍历局部性
+    void maybe_compact_books(int shard_id,
+                             std::vector<SymbolSlot>& slots,
+                             int& last_compact_yday,
+                             std::chrono::steady_clock::time_point& last_check_time) {
+        if (!compact_at_lunch_) return;
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_check_time < std::chrono::seconds(1)) return;
+        last_check_time = now;
+
+        auto now_time_t = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        std::tm tm = *std::localtime(&now_time_t);
+        int current_hhmm = tm.tm_hour * 100 + tm.tm_min;
+        // 避开 11:30 收盘尾部与 13:00 开盘前的最后几分钟
+        if (current_hhmm < 1135 || current_hhmm >= 1255 || tm.tm_yday == last_compact_yday) return;
+        last_compact_yday = tm.tm_yday;
+
+        size_t book_count = 0, moved = 0, slabs_before = 0, slabs_after = 0;
+        for (auto& slot : slots) {
+            if (!slot.book) continue;
+            ++book_count;
+            slabs_before += slot.book->arena_slab_count();
+            moved += slot.book->compact();
+            slabs_after += slot.book->arena_slab_count();
+        }
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - now).count();
+        LOG_M_INFO("Compacted shard {}: books={} nodes={} slabs {} -> {} elapsed={}ms",
+                   shard_id, book_count, moved, slabs_before, slabs_after, ms);
+    }
+
+    // 快照状态 (worker 线程私有)
+    struct CheckpointState {
+        ChannelWatermarks processed;        // 已处理到的序号，随快照写出
+        ChannelWatermarks restored;         // 恢复时的快照水位，用于丢弃重复消息
+        int32_t last_mddate = 0;
+        int32_t last_mdtime = 0;
+        uint64_t dirty_messages = 0;        // 上次快照后处理的逐笔消息数
+        std::chrono::steady_clock::time_point last_save_time;
+    };
+
+    // 建簿后的统一设置：主力资金流向统计、登记并挂接跨线程一档快照 (可重复调用)
+    void prepare_book(const std::string& symbol, FastOrderBook& book) {
+        if (money_flow_ && !book.money_flow_enabled()) book.enable_money_flow(*money_flow_);
+        if (!book.top_of_book()) {
+            SeqlockTopOfBook* top;
+            {
+                std::unique_lock<std::shared_mutex> lock(tops_mutex_);
+                auto& slot = tops_[symbol];
+                if (!slot) slot = std::make_unique<SeqlockTopOfBook>();
+                top = slot.get();
+            }
+            book.set_top_of_book(top);
+        }
+    }
+
+    bool checkpoint_enabled() const {
+        return checkpoint_interval_sec_ > 0 || checkpoint_restore_date_ != 0;
+    }
+
+    // 启动追补：回放落盘逐笔 (跳过快照已覆盖部分)，回放水位并入去重水位
+    void replay_catchup(int shard_id, ObjectPool<OrderNode>& pool,
+                        std::unordered_map<std::string, std::unique_ptr<FastOrderBook>>& books,
+                        CheckpointState& ckpt) {
+        ChannelWatermarks replayed;
+        CatchupReplayer::Stats stats = catchup_->replay_shard(shard_id, pool, books, ckpt.restored, replayed);
+        for (const auto& e : replayed.entries()) {
+            auto stream = static_cast<ChannelWatermarks::Stream>(e.stream);
+            ckpt.restored.update(e.channel, stream, e.applseqnum);
+            ckpt.processed.update(e.channel, stream, e.applseqnum);
+        }
+        if (stats.last_mddate != 0) {
+            ckpt.last_mddate = stats.last_mddate;
+            ckpt.last_mdtime = stats.last_mdtime;
+        }
+        ckpt.dirty_messages += stats.orders + stats.transactions;
+        LOG_M_INFO("Catch-up shard {}: books_created={} orders={} txns={} skipped={} elapsed={}ms",
+                   shard_id, stats.books_created, stats.orders, stats.transactions, stats.skipped, stats.elapsed_ms);
+    }
+
+    // 启动时从快照恢复本分片订单簿
+    void restore_checkpoint(int shard_id, ObjectPool<OrderNode>& pool,
+                            std::unordered_map<std::string, std::unique_ptr<FastOrderBook>>& books,
+                            CheckpointState& ckpt) {
+        std::string path = BookCheckpoint::path_for_shard(checkpoint_dir_, shard_id);
+        auto t0 = std::chrono::steady_clock::now();
+        BookCheckpoint::Header header{};
+        if (!BookCheckpoint::load(path, checkpoint_restore_date_, pool, books, ckpt.restored, &header, &config_)) {
+            LOG_M_WARNING("No usable checkpoint for shard {}: {}", shard_id, path);
+            return;
+        }
+        ckpt.processed = ckpt.restored;
+        ckpt.last_mddate = header.mddate;
+        ckpt.last_mdtime = header.mdtime;
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - t0).count();
+        LOG_M_INFO("Restored shard {} from checkpoint: books={} orders={} mdtime={} elapsed={}ms",
+                   shard_id, header.book_count, header.order_count, header.mdtime, ms);
+    }
+
+    // 到达间隔且有新消息时写快照 (在两条消息之间调用，处于一致点)
+    void maybe_save_checkpoint(int shard_id, const std::vector<SymbolSlot>& slots, CheckpointState& ckpt) {
+        if (checkpoint_interval_sec_ <= 0 || ckpt.dirty_messages == 0) return;
+        auto now = std::chrono::steady_clock::now();
+        if (now - ckpt.last_save_time < std::chrono::seconds(checkpoint_interval_sec_)) return;
+
+        ckpt.last_save_time = now;
+        BookCheckpoint::BookList books;
+        for (const auto& slot : slots) {
+            if (slot.book) books.emplace_back(slot.symbol, slot.book.get());
+        }
+        std::string path = BookCheckpoint::path_for_shard(checkpoint_dir_, shard_id);
+        if (BookCheckpoint::save(path, shard_id, ckpt.last_mddate, ckpt.last_mdtime, books, ckpt.processed, config_)) {
+            ckpt.dirty_messages = 0;
+            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - now).count();
+            LOG_M_DEBUG("Checkpoint saved: shard={} books={} mdtime={} elapsed={}ms",
+                        shard_id, books.size(), ckpt.last_mdtime, ms);
+        }
+    }
+
+    // 逐笔消息去重与水位记录：返回 false 表示该消息已包含在恢复的快照中，应丢弃
+    template<typename T>
+    static bool accept_sequenced(CheckpointState& ckpt, const T& data, ChannelWatermarks::Stream stream) {
+        if (MD_UNLIKELY(!ckpt.restored.empty()) &&
+            ckpt.restored.covers(data.channelno, stream, data.applseqnum)) {
+            return false;
+        }
+        ckpt.processed.update(data.channelno, stream, data.applseqnum);
+        ckpt.last_mddate = data.mddate;
+        ckpt.last_mdtime = data.mdtime;
+        ++ckpt.dirty_messages;
+        return true;
+    }
+
+    // 分发并清空本条消息产生的订单事件与档位变动 (策略已移除时只清空)
+    static void dispatch_book_events(OrderEventBuffer& events, LevelChangeBuffer& changes, bool has_strats,
+                                     const std::vector<Strategy*>& strats, const FastOrderBook& book) {
+        if (MD_UNLIKELY(!events.empty())) {
+            if (has_strats) {
+                for (auto* strat : strats) strat->on_order_events(events.data(), events.size(), book);
+            }
+            events.clear();
+        }
+        if (MD_LIKELY(changes.empty())) return;
+        if (has_strats) {
+            for (auto* strat : strats) strat->on_level_changes(changes.data(), changes.size(), book);
+        }
+        changes.clear();
+    }
+
     // Worker 线程循环
     void worker_loop(int shard_id) {
         auto* q = queues_[shard_id].get();
 
-        // 线程局部对象池
-        ObjectPool<OrderNode> local_pool(500000);  // 增大容量以支持 53 线程
-
-        // 本地订单簿管理
-        std::unordered_map<std::string, std::unique_ptr<FastOrderBook>> books;
+        // 绑核 (先于订单池分配，使首次缺页落在本核所属 NUMA 节点)
+        if (static_cast<size_t>(shard_id) < worker_cpus_.size() && worker_cpus_[shard_id] >= 0) {
+            int cpu = worker_cpus_[shard_id];
+            if (cpu_affinity::pin_current_thread(cpu)) {
+                LOG_M_INFO("Worker {} pinned to CPU {}", shard_id, cpu);
+            } else {
+                LOG_M_WARNING("Failed to pin worker {} to CPU {}", shard_id, cpu);
+            }
+        }
 
-        // 行情中断监控状态
-        std::unordered_map<std::string, SymbolDataStatus> symbol_status;
+        // 线程局部对象池
+        ObjectPool<OrderNode> local_pool(500000, pool_options_);  // 分段增长，满后追加块不搬移已有节点
+
+        // 档位变动缓冲区 (本分片所有挂接的订单簿共用，每条逐笔消息处理完即分发并清空)
+        LevelChangeBuffer level_changes;
+        level_changes.reserve(64);
+
+        // 订单事件缓冲区 (同上，只包含策略关注的档位/方向)
+        OrderEventBuffer order_events;
+        order_events.reserve(64);
+
+        // 按局部证券 ID 下标的订单簿与行情中断监控状态
+        std::vector<SymbolSlot> slots;
+        auto slot_of = [&](uint32_t symbol_id) -> SymbolSlot& {
+            const SymbolTable::Entry& entry = symbols_.entry(symbol_id);
+            if (MD_UNLIKELY(entry.local_id >= slots.size())) {
+                slots.resize(std::max<size_t>(entry.local_id + 1, slots.size() * 2));
+            }
+            SymbolSlot& slot = slots[entry.local_id];
+            slot.symbol = entry.symbol;
+            return slot;
+        };
         int process_counter = 0;
         auto last_check_time = std::chrono::steady_clock::now();
+        auto last_compact_check = last_check_time;
+        int last_compact_yday = -1;
+
+        // 订单簿快照：启动时恢复；再从落盘文件追补 (期间实时消息缓存在队列中)
+        const bool use_watermarks = checkpoint_enabled() || catchup_;
+        CheckpointState ckpt;
+        ckpt.last_save_time = last_check_time;
+        // 恢复/追补按代码在启动暂存表中建簿，完成后登记 ID 并移入下标表
+        {
+            BookCheckpoint::BookMap staged;
+            if (checkpoint_restore_date_ != 0) restore_checkpoint(shard_id, local_pool, staged, ckpt);
+            if (catchup_) replay_catchup(shard_id, local_pool, staged, ckpt);
+            for (auto& [sym, book] : staged) {
+                uint32_t symbol_id = intern_symbol(sym.c_str());
+                if (symbol_id == SymbolTable::INVALID_ID) continue;
+                // 不属于本分片的订单簿 (分片布局变化后的旧快照) 不能按局部 ID 挂入，否则会占用其他证券的下标
+                if (MD_UNLIKELY(symbols_.entry(symbol_id).shard != shard_id)) {
+                    LOG_M_WARNING("Staged book {} belongs to shard {}, not {}, dropped",
+                                  sym, symbols_.entry(symbol_id).shard, shard_id);
+                    continue;
+                }
+                prepare_book(sym, *book);
+                slot_of(symbol_id).book = std::move(book);
+            }
+        }
 
         moodycamel::ConsumerToken c_token(*q);
-        MarketMessage msg;
+        ShardSlabs& shard_slabs = *slabs_[shard_id];
+        WorkerWaiter& waiter = *waiters_[shard_id];
+        uint32_t idle_rounds = 0;
+
+        // 批量出队：一次取一批，处理当前消息前预取下一条消息的订单簿
+        static constexpr size_t BATCH = 32;
+        std::array<QueueMessage, BATCH> batch;
+        int next_row = 0;
+        auto prefetch_book = [&](const QueueMessage& next) {
+            uint32_t local = symbols_.entry(next.symbol_id).local_id;
+            if (local < slots.size() && slots[local].book) MD_PREFETCH(slots[local].book.get());
+        };
+
+        // 策略表 RCU 读者：上线后每条消息处理前为静止点 (上一条消息取得的策略列表引用已用完)
+        registry_.online(shard_id);
+        static const std::vector<Strategy*> no_strats;
 
         while (running_) {
-            if (q->try_dequeue(c_token, msg)) {
-                const char* symbol = get_symbol(msg);
-                std::string sym_str(symbol);
-
-                // 读锁查找策略（复制指针列表，快速释放锁）
-                std::vector<Strategy*> strats;
-                {
-                    std::shared_lock<std::shared_mutex> lock(registry_mutex_);
-                    auto& local_strat_map = registry_[shard_id];
-                    auto strat_it = local_strat_map.find(sym_str);
-                    if (strat_it != local_strat_map.end()) {
-                        strats = strat_it->second;  // 复制指针列表
-                    }
+            size_t batch_size = dequeue_batch(shard_id, *q, c_token, batch.data(), BATCH, next_row);
+            if (batch_size == 0) {
+                registry_.quiescent(shard_id);
+                // 空闲时检查
+                check_data_interruption(slots, shard_id, last_check_time);
+                maybe_save_checkpoint(shard_id, slots, ckpt);
+                maybe_compact_books(shard_id, slots, last_compact_yday, last_compact_check);
+                if (waiter.idle(idle_rounds++)) {
+                    // 挂起期间离线，不阻塞策略注册表写者的宽限期
+                    registry_.offline(shard_id);
+                    waiter.park([&] { return has_pending(shard_id) || !running_.load(std::memory_order_relaxed); });
+                    registry_.online(shard_id);
                 }
+                continue;
+            }
+            idle_rounds = 0;
+
+            for (size_t bi = 0; bi < batch_size; ++bi) {
+                registry_.quiescent(shard_id);
+                const QueueMessage& msg = batch[bi];
+                if (bi + 1 < batch_size) prefetch_book(batch[bi + 1]);
+
+                // 入口已登记的证券 ID：订单簿、状态、策略列表均按局部 ID 直接下标
+                SymbolSlot& slot = slot_of(msg.symbol_id);
+                const char* symbol = slot.symbol;
+                const uint32_t local_id = symbols_.entry(msg.symbol_id).local_id;
+
+                // 无锁查找策略：引用本分片当前快照中的列表，不复制
+                const auto* strat_list = registry_.find(shard_id, local_id);
+                const std::vector<Strategy*>& strats = strat_list ? *strat_list : no_strats;
                 bool has_strats = !strats.empty();
 
-                std::visit([&](auto&& data) {
+                auto handle = [&](auto&& data) {
                     using T = std::decay_t<decltype(data)>;
 
                     if constexpr (std::is_same_v<T, MDStockStruct>) {
                         // 行情中断监控：更新接收时间
-                        auto& status = symbol_status[sym_str];
+                        auto& status = slot.status;
                         auto now_local = std::chrono::steady_clock::now();
 
                         // 检查是否从中断恢复
@@ -637,7 +1207,7 @@ private:
                             int ns = static_cast<int>((now_ms % 60000) / 1000);
                             int nms = static_cast<int>(now_ms % 1000);
                             LOG_M_WARNING("行情恢复: symbol={}, shard={}, 本次mdtime={}, 本次local_time={:02d}:{:02d}:{:02d}.{:03d}",
-                                         sym_str, shard_id, data.mdtime, nh, nm, ns, nms);
+                                         symbol, shard_id, data.mdtime, nh, nm, ns, nms);
                             status.interrupted = false;
                         }
 
@@ -647,44 +1217,77 @@ private:
                         status.has_strategy = has_strats;
 
                         // 如果还没有 OrderBook，使用 MDStockStruct 的 minpx 和 maxpx 创建
-                        auto book_it = books.find(sym_str);
-                        if (MD_UNLIKELY(book_it == books.end())) {
-                            // 确保价格范围有效
+                        if (MD_UNLIKELY(!slot.book)) {
+                            // 涨跌停价无效 (无涨跌幅限制的证券，如新股上市前 5 日) 时两者传 0，建无界订单簿
                             uint32_t min_price = static_cast<uint32_t>(data.minpx);
                             uint32_t max_price = static_cast<uint32_t>(data.maxpx);
+                            if (min_price == 0 || max_price <= min_price) {
+                                min_price = 0;
+                                max_price = 0;
+                            }
+
+                            // 交易所与最小报价单位由代码确定 (基金/可转债 0.001 元)
+                            slot.book = std::make_unique<FastOrderBook>(
+                                0,
+                                local_pool,
+                                min_price,
+                                max_price,
+                                exchange_of(symbol),
+                                symbol_utils::tick_size_for(symbol)
+                            );
+                            prepare_book(symbol, *slot.book);
+                        }
+                        FastOrderBook& book = *slot.book;
+
+                        // 被策略关注的股票开启前 N 档深度缓存 (运行时注册的策略在下一个 Tick 生效)
+                        // 同时挂接档位变动与订单事件缓冲区，策略按增量消费
+                        if (has_strats && !book.depth_cache_enabled()) {
+                            book.enable_depth_cache(true);
+                        }
+                        if (has_strats && !book.level_change_sink()) {
+                            book.set_level_change_sink(&level_changes);
+                        }
+                        if (has_strats && !book.order_event_sink()) {
+                            book.set_order_event_sink(&order_events);
+                        }
 
-                            if (min_price > 0 && max_price > min_price) {
-                                auto new_book = std::make_unique<FastOrderBook>(
-                                    0,
-                                    local_pool,
-                                    min_price,
-                                    max_price
-                                );
-                                books[sym_str] = std::move(new_book);
+                        // 集合竞价时段内维护虚拟撮合 (进入时按当前挂单全量构建，之后增量维护)
+                        if (has_strats) {
+                            bool auction = time_util::in_call_auction(data.mdtime);
+                            if (auction != book.auction_mode()) {
+                                book.set_auction_mode(auction, static_cast<uint32_t>(data.preclosepx));
                             }
-                            // 如果价格范围无效，暂不创建 OrderBook，等待有效数据
                         }
 
                         if (has_strats) {
-                            for (auto* strat : strats) strat->on_tick(data);
+                            for (auto* strat : strats) {
+                                strat->bind_book(book);
+                                strat->on_tick(data);
+                            }
                         }
                     }
                     else if constexpr (std::is_same_v<T, MDOrderStruct>) {
-                        auto book_it = books.find(sym_str);
-                        if (MD_LIKELY(book_it != books.end())) {
-                            book_it->second->on_order(data);
+                        if (use_watermarks && !accept_sequenced(ckpt, data, ChannelWatermarks::ORDER)) {
+                            return;  // 已包含在快照或追补中
+                        }
+                        if (MD_LIKELY(slot.book != nullptr)) {
+                            slot.book->on_order(data);
+                            dispatch_book_events(order_events, level_changes, has_strats, strats, *slot.book);
                             if (has_strats) {
-                                for (auto* strat : strats) strat->on_order(data, *book_it->second);
+                                for (auto* strat : strats) strat->on_order(data, *slot.book);
                             }
                         }
                         // 如果没有 OrderBook，忽略此消息（应该先收到 MDStockStruct）
                     }
                     else if constexpr (std::is_same_v<T, MDTransactionStruct>) {
-                        auto book_it = books.find(sym_str);
-                        if (MD_LIKELY(book_it != books.end())) {
-                            book_it->second->on_transaction(data);
+                        if (use_watermarks && !accept_sequenced(ckpt, data, ChannelWatermarks::TRANSACTION)) {
+                            return;  // 已包含在快照或追补中
+                        }
+                        if (MD_LIKELY(slot.book != nullptr)) {
+                            slot.book->on_transaction(data);
+                            dispatch_book_events(order_events, level_changes, has_strats, strats, *slot.book);
                             if (has_strats) {
-                                for (auto* strat : strats) strat->on_transaction(data, *book_it->second);
+                                for (auto* strat : strats) strat->on_transaction(data, *slot.book);
                             }
                         }
                         // 如果没有 OrderBook，忽略此消息（应该先收到 MDStockStruct）
@@ -703,20 +1306,40 @@ private:
                             }
                         }
                     }
-                }, msg);
+                };
+
+                switch (msg.kind) {
+                    case QueueMessage::Kind::ORDER:
+                        handle(msg.order);
+                        break;
+                    case QueueMessage::Kind::TRANSACTION:
+                        handle(msg.transaction);
+                        break;
+                    case QueueMessage::Kind::TICK:
+                        handle(*msg.tick);
+                        shard_slabs.ticks.release(msg.tick);
+                        break;
+                    case QueueMessage::Kind::ORDERBOOK:
+                        handle(*msg.orderbook);
+                        shard_slabs.orderbooks.release(msg.orderbook);
+                        break;
+                    case QueueMessage::Kind::CONTROL:
+                        handle(msg.control);
+                        if (msg.control.ack_ticket) {
+                            control_acked_.store(msg.control.ack_ticket, std::memory_order_release);
+                        }
+                        break;
+                }
 
                 // 忙碌时的顺便检查（防饿死：高峰期队列永远不空时也能检查）
                 if (++process_counter >= 10000) {
-                    check_data_interruption(symbol_status, shard_id, last_check_time);
+                    check_data_interruption(slots, shard_id, last_check_time);
+                    maybe_save_checkpoint(shard_id, slots, ckpt);
                     process_counter = 0;
                 }
-
-            } else {
-                // 空闲时检查
-                check_data_interruption(symbol_status, shard_id, last_check_time);
-                std::this_thread::yield();
             }
         }
+        registry_.offline(shard_id);
     }
 };
 
@@ -0,0 +1,135 @@
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "utils/symbol_utils.h"
+
+// ============================================================================
+// SymbolTable - 证券代码 -> 稠密整数 ID
+// ============================================================================
+// 行情入口处把 40 字节的 htscsecurityid 映射为全局 ID (0, 1, 2, ...) 一次，
+// 同时确定所属分片 (与 get_exchange_shard_id 相同，保证快照/追补分区一致) 与分片内局部 ID，
+// 之后各阶段按 ID 直接下标访问，不再对字符串做哈希/比较/构造。
+//
+// 启动时由 ALLSYMBOLS.csv 预先登记全市场代码，盘中新上市代码在首次出现时插入。
+// 查找无锁 (开放寻址槽位 acquire 读取)；插入少见，由互斥锁串行化，条目先写好再 release 发布槽位。
+// 条目数组预分配且不搬移，entry() 返回的引用始终有效。
+//
+class SymbolTable {
+public:
+    static constexpr uint32_t INVALID_ID = UINT32_MAX;
+    static constexpr uint32_t DEFAULT_CAPACITY = 1u << 16;   // 沪深证券总数远小于此
+    static constexpr size_t SYMBOL_LEN = 40;                  // 与 htscsecurityid 一致
+
+    struct Entry {
+        char symbol[SYMBOL_LEN];
+        int32_t shard;
+        uint32_t local_id;      // 分片内稠密 ID
+    };
+
+    explicit SymbolTable(const symbol_utils::ExchangeShardConfig& config, uint32_t capacity = DEFAULT_CAPACITY)
+        : config_(config),
+          capacity_(capacity),
+          mask_(slot_count(capacity) - 1),
+          entries_(new Entry[capacity]),
+          slots_(new std::atomic<uint32_t>[mask_ + 1]),
+          shard_sizes_(static_cast<size_t>(config.total_shards()), 0) {
+        for (uint32_t i = 0; i <= mask_; ++i) slots_[i].store(0, std::memory_order_relaxed);
+    }
+
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    // 查找已登记的代码 (任意线程)，未登记返回 INVALID_ID
+    uint32_t find(const char* symbol) const {
+        for (uint32_t pos = hash(symbol) & mask_;; pos = (pos + 1) & mask_) {
+            uint32_t v = slots_[pos].load(std::memory_order_acquire);
+            if (v == 0) return INVALID_ID;
+            if (std::strncmp(entries_[v - 1].symbol, symbol, SYMBOL_LEN) == 0) return v - 1;
+        }
+    }
+
+    // 查找或登记 (任意线程)；表满返回 INVALID_ID
+    uint32_t intern(const char* symbol) {
+        uint32_t id = find(symbol);
+        if (id != INVALID_ID) return id;
+
+        std::lock_guard<std::mutex> lock(insert_mutex_);
+        uint32_t pos = hash(symbol) & mask_;
+        for (;; pos = (pos + 1) & mask_) {
+            uint32_t v = slots_[pos].load(std::memory_order_relaxed);
+            if (v == 0) break;
+            if (std::strncmp(entries_[v - 1].symbol, symbol, SYMBOL_LEN) == 0) return v - 1;   // 并发插入
+        }
+        uint32_t n = size_.load(std::memory_order_relaxed);
+        if (n >= capacity_) return INVALID_ID;
+
+        Entry& e = entries_[n];
+        std::strncpy(e.symbol, symbol, SYMBOL_LEN - 1);
+        e.symbol[SYMBOL_LEN - 1] = '\0';
+        e.shard = symbol_utils::get_exchange_shard_id(e.symbol, config_);
+        e.local_id = shard_sizes_[static_cast<size_t>(e.shard)]++;
+        size_.store(n + 1, std::memory_order_release);
+        slots_[pos].store(n + 1, std::memory_order_release);
+        return n;
+    }
+
+    uint32_t intern(const std::string& symbol) { return intern(symbol.c_str()); }
+
+    // id 须为 intern/find 返回的有效 ID
+    const Entry& entry(uint32_t id) const { return entries_[id]; }
+
+    uint32_t size() const { return size_.load(std::memory_order_acquire); }
+    uint32_t capacity() const { return capacity_; }
+
+    // 从代码列表文件预先登记 (每行首列为代码，无后缀时按首位补 .SH/.SZ；非数字开头的行视为表头跳过)
+    // @return 新登记的数量，文件无法打开返回 0
+    size_t load_csv(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) return 0;
+        size_t added = 0;
+        std::string line;
+        while (std::getline(in, line)) {
+            std::string code = line.substr(0, line.find_first_of(",\r \t"));
+            if (code.empty() || code[0] < '0' || code[0] > '9') continue;
+            uint32_t before = size();
+            if (intern(symbol_utils::normalize_symbol(code)) != INVALID_ID && size() != before) ++added;
+        }
+        return added;
+    }
+
+private:
+    static uint32_t slot_count(uint32_t capacity) {
+        uint32_t n = 1;
+        while (n < capacity * 2) n <<= 1;   // 装载因子 <= 0.5
+        return n;
+    }
+
+    // FNV-1a
+    static uint32_t hash(const char* symbol) {
+        uint32_t h = 2166136261u;
+        for (size_t i = 0; i < SYMBOL_LEN && symbol[i]; ++i) {
+            h ^= static_cast<unsigned char>(symbol[i]);
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    symbol_utils::ExchangeShardConfig config_;
+    uint32_t capacity_;
+    uint32_t mask_;
+    std::unique_ptr<Entry[]> entries_;
+    std::unique_ptr<std::atomic<uint32_t>[]> slots_;   // 全局 ID + 1，0 = 空
+    std::vector<uint32_t> shard_sizes_;                // 仅在插入锁内访问
+    std::atomic<uint32_t> size_{0};
+    std::mutex insert_mutex_;
+};
+
+#endif // SYMBOL_TABLE_H
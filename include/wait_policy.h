@@ -0,0 +1,157 @@
+#ifndef WAIT_POLICY_H
+#define WAIT_POLICY_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <emmintrin.h>  // _mm_pause
+#endif
+
+// ==========================================
+// worker 空闲等待策略
+// ==========================================
+//   yield      : 每个空轮让出 CPU (原行为)
+//   spin       : 纯自旋 (pause)，独占隔离核时延迟最低
+//   spin_yield : 先自旋 spin_limit 轮，仍无消息则每轮让出
+//   park       : 先自旋 spin_limit 轮，再 futex 挂起，由生产者入队后唤醒 (共享机器上基本不占 CPU)
+enum class WaitMode : uint8_t {
+    YIELD,
+    SPIN,
+    SPIN_YIELD,
+    PARK
+};
+
+inline bool parse_wait_mode(const std::string& name, WaitMode& out) {
+    if (name == "yield") out = WaitMode::YIELD;
+    else if (name == "spin") out = WaitMode::SPIN;
+    else if (name == "spin_yield") out = WaitMode::SPIN_YIELD;
+    else if (name == "park") out = WaitMode::PARK;
+    else return false;
+    return true;
+}
+
+inline const char* wait_mode_name(WaitMode mode) {
+    switch (mode) {
+        case WaitMode::SPIN: return "spin";
+        case WaitMode::SPIN_YIELD: return "spin_yield";
+        case WaitMode::PARK: return "park";
+        default: return "yield";
+    }
+}
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+// ============================================================================
+// WorkerWaiter - 单个分片 worker 的空闲等待 (单等待者，多生产者唤醒)
+// ============================================================================
+// park 的防丢失唤醒 (Dekker 式配对)：
+//   worker  : 记下 seq -> sleeping=1 -> 全栅栏 -> 复查队列，仍为空才 futex_wait(seq)
+//   生产者  : 入队 -> 全栅栏 -> 读 sleeping，为 1 则 seq+1 并 futex_wake
+// 二者至少有一方看到对方的写入；生产者在 worker 进入 futex_wait 前递增 seq 时，futex_wait 立即返回。
+// 挂起带超时，worker 定期醒来做行情中断检查/快照/整理等空闲任务。
+//
+class alignas(64) WorkerWaiter {
+public:
+    static constexpr uint32_t DEFAULT_SPIN_LIMIT = 2000;
+    static constexpr std::chrono::milliseconds PARK_TIMEOUT{50};
+
+    void configure(WaitMode mode, uint32_t spin_limit) {
+        mode_ = mode;
+        spin_limit_ = spin_limit;
+    }
+
+    WaitMode mode() const { return mode_; }
+    uint32_t spin_limit() const { return spin_limit_; }
+
+    // 队列为空的一轮 (idle_rounds 为连续空轮数，取到消息后由调用方清零)
+    // @return true 表示自旋期已满、应当挂起：调用方做好挂起前准备后调用 park()
+    bool idle(uint32_t idle_rounds) const {
+        switch (mode_) {
+            case WaitMode::SPIN:
+                cpu_relax();
+                return false;
+            case WaitMode::SPIN_YIELD:
+                if (idle_rounds < spin_limit_) cpu_relax();
+                else std::this_thread::yield();
+                return false;
+            case WaitMode::PARK:
+                if (idle_rounds < spin_limit_) {
+                    cpu_relax();
+                    return false;
+                }
+                return true;
+            default:
+                std::this_thread::yield();
+                return false;
+        }
+    }
+
+    // worker 挂起直到被唤醒或超时；has_work() 复查是否已有消息
+    template <typename F>
+    void park(F&& has_work) {
+        uint32_t seq = seq_.load(std::memory_order_acquire);
+        sleeping_.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!has_work()) {
+            parks_.fetch_add(1, std::memory_order_relaxed);
+            futex_wait(seq);
+        }
+        sleeping_.store(0, std::memory_order_relaxed);
+    }
+
+    // 生产者入队后调用 (仅 park 模式需要)
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping_.load(std::memory_order_relaxed)) {
+            seq_.fetch_add(1, std::memory_order_release);
+            futex_wake();
+        }
+    }
+
+    // 挂起次数 (监控用)
+    uint64_t park_count() const { return parks_.load(std::memory_order_relaxed); }
+
+private:
+    void futex_wait(uint32_t expected) {
+#ifdef __linux__
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(PARK_TIMEOUT).count();
+        timespec ts{static_cast<time_t>(ns / 1000000000), static_cast<long>(ns % 1000000000)};
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&seq_), FUTEX_WAIT_PRIVATE, expected, &ts, nullptr, 0);
+#else
+        if (seq_.load(std::memory_order_acquire) == expected) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+#endif
+    }
+
+    void futex_wake() {
+#ifdef __linux__
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&seq_), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#endif
+    }
+
+    WaitMode mode_ = WaitMode::YIELD;
+    uint32_t spin_limit_ = DEFAULT_SPIN_LIMIT;
+    std::atomic<uint32_t> seq_{0};        // futex 字
+    std::atomic<uint32_t> sleeping_{0};
+    std::atomic<uint64_t> parks_{0};
+};
+
+#endif // WAIT_POLICY_H
@@ -380,6 +380,9 @@ private:
         } else if (action == zmq_ht_proto::Action::DISABLE_STRATEGY) {
             handle_disable_strategy(dealer, req_id, payload);
 
+        } else if (action == zmq_ht_proto::Action::QUERY_BOOK) {
+            handle_query_book(dealer, req_id, payload);
+
         } else {
             LOG_M_WARNING("Unknown action (DEALER{}): {}", dealer.index, action);
         }
@@ -645,6 +648,48 @@ private:
         }
     }
 
+    // ==========================================
+    // 行情查询
+    // ==========================================
+
+    // 消息格式: { "action": "query_book", "symbol": "600000" }
+    // 读取 worker 发布的 seqlock 一档快照，不经过行情队列
+    void handle_query_book(DealerConnection& dealer, const std::string& req_id, const json& payload) {
+        if (!engine_) {
+            LOG_M_ERROR("Engine not initialized, cannot query book");
+            send_response(dealer, req_id, "error", {{"message", "Engine not initialized"}});
+            return;
+        }
+
+        std::string symbol = payload.value("symbol", "");
+        if (symbol.empty()) {
+            LOG_M_WARNING("QUERY_BOOK: missing symbol");
+            send_response(dealer, req_id, "error", {{"message", "Missing symbol"}});
+            return;
+        }
+
+        symbol = symbol_utils::normalize_symbol(symbol);
+        auto top = engine_->query_top_of_book(symbol);
+        if (!top) {
+            LOG_M_WARNING("QUERY_BOOK: no book for {}", symbol);
+            send_response(dealer, req_id, "error", {{"message", "No book: " + symbol}});
+            return;
+        }
+
+        // 价格按元返回 (订单簿内部为 价格 × 10000)
+        send_response(dealer, req_id, "success", {
+            {"symbol", symbol},
+            {"bid_price", top->bid_price / 10000.0},
+            {"bid_volume", top->bid_volume},
+            {"ask_price", top->ask_price / 10000.0},
+            {"ask_volume", top->ask_volume},
+            {"last_price", top->last_price / 10000.0},
+            {"last_volume", top->last_volume},
+            {"applseqnum", top->applseqnum},
+            {"version", top->version}
+        });
+    }
+
     // ==========================================
     // add_hot_stock_ht / remove_hot_stock_ht 处理
     // ==========================================
@@ -30,6 +30,9 @@ namespace Action {
     // 策略启用/禁用
     constexpr const char* ENABLE_STRATEGY = "enable_strategy";
     constexpr const char* DISABLE_STRATEGY = "disable_strategy";
+
+    // 行情查询
+    constexpr const char* QUERY_BOOK = "query_book";
 }
 
 // ========== 消息结构体 ==========
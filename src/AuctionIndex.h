@@ -0,0 +1,173 @@
+#pragma once
+
+#include <map>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief 集合竞价撮合索引 (累计买卖量 Fenwick 树)
+ *
+ * 覆盖 tick 区间 [lo, lo + n)，按档位维护买、卖挂单量，三棵 Fenwick 树：
+ *   bid_:   买量             -> D(p) = 价格 >= p 的买量 = 买总量 - 买量前缀(p)
+ *   ask_:   卖量             -> S(p) = 价格 <= p 的卖量 = 卖量前缀(p + 1)
+ *   cross_: g[t] = 卖[t] + 买[t-1]，其前缀 F(p) = 卖量前缀(p + 1) + 买量前缀(p)
+ *
+ * D 单调不增、S 单调不减，D(p) >= S(p) 等价于 F(p) <= 买总量。
+ * 在 cross_ 上做一次 Fenwick 下降即得最后一个 D >= S 的档位 p*，
+ * 最大成交量只可能在 p* (= S(p*)) 或 p* + 1 (= D(p* + 1)) 处取得；
+ * 成交量相同的价格构成连续区间，两端由卖/买量前缀的 lower_bound 求得。
+ * 每次挂单量变动 O(log n) 更新，查询 O(log n)，不逐档扫描。
+ *
+ * 区间外的委托：高于区间的买单/低于区间的卖单计入边界档 (对区间内任何价格都可成交)，
+ * 低于区间的买单/高于区间的卖单忽略 (在区间内任何价格都不成交)。
+ */
+class AuctionIndex {
+public:
+    // 成交量最大的价格区间 [lo_tick, hi_tick] 与该成交量
+    struct Match {
+        int32_t lo_tick;
+        int32_t hi_tick;
+        uint64_t volume;
+    };
+
+    void reset(int32_t lo, uint32_t n) {
+        lo_ = lo;
+        n_ = n;
+        bid_.assign(n + 1, 0);
+        ask_.assign(n + 1, 0);
+        cross_.assign(n + 1, 0);
+        bid_level_.assign(n, 0);
+        ask_level_.assign(n, 0);
+        overflow_bids_.clear();
+        overflow_asks_.clear();
+        bid_total_ = 0;
+        ask_total_ = 0;
+    }
+
+    int32_t lo() const { return lo_; }
+    uint32_t size() const { return n_; }
+    bool contains(int32_t tick) const { return static_cast<uint32_t>(tick - lo_) < n_; }
+
+    // 设置某档位当前挂单量 (内部换算为增量)
+    void set_bid(int32_t tick, uint64_t volume) {
+        int64_t slot = static_cast<int64_t>(tick) - lo_;
+        if (slot < 0 || n_ == 0) return;
+        if (slot >= n_) {
+            // 高于区间的买单计入最高档：按档位记录原值，差量累加到边界
+            uint64_t& old = overflow_bids_[tick];
+            add_bid(n_ - 1, volume - old);
+            old = volume;
+            if (volume == 0) overflow_bids_.erase(tick);
+            return;
+        }
+        add_bid(static_cast<uint32_t>(slot), volume - bid_level_[slot]);
+        bid_level_[slot] = volume;
+    }
+
+    void set_ask(int32_t tick, uint64_t volume) {
+        int64_t slot = static_cast<int64_t>(tick) - lo_;
+        if (slot >= n_ || n_ == 0) return;
+        if (slot < 0) {
+            uint64_t& old = overflow_asks_[tick];
+            add_ask(0, volume - old);
+            old = volume;
+            if (volume == 0) overflow_asks_.erase(tick);
+            return;
+        }
+        add_ask(static_cast<uint32_t>(slot), volume - ask_level_[slot]);
+        ask_level_[slot] = volume;
+    }
+
+    uint64_t bid_total() const { return bid_total_; }
+    uint64_t ask_total() const { return ask_total_; }
+
+    // 价格 >= tick 的买量 / 价格 <= tick 的卖量 (tick 须在区间内)
+    uint64_t demand(int32_t tick) const { return bid_total_ - prefix(bid_, static_cast<uint32_t>(tick - lo_)); }
+    uint64_t supply(int32_t tick) const { return prefix(ask_, static_cast<uint32_t>(tick - lo_) + 1); }
+
+    // 最大成交量及其价格区间；买卖不交叉时返回 false
+    bool best_match(Match& out) const {
+        if (bid_total_ == 0 || ask_total_ == 0) return false;
+
+        // p*: F(p) <= 买总量 的最长前缀的最后一个位置 (-1 表示 p = 0 处已 D < S)
+        int64_t p = static_cast<int64_t>(descend(cross_, bid_total_)) - 1;
+        uint64_t vs = p >= 0 ? prefix(ask_, static_cast<uint32_t>(p) + 1) : 0;
+        uint64_t vd = p + 1 < n_ ? bid_total_ - prefix(bid_, static_cast<uint32_t>(p) + 1) : 0;
+        uint64_t v = vs > vd ? vs : vd;
+        if (v == 0) return false;
+
+        int64_t lo, hi;
+        if (vs == v) {
+            // [最后一个有卖量的档位 <= p*, p*]：S 恒为 vs
+            lo = static_cast<int64_t>(lower_bound(ask_, vs));
+            hi = p;
+            if (vd == v) hi = static_cast<int64_t>(lower_bound(bid_, prefix(bid_, static_cast<uint32_t>(p) + 1) + 1));
+        } else {
+            // [p* + 1, 第一个有买量的档位 >= p* + 1]：D 恒为 vd
+            lo = p + 1;
+            hi = static_cast<int64_t>(lower_bound(bid_, prefix(bid_, static_cast<uint32_t>(p) + 1) + 1));
+        }
+        out.lo_tick = lo_ + static_cast<int32_t>(lo);
+        out.hi_tick = lo_ + static_cast<int32_t>(hi);
+        out.volume = v;
+        return true;
+    }
+
+private:
+    void add_bid(uint32_t slot, uint64_t delta) {
+        bid_total_ += delta;
+        add(bid_, slot, delta);
+        if (slot + 1 < n_) add(cross_, slot + 1, delta);
+    }
+
+    void add_ask(uint32_t slot, uint64_t delta) {
+        ask_total_ += delta;
+        add(ask_, slot, delta);
+        add(cross_, slot, delta);
+    }
+
+    // 位置 slot (0 起) 加 delta (补码表示负数)
+    void add(std::vector<uint64_t>& tree, uint32_t slot, uint64_t delta) {
+        for (uint32_t i = slot + 1; i <= n_; i += i & (0 - i)) tree[i] += delta;
+    }
+
+    // [0, k) 的前缀和
+    static uint64_t prefix(const std::vector<uint64_t>& tree, uint32_t k) {
+        uint64_t sum = 0;
+        for (uint32_t i = k; i > 0; i -= i & (0 - i)) sum += tree[i];
+        return sum;
+    }
+
+    // 前缀和 <= limit 的最长前缀长度
+    uint32_t descend(const std::vector<uint64_t>& tree, uint64_t limit) const {
+        uint32_t idx = 0;
+        uint32_t step = 1;
+        while (step * 2 <= n_) step *= 2;
+        for (; step > 0; step >>= 1) {
+            uint32_t next = idx + step;
+            if (next <= n_ && tree[next] <= limit) {
+                idx = next;
+                limit -= tree[next];
+            }
+        }
+        return idx;
+    }
+
+    // 前缀和首次 >= target 的位置 (0 起)，即 [0, pos] 之和 >= target
+    uint32_t lower_bound(const std::vector<uint64_t>& tree, uint64_t target) const {
+        return descend(tree, target - 1);
+    }
+
+    int32_t lo_ = 0;
+    uint32_t n_ = 0;
+    std::vector<uint64_t> bid_;     // Fenwick，1 起下标
+    std::vector<uint64_t> ask_;
+    std::vector<uint64_t> cross_;
+    std::vector<uint64_t> bid_level_;   // 各档当前量 (换算增量用)
+    std::vector<uint64_t> ask_level_;
+    std::map<int32_t, uint64_t> overflow_bids_;   // 高于区间的买档 -> 量 (计入最高档)
+    std::map<int32_t, uint64_t> overflow_asks_;   // 低于区间的卖档 -> 量 (计入最低档)
+    uint64_t bid_total_ = 0;
+    uint64_t ask_total_ = 0;
+};
@@ -0,0 +1,254 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DEPTH_KERNELS_X86 1
+#endif
+
+/**
+ * @brief 盘口深度计算内核 (SIMD)
+ *
+ * 作用于 FastOrderBook 的单侧连续挂单量数组 (uint64_t volume[], 下标 = 档位)：
+ * - range_sum:            [begin, end) 区间挂单量求和
+ * - find_cumulative_ge:   从 begin 向上累加，返回累计量首次 >= target 的档位
+ * - rfind_cumulative_ge:  从 end-1 向下累加，返回累计量首次 >= target 的档位
+ *
+ * 实现：AVX-512 / AVX2 / 标量三套，运行时按 CPU 能力选择 (不依赖 -march 编译选项)。
+ * 累计查找按 16 档一块做 SIMD 块求和，块内越过 target 时再标量定位，
+ * 稀疏盘口下绝大部分档位为 0，块求和即可整体跳过。
+ */
+namespace depth_kernels {
+
+enum class SimdLevel : int {
+    Scalar = 0,
+    AVX2 = 1,
+    AVX512 = 2
+};
+
+// 块大小：一次判断 16 档 (AVX2 4 个向量 / AVX-512 2 个向量)
+constexpr size_t BLOCK = 16;
+
+inline SimdLevel detect_simd_level() {
+#if defined(DEPTH_KERNELS_X86)
+    static const SimdLevel level = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return SimdLevel::AVX512;
+        if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+        return SimdLevel::Scalar;
+    }();
+    return level;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+// ============================================================================
+// 标量实现
+// ============================================================================
+
+inline uint64_t range_sum_scalar(const uint64_t* v, size_t begin, size_t end) {
+    uint64_t total = 0;
+    for (size_t i = begin; i < end; ++i) total += v[i];
+    return total;
+}
+
+inline int64_t find_cumulative_ge_scalar(const uint64_t* v, size_t begin, size_t end,
+                                         uint64_t target, uint64_t& acc) {
+    for (size_t i = begin; i < end; ++i) {
+        acc += v[i];
+        if (acc >= target) return static_cast<int64_t>(i);
+    }
+    return -1;
+}
+
+inline int64_t rfind_cumulative_ge_scalar(const uint64_t* v, size_t begin, size_t end,
+                                          uint64_t target, uint64_t& acc) {
+    for (size_t i = end; i > begin; --i) {
+        acc += v[i - 1];
+        if (acc >= target) return static_cast<int64_t>(i - 1);
+    }
+    return -1;
+}
+
+#if defined(DEPTH_KERNELS_X86)
+
+// ============================================================================
+// AVX2 实现
+// ============================================================================
+
+__attribute__((target("avx2")))
+inline uint64_t hsum_avx2(__m256i x) {
+    __m128i s = _mm_add_epi64(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1));
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(s)) + static_cast<uint64_t>(_mm_extract_epi64(s, 1));
+}
+
+__attribute__((target("avx2")))
+inline uint64_t block_sum_avx2(const uint64_t* p) {
+    const __m256i* q = reinterpret_cast<const __m256i*>(p);
+    __m256i a = _mm256_add_epi64(_mm256_loadu_si256(q), _mm256_loadu_si256(q + 1));
+    __m256i b = _mm256_add_epi64(_mm256_loadu_si256(q + 2), _mm256_loadu_si256(q + 3));
+    return hsum_avx2(_mm256_add_epi64(a, b));
+}
+
+__attribute__((target("avx2")))
+inline uint64_t range_sum_avx2(const uint64_t* v, size_t begin, size_t end) {
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        acc0 = _mm256_add_epi64(acc0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + i)));
+        acc1 = _mm256_add_epi64(acc1, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + i + 4)));
+    }
+    uint64_t total = hsum_avx2(_mm256_add_epi64(acc0, acc1));
+    for (; i < end; ++i) total += v[i];
+    return total;
+}
+
+__attribute__((target("avx2")))
+inline int64_t find_cumulative_ge_avx2(const uint64_t* v, size_t begin, size_t end,
+                                       uint64_t target, uint64_t& acc) {
+    size_t i = begin;
+    for (; i + BLOCK <= end; i += BLOCK) {
+        uint64_t s = block_sum_avx2(v + i);
+        if (acc + s >= target) return find_cumulative_ge_scalar(v, i, i + BLOCK, target, acc);
+        acc += s;
+    }
+    return find_cumulative_ge_scalar(v, i, end, target, acc);
+}
+
+__attribute__((target("avx2")))
+inline int64_t rfind_cumulative_ge_avx2(const uint64_t* v, size_t begin, size_t end,
+                                        uint64_t target, uint64_t& acc) {
+    size_t i = end;
+    for (; i >= begin + BLOCK; i -= BLOCK) {
+        uint64_t s = block_sum_avx2(v + i - BLOCK);
+        if (acc + s >= target) return rfind_cumulative_ge_scalar(v, i - BLOCK, i, target, acc);
+        acc += s;
+    }
+    return rfind_cumulative_ge_scalar(v, begin, i, target, acc);
+}
+
+// ============================================================================
+// AVX-512 实现
+// ============================================================================
+
+// 水平求和：落地到栈上逐 lane 相加
+// (GCC 12 的 _mm512_reduce_add_epi64 / shuffle / extract 内联后会触发 -Wuninitialized 误报)
+__attribute__((target("avx512f")))
+inline uint64_t hsum_avx512(__m512i x) {
+    alignas(64) uint64_t lanes[8];
+    _mm512_store_si512(lanes, x);
+    return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) +
+           ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+}
+
+__attribute__((target("avx512f")))
+inline uint64_t block_sum_avx512(const uint64_t* p) {
+    return hsum_avx512(_mm512_add_epi64(_mm512_loadu_si512(p), _mm512_loadu_si512(p + 8)));
+}
+
+__attribute__((target("avx512f")))
+inline uint64_t range_sum_avx512(const uint64_t* v, size_t begin, size_t end) {
+    __m512i acc0 = _mm512_setzero_si512();
+    __m512i acc1 = _mm512_setzero_si512();
+    size_t i = begin;
+    for (; i + 16 <= end; i += 16) {
+        acc0 = _mm512_add_epi64(acc0, _mm512_loadu_si512(v + i));
+        acc1 = _mm512_add_epi64(acc1, _mm512_loadu_si512(v + i + 8));
+    }
+    if (i < end) {
+        // 尾部用掩码加载，不越界读
+        size_t rest = end - i;
+        __mmask8 m0 = static_cast<__mmask8>(rest >= 8 ? 0xFF : ((1u << rest) - 1));
+        acc0 = _mm512_add_epi64(acc0, _mm512_maskz_loadu_epi64(m0, v + i));
+        if (rest > 8) {
+            __mmask8 m1 = static_cast<__mmask8>((1u << (rest - 8)) - 1);
+            acc1 = _mm512_add_epi64(acc1, _mm512_maskz_loadu_epi64(m1, v + i + 8));
+        }
+    }
+    return hsum_avx512(_mm512_add_epi64(acc0, acc1));
+}
+
+__attribute__((target("avx512f")))
+inline int64_t find_cumulative_ge_avx512(const uint64_t* v, size_t begin, size_t end,
+                                         uint64_t target, uint64_t& acc) {
+    size_t i = begin;
+    for (; i + BLOCK <= end; i += BLOCK) {
+        uint64_t s = block_sum_avx512(v + i);
+        if (acc + s >= target) return find_cumulative_ge_scalar(v, i, i + BLOCK, target, acc);
+        acc += s;
+    }
+    return find_cumulative_ge_scalar(v, i, end, target, acc);
+}
+
+__attribute__((target("avx512f")))
+inline int64_t rfind_cumulative_ge_avx512(const uint64_t* v, size_t begin, size_t end,
+                                          uint64_t target, uint64_t& acc) {
+    size_t i = end;
+    for (; i >= begin + BLOCK; i -= BLOCK) {
+        uint64_t s = block_sum_avx512(v + i - BLOCK);
+        if (acc + s >= target) return rfind_cumulative_ge_scalar(v, i - BLOCK, i, target, acc);
+        acc += s;
+    }
+    return rfind_cumulative_ge_scalar(v, begin, i, target, acc);
+}
+
+#endif // DEPTH_KERNELS_X86
+
+// ============================================================================
+// 运行时分发入口
+// ============================================================================
+
+/**
+ * @brief [begin, end) 区间求和
+ */
+inline uint64_t range_sum(const uint64_t* v, size_t begin, size_t end) {
+    if (begin >= end) return 0;
+#if defined(DEPTH_KERNELS_X86)
+    switch (detect_simd_level()) {
+        case SimdLevel::AVX512: return range_sum_avx512(v, begin, end);
+        case SimdLevel::AVX2:   return range_sum_avx2(v, begin, end);
+        default: break;
+    }
+#endif
+    return range_sum_scalar(v, begin, end);
+}
+
+/**
+ * @brief 从 begin 向上累加，返回累计量首次 >= target 的下标
+ * @param acc 输入初始累计量，输出累加到返回档位 (含) 为止的累计量；未找到时为区间总量
+ * @return 档位下标，区间内累计量不足返回 -1
+ */
+inline int64_t find_cumulative_ge(const uint64_t* v, size_t begin, size_t end,
+                                  uint64_t target, uint64_t& acc) {
+    if (begin >= end) return -1;
+#if defined(DEPTH_KERNELS_X86)
+    switch (detect_simd_level()) {
+        case SimdLevel::AVX512: return find_cumulative_ge_avx512(v, begin, end, target, acc);
+        case SimdLevel::AVX2:   return find_cumulative_ge_avx2(v, begin, end, target, acc);
+        default: break;
+    }
+#endif
+    return find_cumulative_ge_scalar(v, begin, end, target, acc);
+}
+
+/**
+ * @brief 从 end-1 向下累加，返回累计量首次 >= target 的下标 (买盘方向)
+ */
+inline int64_t rfind_cumulative_ge(const uint64_t* v, size_t begin, size_t end,
+                                   uint64_t target, uint64_t& acc) {
+    if (begin >= end) return -1;
+#if defined(DEPTH_KERNELS_X86)
+    switch (detect_simd_level()) {
+        case SimdLevel::AVX512: return rfind_cumulative_ge_avx512(v, begin, end, target, acc);
+        case SimdLevel::AVX2:   return rfind_cumulative_ge_avx2(v, begin, end, target, acc);
+        default: break;
+    }
+#endif
+    return rfind_cumulative_ge_scalar(v, begin, end, target, acc);
+}
+
+} // namespace depth_kernels
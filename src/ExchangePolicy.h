@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include "market_data_structs_aligned.h"
+#include "utils/symbol_utils.h"
+
+/**
+ * @brief 交易所差异策略 (编译期)
+ *
+ * FastOrderBook 的 on_order/on_transaction 按策略类型实例化，每个订单簿构造时确定交易所，
+ * 入口处一次分派后，整条处理路径中的交易所判断都是编译期常量：
+ *
+ *   - 委托编号：上海用 orderno，深圳用 orderindex (与成交回报中的 TradeBuyNo/TradeSellNo 匹配)
+ *   - 成交：深圳更新买卖双方；上海连续竞价只更新被动方 (按 bsflag)，集合竞价 (bsflag=0) 更新双方
+ *
+ * Auto 为兼容路径：不区分交易所，逐条消息按字段判断 (原有行为)。
+ */
+enum class Exchange : uint8_t {
+    Auto = 0,
+    Shanghai = 1,
+    Shenzhen = 2
+};
+
+struct ShanghaiPolicy {
+    static constexpr Exchange EXCHANGE = Exchange::Shanghai;
+
+    static uint64_t order_id(const MDOrderStruct& order) {
+        return static_cast<uint64_t>(order.orderno);
+    }
+
+    // 连续竞价成交是否只更新被动方
+    static bool passive_side_only(const MDTransactionStruct&) { return true; }
+};
+
+struct ShenzhenPolicy {
+    static constexpr Exchange EXCHANGE = Exchange::Shenzhen;
+
+    static uint64_t order_id(const MDOrderStruct& order) {
+        return static_cast<uint64_t>(order.orderindex);
+    }
+
+    static bool passive_side_only(const MDTransactionStruct&) { return false; }
+};
+
+struct AutoPolicy {
+    static constexpr Exchange EXCHANGE = Exchange::Auto;
+
+    static uint64_t order_id(const MDOrderStruct& order) {
+        return static_cast<uint64_t>((order.orderno != 0) ? order.orderno : order.orderindex);
+    }
+
+    static bool passive_side_only(const MDTransactionStruct& txn) {
+        return txn.securityidsource != 102;
+    }
+};
+
+// 按证券代码确定订单簿使用的交易所策略
+inline Exchange exchange_of(const char* symbol) {
+    return symbol_utils::is_shanghai_security(symbol) ? Exchange::Shanghai : Exchange::Shenzhen;
+}
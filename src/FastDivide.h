@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief 32 位无符号整数除以运行期不变的除数
+ *
+ * 构造时预计算 M = floor((2^64 - 1) / d) + 1，之后 n / d = (M * n) >> 64 (取 128 位乘积高 64 位)，
+ * 对全部 32 位被除数精确 (Lemire, Kaser, Kurz: "Faster Remainder by Direct Computation", 2019)。
+ * 一次乘法代替 div 指令，用于订单簿价格 -> 档位下标 (除以最小报价单位)。
+ *
+ * 要求 d >= 2 (d = 1 时 M 溢出)。
+ */
+class FastDivU32 {
+public:
+    constexpr explicit FastDivU32(uint32_t divisor)
+        : m_(UINT64_C(0xFFFFFFFFFFFFFFFF) / divisor + 1), divisor_(divisor) {}
+
+    constexpr uint32_t divide(uint32_t n) const {
+        return static_cast<uint32_t>((static_cast<unsigned __int128>(m_) * n) >> 64);
+    }
+
+    constexpr uint32_t divisor() const { return divisor_; }
+
+private:
+    uint64_t m_;
+    uint32_t divisor_;
+};
@@ -1,70 +1,86 @@
 #include "FastOrderBook.h"
 #include <cstring>         // for memset if needed
-#include <algorithm>       // for std::find
+#include <algorithm>       // for std::min/std::max
+#include <stdexcept>
 
 // 日志模块
 #define LOG_MODULE MOD_ORDERBOOK
 
-// 使用类中定义的 TICK_SIZE
-constexpr uint32_t TICK_SIZE = FastOrderBook::TICK_SIZE;
-
-// 确保价格在合法范围内
-#define CHECK_PRICE_RANGE(p) \
-    if ((p) < min_price_ || (p) > (min_price_ + (levels_.size() - 1) * TICK_SIZE)) return false;
-
-FastOrderBook::FastOrderBook(uint32_t code, ObjectPool<OrderNode>& pool, uint32_t min_price, uint32_t max_price)
-    : stock_code_(code), pool_(pool), min_price_(min_price) {
-
-    // 1. 计算价格覆盖范围 (例如 跌停价~涨停价)
-    // 每个档位间隔TICK_SIZE (100)，多加1是为了包含 max_price 本身
-    size_t capacity = (max_price - min_price) / TICK_SIZE + 1;
-    
-    // 2. 预分配 Level 数组 (Direct Array Mapping)
-    // 关键：这里只分配内存，不构造内部对象，因为 Level 是 POD
-    levels_.resize(capacity);
-    
-    // 初始化 Level 状态 (全部置空)
-    for (auto& lvl : levels_) {
-        lvl.bid_volume = 0;
-        lvl.bid_head_idx = -1;
-        lvl.bid_tail_idx = -1;
-        lvl.ask_volume = 0;
-        lvl.ask_head_idx = -1;
-        lvl.ask_tail_idx = -1;
-        // lvl.price 可以在这里初始化，也可以在用的时候算，这里为了严谨设为对应价格
-        // 注意：实际访问是靠下标，这个 price 字段主要用于调试或校验
-        lvl.price = 0;
-    }
-    
+FastOrderBook::FastOrderBook(uint32_t code, ObjectPool<OrderNode>& pool, uint32_t min_price, uint32_t max_price,
+                             Exchange exchange, uint32_t tick_size)
+    : stock_code_(code), pool_(pool), price_limited_(min_price > 0 && max_price > min_price),
+      tick_size_(tick_size), tick_div_(tick_size), exchange_(exchange), fixed_window_(false) {
+
+    if (tick_size < 2) {
+        throw std::invalid_argument("FastOrderBook: tick_size must be >= 2");
+    }
+
+    if (!price_limited_) {
+        // 无涨跌停限制：不低于一个最小报价单位的价格均合法 (tick 0 的价格会与 "不在档位" 混淆)
+        // 密集窗口在首个限价单到达时以其价格为中心分配
+        min_price_ = tick_size_;
+        max_price_ = UINT32_MAX;
+    } else {
+        // 1. 计算价格覆盖范围 (跌停价~涨停价)
+        // 每个档位间隔 tick_size_ (股票 100)，多加1是为了包含 max_price 本身
+        uint32_t band_levels = (max_price - min_price) / tick_size_ + 1;
+        min_price_ = min_price;
+        max_price_ = min_price_ + (band_levels - 1) * tick_size_;
+
+        if (band_levels <= MAX_DENSE_LEVELS) {
+            // 2. 区间足够窄：整个区间预分配为密集数组 (Direct Array Mapping, SoA)
+            // 挂单量清零，链表头尾置空；档位占用位图与数组一一对应
+            fixed_window_ = true;
+            win_lo_ = price_to_level(min_price_);
+            win_size_ = band_levels;
+            bid_volume_.assign(band_levels, 0);
+            ask_volume_.assign(band_levels, 0);
+            level_links_.assign(band_levels, LevelLinks{-1, -1, -1, -1, 0, 0});
+            bid_bitmap_.resize(band_levels);
+            ask_bitmap_.resize(band_levels);
+        } else {
+            // 区间过宽 (高价股等)：先以区间中点 (约为昨收价) 为中心分配窗口，其余价位按需进入稀疏层
+            recenter(price_to_level(min_price_ + (band_levels / 2) * tick_size_));
+        }
+    }
+
     // 初始化游标，-1 表示当前无挂单
     best_bid_idx_ = -1;
     best_ask_idx_ = -1;
+}
 
-    // 预留空间
-    market_orders_.reserve(1000);
-    order_index_.reserve(100000); // 建议使用 flat_hash_map
+FastOrderBook::~FastOrderBook() {
+    // 本订单簿的 slab 整体归还共享池
+    pool_.release(arena_);
 }
 
 bool FastOrderBook::on_order(const MDOrderStruct& order) {
+    // 交易所在构造时确定，每个订单簿固定走同一分支
+    bool ok;
+    switch (exchange_) {
+        case Exchange::Shanghai: ok = on_order_as<ShanghaiPolicy>(order); break;
+        case Exchange::Shenzhen: ok = on_order_as<ShenzhenPolicy>(order); break;
+        default:                 ok = on_order_as<AutoPolicy>(order); break;
+    }
+    if (top_) publish_top(order.applseqnum);
+    return ok;
+}
+
+template<typename Policy>
+bool FastOrderBook::on_order_as(const MDOrderStruct& order) {
     // 映射 MDOrderStruct.ordertype 到内部 OrderType
     // 约定 (基于 OrderBook.cpp): 1=Market, 2=Limit, 3=Best, 4=Cancel
-    // 注意：深圳使用 orderindex 作为订单唯一标识（与成交回报中的 TradeBuyNo/TradeSellNo 匹配）
-    //      上海使用 orderno
-    uint64_t order_id = (order.orderno != 0) ? order.orderno : order.orderindex;
+    // 订单唯一标识由交易所策略给出 (深圳 orderindex，上海 orderno)
+    uint64_t order_id = Policy::order_id(order);
+    Side side = (order.orderbsflag == 1 ? Side::Buy : Side::Sell);
 
     switch (order.ordertype) {
         case 1: // Market Order
-            return add_order(order_id, OrderType::Market,
-                             (order.orderbsflag == 1 ? Side::Buy : Side::Sell),
-                             (uint32_t)order.orderprice, (uint32_t)order.orderqty);
+            return add_order(order_id, OrderType::Market, side, (uint32_t)order.orderprice, (uint32_t)order.orderqty);
         case 2: // Limit Order
-            return add_order(order_id, OrderType::Limit,
-                             (order.orderbsflag == 1 ? Side::Buy : Side::Sell),
-                             (uint32_t)order.orderprice, (uint32_t)order.orderqty);
+            return add_order(order_id, OrderType::Limit, side, (uint32_t)order.orderprice, (uint32_t)order.orderqty);
         case 3: // Best Order
-            return add_order(order_id, OrderType::Best,
-                             (order.orderbsflag == 1 ? Side::Buy : Side::Sell),
-                             (uint32_t)order.orderprice, (uint32_t)order.orderqty);
+            return add_order(order_id, OrderType::Best, side, (uint32_t)order.orderprice, (uint32_t)order.orderqty);
         case 4:  // Cancel (Standard)
         case 10: // ShanghaiCancel
             return cancel_order(order_id, (uint32_t)order.orderqty);
@@ -74,392 +90,1267 @@ bool FastOrderBook::on_order(const MDOrderStruct& order) {
 }
 
 bool FastOrderBook::add_order(uint64_t seq, OrderType type, Side side, uint32_t price, uint32_t volume) {
-    // 1. 从内存池申请节点 (Zero Allocation)
-    int32_t node_idx = pool_.alloc();
+    change_cause_ = LevelChangeCause::Add;
+
+    // 1. 确定物理挂单档位 (lvl < 0 表示进入市价单队列)
+    int32_t lvl = -1;
+    if (type == OrderType::Limit) {
+        lvl = price_to_level(price);
+        if (lvl < 0) return false; // 边界检查 (先于分配，越界不占用节点)
+    } else if (type == OrderType::Best) {
+        // 本方最优：挂到本方当前最优档
+        // 如果本方没有挂单，Best单通常转为市价单或撤销，这里按转市价处理
+        lvl = (side == Side::Buy) ? best_bid_idx_ : best_ask_idx_;
+    }
+
+    // 2. 从内存池申请节点并建立索引 (Zero Allocation)
+    // 原始价与物理价相同 (限价单) 时不额外存储
+    int32_t node_idx = alloc_node(seq, type, side, price, level_price(lvl), volume, lvl);
+    if (node_idx < 0) return false;
+
+    // 3. 挂入 Level 链表，更新最优价游标和深度缓存
+    if (lvl >= 0) link_limit_node(lvl, node_idx, pool_[node_idx]);
+
+    // 主力资金流向：登记原始委托量 (上海主动单的剩余部分加回其已成交量)
+    if (money_flow_enabled_) {
+        uint64_t original = volume + (seq == aggressor_seq_ ? aggressor_filled_ : 0);
+        orig_volumes_.insert(seq, static_cast<int32_t>(std::min<uint64_t>(original, INT32_MAX)));
+    }
+
+    // 4. 关注范围内的订单事件
+    if (order_sink_ && !order_watches_.empty() && order_watched(side, lvl)) {
+        order_sink_->push_back(OrderEvent{seq, lvl >= 0 ? level_price(lvl) : 0u, volume, volume, side, OrderEventType::Added});
+    }
+    return true;
+}
+
+int32_t FastOrderBook::alloc_node(uint64_t seq, OrderType type, Side side, uint32_t original_price,
+                                  uint32_t sort_price, uint32_t volume, int32_t lvl) {
+    if (volume > OrderNode::MAX_VOLUME) {
+        LOG_M_ERROR("Order volume exceeds node capacity: seq={}, volume={}", seq, volume);
+        return -1;
+    }
+
+    int32_t node_idx = pool_.alloc(arena_);
     if (node_idx < 0) {
         LOG_M_ERROR("Memory pool exhausted!");
-        return false;
+        return -1;
     }
 
-    OrderNode& node = pool_.get(node_idx);
+    // seq 基准：首个订单入簿时确定，在其两侧各留 2^31 的窗口
+    // (快照恢复按队列顺序还原，较小的序号可能晚于较大的序号到达)
+    if (!seq_base_set_) {
+        seq_base_ = seq > (1ULL << 31) ? seq - (1ULL << 31) : 0;
+        seq_base_set_ = true;
+    }
+    uint32_t delta = OrderNode::WIDE_SEQ;
+    if (seq >= seq_base_ && seq - seq_base_ < OrderNode::WIDE_SEQ) {
+        delta = static_cast<uint32_t>(seq - seq_base_);
+    } else {
+        wide_seqs_[node_idx] = seq;
+    }
 
-    // 2. 填充数据 (POD赋值，极快)
-    node.seq = seq;
-    node.volume = volume;
-    node.type = type;
-    node.side = side;
-    node.original_price = price; // 保存原始语义
-    node.prev_idx = -1;
-    node.next_idx = -1;
+    bool orig_differs = original_price != sort_price;
+    if (orig_differs) orig_prices_.insert(seq, static_cast<int32_t>(original_price));
 
-    // 3. 建立索引 (Seq -> Index)
-    order_index_[seq] = node_idx;
+    pool_[node_idx].init(delta, type, side, volume, orig_differs);
+    order_index_.insert(seq, node_idx, static_cast<uint32_t>(lvl + 1));
+    if (lvl < 0) push_market_order(node_idx, pool_[node_idx]);
+    return node_idx;
+}
 
-    // 4. 分发逻辑
-    if (type == OrderType::Market) {
-        // --- 市价单 ---
-        node.sort_price = 0; // 无意义
-        market_orders_.push_back(node_idx);
-        return true;
+void FastOrderBook::free_node(uint64_t seq, int32_t node_idx, const OrderNode& node) {
+    if (node.has_original_price()) orig_prices_.erase(seq);
+    if (money_flow_enabled_) orig_volumes_.erase(seq);
+    if (node.seq_delta == OrderNode::WIDE_SEQ) wide_seqs_.erase(node_idx);
+    order_index_.erase(seq);
+    pool_.free(arena_, node_idx);
+}
+
+void FastOrderBook::link_limit_node(int32_t tick, int32_t node_idx, OrderNode& node) {
+    // 无涨跌停订单簿在首个限价单到达时以其价格为中心分配密集窗口
+    if (win_size_ == 0) recenter(tick);
+
+    add_node_to_level(tick, node_idx, node);
+    Side side = node.side();
+
+    // 已开启排队索引的档位：登记队尾位置 (位置用满时按链表重建，新节点已在链表中)
+    if (!tracked_queues_.empty()) {
+        for (TrackedQueue& q : tracked_queues_) {
+            if (q.side != side || q.tick != tick) continue;
+            if (!q.index.append(node_seq(node_idx, node), node.volume())) rebuild_queue_index(q);
+            break;
+        }
     }
-    
-    // --- 确定物理挂单价格 (sort_price) ---
-    uint32_t target_price = price;
-
-    if (type == OrderType::Best) {
-        // 本方最优：获取当前最优价
-        // 如果买单，找 best_bid；如果卖单，找 best_ask
-        // 注意：get_best_xxx 返回的是 optional
-        auto best_opt = (side == Side::Buy) ? get_best_bid() : get_best_ask();
-        
-        if (!best_opt.has_value()) {
-            // 对手盘空或者本方空？通常Best指本方最优。
-            // 如果本方没有挂单，Best单通常转为市价单或撤销，这里按转市价处理
-            market_orders_.push_back(node_idx);
-            return true;
-        }
-        target_price = best_opt.value();
-    }
-    
-    // 记录物理价格
-    node.sort_price = target_price;
-    CHECK_PRICE_RANGE(target_price); // 边界检查
-
-    // 5. 挂入 Level 链表
-    // 计算数组下标：Offset Mapping，每TICK_SIZE为一档
-    uint32_t lvl_idx = (target_price - min_price_) / TICK_SIZE;
-    Level& lvl = levels_[lvl_idx];
-    
-    // 设置 Level 的价格 (如果是第一次用到)
-    lvl.price = target_price; 
-    
-    add_node_to_level(lvl, node_idx, node);
-
-    // 6. 更新最优价游标 (Cursor Update)
+
+    // 更新最优价游标 (Cursor Update)
     // 这是一个 O(1) 的检查
+    bool best_changed = false;
     if (side == Side::Buy) {
         // 买单：价格越高越好。如果新单价格 > 当前最优，或者当前没最优，更新指针
-        if (best_bid_idx_ == -1 || (int32_t)lvl_idx > best_bid_idx_) {
-            best_bid_idx_ = (int32_t)lvl_idx;
+        if (best_bid_idx_ == -1 || tick > best_bid_idx_) {
+            best_bid_idx_ = tick;
+            best_changed = true;
         }
     } else {
         // 卖单：价格越低越好。如果新单价格 < 当前最优，或者当前没最优，更新指针
-        if (best_ask_idx_ == -1 || (int32_t)lvl_idx < best_ask_idx_) {
-            best_ask_idx_ = (int32_t)lvl_idx;
+        if (best_ask_idx_ == -1 || tick < best_ask_idx_) {
+            best_ask_idx_ = tick;
+            best_changed = true;
         }
     }
+    if (best_changed) maybe_recenter();
+
+    // 维护前 N 档深度缓存
+    on_level_changed(side, tick);
+}
+
+bool FastOrderBook::restore_order(uint64_t seq, OrderType type, Side side,
+                                  uint32_t original_price, uint32_t sort_price, uint32_t volume) {
+    change_cause_ = LevelChangeCause::Add;
+
+    // 先做边界检查，避免越界时泄漏节点
+    int32_t lvl = -1;
+    if (type != OrderType::Market && sort_price != 0) {
+        lvl = price_to_level(sort_price);
+        if (lvl < 0) return false;
+    }
+
+    int32_t node_idx = alloc_node(seq, type, side, original_price, level_price(lvl), volume, lvl);
+    if (node_idx < 0) return false;
 
+    if (lvl >= 0) link_limit_node(lvl, node_idx, pool_[node_idx]);
     return true;
 }
 
 bool FastOrderBook::on_trade(uint64_t bid_seq, uint64_t ask_seq, uint32_t volume) {
+    change_cause_ = LevelChangeCause::Trade;
     bool b = update_volume_internal(bid_seq, volume);
     bool a = update_volume_internal(ask_seq, volume);
     return b && a;
 }
 
 bool FastOrderBook::cancel_order(uint64_t seq, uint32_t cancel_volume) {
+    change_cause_ = LevelChangeCause::Cancel;
     return update_volume_internal(seq, cancel_volume);
 }
 
 // 内部核心逻辑
 bool FastOrderBook::update_volume_internal(uint64_t seq, uint32_t delta_vol) {
-    // 1. 查找订单 (O(1) Hash Map)
-    auto it = order_index_.find(seq);
-    if (it == order_index_.end()) return false;
+    // 1. 查找订单 (O(1) 开放寻址)，槽位 aux 直接给出所在档位，无需读节点价格
+    const OrderIndexMap::Slot* found = order_index_.find_slot(seq);
+    if (!found) return false;
 
-    int32_t node_idx = it->second;
-    OrderNode& node = pool_.get(node_idx);
+    int32_t node_idx = found->value;
+    int32_t lvl = static_cast<int32_t>(found->aux) - 1;   // -1: 市价单队列
+    OrderNode& node = pool_[node_idx];
+    Side side = node.side();
 
     // 2. 扣减量
-    if (node.volume < delta_vol) {
+    const uint32_t old_volume = node.volume();
+    uint32_t volume = old_volume;
+    if (volume < delta_vol) {
          // 异常情况：成交量大于剩余量
          LOG_M_ERROR("Volume underflow! seq={}, node.volume={}, delta_vol={}, price={}, side={}",
-             seq, node.volume, delta_vol, node.sort_price, static_cast<int>(node.side));
-         node.volume = 0; 
+             seq, volume, delta_vol, level_price(lvl), static_cast<int>(side));
+         volume = 0;
     } else {
-        node.volume -= delta_vol;
+        volume -= delta_vol;
     }
+    node.set_volume(volume);
 
-    // 3. 更新 Level 总量 (仅限限价类订单)
-    bool is_limit_type = (node.type != OrderType::Market);
-    Level* lvl_ptr = nullptr;
+    // 3. 更新 Level 总量 (仅限挂在档位上的订单，按买卖方向更新对应的 volume)
+    if (lvl < 0) {
+        market_queue(side).volume -= old_volume - volume;
+    } else {
+        LevelRef level = level_ref(side, lvl);
+        if (level.volume) *level.volume -= delta_vol;
+        if (!tracked_queues_.empty()) {
+            if (QueueIndex* q = find_queue_index(side, lvl)) q->reduce(seq, old_volume - volume, volume == 0);
+        }
+    }
 
-    if (is_limit_type) {
-        // 直接通过 sort_price 定位 Level，无需搜索
-        lvl_ptr = get_level_ptr(node.sort_price);
-        if (lvl_ptr) {
-            // 根据买卖方向更新对应的 volume
-            if (node.side == Side::Buy) {
-                lvl_ptr->bid_volume -= delta_vol;
-            } else {
-                lvl_ptr->ask_volume -= delta_vol;
-            }
+    // 关注范围内的订单事件 (成交/撤单由写入口设置的变动原因区分)
+    if (order_sink_ && !order_watches_.empty() && order_watched(side, lvl)) {
+        OrderEventType type = OrderEventType::Cancelled;
+        if (change_cause_ == LevelChangeCause::Trade) {
+            type = volume > 0 ? OrderEventType::PartiallyFilled : OrderEventType::Filled;
         }
+        order_sink_->push_back(OrderEvent{seq, lvl >= 0 ? level_price(lvl) : 0u, old_volume - volume, volume, side, type});
     }
 
     // 4. 如果仍有剩余，处理结束
-    if (node.volume > 0) return true;
+    if (volume > 0) {
+        if (lvl >= 0) on_level_changed(side, lvl);
+        return true;
+    }
 
     // --- 订单完结 (Volume归零) ---
 
-    if (is_limit_type && lvl_ptr) {
-        // 从 Level 链表摘除
-        remove_node_from_level(*lvl_ptr, node_idx, node);
+    if (lvl >= 0) {
+        // 从 Level 链表摘除 (链表变空时同步清除位图/删除稀疏档位)
+        remove_node_from_level(lvl, node_idx, node);
 
         // 5. 关键：检查是否需要移动最优价游标
-        // 只有当删除的单子属于最优价档位，且该档位变空时才需要扫描
-        uint32_t lvl_idx = (node.sort_price - min_price_) / TICK_SIZE;
-
-        if (node.side == Side::Buy) {
-            if ((int32_t)lvl_idx == best_bid_idx_) {
-                // 检查该档位买单是否已空
-                if (lvl_ptr->bid_volume == 0) {
-                    update_best_bid_cursor(); // 触发线性扫描
-                }
+        // 只有当删除的单子属于最优价档位，且该档位变空时才需要移动
+        if (side == Side::Buy) {
+            if (lvl == best_bid_idx_ && level_head(Side::Buy, lvl) == -1) {
+                update_best_bid_cursor(); // 位图/稀疏层查找下一个非空档
             }
         } else {
-            if ((int32_t)lvl_idx == best_ask_idx_) {
-                // 检查该档位卖单是否已空
-                if (lvl_ptr->ask_volume == 0) {
-                    update_best_ask_cursor(); // 触发线性扫描
-                }
+            if (lvl == best_ask_idx_ && level_head(Side::Sell, lvl) == -1) {
+                update_best_ask_cursor(); // 位图/稀疏层查找下一个非空档
             }
         }
-    } 
-    else if (node.type == OrderType::Market) {
-        // 市价单移除逻辑：从 market_orders_ vector 中移除
-        auto it = std::find(market_orders_.begin(), market_orders_.end(), node_idx);
-        if (it != market_orders_.end()) {
-            // swap-and-pop 策略：O(1) 删除，不保持顺序
-            *it = market_orders_.back();
-            market_orders_.pop_back();
-        }
+
+        // 维护前 N 档深度缓存 (游标已更新)
+        on_level_changed(side, lvl);
+    }
+    else {
+        // 市价单 (含本方无挂单时转入市价队列的 Best 单)：从本方市价单链表摘除
+        remove_market_order(node);
     }
 
     // 6. 回收资源
-    order_index_.erase(it);
-    pool_.free(node_idx);
+    free_node(seq, node_idx, node);
 
     return true;
 }
 
 // 链表挂载 (O(1))
-void FastOrderBook::add_node_to_level(Level& lvl, int32_t node_idx, OrderNode& node) {
-    // 根据买卖方向选择不同链表
-    if (node.side == Side::Buy) {
-        // 更新买方统计
-        lvl.bid_volume += node.volume;
-
-        if (lvl.bid_head_idx == -1) {
-            // 链表为空，作为头节点
-            lvl.bid_head_idx = node_idx;
-            lvl.bid_tail_idx = node_idx;
-            node.prev_idx = -1;
-            node.next_idx = -1;
-        } else {
-            // 挂到尾部 (Tail)
-            int32_t old_tail_idx = lvl.bid_tail_idx;
-            OrderNode& old_tail = pool_.get(old_tail_idx);
+void FastOrderBook::add_node_to_level(int32_t tick, int32_t node_idx, OrderNode& node) {
+    Side side = node.side();
+    int32_t slot = window_slot(tick);
+
+    // 窗口内直接定位数组；窗口外在稀疏层取 (或新建) 档位
+    LevelRef lvl;
+    if (slot >= 0) {
+        lvl = level_ref(side, tick);
+    } else {
+        SparseLevel& sparse = sparse_side(side)[tick];
+        lvl = LevelRef{&sparse.volume, &sparse.head_idx, &sparse.tail_idx, &sparse.order_count};
+    }
 
-            old_tail.next_idx = node_idx;
-            node.prev_idx = old_tail_idx;
-            node.next_idx = -1;
-            lvl.bid_tail_idx = node_idx;
-        }
+    // 更新本方统计
+    *lvl.volume += node.volume();
+    ++*lvl.count;
+
+    if (*lvl.head == -1) {
+        // 链表为空，作为头节点
+        *lvl.head = node_idx;
+        *lvl.tail = node_idx;
+        node.prev_idx = -1;
+        node.next_idx = -1;
+        if (slot >= 0) (side == Side::Buy ? bid_bitmap_ : ask_bitmap_).set(static_cast<uint32_t>(slot));
     } else {
-        // 更新卖方统计
-        lvl.ask_volume += node.volume;
-
-        if (lvl.ask_head_idx == -1) {
-            // 链表为空，作为头节点
-            lvl.ask_head_idx = node_idx;
-            lvl.ask_tail_idx = node_idx;
-            node.prev_idx = -1;
-            node.next_idx = -1;
+        // 挂到尾部 (Tail)
+        int32_t old_tail_idx = *lvl.tail;
+        OrderNode& old_tail = pool_[old_tail_idx];
+
+        old_tail.next_idx = node_idx;
+        node.prev_idx = old_tail_idx;
+        node.next_idx = -1;
+        *lvl.tail = node_idx;
+    }
+}
+
+// 链表摘除 (O(1))
+void FastOrderBook::remove_node_from_level(int32_t tick, int32_t node_idx, const OrderNode& node) {
+    Side side = node.side();
+    LevelRef lvl = level_ref(side, tick);
+    if (!lvl.head) return;
+
+    // 1. 处理前驱
+    if (node.prev_idx != -1) {
+        pool_[node.prev_idx].next_idx = node.next_idx;
+    } else {
+        // 是头节点
+        *lvl.head = node.next_idx;
+    }
+
+    // 2. 处理后继
+    if (node.next_idx != -1) {
+        pool_[node.next_idx].prev_idx = node.prev_idx;
+    } else {
+        // 是尾节点
+        *lvl.tail = node.prev_idx;
+    }
+    --*lvl.count;
+
+    if (*lvl.head == -1) {
+        int32_t slot = window_slot(tick);
+        if (slot >= 0) {
+            (side == Side::Buy ? bid_bitmap_ : ask_bitmap_).clear(static_cast<uint32_t>(slot));
         } else {
-            // 挂到尾部 (Tail)
-            int32_t old_tail_idx = lvl.ask_tail_idx;
-            OrderNode& old_tail = pool_.get(old_tail_idx);
+            sparse_side(side).erase(tick);
+        }
+    }
+    // volume 已经在外面减过了，这里只负责链表结构
+}
 
-            old_tail.next_idx = node_idx;
-            node.prev_idx = old_tail_idx;
-            node.next_idx = -1;
-            lvl.ask_tail_idx = node_idx;
+// ==========================================
+// 市价单队列 (侵入式双向链表)
+// ==========================================
+void FastOrderBook::push_market_order(int32_t node_idx, OrderNode& node) {
+    MarketQueue& q = market_queue(node.side());
+    node.prev_idx = q.tail_idx;
+    node.next_idx = -1;
+    if (q.tail_idx == -1) q.head_idx = node_idx;
+    else pool_[q.tail_idx].next_idx = node_idx;
+    q.tail_idx = node_idx;
+    q.volume += node.volume();
+    ++q.count;
+}
+
+void FastOrderBook::remove_market_order(const OrderNode& node) {
+    MarketQueue& q = market_queue(node.side());
+    if (node.prev_idx != -1) pool_[node.prev_idx].next_idx = node.next_idx;
+    else q.head_idx = node.next_idx;
+    if (node.next_idx != -1) pool_[node.next_idx].prev_idx = node.prev_idx;
+    else q.tail_idx = node.prev_idx;
+    --q.count;
+    // volume 已经在外面减过了
+}
+
+// ==========================================
+// 订单事件关注登记
+// ==========================================
+bool FastOrderBook::watch_orders(Side side, uint32_t price) {
+    int32_t tick = price_to_level(price);
+    if (tick < 0) return false;
+    add_watch(side, tick);
+    return true;
+}
+
+void FastOrderBook::unwatch_orders(Side side, uint32_t price) {
+    int32_t tick = price_to_level(price);
+    if (tick >= 0) remove_watch(side, tick);
+}
+
+void FastOrderBook::watch_side(Side side) {
+    add_watch(side, -1);
+}
+
+void FastOrderBook::unwatch_side(Side side) {
+    remove_watch(side, -1);
+}
+
+bool FastOrderBook::orders_watched(Side side, uint32_t price) const {
+    int32_t tick = price_to_level(price);
+    return tick >= 0 && order_watched(side, tick);
+}
+
+void FastOrderBook::add_watch(Side side, int32_t tick) {
+    for (OrderWatch& w : order_watches_) {
+        if (w.side == side && w.tick == tick) {
+            ++w.refs;
+            return;
         }
     }
+    order_watches_.push_back(OrderWatch{side, tick, 1});
 }
 
-// 链表摘除 (O(1))
-void FastOrderBook::remove_node_from_level(Level& lvl, int32_t node_idx, const OrderNode& node) {
-    // 根据买卖方向选择不同链表
-    if (node.side == Side::Buy) {
-        // 1. 处理前驱
-        if (node.prev_idx != -1) {
-            pool_.get(node.prev_idx).next_idx = node.next_idx;
-        } else {
-            // 是头节点
-            lvl.bid_head_idx = node.next_idx;
+void FastOrderBook::remove_watch(Side side, int32_t tick) {
+    for (auto it = order_watches_.begin(); it != order_watches_.end(); ++it) {
+        if (it->side == side && it->tick == tick) {
+            if (--it->refs == 0) order_watches_.erase(it);
+            return;
         }
+    }
+}
 
-        // 2. 处理后继
-        if (node.next_idx != -1) {
-            pool_.get(node.next_idx).prev_idx = node.prev_idx;
-        } else {
-            // 是尾节点
-            lvl.bid_tail_idx = node.prev_idx;
+// ==========================================
+// 排队位置索引
+// ==========================================
+bool FastOrderBook::track_queue(Side side, uint32_t price) {
+    int32_t tick = price_to_level(price);
+    if (tick < 0) return false;
+    if (find_queue_index(side, tick)) return true;
+    tracked_queues_.push_back(TrackedQueue{side, tick, QueueIndex()});
+    rebuild_queue_index(tracked_queues_.back());
+    return true;
+}
+
+void FastOrderBook::untrack_queue(Side side, uint32_t price) {
+    int32_t tick = price_to_level(price);
+    for (auto it = tracked_queues_.begin(); it != tracked_queues_.end(); ++it) {
+        if (it->side == side && it->tick == tick) {
+            tracked_queues_.erase(it);
+            return;
         }
+    }
+}
+
+bool FastOrderBook::queue_tracked(Side side, uint32_t price) const {
+    int32_t tick = price_to_level(price);
+    return tick >= 0 && find_queue_index(side, tick) != nullptr;
+}
+
+QueueIndex* FastOrderBook::find_queue_index(Side side, int32_t tick) {
+    for (TrackedQueue& q : tracked_queues_) {
+        if (q.side == side && q.tick == tick) return &q.index;
+    }
+    return nullptr;
+}
+
+const QueueIndex* FastOrderBook::find_queue_index(Side side, int32_t tick) const {
+    for (const TrackedQueue& q : tracked_queues_) {
+        if (q.side == side && q.tick == tick) return &q.index;
+    }
+    return nullptr;
+}
+
+void FastOrderBook::rebuild_queue_index(TrackedQueue& q) {
+    // 按链表 (时间优先) 顺序重新分配紧凑位置，预留一倍余量
+    uint32_t count = 0;
+    for (int32_t idx = level_head(q.side, q.tick); idx != -1; idx = pool_[idx].next_idx) ++count;
+    q.index.reset(count * 2);
+    for (int32_t idx = level_head(q.side, q.tick); idx != -1; idx = pool_[idx].next_idx) {
+        const OrderNode& node = pool_[idx];
+        q.index.append(node_seq(idx, node), node.volume());
+    }
+}
+
+std::optional<FastOrderBook::QueuePosition> FastOrderBook::queue_position(uint64_t seq) const {
+    const OrderIndexMap::Slot* found = order_index_.find_slot(seq);
+    if (!found || found->aux == 0) return std::nullopt;
+
+    int32_t tick = static_cast<int32_t>(found->aux) - 1;
+    const OrderNode& target = pool_[found->value];
+    Side side = target.side();
+    uint64_t level_total = level_volume(side, tick);
+
+    QueuePosition result{0, 0, 0};
+    if (const QueueIndex* q = find_queue_index(side, tick)) {
+        int32_t pos = q->position_of(seq);
+        if (pos < 0) return std::nullopt;
+        result.orders_ahead = q->count_before(static_cast<uint32_t>(pos));
+        result.volume_ahead = q->volume_before(static_cast<uint32_t>(pos));
     } else {
-        // 1. 处理前驱
-        if (node.prev_idx != -1) {
-            pool_.get(node.prev_idx).next_idx = node.next_idx;
-        } else {
-            // 是头节点
-            lvl.ask_head_idx = node.next_idx;
+        // 未开启索引：从队头遍历到该订单
+        for (int32_t idx = level_head(side, tick); idx != found->value; idx = pool_[idx].next_idx) {
+            if (idx == -1) return std::nullopt;
+            result.volume_ahead += pool_[idx].volume();
+            ++result.orders_ahead;
         }
+    }
+    result.volume_behind = level_total - result.volume_ahead - target.volume();
+    return result;
+}
 
-        // 2. 处理后继
-        if (node.next_idx != -1) {
-            pool_.get(node.next_idx).prev_idx = node.prev_idx;
-        } else {
-            // 是尾节点
-            lvl.ask_tail_idx = node.prev_idx;
-        }
+uint64_t FastOrderBook::queue_volume_of_first(Side side, uint32_t price, uint32_t k) const {
+    int32_t tick = price_to_level(price);
+    if (tick < 0) return 0;
+    if (const QueueIndex* q = find_queue_index(side, tick)) return q->volume_of_first(k);
+
+    uint64_t total = 0;
+    for (int32_t idx = level_head(side, tick); idx != -1 && k > 0; idx = pool_[idx].next_idx, --k) {
+        total += pool_[idx].volume();
     }
-    // volume 已经在外面减过了，这里只负责链表结构
+    return total;
 }
 
-// 游标更新 (线性扫描 Linear Scan)
-void FastOrderBook::update_best_bid_cursor() {
-    // 只有当 best_bid_idx 指向的 Level 的买单空了才调用这里
-    // 买盘：价格从高向低扫
-    while (best_bid_idx_ >= 0) {
-        const Level& lvl = levels_[best_bid_idx_];
-        // 检查该档位是否有买单
-        if (lvl.bid_volume > 0) {
-            return; // 找到了新的支撑位
+// ==========================================
+// 档位存储 (密集窗口 + 稀疏层)
+// ==========================================
+FastOrderBook::LevelRef FastOrderBook::level_ref(Side side, int32_t tick) {
+    int32_t slot = window_slot(tick);
+    if (slot >= 0) {
+        LevelLinks& links = level_links_[slot];
+        if (side == Side::Buy) {
+            return LevelRef{&bid_volume_[slot], &links.bid_head_idx, &links.bid_tail_idx, &links.bid_count};
         }
-        best_bid_idx_--;
+        return LevelRef{&ask_volume_[slot], &links.ask_head_idx, &links.ask_tail_idx, &links.ask_count};
     }
-    // 如果循环结束，best_bid_idx_ 为 -1，表示买盘空了
+    auto& sparse = sparse_side(side);
+    auto it = sparse.find(tick);
+    if (it == sparse.end()) return LevelRef{nullptr, nullptr, nullptr, nullptr};
+    return LevelRef{&it->second.volume, &it->second.head_idx, &it->second.tail_idx, &it->second.order_count};
 }
 
-void FastOrderBook::update_best_ask_cursor() {
-    // 卖盘：价格从低向高扫
-    // 注意边界检查
-    int32_t max_idx = (int32_t)levels_.size() - 1;
-    while (best_ask_idx_ <= max_idx && best_ask_idx_ != -1) {
-        const Level& lvl = levels_[best_ask_idx_];
-        // 检查该档位是否有卖单
-        if (lvl.ask_volume > 0) {
-            return; // 找到了新的压力位
+uint64_t FastOrderBook::level_volume(Side side, int32_t tick) const {
+    int32_t slot = window_slot(tick);
+    if (slot >= 0) return side == Side::Buy ? bid_volume_[slot] : ask_volume_[slot];
+    const auto& sparse = sparse_side(side);
+    auto it = sparse.find(tick);
+    return it == sparse.end() ? 0 : it->second.volume;
+}
+
+uint32_t FastOrderBook::level_order_count(Side side, int32_t tick) const {
+    int32_t slot = window_slot(tick);
+    if (slot >= 0) return side == Side::Buy ? level_links_[slot].bid_count : level_links_[slot].ask_count;
+    const auto& sparse = sparse_side(side);
+    auto it = sparse.find(tick);
+    return it == sparse.end() ? 0 : it->second.order_count;
+}
+
+int32_t FastOrderBook::level_head(Side side, int32_t tick) const {
+    int32_t slot = window_slot(tick);
+    if (slot >= 0) {
+        return side == Side::Buy ? level_links_[slot].bid_head_idx : level_links_[slot].ask_head_idx;
+    }
+    const auto& sparse = sparse_side(side);
+    auto it = sparse.find(tick);
+    return it == sparse.end() ? -1 : it->second.head_idx;
+}
+
+// 稀疏层的档位都在窗口外，按 "窗口下方稀疏层 -> 窗口位图 -> 窗口上方稀疏层" 的顺序查找
+int32_t FastOrderBook::next_level(Side side, int32_t from) const {
+    const auto& sparse = sparse_side(side);
+    const LevelBitmap& bitmap = (side == Side::Buy) ? bid_bitmap_ : ask_bitmap_;
+    const int32_t win_hi = win_lo_ + static_cast<int32_t>(win_size_);
+
+    if (from < win_lo_) {
+        auto it = sparse.lower_bound(from);
+        if (it != sparse.end() && it->first < win_lo_) return it->first;
+        from = win_lo_;
+    }
+    if (from < win_hi) {
+        int32_t slot = bitmap.find_next(static_cast<uint32_t>(from - win_lo_));
+        if (slot >= 0) return win_lo_ + slot;
+        from = win_hi;
+    }
+    auto it = sparse.lower_bound(from);
+    return it == sparse.end() ? -1 : it->first;
+}
+
+int32_t FastOrderBook::prev_level(Side side, int32_t from) const {
+    if (from < 0) return -1;
+    const auto& sparse = sparse_side(side);
+    const LevelBitmap& bitmap = (side == Side::Buy) ? bid_bitmap_ : ask_bitmap_;
+    const int32_t win_hi = win_lo_ + static_cast<int32_t>(win_size_);
+
+    if (from >= win_hi) {
+        auto it = sparse.upper_bound(from);
+        if (it != sparse.begin() && (--it)->first >= win_hi) return it->first;
+        from = win_hi - 1;
+    }
+    if (from >= win_lo_) {
+        int32_t slot = bitmap.find_prev(static_cast<uint32_t>(from - win_lo_));
+        if (slot >= 0) return win_lo_ + slot;
+        from = win_lo_ - 1;
+    }
+    auto it = sparse.upper_bound(from);
+    if (it == sparse.begin()) return -1;
+    return (--it)->first;
+}
+
+uint64_t FastOrderBook::range_volume(Side side, int32_t from, int32_t to) const {
+    uint64_t total = 0;
+    // 窗口部分 SIMD 连续数组扫描
+    int32_t lo = std::max(from, win_lo_);
+    int32_t hi = std::min(to, win_lo_ + static_cast<int32_t>(win_size_) - 1);
+    if (lo <= hi) {
+        const uint64_t* volume = (side == Side::Buy) ? bid_volume_.data() : ask_volume_.data();
+        total += depth_kernels::range_sum(volume, static_cast<size_t>(lo - win_lo_), static_cast<size_t>(hi - win_lo_ + 1));
+    }
+    // 稀疏层 (均在窗口外)
+    const auto& sparse = sparse_side(side);
+    for (auto it = sparse.lower_bound(from); it != sparse.end() && it->first <= to; ++it) {
+        total += it->second.volume;
+    }
+    return total;
+}
+
+void FastOrderBook::maybe_recenter() {
+    if (fixed_window_) return;
+
+    // 参考价：买卖中间价 (单边时取该边最优价)
+    int32_t ref;
+    if (best_bid_idx_ >= 0 && best_ask_idx_ >= 0) {
+        ref = best_bid_idx_ + (best_ask_idx_ - best_bid_idx_) / 2;
+    } else if (best_bid_idx_ >= 0) {
+        ref = best_bid_idx_;
+    } else if (best_ask_idx_ >= 0) {
+        ref = best_ask_idx_;
+    } else {
+        return;
+    }
+
+    // 参考价仍在窗口中部 [1/4, 3/4) 时不动，避免价格在边界附近来回时反复迁移
+    uint32_t offset = static_cast<uint32_t>(ref - win_lo_);
+    if (win_size_ > 0 && offset >= win_size_ / 4 && offset < win_size_ / 4 * 3) return;
+    recenter(ref);
+}
+
+void FastOrderBook::recenter(int32_t center) {
+    const uint32_t size = DENSE_WINDOW_LEVELS;
+
+    // 有涨跌停时窗口不越出区间
+    int64_t lo = static_cast<int64_t>(center) - size / 2;
+    int64_t max_lo = static_cast<int64_t>(tick_div_.divide(max_price_)) - size + 1;
+    if (lo > max_lo) lo = max_lo;
+    int64_t min_lo = price_to_level(min_price_);
+    if (lo < min_lo) lo = min_lo;
+    const int32_t new_lo = static_cast<int32_t>(lo);
+    if (win_size_ == size && new_lo == win_lo_) return;
+
+    std::vector<uint64_t> bid_volume(size, 0);
+    std::vector<uint64_t> ask_volume(size, 0);
+    std::vector<LevelLinks> links(size, LevelLinks{-1, -1, -1, -1, 0, 0});
+    LevelBitmap bid_bitmap(size);
+    LevelBitmap ask_bitmap(size);
+
+    auto migrate = [&](const LevelBitmap& old_bitmap, const std::vector<uint64_t>& old_volume,
+                       std::vector<uint64_t>& new_volume, LevelBitmap& new_bitmap,
+                       int32_t LevelLinks::*head, int32_t LevelLinks::*tail, uint32_t LevelLinks::*count,
+                       std::map<int32_t, SparseLevel>& sparse) {
+        // 1. 旧窗口中的非空档位：仍在新窗口内的搬到新数组，其余下沉到稀疏层
+        for (int32_t s = old_bitmap.find_next(0); s >= 0; s = old_bitmap.find_next(static_cast<uint32_t>(s) + 1)) {
+            int32_t tick = win_lo_ + s;
+            const LevelLinks& old_links = level_links_[s];
+            uint32_t d = static_cast<uint32_t>(tick - new_lo);
+            if (d < size) {
+                new_volume[d] = old_volume[s];
+                links[d].*head = old_links.*head;
+                links[d].*tail = old_links.*tail;
+                links[d].*count = old_links.*count;
+                new_bitmap.set(d);
+            } else {
+                sparse[tick] = SparseLevel{old_volume[s], old_links.*head, old_links.*tail, old_links.*count};
+            }
         }
-        best_ask_idx_++;
+        // 2. 稀疏层中落入新窗口的档位上浮到新数组
+        for (auto it = sparse.lower_bound(new_lo);
+             it != sparse.end() && static_cast<uint32_t>(it->first - new_lo) < size; it = sparse.erase(it)) {
+            uint32_t d = static_cast<uint32_t>(it->first - new_lo);
+            new_volume[d] = it->second.volume;
+            links[d].*head = it->second.head_idx;
+            links[d].*tail = it->second.tail_idx;
+            links[d].*count = it->second.order_count;
+            new_bitmap.set(d);
+        }
+    };
+    migrate(bid_bitmap_, bid_volume_, bid_volume, bid_bitmap,
+            &LevelLinks::bid_head_idx, &LevelLinks::bid_tail_idx, &LevelLinks::bid_count, sparse_bids_);
+    migrate(ask_bitmap_, ask_volume_, ask_volume, ask_bitmap,
+            &LevelLinks::ask_head_idx, &LevelLinks::ask_tail_idx, &LevelLinks::ask_count, sparse_asks_);
+
+    if (win_size_ > 0) ++recenter_count_;
+    win_lo_ = new_lo;
+    win_size_ = size;
+    bid_volume_.swap(bid_volume);
+    ask_volume_.swap(ask_volume);
+    level_links_.swap(links);
+    bid_bitmap_ = std::move(bid_bitmap);
+    ask_bitmap_ = std::move(ask_bitmap);
+}
+
+// ==========================================
+// 节点整理 (Compaction)
+// ==========================================
+size_t FastOrderBook::compact() {
+    // 在新 Arena 中按 "买一向下、卖一向上、市价单队列" 的顺序重新分配节点，
+    // 同一档位的队列落在连续下标上；旧 slab 在全部搬完后一次性归还
+    auto for_each_queue = [&](auto&& fn) {
+        // 稀疏层 std::map 节点地址稳定，可直接改写其链表头尾
+        for (int32_t lvl = best_bid_idx_; lvl >= 0; lvl = prev_level(Side::Buy, lvl - 1)) {
+            LevelRef level = level_ref(Side::Buy, lvl);
+            fn(*level.head, *level.tail);
+        }
+        for (int32_t lvl = best_ask_idx_; lvl >= 0; lvl = next_level(Side::Sell, lvl + 1)) {
+            LevelRef level = level_ref(Side::Sell, lvl);
+            fn(*level.head, *level.tail);
+        }
+        fn(market_bids_.head_idx, market_bids_.tail_idx);
+        fn(market_asks_.head_idx, market_asks_.tail_idx);
+    };
+
+    // 先按存活节点数一次性预留新 slab：池无法满足时放弃整理，订单簿保持原样 (全有或全无)
+    size_t live = 0;
+    for_each_queue([&](int32_t& head, int32_t&) {
+        for (int32_t idx = head; idx != -1; idx = pool_[idx].next_idx) ++live;
+    });
+    ObjectPool<OrderNode>::Arena fresh;
+    if (!pool_.reserve(fresh, live)) {
+        LOG_M_ERROR("Memory pool exhausted, compaction skipped: live_nodes={}", live);
+        return 0;
     }
-    // 如果超界，表示卖盘空了
-    if (best_ask_idx_ > max_idx) best_ask_idx_ = -1;
+    size_t moved = 0;
+
+    // 搬移单个节点，索引槽位中的档位 (aux) 不变，只更新节点下标 (已预留，分配不会失败)
+    auto move_node = [&](int32_t old_idx) {
+        const OrderNode& old_node = pool_[old_idx];
+        uint64_t seq = node_seq(old_idx, old_node);
+        int32_t n = pool_.alloc(fresh);
+        assert(n >= 0);
+        pool_[n] = old_node;
+        if (old_node.seq_delta == OrderNode::WIDE_SEQ) {
+            wide_seqs_.erase(old_idx);
+            wide_seqs_[n] = seq;
+        }
+        *order_index_.find(seq) = n;
+        ++moved;
+        return n;
+    };
+
+    for_each_queue([&](int32_t& head, int32_t& tail) {
+        int32_t prev_new = -1;
+        for (int32_t idx = head; idx != -1; ) {
+            int32_t next_old = pool_[idx].next_idx;
+            int32_t n = move_node(idx);
+            OrderNode& node = pool_[n];
+            node.prev_idx = prev_new;
+            node.next_idx = -1;
+            if (prev_new == -1) head = n;
+            else pool_[prev_new].next_idx = n;
+            prev_new = n;
+            idx = next_old;
+        }
+        tail = prev_new;
+    });
+
+    pool_.release(arena_);
+    arena_ = std::move(fresh);
+    return moved;
+}
+
+// 游标更新 (位图查找 Bitmap Scan)
+void FastOrderBook::update_best_bid_cursor() {
+    // 只有当 best_bid_idx 指向的 Level 的买单空了才调用这里
+    // 买盘：价格从高向低找第一个非空档，找不到返回 -1 表示买盘空了
+    if (best_bid_idx_ < 0) return;
+    best_bid_idx_ = prev_level(Side::Buy, best_bid_idx_);
+    maybe_recenter();
+}
+
+void FastOrderBook::update_best_ask_cursor() {
+    // 卖盘：价格从低向高找第一个非空档，找不到返回 -1 表示卖盘空了
+    if (best_ask_idx_ < 0) return;
+    best_ask_idx_ = next_level(Side::Sell, best_ask_idx_);
+    maybe_recenter();
 }
 
 // 获取最优买价
 std::optional<uint32_t> FastOrderBook::get_best_bid() const {
     if (best_bid_idx_ == -1) return std::nullopt;
-    return min_price_ + best_bid_idx_ * TICK_SIZE;
+    return level_price(best_bid_idx_);
 }
 
 // 获取最优卖价
 std::optional<uint32_t> FastOrderBook::get_best_ask() const {
     if (best_ask_idx_ == -1) return std::nullopt;
-    return min_price_ + best_ask_idx_ * TICK_SIZE;
+    return level_price(best_ask_idx_);
 }
 
-// 获取某价格档位挂单量 (O(1) Array Access)
+// 获取某价格档位挂单量 (窗口内 O(1) Array Access)
 // 返回买卖总量
 uint64_t FastOrderBook::get_volume_at_price(uint32_t price) const {
-    if (price < min_price_ || price > min_price_ + (levels_.size() - 1) * TICK_SIZE) return 0;
-    const Level& lvl = levels_[(price - min_price_) / TICK_SIZE];
-    return lvl.bid_volume + lvl.ask_volume;
+    int32_t lvl = price_to_level(price);
+    if (lvl < 0) return 0;
+    return level_volume(Side::Buy, lvl) + level_volume(Side::Sell, lvl);
 }
 
 // 获取某价格档位的买方挂单量
 uint64_t FastOrderBook::get_bid_volume_at_price(uint32_t price) const {
-    if (price < min_price_ || price > min_price_ + (levels_.size() - 1) * TICK_SIZE) return 0;
-    return levels_[(price - min_price_) / TICK_SIZE].bid_volume;
+    int32_t lvl = price_to_level(price);
+    return lvl < 0 ? 0 : level_volume(Side::Buy, lvl);
 }
 
 // 获取某价格档位的卖方挂单量
 uint64_t FastOrderBook::get_ask_volume_at_price(uint32_t price) const {
-    if (price < min_price_ || price > min_price_ + (levels_.size() - 1) * TICK_SIZE) return 0;
-    return levels_[(price - min_price_) / TICK_SIZE].ask_volume;
+    int32_t lvl = price_to_level(price);
+    return lvl < 0 ? 0 : level_volume(Side::Sell, lvl);
+}
+
+// 获取某价格档位的挂单笔数
+uint32_t FastOrderBook::get_bid_order_count_at_price(uint32_t price) const {
+    int32_t lvl = price_to_level(price);
+    return lvl < 0 ? 0 : level_order_count(Side::Buy, lvl);
 }
 
-// 区间总量查询 (SIMD 友好的内存连续扫描)
+uint32_t FastOrderBook::get_ask_order_count_at_price(uint32_t price) const {
+    int32_t lvl = price_to_level(price);
+    return lvl < 0 ? 0 : level_order_count(Side::Sell, lvl);
+}
+
+// 区间总量查询 (窗口内 SIMD 连续数组扫描，窗口外遍历稀疏层)
 // 只统计卖方挂单量
 uint64_t FastOrderBook::get_ask_volume_in_range(uint32_t start_price, uint32_t end_price) const {
     // 简单的边界裁剪
-    uint32_t max_price = min_price_ + (levels_.size() - 1) * TICK_SIZE;
     if (start_price < min_price_) start_price = min_price_;
-    if (end_price > max_price) end_price = max_price;
+    if (end_price > max_price_) end_price = max_price_;
 
     if (start_price > end_price) return 0;
 
-    uint32_t start_idx = (start_price - min_price_) / TICK_SIZE;
-    uint32_t end_idx = (end_price - min_price_) / TICK_SIZE;
+    return range_volume(Side::Sell, price_to_level(start_price), price_to_level(end_price));
+}
 
-    uint64_t total = 0;
+// 只统计买方挂单量
+uint64_t FastOrderBook::get_bid_volume_in_range(uint32_t start_price, uint32_t end_price) const {
+    if (start_price < min_price_) start_price = min_price_;
+    if (end_price > max_price_) end_price = max_price_;
 
-    // 这是一个极度紧凑的循环
-    // 编译器会自动进行循环展开 (Loop Unrolling) 和 SIMD 优化
-    for (uint32_t i = start_idx; i <= end_idx; ++i) {
-        total += levels_[i].ask_volume;
-    }
+    if (start_price > end_price) return 0;
 
-    return total;
+    return range_volume(Side::Buy, price_to_level(start_price), price_to_level(end_price));
 }
 
-// 获取买盘前N档 (价格从高到低)
-std::vector<std::pair<uint32_t, uint64_t>> FastOrderBook::get_bid_levels(int n) const {
-    std::vector<std::pair<uint32_t, uint64_t>> result;
-    result.reserve(n);
+// ==========================================
+// 分价成交量查询
+// ==========================================
+TradeProfile::Stats FastOrderBook::get_traded_at_price(uint32_t price) const {
+    int32_t tick = price_to_level(price);
+    return tick >= 0 ? trades_.at(tick) : TradeProfile::Stats{};
+}
+
+TradeProfile::Stats FastOrderBook::get_traded_in_range(uint32_t start_price, uint32_t end_price) const {
+    if (start_price < min_price_) start_price = min_price_;
+    if (end_price > max_price_) end_price = max_price_;
+
+    if (start_price > end_price) return TradeProfile::Stats{};
+
+    return trades_.range(price_to_level(start_price), price_to_level(end_price));
+}
+
+std::optional<double> FastOrderBook::get_vwap(uint32_t start_price, uint32_t end_price) const {
+    if (start_price < min_price_) start_price = min_price_;
+    if (end_price > max_price_) end_price = max_price_;
 
-    // 从 best_bid_idx_ 开始向下扫描
-    int32_t idx = best_bid_idx_;
-    while (idx >= 0 && (int)result.size() < n) {
-        const Level& lvl = levels_[idx];
-        // 检查该档位是否有买单
-        if (lvl.bid_volume > 0) {
-            result.emplace_back(min_price_ + idx * TICK_SIZE, lvl.bid_volume);
+    if (start_price > end_price) return std::nullopt;
+
+    std::optional<double> tick = trades_.vwap_tick(price_to_level(start_price), price_to_level(end_price));
+    if (!tick) return std::nullopt;
+    return *tick * tick_size_;
+}
+
+// 累计深度查询：卖一向上扫描到累计量 >= target_volume
+// 顺序：窗口下方稀疏层 -> 窗口 (SIMD) -> 窗口上方稀疏层
+std::optional<uint32_t> FastOrderBook::get_ask_price_for_volume(uint64_t target_volume, uint64_t* cumulative) const {
+    uint64_t acc = 0;
+    int64_t idx = -1;
+    if (best_ask_idx_ >= 0) {
+        const int32_t win_hi = win_lo_ + static_cast<int32_t>(win_size_);
+        auto it = sparse_asks_.lower_bound(best_ask_idx_);
+        for (; it != sparse_asks_.end() && it->first < win_lo_ && idx < 0; ++it) {
+            acc += it->second.volume;
+            if (acc >= target_volume) idx = it->first;
+        }
+        if (idx < 0 && best_ask_idx_ < win_hi) {
+            int32_t from = std::max(best_ask_idx_, win_lo_) - win_lo_;
+            int64_t slot = depth_kernels::find_cumulative_ge(ask_volume_.data(), from, win_size_, target_volume, acc);
+            if (slot >= 0) idx = win_lo_ + slot;
+        }
+        for (it = sparse_asks_.lower_bound(std::max(best_ask_idx_, win_hi)); it != sparse_asks_.end() && idx < 0; ++it) {
+            acc += it->second.volume;
+            if (acc >= target_volume) idx = it->first;
+        }
+    }
+    if (cumulative) *cumulative = acc;
+    if (idx < 0) return std::nullopt;
+    return level_price(static_cast<int32_t>(idx));
+}
+
+// 累计深度查询：买一向下扫描到累计量 >= target_volume
+// 顺序：窗口上方稀疏层 -> 窗口 (SIMD) -> 窗口下方稀疏层
+std::optional<uint32_t> FastOrderBook::get_bid_price_for_volume(uint64_t target_volume, uint64_t* cumulative) const {
+    uint64_t acc = 0;
+    int64_t idx = -1;
+    if (best_bid_idx_ >= 0) {
+        const int32_t win_hi = win_lo_ + static_cast<int32_t>(win_size_);
+        auto it = sparse_bids_.upper_bound(best_bid_idx_);
+        while (it != sparse_bids_.begin() && idx < 0) {
+            --it;
+            if (it->first < win_hi) break;
+            acc += it->second.volume;
+            if (acc >= target_volume) idx = it->first;
+        }
+        if (idx < 0 && best_bid_idx_ >= win_lo_) {
+            int32_t to = std::min(best_bid_idx_, win_hi - 1) - win_lo_ + 1;
+            int64_t slot = depth_kernels::rfind_cumulative_ge(bid_volume_.data(), 0, to, target_volume, acc);
+            if (slot >= 0) idx = win_lo_ + slot;
+        }
+        it = sparse_bids_.upper_bound(std::min(best_bid_idx_, win_lo_ - 1));
+        while (it != sparse_bids_.begin() && idx < 0) {
+            --it;
+            acc += it->second.volume;
+            if (acc >= target_volume) idx = it->first;
         }
-        idx--;
     }
+    if (cumulative) *cumulative = acc;
+    if (idx < 0) return std::nullopt;
+    return level_price(static_cast<int32_t>(idx));
+}
+
+// 获取买盘前N档 (价格从高到低)
+std::vector<PriceVolume> FastOrderBook::get_bid_levels(int n) const {
+    std::vector<PriceVolume> result;
+    if (n <= 0) return result;
+    result.resize(n);
+    result.resize(get_bid_levels(result.data(), n));
     return result;
 }
 
 // 获取卖盘前N档 (价格从低到高)
-std::vector<std::pair<uint32_t, uint64_t>> FastOrderBook::get_ask_levels(int n) const {
-    std::vector<std::pair<uint32_t, uint64_t>> result;
-    result.reserve(n);
+std::vector<PriceVolume> FastOrderBook::get_ask_levels(int n) const {
+    std::vector<PriceVolume> result;
+    if (n <= 0) return result;
+    result.resize(n);
+    result.resize(get_ask_levels(result.data(), n));
+    return result;
+}
+
+// 获取买盘前N档到定长数组 (零分配)
+int FastOrderBook::get_bid_levels(PriceVolume* out, int n) const {
+    if (depth_cache_enabled_ && n <= DEPTH_CACHE_LEVELS) {
+        int count = std::min(n, bid_cache_.count);
+        std::copy(bid_cache_.levels, bid_cache_.levels + count, out);
+        return count;
+    }
+
+    // 从 best_bid_idx_ 开始向下，只访问非空的档位 (窗口位图 + 稀疏层)
+    int count = 0;
+    for (int32_t idx = best_bid_idx_; idx >= 0 && count < n; idx = prev_level(Side::Buy, idx - 1)) {
+        uint64_t vol = level_volume(Side::Buy, idx);
+        if (vol > 0) out[count++] = PriceVolume(level_price(idx), vol);
+    }
+    return count;
+}
+
+// 获取卖盘前N档到定长数组 (零分配)
+int FastOrderBook::get_ask_levels(PriceVolume* out, int n) const {
+    if (depth_cache_enabled_ && n <= DEPTH_CACHE_LEVELS) {
+        int count = std::min(n, ask_cache_.count);
+        std::copy(ask_cache_.levels, ask_cache_.levels + count, out);
+        return count;
+    }
 
-    int32_t max_idx = (int32_t)levels_.size() - 1;
-    // 从 best_ask_idx_ 开始向上扫描
-    int32_t idx = best_ask_idx_;
-    while (idx >= 0 && idx <= max_idx && (int)result.size() < n) {
-        const Level& lvl = levels_[idx];
-        // 检查该档位是否有卖单
-        if (lvl.ask_volume > 0) {
-            result.emplace_back(min_price_ + idx * TICK_SIZE, lvl.ask_volume);
+    // 从 best_ask_idx_ 开始向上，只访问非空的档位 (窗口位图 + 稀疏层)
+    int count = 0;
+    for (int32_t idx = best_ask_idx_; idx >= 0 && count < n; idx = next_level(Side::Sell, idx + 1)) {
+        uint64_t vol = level_volume(Side::Sell, idx);
+        if (vol > 0) out[count++] = PriceVolume(level_price(idx), vol);
+    }
+    return count;
+}
+
+// 合成前 N 档快照：量取自深度缓存 (或位图扫描)，笔数按档位查询
+void FastOrderBook::build_l2_snapshot(L2Snapshot& out) const {
+    out.bid_count = get_bid_levels(out.bids, L2Snapshot::LEVELS);
+    out.ask_count = get_ask_levels(out.asks, L2Snapshot::LEVELS);
+    for (int i = 0; i < out.bid_count; ++i) {
+        out.bid_orders[i] = level_order_count(Side::Buy, price_to_level(out.bids[i].first));
+    }
+    for (int i = 0; i < out.ask_count; ++i) {
+        out.ask_orders[i] = level_order_count(Side::Sell, price_to_level(out.asks[i].first));
+    }
+    out.bid_version = bid_depth_version_;
+    out.ask_version = ask_depth_version_;
+}
+
+// ==========================================
+// 前 N 档深度缓存
+// ==========================================
+
+void FastOrderBook::enable_depth_cache(bool enable) {
+    depth_cache_enabled_ = enable;
+    bid_cache_.count = 0;
+    ask_cache_.count = 0;
+    if (enable) {
+        rebuild_bid_cache();
+        rebuild_ask_cache();
+    }
+    ++bid_depth_version_;
+    ++ask_depth_version_;
+}
+
+void FastOrderBook::rebuild_bid_cache() {
+    DepthCache& c = bid_cache_;
+    c.count = 0;
+    for (int32_t idx = best_bid_idx_; idx >= 0 && c.count < DepthCache::LEVELS; idx = prev_level(Side::Buy, idx - 1)) {
+        uint64_t vol = level_volume(Side::Buy, idx);
+        if (vol > 0) {
+            c.levels[c.count] = PriceVolume(level_price(idx), vol);
+            c.lvl_idx[c.count] = idx;
+            ++c.count;
         }
-        idx++;
     }
-    return result;
 }
 
-Level* FastOrderBook::get_level_ptr(uint32_t price) {
-    if (price < min_price_ || price > min_price_ + (levels_.size() - 1) * TICK_SIZE) return nullptr;
-    return &levels_[(price - min_price_) / TICK_SIZE];
+void FastOrderBook::rebuild_ask_cache() {
+    DepthCache& c = ask_cache_;
+    c.count = 0;
+    for (int32_t idx = best_ask_idx_; idx >= 0 && c.count < DepthCache::LEVELS; idx = next_level(Side::Sell, idx + 1)) {
+        uint64_t vol = level_volume(Side::Sell, idx);
+        if (vol > 0) {
+            c.levels[c.count] = PriceVolume(level_price(idx), vol);
+            c.lvl_idx[c.count] = idx;
+            ++c.count;
+        }
+    }
+}
+
+void FastOrderBook::on_level_changed(Side side, int32_t lvl) {
+    // 档位变动事件 (未挂接缓冲区时只多一次判空)
+    if (level_sink_) {
+        level_sink_->push_back(LevelChange{level_volume(side, lvl), level_price(lvl),
+                                           level_order_count(side, lvl), side, change_cause_});
+    }
+
+    update_depth_cache(side, lvl);
+
+    // 集合竞价累计量索引
+    if (auction_mode_) {
+        if (side == Side::Buy) auction_.set_bid(lvl, level_volume(Side::Buy, lvl));
+        else auction_.set_ask(lvl, level_volume(Side::Sell, lvl));
+    }
+
+    // 盘口流量指标 (依赖已更新的游标与深度缓存)
+    if (flow_enabled_) update_flow_metrics();
+}
+
+void FastOrderBook::update_depth_cache(Side side, int32_t lvl) {
+    if (side == Side::Buy) {
+        if (!depth_cache_enabled_) {
+            ++bid_depth_version_;
+            return;
+        }
+        DepthCache& c = bid_cache_;
+        // 缓存已满且变动档位低于第 N 档：前 N 档不受影响
+        if (c.count == DepthCache::LEVELS && lvl < c.lvl_idx[c.count - 1]) return;
+
+        ++bid_depth_version_;
+        uint64_t vol = level_volume(Side::Buy, lvl);
+        if (vol > 0) {
+            // 已缓存档位只是量变化：原地修改
+            for (int i = 0; i < c.count; ++i) {
+                if (c.lvl_idx[i] == lvl) {
+                    c.levels[i].second = vol;
+                    return;
+                }
+            }
+        }
+        // 档位新增或清空：重建
+        rebuild_bid_cache();
+    } else {
+        if (!depth_cache_enabled_) {
+            ++ask_depth_version_;
+            return;
+        }
+        DepthCache& c = ask_cache_;
+        // 缓存已满且变动档位高于第 N 档：前 N 档不受影响
+        if (c.count == DepthCache::LEVELS && lvl > c.lvl_idx[c.count - 1]) return;
+
+        ++ask_depth_version_;
+        uint64_t vol = level_volume(Side::Sell, lvl);
+        if (vol > 0) {
+            for (int i = 0; i < c.count; ++i) {
+                if (c.lvl_idx[i] == lvl) {
+                    c.levels[i].second = vol;
+                    return;
+                }
+            }
+        }
+        rebuild_ask_cache();
+    }
+}
+
+// ==========================================
+// 盘口流量指标 (不平衡度 / 微观价格 / OFI)
+// ==========================================
+void FastOrderBook::enable_flow_metrics(bool enable, uint32_t window_events) {
+    if (window_events == 0) window_events = 1;
+    // 已按相同窗口开启 (多个策略共用同一订单簿)：保留已累计的指标
+    if (enable && flow_enabled_ && window_events == flow_.ofi_window_events) return;
+
+    flow_enabled_ = enable;
+    flow_ = FlowMetrics{};
+    ofi_ring_.clear();
+    ofi_pos_ = 0;
+    if (!enable) return;
+
+    // 五档量取自深度缓存
+    if (!depth_cache_enabled_) enable_depth_cache(true);
+    ofi_ring_.assign(window_events, 0);
+    flow_.ofi_window_events = static_cast<uint32_t>(ofi_ring_.size());
+
+    // 以当前盘口为起点，不计入事件
+    flow_.bid_price = best_bid_idx_ >= 0 ? level_price(best_bid_idx_) : 0;
+    flow_.ask_price = best_ask_idx_ >= 0 ? level_price(best_ask_idx_) : 0;
+    flow_.bid_volume = best_bid_idx_ >= 0 ? level_volume(Side::Buy, best_bid_idx_) : 0;
+    flow_.ask_volume = best_ask_idx_ >= 0 ? level_volume(Side::Sell, best_ask_idx_) : 0;
+    flow_.bid_volume_l5 = top_volume(bid_cache_, FlowMetrics::DEEP_LEVELS);
+    flow_.ask_volume_l5 = top_volume(ask_cache_, FlowMetrics::DEEP_LEVELS);
+}
+
+uint64_t FastOrderBook::top_volume(const DepthCache& cache, int n) {
+    uint64_t total = 0;
+    for (int i = 0; i < n && i < cache.count; ++i) total += cache.levels[i].second;
+    return total;
+}
+
+void FastOrderBook::update_flow_metrics() {
+    flow_.bid_volume_l5 = top_volume(bid_cache_, FlowMetrics::DEEP_LEVELS);
+    flow_.ask_volume_l5 = top_volume(ask_cache_, FlowMetrics::DEEP_LEVELS);
+
+    // 一侧为空时按价格 0 (买) / 无穷大 (卖)、量 0 处理
+    const uint32_t bp = best_bid_idx_ >= 0 ? level_price(best_bid_idx_) : 0;
+    const uint32_t ap = best_ask_idx_ >= 0 ? level_price(best_ask_idx_) : 0;
+    const uint64_t bq = best_bid_idx_ >= 0 ? level_volume(Side::Buy, best_bid_idx_) : 0;
+    const uint64_t aq = best_ask_idx_ >= 0 ? level_volume(Side::Sell, best_ask_idx_) : 0;
+    if (bp == flow_.bid_price && bq == flow_.bid_volume && ap == flow_.ask_price && aq == flow_.ask_volume) {
+        return;   // 一档未变：不是 OFI 事件
+    }
+
+    // Cont-Kukanov-Stoikov OFI：
+    // e = q_b·1{P_b >= P_b'} - q_b'·1{P_b <= P_b'} - q_a·1{P_a <= P_a'} + q_a'·1{P_a >= P_a'}
+    const uint64_t ap_now = ap ? ap : UINT32_MAX + uint64_t{1};
+    const uint64_t ap_prev = flow_.ask_price ? flow_.ask_price : UINT32_MAX + uint64_t{1};
+    int64_t e = 0;
+    if (bp >= flow_.bid_price) e += static_cast<int64_t>(bq);
+    if (bp <= flow_.bid_price) e -= static_cast<int64_t>(flow_.bid_volume);
+    if (ap_now <= ap_prev) e -= static_cast<int64_t>(aq);
+    if (ap_now >= ap_prev) e += static_cast<int64_t>(flow_.ask_volume);
+
+    flow_.bid_price = bp;
+    flow_.ask_price = ap;
+    flow_.bid_volume = bq;
+    flow_.ask_volume = aq;
+    flow_.ofi_total += e;
+    flow_.ofi_window += e - ofi_ring_[ofi_pos_];
+    ofi_ring_[ofi_pos_] = e;
+    if (++ofi_pos_ == ofi_ring_.size()) ofi_pos_ = 0;
+    ++flow_.events;
+}
+
+// ==========================================
+// 跨线程一档快照
+// ==========================================
+void FastOrderBook::set_top_of_book(SeqlockTopOfBook* top) {
+    top_ = top;
+    if (top_) publish_top(last_applseqnum_);
+}
+
+void FastOrderBook::publish_top(int64_t applseqnum) {
+    last_applseqnum_ = applseqnum;
+    TopOfBook t;
+    if (best_bid_idx_ >= 0) {
+        t.bid_price = level_price(best_bid_idx_);
+        t.bid_volume = level_volume(Side::Buy, best_bid_idx_);
+    }
+    if (best_ask_idx_ >= 0) {
+        t.ask_price = level_price(best_ask_idx_);
+        t.ask_volume = level_volume(Side::Sell, best_ask_idx_);
+    }
+    t.last_price = last_trade_price_;
+    t.last_volume = last_trade_volume_;
+    t.applseqnum = applseqnum;
+    top_->publish(t);
+}
+
+// ==========================================
+// 主力资金流向
+// ==========================================
+void FastOrderBook::enable_money_flow(const MoneyFlowBuckets& buckets) {
+    flow_buckets_ = buckets;
+    money_flow_enabled_ = true;
+}
+
+uint64_t FastOrderBook::parent_volume(uint64_t seq, bool aggressor, uint64_t qty) {
+    if (const int32_t* original = orig_volumes_.find(seq)) return static_cast<uint64_t>(*original);
+    if (aggressor) {
+        // 不入簿的主动单 (上海)：同一主动单的成交连续到达，按已累计成交量计
+        if (seq != aggressor_seq_) {
+            aggressor_seq_ = seq;
+            aggressor_filled_ = 0;
+        }
+        aggressor_filled_ += qty;
+        return aggressor_filled_;
+    }
+    // 开启前已在簿的订单：以剩余量代替
+    if (const int32_t* idx = order_index_.find(seq)) return pool_[*idx].volume();
+    return qty;
+}
+
+void FastOrderBook::record_money_flow(const MDTransactionStruct& txn, bool buy_aggressor, bool sell_aggressor) {
+    if (txn.tradeprice <= 0 || txn.tradeqty <= 0) return;
+    const uint64_t price = static_cast<uint64_t>(txn.tradeprice);
+    const uint64_t qty = static_cast<uint64_t>(txn.tradeqty);
+    const uint64_t amount = price * qty;
+
+    int buy_bucket = flow_buckets_.classify(parent_volume(static_cast<uint64_t>(txn.tradebuyno), buy_aggressor, qty) * price);
+    int sell_bucket = flow_buckets_.classify(parent_volume(static_cast<uint64_t>(txn.tradesellno), sell_aggressor, qty) * price);
+    money_flow_.inflow[buy_bucket] += amount;
+    money_flow_.inflow_volume[buy_bucket] += qty;
+    money_flow_.outflow[sell_bucket] += amount;
+    money_flow_.outflow_volume[sell_bucket] += qty;
+    ++money_flow_.trades;
+}
+
+// ==========================================
+// 集合竞价虚拟撮合
+// ==========================================
+void FastOrderBook::set_auction_mode(bool enable, uint32_t reference_price) {
+    auction_mode_ = enable;
+    auction_ref_price_ = reference_price;
+    if (!enable) {
+        auction_.reset(0, 0);
+        return;
+    }
+
+    // 索引区间：涨跌停区间不超过 AUCTION_SPAN_LEVELS 档时覆盖整个区间；否则以参考价 (或当前盘口) 为中心
+    int32_t lo = price_to_level(min_price_);
+    int32_t hi = price_to_level(max_price_);
+    if (!price_limited() || static_cast<uint32_t>(hi - lo) >= AUCTION_SPAN_LEVELS) {
+        int32_t center = price_to_level(reference_price);
+        if (center < 0) {
+            if (best_bid_idx_ >= 0 && best_ask_idx_ >= 0) center = best_bid_idx_ + (best_ask_idx_ - best_bid_idx_) / 2;
+            else center = best_bid_idx_ >= 0 ? best_bid_idx_ : best_ask_idx_;
+        }
+        if (center < 0) center = price_to_level(min_price_) + AUCTION_SPAN_LEVELS / 2;
+        lo = std::max(lo, center - static_cast<int32_t>(AUCTION_SPAN_LEVELS / 2));
+        hi = std::min(hi, lo + static_cast<int32_t>(AUCTION_SPAN_LEVELS) - 1);
+    }
+    auction_.reset(lo, static_cast<uint32_t>(hi - lo + 1));
+
+    for (int32_t tick = next_level(Side::Buy, 0); tick >= 0; tick = next_level(Side::Buy, tick + 1)) {
+        auction_.set_bid(tick, level_volume(Side::Buy, tick));
+    }
+    for (int32_t tick = next_level(Side::Sell, 0); tick >= 0; tick = next_level(Side::Sell, tick + 1)) {
+        auction_.set_ask(tick, level_volume(Side::Sell, tick));
+    }
+}
+
+std::optional<FastOrderBook::AuctionState> FastOrderBook::get_auction_state() const {
+    AuctionIndex::Match match;
+    if (!auction_mode_ || !auction_.best_match(match)) return std::nullopt;
+
+    // 成交量相同的价格区间内选价：上海取中间价 (四舍五入到档位)，深圳取最接近参考价者
+    int32_t tick = match.lo_tick + (match.hi_tick - match.lo_tick + 1) / 2;
+    int32_t ref = price_to_level(auction_ref_price_);
+    if (exchange_ != Exchange::Shanghai && ref >= 0) {
+        tick = std::min(std::max(ref, match.lo_tick), match.hi_tick);
+    }
+
+    AuctionState state;
+    state.price = level_price(tick);
+    state.volume = match.volume;
+    state.bid_volume = auction_.demand(tick);
+    state.ask_volume = auction_.supply(tick);
+    state.imbalance = static_cast<int64_t>(state.bid_volume) - static_cast<int64_t>(state.ask_volume);
+    return state;
 }
 
 // 处理逐笔成交消息
 bool FastOrderBook::on_transaction(const MDTransactionStruct& txn) {
+    bool ok;
+    switch (exchange_) {
+        case Exchange::Shanghai: ok = on_transaction_as<ShanghaiPolicy>(txn); break;
+        case Exchange::Shenzhen: ok = on_transaction_as<ShenzhenPolicy>(txn); break;
+        default:                 ok = on_transaction_as<AutoPolicy>(txn); break;
+    }
+    if (top_) {
+        if (static_cast<TradeType>(txn.tradetype) == TradeType::Trade && txn.tradeprice > 0 && txn.tradeqty > 0) {
+            last_trade_price_ = static_cast<uint32_t>(txn.tradeprice);
+            last_trade_volume_ = static_cast<uint64_t>(txn.tradeqty);
+        }
+        publish_top(txn.applseqnum);
+    }
+    return ok;
+}
+
+template<typename Policy>
+bool FastOrderBook::on_transaction_as(const MDTransactionStruct& txn) {
     TradeType type = static_cast<TradeType>(txn.tradetype);
     TradeBSFlag bsflag = static_cast<TradeBSFlag>(txn.tradebsflag);
 
@@ -479,9 +1370,22 @@ bool FastOrderBook::on_transaction(const MDTransactionStruct& txn) {
     }
 
     // 成交逻辑 (tradetype == 0)
-    bool is_shenzhen = (txn.securityidsource == 102);
+    change_cause_ = LevelChangeCause::Trade;
+
+    // 分价成交量：按成交价与主动方累计 (不依赖双方委托是否在簿)
+    int32_t trade_tick = (txn.tradeprice > 0 && txn.tradeprice <= UINT32_MAX)
+                             ? price_to_level(static_cast<uint32_t>(txn.tradeprice)) : -1;
+    if (trade_tick >= 0) {
+        TradeProfile::Aggressor aggressor = bsflag == TradeBSFlag::Buy  ? TradeProfile::BUY
+                                          : bsflag == TradeBSFlag::Sell ? TradeProfile::SELL
+                                                                        : TradeProfile::UNKNOWN;
+        trades_.record(trade_tick, static_cast<uint64_t>(txn.tradeqty), aggressor);
+    }
+    if (money_flow_enabled_) {
+        record_money_flow(txn, bsflag == TradeBSFlag::Buy, bsflag == TradeBSFlag::Sell);
+    }
 
-    if (is_shenzhen) {
+    if (!Policy::passive_side_only(txn)) {
         // 深圳：更新双方订单
         return on_trade(txn.tradebuyno, txn.tradesellno, (uint32_t)txn.tradeqty);
     }
@@ -492,9 +1396,9 @@ bool FastOrderBook::on_transaction(const MDTransactionStruct& txn) {
     if (bsflag == TradeBSFlag::Buy) {
         // 买方主动成交：只更新卖方订单
         // 如果 tradebuyno 对应委托存在，说明买方委托先于成交到达（乱序）
-        auto it = order_index_.find(txn.tradebuyno);
-        if (it != order_index_.end()) {
-            const OrderNode& order = pool_.get(it->second);
+        const OrderIndexMap::Slot* found = order_index_.find_slot(txn.tradebuyno);
+        if (found) {
+            OrderView order = make_view(found->value, level_price(static_cast<int32_t>(found->aux) - 1));
             LOG_M_ERROR("Shanghai out-of-order: tradebuyno exists when bsflag=Buy | "
                 "txn: seq={}, security={}, buyno={}, sellno={}, price={}, qty={}, type={} | "
                 "order: seq={}, price={}, vol={}, side={}, type={}",
@@ -507,9 +1411,9 @@ bool FastOrderBook::on_transaction(const MDTransactionStruct& txn) {
     else if (bsflag == TradeBSFlag::Sell) {
         // 卖方主动成交：只更新买方订单
         // 如果 tradesellno 对应委托存在，说明卖方委托先于成交到达（乱序）
-        auto it = order_index_.find(txn.tradesellno);
-        if (it != order_index_.end()) {
-            const OrderNode& order = pool_.get(it->second);
+        const OrderIndexMap::Slot* found = order_index_.find_slot(txn.tradesellno);
+        if (found) {
+            OrderView order = make_view(found->value, level_price(static_cast<int32_t>(found->aux) - 1));
             LOG_M_ERROR("Shanghai out-of-order: tradesellno exists when bsflag=Sell | "
                 "txn: seq={}, security={}, buyno={}, sellno={}, price={}, qty={}, type={} | "
                 "order: seq={}, price={}, vol={}, side={}, type={}",
@@ -527,6 +1431,14 @@ bool FastOrderBook::on_transaction(const MDTransactionStruct& txn) {
     return result;
 }
 
+// 各交易所策略的显式实例化
+template bool FastOrderBook::on_order_as<ShanghaiPolicy>(const MDOrderStruct&);
+template bool FastOrderBook::on_order_as<ShenzhenPolicy>(const MDOrderStruct&);
+template bool FastOrderBook::on_order_as<AutoPolicy>(const MDOrderStruct&);
+template bool FastOrderBook::on_transaction_as<ShanghaiPolicy>(const MDTransactionStruct&);
+template bool FastOrderBook::on_transaction_as<ShenzhenPolicy>(const MDTransactionStruct&);
+template bool FastOrderBook::on_transaction_as<AutoPolicy>(const MDTransactionStruct&);
+
 // 打印N档盘口信息（用于调试）
 void FastOrderBook::print_orderbook(int n, const std::string& context) const {
     if (!context.empty()) {
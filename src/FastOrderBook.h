@@ -3,22 +3,34 @@
 
 #include <vector>
 #include <cstdint>
-#include <unordered_map>
+#include <map>
 #include <optional>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include "market_data_structs_aligned.h"
 #include "ObjectPool.h"
+#include "LevelBitmap.h"
+#include "OrderIndex.h"
+#include "QueueIndex.h"
+#include "TradeProfile.h"
+#include "AuctionIndex.h"
+#include "MoneyFlow.h"
+#include "TopOfBook.h"
+#include "DepthKernels.h"
+#include "FastDivide.h"
+#include "ExchangePolicy.h"
 #include "logger.h"
 
 // 强类型枚举，单字节存储
-enum class OrderType : int32_t {
+enum class OrderType : uint8_t {
     Limit = 1,
     Market = 2,
     Best = 3,
     ShanghaiCancel = 10
 };
 
-enum class Side : int32_t {
+enum class Side : uint8_t {
     Buy = 1,
     Sell = 2
 };
@@ -42,65 +54,231 @@ enum class TradeBSFlag : int32_t {
 };
 
 // ==========================================
-// 1. 订单节点 (OrderNode) - POD 类型
+// 1. 订单节点 (OrderNode) - POD 类型，16 字节
 // ==========================================
-// 存放在 Object Pool 中，构成变长链表的节点
-struct alignas(32) OrderNode {
-    // --- 业务标识 ---
-    uint64_t seq;           // 委托流水号
+// 存放在 Object Pool 中，构成变长链表的节点。一条 64 字节缓存行容纳 4 个节点。
+// 节点只保存链表遍历与量更新必需的字段，其余信息按需还原：
+// - seq: 存相对订单簿 seq_base_ 的 32 位偏移 (单只股票只属于一个通道，通道内序号连续)；
+//        超出窗口的 (实际不会出现) 记为 WIDE_SEQ，完整值放在订单簿的旁路表
+// - sort_price: 不存；所在档位记在订单索引槽位的 aux 中，遍历档位时由档位 tick 得出
+// - original_price: 与 sort_price 相同 (绝大多数限价单) 时不存；
+//        不同时 (市价单、本方最优单) 置 ORIG_PRICE_BIT，原始价放在订单簿的旁路表
+// - volume/type/side: 打包在 meta 一个 32 位字中
+struct alignas(16) OrderNode {
+    // --- 链表索引 (核心机制) ---
+    // 指向 ObjectPool 中的下标，-1 表示空
+    int32_t next_idx;
+    int32_t prev_idx;
 
-    // --- 价格语义分离 ---
-    uint32_t original_price;// 原始委托价 (用户输入，市价单可能为0)
-    uint32_t sort_price;    // 物理排序价 (实际挂入哪个 Level，用于系统定位)
+    // --- 业务标识 ---
+    uint32_t seq_delta;     // 委托流水号 - seq_base_
 
     // --- 核心数据 ---
-    uint32_t volume;        // 当前剩余未成交量 (热数据)
-
-    // --- 链表索引 (核心机制) ---
-    // 指向 ObjectPool 中的下标，-1 表示空
-    int32_t next_idx;       
-    int32_t prev_idx;       
+    // [0, 28) 剩余未成交量 | [28, 30) OrderType | 30 卖方 | 31 原始价在旁路表
+    uint32_t meta;
+
+    static constexpr uint32_t VOLUME_BITS = 28;
+    static constexpr uint32_t MAX_VOLUME = (1u << VOLUME_BITS) - 1;   // 单笔上限远大于交易所 100 万股
+    static constexpr uint32_t TYPE_SHIFT = VOLUME_BITS;
+    static constexpr uint32_t SELL_BIT = 1u << 30;
+    static constexpr uint32_t ORIG_PRICE_BIT = 1u << 31;
+    static constexpr uint32_t WIDE_SEQ = UINT32_MAX;
+
+    void init(uint32_t delta, OrderType t, Side s, uint32_t vol, bool orig_price_differs) {
+        next_idx = -1;
+        prev_idx = -1;
+        seq_delta = delta;
+        meta = vol | (static_cast<uint32_t>(t) << TYPE_SHIFT) |
+               (s == Side::Sell ? SELL_BIT : 0u) | (orig_price_differs ? ORIG_PRICE_BIT : 0u);
+    }
 
-    // --- 元数据 (压缩存储) ---
-    OrderType type;         
-    Side side;              
-    
-    // --- Padding ---
-    // 自动填充以保证 32 字节对齐，利用 padding 空间不造成浪费
-    uint8_t _padding[2];    
+    uint32_t volume() const { return meta & MAX_VOLUME; }
+    void set_volume(uint32_t vol) { meta = (meta & ~MAX_VOLUME) | vol; }
+    OrderType type() const { return static_cast<OrderType>((meta >> TYPE_SHIFT) & 3u); }
+    Side side() const { return (meta & SELL_BIT) ? Side::Sell : Side::Buy; }
+    bool has_original_price() const { return (meta & ORIG_PRICE_BIT) != 0; }
+};
+static_assert(sizeof(OrderNode) == 16, "OrderNode must stay 16 bytes");
+
+// 订单的完整视图 (由 OrderNode + 档位 + 旁路表还原)，供快照/遍历使用
+struct OrderView {
+    uint64_t seq;
+    uint32_t original_price;
+    uint32_t sort_price;    // 物理排序价 (所在档位价格)，市价单队列中为 0
+    uint32_t volume;
+    OrderType type;
+    Side side;
 };
 
 // ==========================================
-// 2. 价格档位 (Level) - POD 类型
+// 2. 价格档位链表 (LevelLinks) - POD 类型
 // ==========================================
-// 存放在 Fixed Array 中，买卖双链表各自独立
-struct alignas(64) Level {
-    uint32_t price;         // 价格 (冗余校验，实际由数组下标决定)
-
-    // 买单链表
-    uint64_t bid_volume;    // 买方挂单量
+// 密集窗口内的档位采用 SoA 布局：挂单量 (热数据) 按买卖方向各自存放在连续数组中，
+// 链表头尾与单数 (冷数据，仅挂单/摘单时访问) 单独存放在本结构数组中
+struct LevelLinks {
     int32_t bid_head_idx;   // 买单链表头
     int32_t bid_tail_idx;   // 买单链表尾
-
-    // 卖单链表
-    uint64_t ask_volume;    // 卖方挂单量
     int32_t ask_head_idx;   // 卖单链表头
     int32_t ask_tail_idx;   // 卖单链表尾
+    uint32_t bid_count;     // 买单笔数
+    uint32_t ask_count;     // 卖单笔数
 };
 
 
 
+// 稀疏层档位 (单侧)：密集窗口之外的价位，按价格有序存放在 std::map 中
+struct SparseLevel {
+    uint64_t volume = 0;
+    int32_t head_idx = -1;
+    int32_t tail_idx = -1;
+    uint32_t order_count = 0;
+};
+
+// 档位 (价格, 量)
+using PriceVolume = std::pair<uint32_t, uint64_t>;
+
+// ==========================================
+// 3. 前 N 档深度缓存 (DepthCache)
 // ==========================================
-// 4. 高性能订单簿引擎 (FastOrderBook)
+// 单侧前 DEPTH_CACHE_LEVELS 档，随挂单/成交/撤单增量维护：
+// - 变动档位在缓存范围外 (缓存已满且比第 N 档更差) 时不做任何事
+// - 已缓存档位仅量变化时原地修改
+// - 档位新增/清空时按档位顺序重建 (最多 N 次位图/稀疏层查找)
+// version 在前 N 档发生任何变化时递增，策略可据此跳过重复计算
+struct DepthCache {
+    static constexpr int LEVELS = 10;
+
+    PriceVolume levels[LEVELS];   // 价格优先顺序
+    int32_t lvl_idx[LEVELS];      // 对应档位 (tick = 价格 / 最小报价单位)
+    int count = 0;
+};
+
+// ==========================================
+// 4. 档位变动事件 (LevelChange) 与合成 N 档快照 (L2Snapshot)
+// ==========================================
+// 订单簿挂接变动缓冲区后，每处理一条逐笔消息，就把受影响档位变动后的状态
+// 逐条追加到缓冲区 (一条消息通常 1~2 条)。策略按增量消费，无需每次重新查询盘口
+enum class LevelChangeCause : uint8_t {
+    Add = 1,      // 新委托挂入 (含快照恢复)
+    Cancel = 2,   // 撤单
+    Trade = 3     // 成交
+};
+
+struct LevelChange {
+    uint64_t volume;        // 变动后该档位挂单量，0 表示档位清空
+    uint32_t price;
+    uint32_t order_count;   // 变动后该档位挂单笔数
+    Side side;
+    LevelChangeCause cause;
+};
+
+// 按工作线程 (分片) 共享，由调用方在每条消息处理完后消费并清空
+using LevelChangeBuffer = std::vector<LevelChange>;
+
+// 由订单簿当前状态合成的 N 档快照 (价格优先顺序)，不依赖交易所 3 秒快照
+struct L2Snapshot {
+    static constexpr int LEVELS = DepthCache::LEVELS;
+
+    PriceVolume bids[LEVELS];
+    PriceVolume asks[LEVELS];
+    uint32_t bid_orders[LEVELS];
+    uint32_t ask_orders[LEVELS];
+    int bid_count = 0;
+    int ask_count = 0;
+    uint64_t bid_version = 0;   // 生成时的前 N 档版本号
+    uint64_t ask_version = 0;
+};
+
+// ==========================================
+// 5. 订单生命周期事件 (OrderEvent)
+// ==========================================
+// 策略按档位或方向登记关注后，订单簿在处理逐笔消息时把关注范围内订单的
+// 挂入/成交/撤单事件追加到挂接的缓冲区，策略无需再维护订单簿状态的影子副本。
+// 未关注的档位不产生任何事件
+enum class OrderEventType : uint8_t {
+    Added = 1,             // 挂入 (volume = remaining = 委托量)
+    PartiallyFilled = 2,   // 部分成交，remaining > 0
+    Filled = 3,            // 全部成交，remaining == 0
+    Cancelled = 4          // 撤单，remaining > 0 表示部分撤单
+};
+
+struct OrderEvent {
+    uint64_t seq;
+    uint32_t price;         // 所在档位价格，市价单队列中为 0
+    uint32_t volume;        // 本次变动量 (挂入量/成交量/撤单量)
+    uint32_t remaining;     // 变动后剩余量
+    Side side;
+    OrderEventType type;
+};
+
+// 与 LevelChangeBuffer 相同，按工作线程共享，每条消息处理完后消费并清空
+using OrderEventBuffer = std::vector<OrderEvent>;
+
+// ==========================================
+// 6. 盘口流量指标 (FlowMetrics)
+// ==========================================
+// 随档位变动增量维护 (与深度缓存同一更新点)，策略读取均为 O(1)：
+// - 一档/五档不平衡度: (买量 - 卖量) / (买量 + 卖量)，范围 [-1, 1]
+// - 微观价格 (microprice): 一档量加权中间价 (P_b·Q_a + P_a·Q_b) / (Q_b + Q_a)
+// - OFI (Order Flow Imbalance, Cont-Kukanov-Stoikov): 一档价格/量每变动一次记一个事件，
+//   累计值自开启起算，另维护最近 N 个事件的滑动窗口和
+struct FlowMetrics {
+    static constexpr int DEEP_LEVELS = 5;
+
+    uint32_t bid_price = 0;        // 一档价格，0 表示该侧为空
+    uint32_t ask_price = 0;
+    uint64_t bid_volume = 0;       // 一档量
+    uint64_t ask_volume = 0;
+    uint64_t bid_volume_l5 = 0;    // 前五档量之和
+    uint64_t ask_volume_l5 = 0;
+    int64_t ofi_total = 0;         // 自开启起累计 OFI
+    int64_t ofi_window = 0;        // 最近 ofi_window_events 个事件的 OFI 之和
+    uint32_t ofi_window_events = 0;
+    uint64_t events = 0;           // 累计 OFI 事件数
+
+    double imbalance_l1() const { return imbalance(bid_volume, ask_volume); }
+    double imbalance_l5() const { return imbalance(bid_volume_l5, ask_volume_l5); }
+
+    // 双边都有挂单时返回微观价格 (与价格同单位)
+    std::optional<double> microprice() const {
+        if (bid_price == 0 || ask_price == 0 || bid_volume + ask_volume == 0) return std::nullopt;
+        return (static_cast<double>(bid_price) * static_cast<double>(ask_volume) +
+                static_cast<double>(ask_price) * static_cast<double>(bid_volume)) /
+               static_cast<double>(bid_volume + ask_volume);
+    }
+
+private:
+    static double imbalance(uint64_t bid, uint64_t ask) {
+        if (bid + ask == 0) return 0.0;
+        return (static_cast<double>(bid) - static_cast<double>(ask)) / static_cast<double>(bid + ask);
+    }
+};
+
+// ==========================================
+// 7. 高性能订单簿引擎 (FastOrderBook)
 // ==========================================
 class FastOrderBook {
 public:
-    // 价格档位间隔：0.01元 * 10000 = 100
-    static constexpr uint32_t TICK_SIZE = 100;
+    // 默认价格档位间隔 (股票)：0.01元 * 10000 = 100；基金/可转债为 10 (0.001元)
+    static constexpr uint32_t TICK_SIZE = symbol_utils::STOCK_TICK_SIZE;
+
+    // 深度缓存档数
+    static constexpr int DEPTH_CACHE_LEVELS = DepthCache::LEVELS;
+
+    // 档位存储：涨跌停区间不超过 MAX_DENSE_LEVELS 档时整个区间用密集数组 (与区间一一对应，永不移动)；
+    // 区间更宽或无涨跌停限制时，只在活跃价附近保留 DENSE_WINDOW_LEVELS 档的密集窗口，
+    // 窗口外的价位进入稀疏层，最优价偏离窗口中部时窗口重新居中 (档位在两层间迁移)
+    static constexpr uint32_t MAX_DENSE_LEVELS = 4096;
+    static constexpr uint32_t DENSE_WINDOW_LEVELS = 2048;
 
     // 构造函数：需要传入全剧唯一的内存池引用
-    // min_price/max_price 用于预分配 Level 数组的大小 (Offset Mapping)
-    FastOrderBook(uint32_t code, ObjectPool<OrderNode>& pool, uint32_t min_price, uint32_t max_price);
+    // min_price/max_price 为涨跌停价，决定合法价格区间与档位存储方式 (见上)；
+    // min_price == 0 或 max_price <= min_price 表示无涨跌停限制 (如新股上市前几日)，任何正价格均可挂单
+    // 节点从本订单簿私有的 Arena 分配 (按 slab 向共享池申请)，pool 须比订单簿活得久
+    // exchange 决定逐笔处理使用的交易所策略 (见 ExchangePolicy.h)，tick_size 须 >= 2
+    FastOrderBook(uint32_t code, ObjectPool<OrderNode>& pool, uint32_t min_price, uint32_t max_price,
+                  Exchange exchange = Exchange::Auto, uint32_t tick_size = TICK_SIZE);
+    ~FastOrderBook();
 
     // 禁止拷贝，仅允许移动 (Resource handle)
     FastOrderBook(const FastOrderBook&) = delete;
@@ -110,12 +288,19 @@ public:
     // 核心写接口 (Hot Path)
     // --------------------------------------------------------
 
-    // 处理逐笔委托消息
+    // 处理逐笔委托消息 (按构造时的交易所分派到对应策略的实例)
     bool on_order(const MDOrderStruct& order);
 
     // 处理逐笔成交消息
     bool on_transaction(const MDTransactionStruct& transaction);
 
+    // 指定交易所策略的处理路径 (调用方已知交易所时可直接调用，跳过分派)
+    template<typename Policy>
+    bool on_order_as(const MDOrderStruct& order);
+
+    template<typename Policy>
+    bool on_transaction_as(const MDTransactionStruct& transaction);
+
     // --------------------------------------------------------
     // 核心读接口 (Query Path)
     // --------------------------------------------------------
@@ -133,30 +318,268 @@ public:
     // 获取某价格档位的卖方挂单量
     uint64_t get_ask_volume_at_price(uint32_t price) const;
 
-    // 计算价格区间内的累积挂单量 (用于打板策略，极速数组扫描)
+    // 计算价格区间内的累积挂单量 (用于打板策略，SIMD 连续数组扫描)
     uint64_t get_ask_volume_in_range(uint32_t start_price, uint32_t end_price) const;
+    uint64_t get_bid_volume_in_range(uint32_t start_price, uint32_t end_price) const;
+
+    // 从卖一向上累加挂单量，返回累计量首次 >= target_volume 的价格 (即吃掉 target_volume 需要扫到的价位)
+    // 卖盘累计量不足返回 nullopt；cumulative 非空时输出累加到该价位 (或整个卖盘) 的总量
+    std::optional<uint32_t> get_ask_price_for_volume(uint64_t target_volume, uint64_t* cumulative = nullptr) const;
+
+    // 从买一向下累加挂单量，返回累计量首次 >= target_volume 的价格
+    std::optional<uint32_t> get_bid_price_for_volume(uint64_t target_volume, uint64_t* cumulative = nullptr) const;
+
+    // 市价单队列 (含本方无挂单时转入的本方最优单) 的挂单量与单数，O(1)
+    uint64_t get_market_bid_volume() const { return market_bids_.volume; }
+    uint64_t get_market_ask_volume() const { return market_asks_.volume; }
+    uint32_t market_order_count(Side side) const {
+        return side == Side::Buy ? market_bids_.count : market_asks_.count;
+    }
 
     // 获取买卖N档数据 (价格, 量)
-    std::vector<std::pair<uint32_t, uint64_t>> get_bid_levels(int n) const;
-    std::vector<std::pair<uint32_t, uint64_t>> get_ask_levels(int n) const;
+    // 注意：返回 vector 会在堆上分配，热路径请使用下方定长输出版本
+    std::vector<PriceVolume> get_bid_levels(int n) const;
+    std::vector<PriceVolume> get_ask_levels(int n) const;
+
+    // 获取买卖N档数据，写入调用方提供的定长数组 out[0..n)，返回实际档数
+    // 零分配；开启深度缓存且 n <= DEPTH_CACHE_LEVELS 时直接拷贝缓存
+    int get_bid_levels(PriceVolume* out, int n) const;
+    int get_ask_levels(PriceVolume* out, int n) const;
+
+    // --------------------------------------------------------
+    // 前 N 档深度缓存
+    // --------------------------------------------------------
+
+    // 开启/关闭深度缓存 (开启时立即全量构建)
+    // 只有被策略关注的股票需要开启，未开启时不产生额外维护开销
+    void enable_depth_cache(bool enable);
+    bool depth_cache_enabled() const { return depth_cache_enabled_; }
+
+    // 前 N 档版本号：前 N 档 (价格或量) 有变化时递增
+    // 未开启深度缓存时，本侧任何档位变化都会递增 (保守)
+    uint64_t bid_depth_version() const { return bid_depth_version_; }
+    uint64_t ask_depth_version() const { return ask_depth_version_; }
+
+    // --------------------------------------------------------
+    // 盘口流量指标
+    // --------------------------------------------------------
+
+    // 开启/关闭流量指标 (开启时同时开启深度缓存，指标清零并以当前盘口为起点；
+    // 已按相同窗口开启时不做任何事)。开启期间不应关闭深度缓存 (五档量取自缓存)
+    // window_events: OFI 滑动窗口的事件数
+    static constexpr uint32_t DEFAULT_OFI_WINDOW = 100;
+    void enable_flow_metrics(bool enable, uint32_t window_events = DEFAULT_OFI_WINDOW);
+    bool flow_metrics_enabled() const { return flow_enabled_; }
+    const FlowMetrics& flow_metrics() const { return flow_; }
+
+    // --------------------------------------------------------
+    // 主力资金流向 (按母单原始规模分档)
+    // --------------------------------------------------------
+
+    // 开启后逐笔成交按买卖双方母单的原始委托量 × 成交价分档累计流入/流出；
+    // 开启期间为每笔挂单额外登记原始委托量 (旁路表)。已开启时只更新分档阈值
+    // 母单原始量：在簿订单取登记值；上海不入簿的主动单取其已累计成交量 (连续成交逐笔增长)；
+    // 开启前已在簿 (或快照恢复) 的订单取当前剩余量
+    void enable_money_flow(const MoneyFlowBuckets& buckets);
+    bool money_flow_enabled() const { return money_flow_enabled_; }
+    const MoneyFlow& money_flow() const { return money_flow_; }
+    const MoneyFlowBuckets& money_flow_buckets() const { return flow_buckets_; }
+
+    // --------------------------------------------------------
+    // 跨线程一档快照
+    // --------------------------------------------------------
+
+    // 挂接 seqlock 一档快照 (nullptr 取消)：挂接时立即发布当前状态，
+    // 之后每条逐笔 (on_order / on_transaction) 处理完发布一次。记录由调用方持有
+    void set_top_of_book(SeqlockTopOfBook* top);
+    SeqlockTopOfBook* top_of_book() const { return top_; }
+
+    // --------------------------------------------------------
+    // 集合竞价虚拟撮合
+    // --------------------------------------------------------
+
+    // 虚拟撮合结果：成交量最大的价格；成交量相同的价格有多个时，
+    // 上海取其中间价，深圳取最接近参考价 (昨收) 的价格 (无参考价时同上海)
+    struct AuctionState {
+        uint32_t price;
+        uint64_t volume;          // 虚拟成交量
+        uint64_t bid_volume;      // 价格 >= price 的买量
+        uint64_t ask_volume;      // 价格 <= price 的卖量
+        int64_t imbalance;        // bid_volume - ask_volume，> 0 为买方未成交余量
+    };
+
+    // 进入/退出集合竞价模式 (进入时按当前挂单全量构建累计量索引，之后随档位变动 O(log n) 增量维护)
+    // reference_price: 昨收价，用于深圳的价格选择与无涨跌停订单簿的索引区间定位 (0 表示未知)
+    void set_auction_mode(bool enable, uint32_t reference_price = 0);
+    bool auction_mode() const { return auction_mode_; }
+
+    // 当前虚拟撮合结果 (O(log n))；非竞价模式或买卖不交叉时返回 nullopt
+    std::optional<AuctionState> get_auction_state() const;
+
+    // 竞价索引最多覆盖的档位数 (无涨跌停或区间过宽时以参考价为中心)
+    static constexpr uint32_t AUCTION_SPAN_LEVELS = 1u << 14;
+
+    // --------------------------------------------------------
+    // 档位变动事件与合成快照
+    // --------------------------------------------------------
+
+    // 挂接档位变动缓冲区 (nullptr 关闭)；缓冲区须比订单簿活得久或在其之前摘除
+    void set_level_change_sink(LevelChangeBuffer* sink) { level_sink_ = sink; }
+    LevelChangeBuffer* level_change_sink() const { return level_sink_; }
+
+    // --------------------------------------------------------
+    // 订单生命周期事件
+    // --------------------------------------------------------
+
+    // 挂接订单事件缓冲区 (nullptr 关闭)
+    void set_order_event_sink(OrderEventBuffer* sink) { order_sink_ = sink; }
+    OrderEventBuffer* order_event_sink() const { return order_sink_; }
+
+    // 登记/撤销关注 (引用计数，多个策略可关注同一档位)
+    // watch_orders: 指定方向某价格档位的订单；watch_side: 指定方向全部订单 (含市价单队列)
+    // 价格越界返回 false
+    bool watch_orders(Side side, uint32_t price);
+    void unwatch_orders(Side side, uint32_t price);
+    void watch_side(Side side);
+    void unwatch_side(Side side);
+    bool orders_watched(Side side, uint32_t price) const;
+
+    // 某价格档位的挂单笔数
+    uint32_t get_bid_order_count_at_price(uint32_t price) const;
+    uint32_t get_ask_order_count_at_price(uint32_t price) const;
+
+    // 合成前 L2Snapshot::LEVELS 档快照 (开启深度缓存时直接拷贝缓存)
+    void build_l2_snapshot(L2Snapshot& out) const;
+
+    // --------------------------------------------------------
+    // 分价成交量 (on_transaction 逐笔累计，按主动方拆分)
+    // --------------------------------------------------------
+
+    // 某价格的累计成交量/笔数 O(1)
+    TradeProfile::Stats get_traded_at_price(uint32_t price) const;
+
+    // 价格闭区间 [start_price, end_price] 内的累计成交量/笔数 (SIMD 区间求和)
+    TradeProfile::Stats get_traded_in_range(uint32_t start_price, uint32_t end_price) const;
+
+    // 价格闭区间内的成交量加权均价 (与价格同单位)，区间内无成交返回 nullopt
+    std::optional<double> get_vwap(uint32_t start_price, uint32_t end_price) const;
+
+    // 全天累计成交量/笔数 (只含落在价格区间内的成交)
+    uint64_t get_total_traded_volume() const { return trades_.total_volume(); }
+    uint64_t get_total_traded_count() const { return trades_.total_count(); }
+
+    const TradeProfile& trade_profile() const { return trades_; }
 
     // 遍历指定价格档位的所有买单，对每个订单调用 fn(seq, volume)
     // 零分配、可内联，用于策略初始化时从 OrderBook 同步订单状态
     template<typename Fn>
     void for_each_bid_order_at_price(uint32_t price, Fn&& fn) const {
-        if (price < min_price_ || price > min_price_ + (levels_.size() - 1) * TICK_SIZE) return;
-        const Level& lvl = levels_[(price - min_price_) / TICK_SIZE];
-        int32_t idx = lvl.bid_head_idx;
+        int32_t tick = price_to_level(price);
+        if (tick < 0) return;
+        int32_t idx = level_head(Side::Buy, tick);
         while (idx != -1) {
-            const OrderNode& node = pool_.get(idx);
-            fn(node.seq, node.volume);
+            const OrderNode& node = pool_[idx];
+            fn(node_seq(idx, node), node.volume());
             idx = node.next_idx;
         }
     }
 
+    // --------------------------------------------------------
+    // 排队位置查询 (Queue Position)
+    // --------------------------------------------------------
+
+    // 订单在所在档位队列中的位置：前方单数、前方挂单量、后方挂单量 (均不含自身)
+    struct QueuePosition {
+        uint32_t orders_ahead;
+        uint64_t volume_ahead;
+        uint64_t volume_behind;
+    };
+
+    // 为指定档位建立排队前缀和索引 (按当前队列全量构建)，此后该档位的位置查询为 O(log n)
+    // 只有策略关注的档位 (如涨停价买一) 需要开启；价格越界返回 false
+    bool track_queue(Side side, uint32_t price);
+    void untrack_queue(Side side, uint32_t price);
+    bool queue_tracked(Side side, uint32_t price) const;
+
+    // 查询限价订单的排队位置；订单不存在或在市价单队列中返回 nullopt
+    // 所在档位已开启索引时 O(log n)，否则沿链表遍历 (O(队列长度))
+    std::optional<QueuePosition> queue_position(uint64_t seq) const;
+
+    std::optional<uint64_t> volume_ahead(uint64_t seq) const {
+        auto pos = queue_position(seq);
+        return pos ? std::optional<uint64_t>(pos->volume_ahead) : std::nullopt;
+    }
+
+    std::optional<uint64_t> volume_behind(uint64_t seq) const {
+        auto pos = queue_position(seq);
+        return pos ? std::optional<uint64_t>(pos->volume_behind) : std::nullopt;
+    }
+
+    // 指定档位前 k 个订单的累计挂单量 (k 超过队列长度时为该档位全部挂单量)
+    uint64_t queue_volume_of_first(Side side, uint32_t price, uint32_t k) const;
+
     // 打印N档盘口信息（用于调试）
     void print_orderbook(int n = 10, const std::string& context = "") const;
 
+    // --------------------------------------------------------
+    // 快照/恢复接口 (Checkpoint)
+    // --------------------------------------------------------
+
+    // 涨跌停价 (无涨跌停限制时均为 0)
+    uint32_t min_price() const { return price_limited_ ? min_price_ : 0; }
+    uint32_t max_price() const { return price_limited_ ? max_price_ : 0; }
+    bool price_limited() const { return price_limited_; }
+    uint32_t tick_size() const { return tick_size_; }
+    Exchange exchange() const { return exchange_; }
+
+    // 当前在册订单数 (含市价单队列)
+    size_t order_count() const { return order_index_.size(); }
+
+    // 遍历所有在册订单，对每个订单调用 fn(const OrderView&)
+    // 每个档位内按链表顺序 (即时间优先顺序)，最后是买、卖市价单队列 (同样按到达顺序)
+    // 按此顺序逐个 restore_order 可还原出完全相同的订单簿
+    template<typename Fn>
+    void for_each_order(Fn&& fn) const {
+        for (Side side : {Side::Buy, Side::Sell}) {
+            for (int32_t tick = next_level(side, 0); tick >= 0; tick = next_level(side, tick + 1)) {
+                uint32_t price = level_price(tick);
+                for (int32_t idx = level_head(side, tick); idx != -1; idx = pool_[idx].next_idx) {
+                    fn(make_view(idx, price));
+                }
+            }
+        }
+        for (const MarketQueue* q : {&market_bids_, &market_asks_}) {
+            for (int32_t idx = q->head_idx; idx != -1; idx = pool_[idx].next_idx) {
+                fn(make_view(idx, 0));
+            }
+        }
+    }
+
+    // 档位存储统计：密集窗口档数 (未挂过限价单的无涨跌停订单簿为 0)、稀疏层档位数 (买+卖)、窗口重新居中次数
+    uint32_t dense_level_count() const { return win_size_; }
+    size_t sparse_level_count() const { return sparse_bids_.size() + sparse_asks_.size(); }
+    uint64_t recenter_count() const { return recenter_count_; }
+
+    // 旁路表条目数 (原始价 != 排序价的订单、超出 seq 窗口的订单)
+    size_t original_price_entries() const { return orig_prices_.size(); }
+    size_t wide_seq_entries() const { return wide_seqs_.size(); }
+
+    // --------------------------------------------------------
+    // 节点整理 (Compaction)
+    // --------------------------------------------------------
+
+    // 按队列顺序把所有在册订单搬到新的连续 slab 中，释放旧 slab，返回搬移的节点数
+    // 耗时与挂单数成正比，应在行情空闲时调用 (如午休)；调用后原有节点下标全部失效
+    size_t compact();
+
+    // 本订单簿持有的 slab 数 (每个 ObjectPool::SLAB_SIZE 个节点)
+    size_t arena_slab_count() const { return arena_.slab_count(); }
+
+    // 按快照记录还原一个订单 (挂到对应档位队尾，不重新计算 Best 单的挂单价)
+    // sort_price == 0 表示该订单在市价单队列中
+    bool restore_order(uint64_t seq, OrderType type, Side side,
+                       uint32_t original_price, uint32_t sort_price, uint32_t volume);
+
 private:
     // --------------------------------------------------------
     // 内部数据成员
@@ -164,23 +587,124 @@ private:
     
     const uint32_t stock_code_;
     ObjectPool<OrderNode>& pool_;
-
-    // [核心优化] 价格档位数组 (Direct Array Mapping)
-    // 访问方式: levels_[price - min_price_]
-    std::vector<Level> levels_;
-    uint32_t min_price_; // 价格偏移量 (Base Price)
-
-    // [核心优化] 维护当前的 best 指针，避免每次从头扫描
-    // 当 best Level 被打穿(空)时，向下/向上移动指针寻找下一个非空 Level
-    int32_t best_bid_idx_ = -1; 
+    ObjectPool<OrderNode>::Arena arena_;   // 本订单簿的节点 slab 与空闲链表
+
+    // 档位统一用 tick (= 价格 / tick_size_) 表示，与存储位置无关：
+    // 订单索引 aux、最优价游标、深度缓存记录的都是 tick，窗口重新居中时无需改写
+
+    // 合法价格区间 [min_price_, max_price_] (无涨跌停限制时为 [1, UINT32_MAX])
+    bool price_limited_;
+    uint32_t min_price_;
+    uint32_t max_price_; // 有涨跌停时为 min_price_ + k * tick_size_ 中不超过涨停价的最大值
+    uint32_t tick_size_;
+    FastDivU32 tick_div_;
+    Exchange exchange_;
+    bool fixed_window_;   // 整个涨跌停区间都在密集数组中 (不会重新居中)
+
+    // [核心优化] 密集窗口 (Direct Array Mapping, SoA)，覆盖 tick [win_lo_, win_lo_ + win_size_)
+    // 访问方式: xxx_[tick - win_lo_]
+    // 买卖挂单量各自连续存放，区间求和/累计深度直接 SIMD 扫描，不夹带链表字段
+    int32_t win_lo_ = 0;
+    uint32_t win_size_ = 0;
+    std::vector<uint64_t> bid_volume_;
+    std::vector<uint64_t> ask_volume_;
+    std::vector<LevelLinks> level_links_;  // 链表头尾与单数 (冷数据)
+
+    // [核心优化] 窗口内档位占用位图 (每侧 1 bit/档 + summary)
+    // 由 add_node_to_level/remove_node_from_level 维护，链表非空即置位
+    LevelBitmap bid_bitmap_;
+    LevelBitmap ask_bitmap_;
+
+    // 稀疏层：窗口外的非空档位 (tick -> 档位)，链表变空即删除
+    std::map<int32_t, SparseLevel> sparse_bids_;
+    std::map<int32_t, SparseLevel> sparse_asks_;
+    uint64_t recenter_count_ = 0;
+
+    // [核心优化] 维护当前的 best 档位 (tick)，避免每次从头扫描
+    // 当 best 档位被打穿(空)时，通过位图/稀疏层跳到下一个非空档位
+    int32_t best_bid_idx_ = -1;
     int32_t best_ask_idx_ = -1;
 
-    // 市价单队列 (不入 Level，独立排队)
-    std::vector<int32_t> market_orders_;
-
-    // 订单索引: Seq -> Pool Index
-    // 生产环境建议替换为 flat_hash_map 以减少 Cache Miss
-    std::unordered_map<uint64_t, int32_t> order_index_;
+    // 市价单队列 (不入 Level，按买卖方向独立排队)
+    // 复用节点的 next_idx/prev_idx 组成侵入式双向链表，完结时 O(1) 摘除
+    // 本方无挂单时转入的本方最优 (Best) 单也在此排队
+    struct MarketQueue {
+        int32_t head_idx = -1;
+        int32_t tail_idx = -1;
+        uint64_t volume = 0;
+        uint32_t count = 0;
+    };
+    MarketQueue market_bids_;
+    MarketQueue market_asks_;
+
+    // 开启排队索引的档位 (通常 0~2 个，线性查找)
+    struct TrackedQueue {
+        Side side;
+        int32_t tick;
+        QueueIndex index;
+    };
+    std::vector<TrackedQueue> tracked_queues_;
+
+    // 订单索引: Seq -> Pool Index (开放寻址，按实际挂单数自适应扩容)
+    // 槽位 aux 记录所在档位 tick + 1，0 表示不在任何档位 (市价单队列)
+    OrderIndexMap order_index_;
+
+    // 节点 seq 的基准：首个订单入簿时确定，之后的 seq 存为相对偏移
+    uint64_t seq_base_ = 0;
+    bool seq_base_set_ = false;
+
+    // 旁路表 (冷数据)：原始价与排序价不同的订单 seq -> 原始价；超出 seq 窗口的节点下标 -> 完整 seq
+    OrderIndexMap orig_prices_{OrderIndexMap::MIN_CAPACITY};
+    std::unordered_map<int32_t, uint64_t> wide_seqs_;
+
+    // 前 N 档深度缓存与版本号
+    bool depth_cache_enabled_ = false;
+    DepthCache bid_cache_;
+    DepthCache ask_cache_;
+    uint64_t bid_depth_version_ = 0;
+    uint64_t ask_depth_version_ = 0;
+
+    // 分价成交量 (按 tick 索引，独立于挂单窗口)
+    TradeProfile trades_;
+
+    // 主力资金流向：分档阈值、累计值、挂单原始量旁路表 (seq -> 原始委托量)
+    // 与上海当前主动单 (不入簿) 的已成交量
+    bool money_flow_enabled_ = false;
+    MoneyFlowBuckets flow_buckets_;
+    MoneyFlow money_flow_;
+    OrderIndexMap orig_volumes_{OrderIndexMap::MIN_CAPACITY};
+    uint64_t aggressor_seq_ = 0;
+    uint64_t aggressor_filled_ = 0;
+
+    // 跨线程一档快照与最近成交 (仅挂接时维护)
+    SeqlockTopOfBook* top_ = nullptr;
+    uint32_t last_trade_price_ = 0;
+    uint64_t last_trade_volume_ = 0;
+    int64_t last_applseqnum_ = 0;
+
+    // 集合竞价累计量索引 (仅竞价模式下维护)
+    bool auction_mode_ = false;
+    uint32_t auction_ref_price_ = 0;
+    AuctionIndex auction_;
+
+    // 盘口流量指标与 OFI 滑动窗口 (环形缓冲，存最近 N 个事件的 OFI)
+    bool flow_enabled_ = false;
+    FlowMetrics flow_;
+    std::vector<int64_t> ofi_ring_;
+    size_t ofi_pos_ = 0;
+
+    // 订单事件：关注的 (方向, 档位)，tick == -1 表示整个方向 (通常 0~2 项，线性查找)
+    struct OrderWatch {
+        Side side;
+        int32_t tick;
+        uint32_t refs;
+    };
+    std::vector<OrderWatch> order_watches_;
+    OrderEventBuffer* order_sink_ = nullptr;
+
+    // 档位变动事件：挂接的缓冲区与当前消息的变动原因 (由写入口设置)
+    LevelChangeBuffer* level_sink_ = nullptr;
+    LevelChangeCause change_cause_ = LevelChangeCause::Add;
 
     // --------------------------------------------------------
     // 内部写操作 (由 on_order/on_transaction 调用)
@@ -202,18 +726,134 @@ private:
     // 通用的量更新逻辑 (成交/撤单共用)
     bool update_volume_internal(uint64_t seq, uint32_t delta_vol);
 
-    // 链表操作：挂载节点到 Level 尾部
-    void add_node_to_level(Level& lvl, int32_t node_idx, OrderNode& node);
+    // 分配并填充节点、建立索引 (add_order/restore_order 共用)，池耗尽返回 -1
+    // lvl < 0 表示进入市价单队列
+    int32_t alloc_node(uint64_t seq, OrderType type, Side side, uint32_t original_price,
+                       uint32_t sort_price, uint32_t volume, int32_t lvl);
+
+    // 回收节点及其旁路表条目
+    void free_node(uint64_t seq, int32_t node_idx, const OrderNode& node);
+
+    // 挂入限价档位并维护最优价游标和深度缓存 (add_order/restore_order 共用)
+    void link_limit_node(int32_t tick, int32_t node_idx, OrderNode& node);
+
+    // 链表操作：挂载节点到 Level 尾部 (窗口内链表由空变非空时置位位图，窗口外新建稀疏档位)
+    void add_node_to_level(int32_t tick, int32_t node_idx, OrderNode& node);
+
+    // 链表操作：从 Level 中物理摘除节点 (链表变空时清除位图/删除稀疏档位)
+    void remove_node_from_level(int32_t tick, int32_t node_idx, const OrderNode& node);
+
+    // 档位存储：最优价偏离窗口中部时把窗口重新居中到买卖中间价
+    void maybe_recenter();
+
+    // 把密集窗口移动到以 center 为中心 (首次调用时分配窗口)，档位在窗口与稀疏层间迁移
+    void recenter(int32_t center);
+
+    // 市价单队列：挂到本方队尾 / 摘除 (O(1))
+    MarketQueue& market_queue(Side side) { return side == Side::Buy ? market_bids_ : market_asks_; }
+    void push_market_order(int32_t node_idx, OrderNode& node);
+    void remove_market_order(const OrderNode& node);
+
+    // 订单事件：登记关注与判断 (tick == -1 为整个方向)
+    void add_watch(Side side, int32_t tick);
+    void remove_watch(Side side, int32_t tick);
+    bool order_watched(Side side, int32_t tick) const {
+        for (const OrderWatch& w : order_watches_) {
+            if (w.side == side && (w.tick == -1 || w.tick == tick)) return true;
+        }
+        return false;
+    }
 
-    // 链表操作：从 Level 中物理摘除节点
-    void remove_node_from_level(Level& lvl, int32_t node_idx, const OrderNode& node);
+    // 排队索引：查找档位对应的索引 (未开启返回 nullptr)，按当前链表顺序重建
+    QueueIndex* find_queue_index(Side side, int32_t tick);
+    const QueueIndex* find_queue_index(Side side, int32_t tick) const;
+    void rebuild_queue_index(TrackedQueue& q);
 
     // 状态维护：当最优价档位空了之后，寻找下一个最优价
     void update_best_bid_cursor();
     void update_best_ask_cursor();
 
-    // 辅助：安全获取 Level 引用
-    Level* get_level_ptr(uint32_t price);
+    // 状态维护：档位量/占用变化后维护深度缓存与版本号 (须在位图和游标更新之后调用)
+    void on_level_changed(Side side, int32_t lvl);
+    void update_depth_cache(Side side, int32_t lvl);
+
+    // 主力资金流向：按成交记账 (须在更新双方委托量之前调用)
+    void record_money_flow(const MDTransactionStruct& txn, bool buy_aggressor, bool sell_aggressor);
+    uint64_t parent_volume(uint64_t seq, bool aggressor, uint64_t qty);
+
+    // 发布一档快照 (top_ 非空时调用)
+    void publish_top(int64_t applseqnum);
+
+    // 盘口流量指标：档位变动后重算一档状态与 OFI
+    void update_flow_metrics();
+    static uint64_t top_volume(const DepthCache& cache, int n);
+
+    // 从占用位图重建单侧深度缓存
+    void rebuild_bid_cache();
+    void rebuild_ask_cache();
+
+    // 辅助：节点 -> 完整 seq
+    uint64_t node_seq(int32_t node_idx, const OrderNode& node) const {
+        if (node.seq_delta != OrderNode::WIDE_SEQ) return seq_base_ + node.seq_delta;
+        return wide_seqs_.at(node_idx);
+    }
+
+    // 辅助：还原订单完整视图 (sort_price 由调用方按所在档位给出)
+    OrderView make_view(int32_t node_idx, uint32_t sort_price) const {
+        const OrderNode& node = pool_[node_idx];
+        uint64_t seq = node_seq(node_idx, node);
+        uint32_t original_price = sort_price;
+        if (node.has_original_price()) {
+            original_price = static_cast<uint32_t>(*orig_prices_.find(seq));
+        }
+        return OrderView{seq, original_price, sort_price, node.volume(), node.type(), node.side()};
+    }
+
+    // 辅助：档位 (tick) -> 价格，-1 (不在档位) 返回 0
+    uint32_t level_price(int32_t lvl) const {
+        return lvl < 0 ? 0 : static_cast<uint32_t>(lvl) * tick_size_;
+    }
+
+    // 辅助：价格 -> 档位 (tick)，越界返回 -1
+    int32_t price_to_level(uint32_t price) const {
+        if (price < min_price_ || price > max_price_) return -1;
+        return static_cast<int32_t>(tick_div_.divide(price));
+    }
+
+    // 辅助：tick 在密集窗口中的下标，不在窗口内返回 -1
+    int32_t window_slot(int32_t tick) const {
+        uint32_t slot = static_cast<uint32_t>(tick - win_lo_);
+        return slot < win_size_ ? static_cast<int32_t>(slot) : -1;
+    }
+
+    std::map<int32_t, SparseLevel>& sparse_side(Side side) {
+        return side == Side::Buy ? sparse_bids_ : sparse_asks_;
+    }
+    const std::map<int32_t, SparseLevel>& sparse_side(Side side) const {
+        return side == Side::Buy ? sparse_bids_ : sparse_asks_;
+    }
+
+    // 辅助：单侧档位的挂单量与链表头尾指针，稀疏层中不存在的档位返回空指针
+    struct LevelRef {
+        uint64_t* volume;
+        int32_t* head;
+        int32_t* tail;
+        uint32_t* count;
+    };
+    LevelRef level_ref(Side side, int32_t tick);
+
+    // 辅助：单侧 [from, to] 档位挂单量之和 (窗口部分 SIMD 扫描 + 稀疏层)
+    uint64_t range_volume(Side side, int32_t from, int32_t to) const;
+
+    // 辅助：单侧档位的挂单量、笔数与链表头 (档位不存在时返回 0 / 0 / -1)
+    uint64_t level_volume(Side side, int32_t tick) const;
+    uint32_t level_order_count(Side side, int32_t tick) const;
+    int32_t level_head(Side side, int32_t tick) const;
+
+    // 辅助：单侧非空档位查找，覆盖窗口与稀疏层
+    // next_level: >= from 的最低档位；prev_level: <= from 的最高档位；不存在返回 -1
+    int32_t next_level(Side side, int32_t from) const;
+    int32_t prev_level(Side side, int32_t from) const;
 };
 
 #endif // FAST_ORDER_BOOK_H
\ No newline at end of file
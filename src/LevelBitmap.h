@@ -0,0 +1,136 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+/**
+ * @brief 价格档位占用位图 (两层)
+ *
+ * 每个档位 1 bit，表示该档位是否有挂单；上层 summary 每 bit 对应下层一个 64-bit word。
+ * "寻找下一个非空档位" 只需在叶子 word 内做一次 tzcnt/lzcnt，
+ * 叶子为空时再扫描 summary（每个 summary word 覆盖 4096 档）。
+ *
+ * 用于 FastOrderBook 的最优价游标移动和 N 档深度遍历，跳过空档位。
+ */
+class LevelBitmap {
+public:
+    LevelBitmap() = default;
+
+    explicit LevelBitmap(size_t n) {
+        resize(n);
+    }
+
+    /**
+     * @brief 重新设置档位数量，所有 bit 清零
+     */
+    void resize(size_t n) {
+        size_ = n;
+        words_.assign((n + 63) / 64, 0);
+        summary_.assign((words_.size() + 63) / 64, 0);
+    }
+
+    size_t size() const { return size_; }
+
+    void set(uint32_t i) {
+        uint32_t w = i >> 6;
+        words_[w] |= (1ULL << (i & 63));
+        summary_[w >> 6] |= (1ULL << (w & 63));
+    }
+
+    void clear(uint32_t i) {
+        uint32_t w = i >> 6;
+        words_[w] &= ~(1ULL << (i & 63));
+        if (words_[w] == 0) {
+            summary_[w >> 6] &= ~(1ULL << (w & 63));
+        }
+    }
+
+    bool test(uint32_t i) const {
+        return (words_[i >> 6] >> (i & 63)) & 1ULL;
+    }
+
+    bool any() const {
+        for (uint64_t s : summary_) {
+            if (s) return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief 查找 >= i 的第一个置位档位
+     * @return 档位下标，不存在返回 -1
+     */
+    int32_t find_next(uint32_t i) const {
+        if (i >= size_) return -1;
+
+        // 1. 当前 word 内查找
+        uint32_t w = i >> 6;
+        uint64_t m = words_[w] & (~0ULL << (i & 63));
+        if (m) {
+            return static_cast<int32_t>((w << 6) + __builtin_ctzll(m));
+        }
+
+        // 2. 通过 summary 跳到下一个非空 word
+        uint32_t nw = w + 1;
+        if (nw >= words_.size()) return -1;
+        uint32_t s = nw >> 6;
+        uint64_t sm = summary_[s] & (~0ULL << (nw & 63));
+        while (true) {
+            if (sm) {
+                uint32_t w2 = (s << 6) + __builtin_ctzll(sm);
+                return static_cast<int32_t>((w2 << 6) + __builtin_ctzll(words_[w2]));
+            }
+            if (++s >= summary_.size()) return -1;
+            sm = summary_[s];
+        }
+    }
+
+    /**
+     * @brief 查找 <= i 的最后一个置位档位
+     * @return 档位下标，不存在返回 -1
+     */
+    int32_t find_prev(uint32_t i) const {
+        if (size_ == 0) return -1;
+        if (i >= size_) i = static_cast<uint32_t>(size_ - 1);
+
+        // 1. 当前 word 内查找 (保留 [0, i&63] 位)
+        uint32_t w = i >> 6;
+        uint64_t m = words_[w] & low_mask_inclusive(i & 63);
+        if (m) {
+            return static_cast<int32_t>((w << 6) + 63 - __builtin_clzll(m));
+        }
+
+        // 2. 通过 summary 跳到上一个非空 word
+        if (w == 0) return -1;
+        uint32_t pw = w - 1;
+        int32_t s = static_cast<int32_t>(pw >> 6);
+        uint64_t sm = summary_[s] & low_mask_inclusive(pw & 63);
+        while (true) {
+            if (sm) {
+                uint32_t w2 = (static_cast<uint32_t>(s) << 6) + 63 - __builtin_clzll(sm);
+                return static_cast<int32_t>((w2 << 6) + 63 - __builtin_clzll(words_[w2]));
+            }
+            if (--s < 0) return -1;
+            sm = summary_[s];
+        }
+    }
+
+    /**
+     * @brief 清空所有 bit (保留大小)
+     */
+    void clear_all() {
+        std::fill(words_.begin(), words_.end(), 0);
+        std::fill(summary_.begin(), summary_.end(), 0);
+    }
+
+private:
+    static uint64_t low_mask_inclusive(uint32_t bit) {
+        return (bit == 63) ? ~0ULL : ((1ULL << (bit + 1)) - 1);
+    }
+
+    size_t size_ = 0;
+    std::vector<uint64_t> words_;    // 叶子层：每 bit 一个档位
+    std::vector<uint64_t> summary_;  // 汇总层：每 bit 一个叶子 word 是否非空
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 主力资金流向 (按母单规模分档的流入/流出)
+ *
+ * 每笔成交按买方、卖方母单 (委托) 的原始规模分别归档：
+ *   买方母单所在档 += 成交额 (流入)，卖方母单所在档 += 成交额 (流出)。
+ * 母单规模 = 母单原始委托量 × 成交价，按可配置的金额阈值分为 小/中/大/特大 四档。
+ *
+ * 金额单位与订单簿价格一致 (价格 × 10000 的整数乘以股数)，阈值配置以元为单位，
+ * 由 MoneyFlowBuckets::from_yuan 换算。
+ */
+struct MoneyFlowBuckets {
+    static constexpr int COUNT = 4;           // 小单 / 中单 / 大单 / 特大单
+    static constexpr uint64_t PRICE_SCALE = 10000;
+
+    // 各档下限 (第 0 档下限为 0)，单位同成交额 (价格 × 股数)
+    uint64_t lower[COUNT] = {0, 40000 * PRICE_SCALE, 200000 * PRICE_SCALE, 1000000 * PRICE_SCALE};
+
+    // 按元配置三个分界 (小/中、中/大、大/特大)
+    static MoneyFlowBuckets from_yuan(uint64_t medium, uint64_t large, uint64_t xlarge) {
+        MoneyFlowBuckets b;
+        b.lower[1] = medium * PRICE_SCALE;
+        b.lower[2] = large * PRICE_SCALE;
+        b.lower[3] = xlarge * PRICE_SCALE;
+        return b;
+    }
+
+    // 解析 "40000,200000,1000000" (元)；格式错误或非递增返回 false
+    static bool parse(const std::string& text, MoneyFlowBuckets& out) {
+        std::vector<uint64_t> values;
+        size_t pos = 0;
+        while (pos <= text.size()) {
+            size_t comma = text.find(',', pos);
+            std::string item = text.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+            if (item.empty() || item.find_first_not_of("0123456789 ") != std::string::npos) return false;
+            values.push_back(std::stoull(item));
+            if (comma == std::string::npos) break;
+            pos = comma + 1;
+        }
+        if (values.size() != COUNT - 1 || values[0] == 0 || values[0] >= values[1] || values[1] >= values[2]) {
+            return false;
+        }
+        out = from_yuan(values[0], values[1], values[2]);
+        return true;
+    }
+
+    int classify(uint64_t amount) const {
+        int b = 0;
+        while (b + 1 < COUNT && amount >= lower[b + 1]) ++b;
+        return b;
+    }
+};
+
+// 单只股票累计值，读取 O(1)
+struct MoneyFlow {
+    uint64_t inflow[MoneyFlowBuckets::COUNT] = {0, 0, 0, 0};          // 买方母单所在档的成交额
+    uint64_t outflow[MoneyFlowBuckets::COUNT] = {0, 0, 0, 0};         // 卖方母单所在档的成交额
+    uint64_t inflow_volume[MoneyFlowBuckets::COUNT] = {0, 0, 0, 0};   // 对应成交量 (股)
+    uint64_t outflow_volume[MoneyFlowBuckets::COUNT] = {0, 0, 0, 0};
+    uint64_t trades = 0;
+
+    int64_t net(int bucket) const {
+        return static_cast<int64_t>(inflow[bucket]) - static_cast<int64_t>(outflow[bucket]);
+    }
+
+    // 主力净流入 (大单 + 特大单)，单位同成交额
+    int64_t main_net() const { return net(2) + net(3); }
+
+    // 成交额换算为元
+    static double to_yuan(int64_t amount) {
+        return static_cast<double>(amount) / static_cast<double>(MoneyFlowBuckets::PRICE_SCALE);
+    }
+};
@@ -1,29 +1,109 @@
 #pragma once
 
+#include <sys/mman.h>
 #include <vector>
+#include <new>
+#include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <stdexcept>
+#include <type_traits>
 
 /**
- * @brief 通用对象池实现
- * 
- * 使用 std::vector 作为底层存储，结合空闲链表（Free List）实现对象的复用。
- * 对象 T 需要是可默认构造的。
- * 
+ * @brief 对象池内存选项
+ *
+ * huge_pages:
+ *   None    - 普通匿名映射 (4KB 页)
+ *   THP     - 普通映射 + madvise(MADV_HUGEPAGE)，由内核透明大页合并
+ *   HugeTLB - MAP_HUGETLB 预留大页；系统未预留 (vm.nr_hugepages) 时回退为 THP
+ * prefault: 分配块时立即缺页 (MAP_POPULATE)，避免开盘时在热路径上触发缺页
+ */
+struct ObjectPoolOptions {
+    enum class HugePages : uint8_t {
+        None = 0,
+        THP = 1,
+        HugeTLB = 2
+    };
+
+    HugePages huge_pages = HugePages::None;
+    bool prefault = false;
+};
+
+/**
+ * @brief 通用对象池实现 (分段、地址稳定)
+ *
+ * 底层按固定大小的块 (CHUNK_SIZE 个对象) 分段存储，容量不足时追加新块，
+ * 已分配对象永不移动 (不会像 std::vector 扩容那样整体拷贝)，结合空闲链表（Free List）实现对象的复用。
+ * 每块单独 mmap，可选大页与预缺页。对象 T 需要是可默认构造的。
+ *
+ * 下标 idx 的定位: chunks_[idx >> CHUNK_SHIFT][idx & CHUNK_MASK]
+ *
+ * Arena (按订单簿亲和分配)：
+ *   多个订单簿共用一个池时，每个订单簿持有一个 Arena，以 slab (SLAB_SIZE 个连续对象) 为单位向池申请，
+ *   自己的空闲对象只在自己的 slab 内复用，同一只股票的队列节点集中在少数几段连续内存中。
+ *   Arena 释放 (release) 时 slab 整体归还池，供其他 Arena 复用。
+ *
  * @tparam T 对象类型
  */
 template <typename T>
 class ObjectPool {
 public:
+    // 大页大小 (x86_64 默认 2MB)，块映射长度按此取整以满足 MAP_HUGETLB 要求
+    static constexpr size_t HUGE_PAGE_SIZE = size_t(2) << 20;
+
+    // 每个 slab 1024 个对象 (16 字节 OrderNode 为 16KB)，CHUNK_SIZE 的整数分之一，slab 不跨块、内存连续
+    static constexpr uint32_t SLAB_SHIFT = 10;
+    static constexpr size_t SLAB_SIZE = size_t(1) << SLAB_SHIFT;
+
+    // 每块对象数取 2 的幂，使一块不超过一个大页 (16 字节 OrderNode 为 131072 个，恰好 2MB)
+    static constexpr uint32_t CHUNK_SHIFT = [] {
+        uint32_t shift = SLAB_SHIFT;
+        while ((sizeof(T) << (shift + 1)) <= HUGE_PAGE_SIZE) ++shift;
+        return shift;
+    }();
+    static constexpr size_t CHUNK_SIZE = size_t(1) << CHUNK_SHIFT;
+    static constexpr size_t CHUNK_MASK = CHUNK_SIZE - 1;
+    static_assert(CHUNK_SIZE % SLAB_SIZE == 0, "slab must not straddle chunks");
+
+    /**
+     * @brief 订单簿私有的分配区 (由使用者持有，池只负责 slab 的申请与回收)
+     */
+    struct Arena {
+        std::vector<int32_t> free_list;   // 本 Arena 释放的对象
+        std::vector<int32_t> slabs;       // 持有的 slab 起始下标
+        std::vector<int32_t> reserved;    // 已预留 (已计入 slabs) 但尚未启用的 slab
+        int32_t bump = 0;                 // 当前 slab 中下一个未用下标
+        int32_t bump_end = 0;
+
+        size_t slab_count() const { return slabs.size(); }
+    };
+
     /**
      * @brief 构造函数
-     * @param initial_capacity 初始容量，避免频繁扩容
+     * @param initial_capacity 初始容量，启动时一次性映射足够的块
+     * @param options 大页/预缺页选项
      */
-    explicit ObjectPool(size_t initial_capacity = 100000) {
-        pool_.reserve(initial_capacity);
+    explicit ObjectPool(size_t initial_capacity = 100000, ObjectPoolOptions options = {})
+        : options_(options) {
         free_list_.reserve(initial_capacity);
+        size_t chunks = (initial_capacity + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        if (chunks == 0) chunks = 1;
+        for (size_t i = 0; i < chunks; ++i) {
+            if (!add_chunk()) throw std::bad_alloc();
+        }
+    }
+
+    ~ObjectPool() {
+        destroy_all();
+        for (T* chunk : chunks_) {
+            ::munmap(chunk, chunk_bytes());
+        }
     }
 
+    // 持有裸映射，禁止拷贝/移动
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
     /**
      * @brief 分配一个对象
      * @return 对象的索引 (idx)。如果分配失败返回 -1。
@@ -35,16 +115,21 @@ public:
             free_list_.pop_back();
             return idx;
         }
-        
+
         // 2. 检查容量上限 (int32_t 限制)
-        if (pool_.size() >= static_cast<size_t>(INT32_MAX)) {
-            return -1; 
+        if (size_ >= static_cast<size_t>(INT32_MAX)) {
+            return -1;
+        }
+
+        // 3. 当前块用完时追加新块 (已有对象不移动)
+        if (size_ == chunks_.size() * CHUNK_SIZE && !add_chunk()) {
+            return -1;
         }
-        
-        // 3. 新增对象
-        // 注意：这里可能会触发 vector 扩容
-        pool_.emplace_back();
-        return static_cast<int32_t>(pool_.size() - 1);
+
+        // 4. 新增对象
+        T* slot = &chunks_[size_ >> CHUNK_SHIFT][size_ & CHUNK_MASK];
+        new (slot) T();
+        return static_cast<int32_t>(size_++);
     }
 
     /**
@@ -52,60 +137,248 @@ public:
      * @param idx 对象索引
      */
     void free(int32_t idx) {
-        if (idx < 0 || static_cast<size_t>(idx) >= pool_.size()) {
+        if (idx < 0 || static_cast<size_t>(idx) >= size_) {
             return;
         }
         free_list_.push_back(idx);
     }
 
     /**
-     * @brief 获取对象引用
+     * @brief 从 Arena 分配一个对象：先复用 Arena 的空闲对象，再用当前 slab，最后向池申请新 slab
+     * @return 对象的索引 (idx)。如果分配失败返回 -1。
+     */
+    int32_t alloc(Arena& arena) {
+        if (!arena.free_list.empty()) {
+            int32_t idx = arena.free_list.back();
+            arena.free_list.pop_back();
+            return idx;
+        }
+        if (arena.bump == arena.bump_end) {
+            int32_t base;
+            if (!arena.reserved.empty()) {
+                base = arena.reserved.back();
+                arena.reserved.pop_back();
+            } else {
+                base = acquire_slab();
+                if (base < 0) return -1;
+                arena.slabs.push_back(base);
+            }
+            arena.bump = base;
+            arena.bump_end = base + static_cast<int32_t>(SLAB_SIZE);
+        }
+        return arena.bump++;
+    }
+
+    /**
+     * @brief 预留 slab，保证此后从 Arena 连续分配 count 个对象不会失败
+     * @return 池无法提供足够 slab 时返回 false，本次申请的 slab 全部退回池 (Arena 不变)
+     */
+    bool reserve(Arena& arena, size_t count) {
+        size_t available = arena.free_list.size() + static_cast<size_t>(arena.bump_end - arena.bump) +
+                           arena.reserved.size() * SLAB_SIZE;
+        std::vector<int32_t> acquired;
+        while (available < count) {
+            int32_t base = acquire_slab();
+            if (base < 0) {
+                free_slabs_.insert(free_slabs_.end(), acquired.begin(), acquired.end());
+                return false;
+            }
+            acquired.push_back(base);
+            available += SLAB_SIZE;
+        }
+        // 逆序压入，按申请顺序启用
+        arena.slabs.insert(arena.slabs.end(), acquired.begin(), acquired.end());
+        arena.reserved.insert(arena.reserved.begin(), acquired.rbegin(), acquired.rend());
+        return true;
+    }
+
+    /**
+     * @brief 归还对象到 Arena 的空闲链表
+     */
+    void free(Arena& arena, int32_t idx) {
+        assert(idx >= 0 && static_cast<size_t>(idx) < size_);
+        arena.free_list.push_back(idx);
+    }
+
+    /**
+     * @brief 将 Arena 持有的全部 slab 归还池 (Arena 内对象全部失效)
+     */
+    void release(Arena& arena) {
+        free_slabs_.insert(free_slabs_.end(), arena.slabs.begin(), arena.slabs.end());
+        arena.slabs.clear();
+        arena.reserved.clear();
+        arena.free_list.clear();
+        arena.bump = arena.bump_end = 0;
+    }
+
+    /**
+     * @brief 池中空闲 (已归还) 的 slab 数
+     */
+    size_t free_slab_count() const {
+        return free_slabs_.size();
+    }
+
+    /**
+     * @brief 热路径访问：不做边界检查 (仅 Debug 构建 assert)
+     * @param idx 对象索引，调用方保证有效
+     */
+    T& operator[](int32_t idx) {
+        assert(idx >= 0 && static_cast<size_t>(idx) < size_);
+        return chunks_[static_cast<uint32_t>(idx) >> CHUNK_SHIFT][static_cast<uint32_t>(idx) & CHUNK_MASK];
+    }
+
+    const T& operator[](int32_t idx) const {
+        assert(idx >= 0 && static_cast<size_t>(idx) < size_);
+        return chunks_[static_cast<uint32_t>(idx) >> CHUNK_SHIFT][static_cast<uint32_t>(idx) & CHUNK_MASK];
+    }
+
+    /**
+     * @brief 获取对象引用 (带边界检查，非热路径使用)
      * @param idx 对象索引
-     * @return T& 
+     * @return T&
      */
     T& get(int32_t idx) {
         // 简单的边界检查
-        if (idx < 0 || static_cast<size_t>(idx) >= pool_.size()) {
+        if (idx < 0 || static_cast<size_t>(idx) >= size_) {
             throw std::out_of_range("ObjectPool index out of range");
         }
-        return pool_[idx];
+        return (*this)[idx];
     }
 
     /**
      * @brief 获取对象常量引用
      * @param idx 对象索引
-     * @return const T& 
+     * @return const T&
      */
     const T& get(int32_t idx) const {
-        if (idx < 0 || static_cast<size_t>(idx) >= pool_.size()) {
+        if (idx < 0 || static_cast<size_t>(idx) >= size_) {
             throw std::out_of_range("ObjectPool index out of range");
         }
-        return pool_[idx];
+        return (*this)[idx];
     }
 
     /**
-     * @brief 获取底层 vector 的大小（包含已分配和未使用的空洞）
+     * @brief 已使用过的下标数量（包含已分配和未使用的空洞）
      */
     size_t size() const {
-        return pool_.size();
+        return size_;
+    }
+
+    /**
+     * @brief 已映射的对象容量 (块数 * CHUNK_SIZE)
+     */
+    size_t capacity() const {
+        return chunks_.size() * CHUNK_SIZE;
+    }
+
+    /**
+     * @brief 已映射的块数
+     */
+    size_t chunk_count() const {
+        return chunks_.size();
+    }
+
+    /**
+     * @brief 以 MAP_HUGETLB 映射成功的块数 (用于确认大页是否生效)
+     */
+    size_t hugetlb_chunk_count() const {
+        return hugetlb_chunks_;
     }
-    
+
     /**
      * @brief 获取当前空闲对象的数量
      */
     size_t free_count() const {
         return free_list_.size();
     }
-    
+
     /**
-     * @brief 清空对象池
+     * @brief 清空对象池 (保留已映射的块，下标从 0 重新分配)
      */
     void clear() {
-        pool_.clear();
+        destroy_all();
+        size_ = 0;
         free_list_.clear();
+        free_slabs_.clear();
     }
 
 private:
-    std::vector<T> pool_;
+    size_t chunk_bytes() const {
+        size_t bytes = CHUNK_SIZE * sizeof(T);
+        return (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    }
+
+    // 映射一个新块；HugeTLB 失败时回退到普通映射 + THP
+    bool add_chunk() {
+        const size_t bytes = chunk_bytes();
+        const int populate = options_.prefault ? MAP_POPULATE : 0;
+        void* p = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+        if (options_.huge_pages == ObjectPoolOptions::HugePages::HugeTLB) {
+            p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | populate, -1, 0);
+            if (p != MAP_FAILED) ++hugetlb_chunks_;
+        }
+#endif
+        if (p == MAP_FAILED) {
+            p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | (options_.huge_pages == ObjectPoolOptions::HugePages::None ? populate : 0),
+                       -1, 0);
+            if (p == MAP_FAILED) return false;
+#ifdef MADV_HUGEPAGE
+            if (options_.huge_pages != ObjectPoolOptions::HugePages::None) {
+                // 先 madvise 再缺页，才能直接拿到透明大页
+                ::madvise(p, bytes, MADV_HUGEPAGE);
+                if (options_.prefault) prefault(p, bytes);
+            }
+#endif
+        }
+
+        chunks_.push_back(static_cast<T*>(p));
+        return true;
+    }
+
+    // 申请一个 slab：优先复用已归还的 slab，否则按 SLAB_SIZE 对齐从尾部切出
+    // (对齐跳过的下标交给全局空闲链表)。slab 内对象全部重新初始化
+    int32_t acquire_slab() {
+        if (!free_slabs_.empty()) {
+            int32_t base = free_slabs_.back();
+            free_slabs_.pop_back();
+            for (size_t i = 0; i < SLAB_SIZE; ++i) (*this)[base + static_cast<int32_t>(i)] = T();
+            return base;
+        }
+
+        size_t base = (size_ + SLAB_SIZE - 1) & ~(SLAB_SIZE - 1);
+        if (base + SLAB_SIZE > static_cast<size_t>(INT32_MAX)) return -1;
+        while (chunks_.size() * CHUNK_SIZE < base + SLAB_SIZE) {
+            if (!add_chunk()) return -1;
+        }
+        for (size_t i = size_; i < base + SLAB_SIZE; ++i) {
+            new (&chunks_[i >> CHUNK_SHIFT][i & CHUNK_MASK]) T();
+            if (i < base) free_list_.push_back(static_cast<int32_t>(i));
+        }
+        size_ = base + SLAB_SIZE;
+        return static_cast<int32_t>(base);
+    }
+
+    static void prefault(void* p, size_t bytes) {
+        volatile char* c = static_cast<volatile char*>(p);
+        for (size_t off = 0; off < bytes; off += 4096) c[off] = 0;
+    }
+
+    void destroy_all() {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (size_t i = 0; i < size_; ++i) {
+                (*this)[static_cast<int32_t>(i)].~T();
+            }
+        }
+    }
+
+    std::vector<T*> chunks_;          // 块指针表 (扩容只移动指针，不移动对象)
     std::vector<int32_t> free_list_;
+    std::vector<int32_t> free_slabs_;  // Arena 归还的 slab
+    size_t size_ = 0;                 // 已使用过的下标上界
+    size_t hugetlb_chunks_ = 0;
+    ObjectPoolOptions options_;
 };
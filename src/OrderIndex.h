@@ -0,0 +1,256 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief 订单索引：Seq -> Pool Index 的开放寻址哈希表
+ *
+ * 针对 FastOrderBook 的订单索引定制，替代 std::unordered_map<uint64_t, int32_t>：
+ * - 键值对内联存储在连续数组中 (16 字节/槽)，查找无指针跳转
+ * - 每槽附带 32 位 aux (占用对齐填充，不增加槽大小)，供调用方随键存放少量元数据
+ * - 线性探测 + 16 字节控制字节组 (SSE2 一次比较 16 个槽的 7-bit 指纹)
+ * - 删除使用 backward-shift，不产生墓碑，长时间运行探测链不退化
+ * - 从小容量起步，按 2 倍扩容，内存随该股票实际挂单数增长
+ *
+ * 控制字节: 0 = 空槽，0x80 | h7 = 占用 (h7 为哈希的 7-bit 指纹)。
+ * 控制数组尾部额外镜像前 GROUP_SIZE-1 个字节，使任意位置起的 16 字节组加载无需回绕。
+ */
+class OrderIndexMap {
+public:
+    static constexpr size_t GROUP_SIZE = 16;
+    static constexpr size_t MIN_CAPACITY = 16;
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+    struct Slot {
+        uint64_t key;
+        int32_t value;
+        uint32_t aux;
+    };
+
+    explicit OrderIndexMap(size_t initial_capacity = DEFAULT_CAPACITY) {
+        init(round_up_capacity(initial_capacity));
+    }
+
+    /**
+     * @brief 查找
+     * @return 指向 value 的指针，不存在返回 nullptr
+     */
+    int32_t* find(uint64_t key) {
+        size_t pos = find_pos(key);
+        return pos == NPOS ? nullptr : &slots_[pos].value;
+    }
+
+    const int32_t* find(uint64_t key) const {
+        size_t pos = find_pos(key);
+        return pos == NPOS ? nullptr : &slots_[pos].value;
+    }
+
+    /**
+     * @brief 查找整个槽位 (value + aux)
+     * @return 槽位指针，不存在返回 nullptr；任何插入/删除后失效
+     */
+    const Slot* find_slot(uint64_t key) const {
+        size_t pos = find_pos(key);
+        return pos == NPOS ? nullptr : &slots_[pos];
+    }
+
+    bool contains(uint64_t key) const {
+        return find_pos(key) != NPOS;
+    }
+
+    /**
+     * @brief 插入或覆盖 (value 与 aux 一并覆盖)
+     */
+    void insert(uint64_t key, int32_t value, uint32_t aux = 0) {
+        size_t pos = find_pos(key);
+        if (pos != NPOS) {
+            slots_[pos].value = value;
+            slots_[pos].aux = aux;
+            return;
+        }
+
+        // 负载因子上限 3/4，超过则 2 倍扩容
+        if ((size_ + 1) * 4 > capacity_ * 3) {
+            rehash(capacity_ * 2);
+        }
+        insert_new(key, value, aux);
+    }
+
+    /**
+     * @brief 删除 (backward-shift，无墓碑)
+     * @return 是否删除成功
+     */
+    bool erase(uint64_t key) {
+        size_t pos = find_pos(key);
+        if (pos == NPOS) return false;
+        erase_at(pos);
+        return true;
+    }
+
+    /**
+     * @brief 预留容量 (保证 n 个元素不触发扩容)
+     */
+    void reserve(size_t n) {
+        size_t need = round_up_capacity((n * 4 + 2) / 3);
+        if (need > capacity_) rehash(need);
+    }
+
+    void clear() {
+        std::memset(ctrl_.data(), 0, ctrl_.size());
+        size_ = 0;
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t capacity() const { return capacity_; }
+
+    /**
+     * @brief 占用内存 (字节)
+     */
+    size_t memory_bytes() const {
+        return slots_.size() * sizeof(Slot) + ctrl_.size();
+    }
+
+    /**
+     * @brief 遍历所有元素，fn(key, value)
+     */
+    template<typename Fn>
+    void for_each(Fn&& fn) const {
+        for (size_t i = 0; i < capacity_; ++i) {
+            if (ctrl_[i] != EMPTY) fn(slots_[i].key, slots_[i].value);
+        }
+    }
+
+private:
+    static constexpr size_t NPOS = static_cast<size_t>(-1);
+    static constexpr uint8_t EMPTY = 0;
+
+    std::vector<Slot> slots_;
+    std::vector<uint8_t> ctrl_;   // capacity_ + GROUP_SIZE - 1
+    size_t capacity_ = 0;         // 2 的幂
+    size_t mask_ = 0;
+    uint32_t shift_ = 0;          // 64 - log2(capacity_)
+    size_t size_ = 0;
+
+    static size_t round_up_capacity(size_t n) {
+        size_t cap = MIN_CAPACITY;
+        while (cap < n) cap <<= 1;
+        return cap;
+    }
+
+    void init(size_t cap) {
+        capacity_ = cap;
+        mask_ = cap - 1;
+        shift_ = 64 - static_cast<uint32_t>(__builtin_ctzll(cap));
+        slots_.assign(cap, Slot{0, -1, 0});
+        ctrl_.assign(cap + GROUP_SIZE - 1, EMPTY);
+        size_ = 0;
+    }
+
+    // Fibonacci 哈希：高位决定起始槽，另取 7 bit 作为指纹
+    static uint64_t hash(uint64_t key) {
+        return key * 0x9E3779B97F4A7C15ULL;
+    }
+
+    size_t home(uint64_t h) const {
+        return static_cast<size_t>(h >> shift_);
+    }
+
+    static uint8_t tag(uint64_t h) {
+        return static_cast<uint8_t>(0x80 | ((h >> 24) & 0x7F));
+    }
+
+    void set_ctrl(size_t i, uint8_t v) {
+        ctrl_[i] = v;
+        if (i < GROUP_SIZE - 1) ctrl_[capacity_ + i] = v;
+    }
+
+    // 返回 16 字节组中等于 v 的位掩码
+    uint32_t match_group(size_t pos, uint8_t v) const {
+#if defined(__SSE2__)
+        __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl_.data() + pos));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(static_cast<char>(v)))));
+#else
+        uint32_t m = 0;
+        for (size_t i = 0; i < GROUP_SIZE; ++i) {
+            if (ctrl_[pos + i] == v) m |= (1u << i);
+        }
+        return m;
+#endif
+    }
+
+    size_t find_pos(uint64_t key) const {
+        uint64_t h = hash(key);
+        uint8_t t = tag(h);
+        size_t pos = home(h);
+
+        while (true) {
+            uint32_t empty = match_group(pos, EMPTY);
+            uint32_t match = match_group(pos, t);
+            // 线性探测无墓碑：键只可能出现在第一个空槽之前
+            if (empty) match &= (empty & (~empty + 1)) - 1;
+            while (match) {
+                size_t i = (pos + __builtin_ctz(match)) & mask_;
+                if (slots_[i].key == key) return i;
+                match &= match - 1;
+            }
+            if (empty) return NPOS;
+            pos = (pos + GROUP_SIZE) & mask_;
+        }
+    }
+
+    void insert_new(uint64_t key, int32_t value, uint32_t aux) {
+        uint64_t h = hash(key);
+        size_t pos = home(h);
+        while (true) {
+            uint32_t empty = match_group(pos, EMPTY);
+            if (empty) {
+                size_t i = (pos + __builtin_ctz(empty)) & mask_;
+                set_ctrl(i, tag(h));
+                slots_[i].key = key;
+                slots_[i].value = value;
+                slots_[i].aux = aux;
+                ++size_;
+                return;
+            }
+            pos = (pos + GROUP_SIZE) & mask_;
+        }
+    }
+
+    void erase_at(size_t hole) {
+        // Backward-shift：把后续探测链上可以前移的元素搬到空洞，保持"键在首个空槽之前"
+        size_t j = hole;
+        while (true) {
+            j = (j + 1) & mask_;
+            if (ctrl_[j] == EMPTY) break;
+            size_t k = home(hash(slots_[j].key));
+            // 元素 j 的起始槽 k 不在 (hole, j] 区间内 (循环意义) 时才能前移
+            bool movable = (hole <= j) ? (k <= hole || k > j) : (k <= hole && k > j);
+            if (movable) {
+                slots_[hole] = slots_[j];
+                set_ctrl(hole, ctrl_[j]);
+                hole = j;
+            }
+        }
+        set_ctrl(hole, EMPTY);
+        --size_;
+    }
+
+    void rehash(size_t new_cap) {
+        std::vector<Slot> old_slots = std::move(slots_);
+        std::vector<uint8_t> old_ctrl = std::move(ctrl_);
+        size_t old_cap = capacity_;
+
+        init(new_cap);
+        for (size_t i = 0; i < old_cap; ++i) {
+            if (old_ctrl[i] != EMPTY) insert_new(old_slots[i].key, old_slots[i].value, old_slots[i].aux);
+        }
+    }
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "OrderIndex.h"
+
+/**
+ * @brief 单个价格档位的排队前缀和索引 (Fenwick 树)
+ *
+ * 档位内订单按进入队列的先后分配位置 (只增不复用)，对位置维护两棵 Fenwick 树：
+ * 剩余量与在册单数。由此 O(log n) 回答：
+ *   - 某订单前方/后方的挂单量与单数
+ *   - 前 k 个订单的累计量
+ *
+ * 订单完结后位置留空 (量与单数清零)；位置用满时若在册单数不足一半，
+ * append 返回 false，由调用方按链表顺序 reset + 逐个 append 重建 (位置重新紧凑)，
+ * 否则原地 2 倍扩容 (Fenwick 树扩容只需把新的根节点置为全体之和)。
+ *
+ * 树中按 uint64 模运算累加，撤单/成交的减量以补码加入，前缀和结果始终非负。
+ */
+class QueueIndex {
+public:
+    static constexpr uint32_t MIN_CAPACITY = 64;
+
+    explicit QueueIndex(uint32_t capacity = MIN_CAPACITY) : positions_(OrderIndexMap::MIN_CAPACITY) {
+        reset(capacity);
+    }
+
+    // 清空并按至少 capacity 个位置重新分配
+    void reset(uint32_t capacity) {
+        capacity_ = MIN_CAPACITY;
+        while (capacity_ < capacity) capacity_ <<= 1;
+        volume_tree_.assign(capacity_ + 1, 0);
+        count_tree_.assign(capacity_ + 1, 0);
+        positions_.clear();
+        next_pos_ = 0;
+        live_ = 0;
+        total_volume_ = 0;
+    }
+
+    // 订单进入队尾；位置用满且空洞过半时返回 false (未登记)，调用方需重建
+    bool append(uint64_t seq, uint64_t volume) {
+        if (next_pos_ == capacity_) {
+            if (live_ * 2 <= capacity_) return false;
+            grow();
+        }
+        uint32_t pos = next_pos_++;
+        positions_.insert(seq, static_cast<int32_t>(pos));
+        add(pos, volume, 1);
+        ++live_;
+        total_volume_ += volume;
+        return true;
+    }
+
+    // 订单量减少 delta (成交/部分撤单)；finished 表示订单已完结，位置清空
+    void reduce(uint64_t seq, uint64_t delta, bool finished) {
+        const int32_t* pos = positions_.find(seq);
+        if (!pos) return;
+        add(static_cast<uint32_t>(*pos), 0 - delta, finished ? UINT64_MAX : 0);
+        total_volume_ -= delta;
+        if (finished) {
+            positions_.erase(seq);
+            --live_;
+        }
+    }
+
+    // 订单在队列中的位置，不在本档位返回 -1
+    int32_t position_of(uint64_t seq) const {
+        const int32_t* pos = positions_.find(seq);
+        return pos ? *pos : -1;
+    }
+
+    // 位置 [0, pos) 的累计量/单数，即 pos 处订单前方的挂单
+    uint64_t volume_before(uint32_t pos) const { return prefix(volume_tree_, pos); }
+    uint32_t count_before(uint32_t pos) const { return static_cast<uint32_t>(prefix(count_tree_, pos)); }
+
+    // 前 k 个在册订单的累计量 (k 超过在册单数时为全部挂单量)
+    uint64_t volume_of_first(uint32_t k) const {
+        if (k == 0) return 0;
+        if (k >= live_) return total_volume_;
+        // Fenwick 下降：找单数前缀和 < k 的最长前缀，第 k 个订单就在其后一个位置
+        uint32_t idx = 0;
+        uint64_t remaining = k;
+        for (uint32_t step = capacity_; step > 0; step >>= 1) {
+            uint32_t next = idx + step;
+            if (next <= capacity_ && count_tree_[next] < remaining) {
+                idx = next;
+                remaining -= count_tree_[next];
+            }
+        }
+        return prefix(volume_tree_, idx + 1);
+    }
+
+    uint64_t total_volume() const { return total_volume_; }
+    uint32_t live_count() const { return live_; }
+    uint32_t capacity() const { return capacity_; }
+
+private:
+    // 位置 pos (0 起) 处加上 volume/count (补码表示负数)
+    void add(uint32_t pos, uint64_t volume, uint64_t count) {
+        for (uint32_t i = pos + 1; i <= capacity_; i += i & (0 - i)) {
+            volume_tree_[i] += volume;
+            count_tree_[i] += count;
+        }
+    }
+
+    static uint64_t prefix(const std::vector<uint64_t>& tree, uint32_t pos) {
+        uint64_t sum = 0;
+        for (uint32_t i = pos; i > 0; i -= i & (0 - i)) sum += tree[i];
+        return sum;
+    }
+
+    // 容量翻倍：原有节点覆盖的区间不变，新增的根节点覆盖 [1, 2C]，等于全体之和
+    void grow() {
+        uint32_t cap = capacity_ * 2;
+        volume_tree_.resize(cap + 1, 0);
+        count_tree_.resize(cap + 1, 0);
+        volume_tree_[cap] = total_volume_;
+        count_tree_[cap] = live_;
+        capacity_ = cap;
+    }
+
+    std::vector<uint64_t> volume_tree_;    // 1 起下标，[0] 不用
+    std::vector<uint64_t> count_tree_;
+    OrderIndexMap positions_;              // seq -> 位置
+    uint32_t capacity_ = 0;                // 2 的幂
+    uint32_t next_pos_ = 0;
+    uint32_t live_ = 0;
+    uint64_t total_volume_ = 0;
+};
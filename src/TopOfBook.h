@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// 一档行情快照 (读者拿到的一致副本)
+struct TopOfBook {
+    uint32_t bid_price = 0;      // 0 表示无买盘
+    uint32_t ask_price = 0;      // 0 表示无卖盘
+    uint64_t bid_volume = 0;
+    uint64_t ask_volume = 0;
+    uint32_t last_price = 0;     // 最近成交价 (0 表示发布以来尚无成交)
+    uint64_t last_volume = 0;
+    int64_t applseqnum = 0;      // 最近处理的逐笔序号
+    uint64_t version = 0;        // 发布次数 (0 表示从未发布)
+};
+
+/**
+ * @brief seqlock 发布的一档快照 (单写多读)
+ *
+ * 写者为订单簿所属 worker，每条逐笔处理完后发布；读者 (ZMQ 命令线程、监控、下单前校验)
+ * 无锁读取，不触碰 worker 的队列与订单簿内部结构。
+ *
+ * 写：seq 置奇数 -> release 栅栏 -> 写字段 -> seq 置偶数 (release)
+ * 读：acquire 读 seq (奇数则重试) -> 读字段 -> acquire 栅栏 -> 复读 seq，前后一致则副本有效
+ * 字段均为 relaxed 原子量，避免数据竞争的未定义行为；x86 上即普通 mov。
+ * 写者从不等待读者；读者只在与写者重叠时重试。
+ */
+class SeqlockTopOfBook {
+public:
+    void publish(const TopOfBook& t) {
+        uint64_t s = seq_.load(std::memory_order_relaxed);
+        seq_.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        prices_.store(static_cast<uint64_t>(t.bid_price) << 32 | t.ask_price, std::memory_order_relaxed);
+        bid_volume_.store(t.bid_volume, std::memory_order_relaxed);
+        ask_volume_.store(t.ask_volume, std::memory_order_relaxed);
+        last_price_.store(t.last_price, std::memory_order_relaxed);
+        last_volume_.store(t.last_volume, std::memory_order_relaxed);
+        applseqnum_.store(t.applseqnum, std::memory_order_relaxed);
+        seq_.store(s + 2, std::memory_order_release);
+    }
+
+    // 单次尝试：与写者重叠时返回 false
+    bool try_read(TopOfBook& out) const {
+        uint64_t s1 = seq_.load(std::memory_order_acquire);
+        if (s1 & 1) return false;
+        uint64_t prices = prices_.load(std::memory_order_relaxed);
+        out.bid_price = static_cast<uint32_t>(prices >> 32);
+        out.ask_price = static_cast<uint32_t>(prices);
+        out.bid_volume = bid_volume_.load(std::memory_order_relaxed);
+        out.ask_volume = ask_volume_.load(std::memory_order_relaxed);
+        out.last_price = last_price_.load(std::memory_order_relaxed);
+        out.last_volume = last_volume_.load(std::memory_order_relaxed);
+        out.applseqnum = applseqnum_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t s2 = seq_.load(std::memory_order_relaxed);
+        out.version = s1 / 2;
+        return s1 == s2;
+    }
+
+    // 读取一致副本 (写者发布间隔远大于写临界区，重试次数极少)
+    TopOfBook read() const {
+        TopOfBook out;
+        while (!try_read(out)) {
+        }
+        return out;
+    }
+
+    bool published() const { return seq_.load(std::memory_order_acquire) != 0; }
+
+private:
+    // 与写者频繁修改的订单簿数据分开缓存行
+    alignas(64) std::atomic<uint64_t> seq_{0};
+    std::atomic<uint64_t> prices_{0};          // bid_price << 32 | ask_price
+    std::atomic<uint64_t> bid_volume_{0};
+    std::atomic<uint64_t> ask_volume_{0};
+    std::atomic<uint32_t> last_price_{0};
+    std::atomic<uint64_t> last_volume_{0};
+    std::atomic<int64_t> applseqnum_{0};
+};
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include <map>
+#include <cstdint>
+#include <cstddef>
+#include <optional>
+#include "DepthKernels.h"
+
+/**
+ * @brief 分价成交量表 (Volume-at-Price Profile)
+ *
+ * 按档位 (tick) 累计当日成交量与成交笔数，按主动方 (tradebsflag) 拆分为
+ * 买方主动 / 卖方主动 / 不明 (集合竞价) 三类。
+ *
+ * 存储与订单簿档位同样分两层：
+ * - 密集区：覆盖已成交的 tick 区间 [lo_, lo_ + size)，SoA 连续数组，O(1) 访问，
+ *           区间求和走 depth_kernels::range_sum (SIMD)。成交落在区间外时按 2 倍扩展，
+ *           日内成交价区间通常只有几十到几百档，扩展次数很少。
+ * - 稀疏区：扩展后跨度会超过 MAX_DENSE_SPAN 的离群成交 (无涨跌幅限制证券的异常价格)，
+ *           记入 std::map，避免按离群价分配巨大数组。
+ *
+ * 只增不减 (成交不可撤销)，除 reset 外没有删除操作。
+ */
+class TradeProfile {
+public:
+    static constexpr uint32_t MAX_DENSE_SPAN = 1u << 16;
+    static constexpr uint32_t MIN_DENSE_SPAN = 64;
+
+    // 主动方 (下标)
+    enum Aggressor : uint8_t {
+        BUY = 0,
+        SELL = 1,
+        UNKNOWN = 2,
+        AGGRESSOR_COUNT = 3
+    };
+
+    // 单档或区间的成交统计
+    struct Stats {
+        uint64_t volume[AGGRESSOR_COUNT] = {0, 0, 0};
+        uint64_t count[AGGRESSOR_COUNT] = {0, 0, 0};
+
+        uint64_t total_volume() const { return volume[BUY] + volume[SELL] + volume[UNKNOWN]; }
+        uint64_t total_count() const { return count[BUY] + count[SELL] + count[UNKNOWN]; }
+
+        void add(const Stats& o) {
+            for (int a = 0; a < AGGRESSOR_COUNT; ++a) {
+                volume[a] += o.volume[a];
+                count[a] += o.count[a];
+            }
+        }
+    };
+
+    // 记录一笔成交
+    void record(int32_t tick, uint64_t volume, Aggressor aggressor) {
+        int32_t slot = dense_slot(tick);
+        if (slot < 0 && grow_to(tick)) slot = dense_slot(tick);
+        if (slot >= 0) {
+            volume_[aggressor][slot] += volume;
+            ++count_[aggressor][slot];
+        } else {
+            Stats& s = sparse_[tick];
+            s.volume[aggressor] += volume;
+            ++s.count[aggressor];
+        }
+        total_volume_ += volume;
+        ++total_count_;
+        if (total_count_ == 1 || tick < low_tick_) low_tick_ = tick;
+        if (total_count_ == 1 || tick > high_tick_) high_tick_ = tick;
+    }
+
+    // 单档统计 O(1)
+    Stats at(int32_t tick) const {
+        Stats s;
+        int32_t slot = dense_slot(tick);
+        if (slot >= 0) {
+            for (int a = 0; a < AGGRESSOR_COUNT; ++a) {
+                s.volume[a] = volume_[a][slot];
+                s.count[a] = count_[a][slot];
+            }
+        } else {
+            auto it = sparse_.find(tick);
+            if (it != sparse_.end()) s = it->second;
+        }
+        return s;
+    }
+
+    // 闭区间 [from, to] 统计：密集区 SIMD 求和 + 稀疏区遍历
+    Stats range(int32_t from, int32_t to) const {
+        Stats s;
+        int32_t lo = from > lo_ ? from : lo_;
+        int32_t hi = to < dense_end() - 1 ? to : dense_end() - 1;
+        if (lo <= hi) {
+            size_t b = static_cast<size_t>(lo - lo_);
+            size_t e = static_cast<size_t>(hi - lo_ + 1);
+            for (int a = 0; a < AGGRESSOR_COUNT; ++a) {
+                s.volume[a] = depth_kernels::range_sum(volume_[a].data(), b, e);
+                s.count[a] = depth_kernels::range_sum(count_[a].data(), b, e);
+            }
+        }
+        for (auto it = sparse_.lower_bound(from); it != sparse_.end() && it->first <= to; ++it) {
+            s.add(it->second);
+        }
+        return s;
+    }
+
+    // 闭区间 [from, to] 的成交量加权平均 tick (区间内无成交返回 nullopt)
+    // 按相对 from 的偏移累加，整数运算无精度损失
+    std::optional<double> vwap_tick(int32_t from, int32_t to) const {
+        if (from > to) return std::nullopt;
+        uint64_t volume = 0;
+        uint64_t weighted = 0;
+        int32_t lo = from > lo_ ? from : lo_;
+        int32_t hi = to < dense_end() - 1 ? to : dense_end() - 1;
+        for (int32_t t = lo; t <= hi; ++t) {
+            size_t slot = static_cast<size_t>(t - lo_);
+            uint64_t v = volume_[BUY][slot] + volume_[SELL][slot] + volume_[UNKNOWN][slot];
+            volume += v;
+            weighted += v * static_cast<uint64_t>(t - from);
+        }
+        for (auto it = sparse_.lower_bound(from); it != sparse_.end() && it->first <= to; ++it) {
+            uint64_t v = it->second.total_volume();
+            volume += v;
+            weighted += v * static_cast<uint64_t>(it->first - from);
+        }
+        if (volume == 0) return std::nullopt;
+        return static_cast<double>(from) + static_cast<double>(weighted) / static_cast<double>(volume);
+    }
+
+    uint64_t total_volume() const { return total_volume_; }
+    uint64_t total_count() const { return total_count_; }
+
+    // 成交过的最低/最高 tick (无成交时返回 nullopt)
+    std::optional<int32_t> low_tick() const { return total_count_ ? std::optional<int32_t>(low_tick_) : std::nullopt; }
+    std::optional<int32_t> high_tick() const { return total_count_ ? std::optional<int32_t>(high_tick_) : std::nullopt; }
+
+    uint32_t dense_span() const { return static_cast<uint32_t>(volume_[BUY].size()); }
+    size_t sparse_count() const { return sparse_.size(); }
+
+    void reset() {
+        for (int a = 0; a < AGGRESSOR_COUNT; ++a) {
+            volume_[a].clear();
+            count_[a].clear();
+        }
+        sparse_.clear();
+        lo_ = 0;
+        total_volume_ = 0;
+        total_count_ = 0;
+        low_tick_ = 0;
+        high_tick_ = 0;
+    }
+
+private:
+    int32_t dense_end() const { return lo_ + static_cast<int32_t>(dense_span()); }
+
+    int32_t dense_slot(int32_t tick) const {
+        uint32_t slot = static_cast<uint32_t>(tick - lo_);
+        return slot < dense_span() ? static_cast<int32_t>(slot) : -1;
+    }
+
+    // 扩展密集区以覆盖 tick (跨度至少翻倍)；超过 MAX_DENSE_SPAN 时返回 false，由稀疏区记录
+    bool grow_to(int32_t tick) {
+        const uint32_t old_span = dense_span();
+        int64_t new_lo, new_hi;   // [new_lo, new_hi)
+        if (old_span == 0) {
+            new_lo = static_cast<int64_t>(tick) - MIN_DENSE_SPAN / 2;
+            new_hi = new_lo + MIN_DENSE_SPAN;
+        } else {
+            new_lo = lo_;
+            new_hi = dense_end();
+            int64_t span = old_span;
+            if (tick < lo_) new_lo = std::min<int64_t>(tick, new_hi - 2 * span);
+            else new_hi = std::max<int64_t>(static_cast<int64_t>(tick) + 1, new_lo + 2 * span);
+        }
+        if (new_lo < 0) new_lo = 0;
+        if (new_hi - new_lo > MAX_DENSE_SPAN) return false;
+
+        const uint32_t span = static_cast<uint32_t>(new_hi - new_lo);
+        const size_t shift = static_cast<size_t>(lo_ - new_lo);
+        for (int a = 0; a < AGGRESSOR_COUNT; ++a) {
+            std::vector<uint64_t> v(span, 0), c(span, 0);
+            for (size_t i = 0; i < old_span; ++i) {
+                v[i + shift] = volume_[a][i];
+                c[i + shift] = count_[a][i];
+            }
+            volume_[a].swap(v);
+            count_[a].swap(c);
+        }
+        lo_ = static_cast<int32_t>(new_lo);
+
+        // 稀疏区中落入新密集区的档位上浮
+        for (auto it = sparse_.lower_bound(lo_); it != sparse_.end() && it->first < dense_end(); it = sparse_.erase(it)) {
+            size_t slot = static_cast<size_t>(it->first - lo_);
+            for (int a = 0; a < AGGRESSOR_COUNT; ++a) {
+                volume_[a][slot] += it->second.volume[a];
+                count_[a][slot] += it->second.count[a];
+            }
+        }
+        return true;
+    }
+
+    std::vector<uint64_t> volume_[AGGRESSOR_COUNT];   // 按主动方拆分，下标 = tick - lo_
+    std::vector<uint64_t> count_[AGGRESSOR_COUNT];
+    std::map<int32_t, Stats> sparse_;
+    int32_t lo_ = 0;
+    uint64_t total_volume_ = 0;
+    uint64_t total_count_ = 0;
+    int32_t low_tick_ = 0;
+    int32_t high_tick_ = 0;
+};
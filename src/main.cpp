@@ -9,6 +9,8 @@
 #include <algorithm>
 #include <csignal>
 #include <atomic>
+#include <sstream>
+#include <vector>
 
 // 引入策略引擎和适配器
 #include "strategy_engine.h"
@@ -249,6 +251,58 @@ static void signal_handler(int signum) {
     }
 }
 
+// ==========================================
+// worker 等待策略与绑核
+// ==========================================
+static void configure_workers(StrategyEngine& engine, const EngineConfig& cfg, quill::Logger* logger) {
+    const int total = engine.shard_count();
+    const int sh_count = engine.shard_config().sh_shard_count;
+    const uint32_t spin_limit = static_cast<uint32_t>(std::max(cfg.worker_spin_limit, 0));
+
+    WaitMode mode;
+    if (!parse_wait_mode(cfg.worker_wait, mode)) {
+        LOG_MODULE_WARNING(logger, MOD_ENGINE, "Unknown worker_wait: {}, using yield", cfg.worker_wait);
+        mode = WaitMode::YIELD;
+    }
+    for (int i = 0; i < total; ++i) engine.set_worker_wait(i, mode, spin_limit);
+
+    // 按分片覆盖："<分片>[-<分片>]:<策略>,..."
+    std::stringstream overrides(cfg.worker_wait_shards);
+    std::string item;
+    while (std::getline(overrides, item, ',')) {
+        size_t colon = item.find(':');
+        std::vector<int> shards;
+        WaitMode shard_mode;
+        if (colon == std::string::npos || !cpu_affinity::parse_cpu_list(item.substr(0, colon), shards) ||
+            !parse_wait_mode(item.substr(colon + 1), shard_mode)) {
+            LOG_MODULE_WARNING(logger, MOD_ENGINE, "Invalid worker_wait_shards entry: {}", item);
+            continue;
+        }
+        for (int shard : shards) {
+            if (shard < total) engine.set_worker_wait(shard, shard_mode, spin_limit);
+        }
+    }
+
+    // 绑核：上海/深圳 worker 按分片顺序，列表不足的分片不绑核
+    std::vector<int> sh_cpus, sz_cpus, gateway_cpus;
+    if (!cpu_affinity::parse_cpu_list(cfg.cpu_sh_workers, sh_cpus) ||
+        !cpu_affinity::parse_cpu_list(cfg.cpu_sz_workers, sz_cpus) ||
+        !cpu_affinity::parse_cpu_list(cfg.cpu_gateway, gateway_cpus)) {
+        LOG_MODULE_WARNING(logger, MOD_ENGINE, "Invalid CPU list in cpu_sh_workers/cpu_sz_workers/cpu_gateway, pinning disabled");
+        return;
+    }
+    if (!sh_cpus.empty() || !sz_cpus.empty()) {
+        std::vector<int> worker_cpus(static_cast<size_t>(total), -1);
+        for (int i = 0; i < sh_count && i < static_cast<int>(sh_cpus.size()); ++i) worker_cpus[i] = sh_cpus[i];
+        for (int i = 0; sh_count + i < total && i < static_cast<int>(sz_cpus.size()); ++i) worker_cpus[sh_count + i] = sz_cpus[i];
+        engine.set_worker_cpus(worker_cpus);
+    }
+    engine.set_gateway_cpus(gateway_cpus);
+    LOG_MODULE_INFO(logger, MOD_ENGINE, "Worker wait={} spin_limit={} overrides=[{}], CPUs: sh=[{}] sz=[{}] gateway=[{}] persist={}",
+                    cfg.worker_wait, spin_limit, cfg.worker_wait_shards, cfg.cpu_sh_workers, cfg.cpu_sz_workers,
+                    cfg.cpu_gateway, cfg.cpu_persist_writer);
+}
+
 // ==========================================
 // 实盘模式
 // ==========================================
@@ -270,6 +324,61 @@ void run_live_mode(quill::Logger* logger,
         engine_cfg.interrupt_threshold_strategy_ms,
         engine_cfg.interrupt_threshold_other_ms
     );
+
+    // 订单簿快照：盘中重启时恢复当日快照，并按间隔写新快照
+    if (engine_cfg.checkpoint_interval_sec > 0 || engine_cfg.checkpoint_restore) {
+        int32_t restore_date = engine_cfg.checkpoint_restore ? std::stoi(get_current_date()) : 0;
+        engine.set_checkpoint(engine_cfg.checkpoint_dir, engine_cfg.checkpoint_interval_sec, restore_date);
+        LOG_MODULE_INFO(logger, MOD_ENGINE, "Book checkpoint: dir={} interval={}s restore_date={}",
+                        engine_cfg.checkpoint_dir, engine_cfg.checkpoint_interval_sec, restore_date);
+    }
+
+    // 订单节点池：大页与预缺页
+    {
+        ObjectPoolOptions pool_options;
+        if (engine_cfg.pool_huge_pages == "hugetlb") {
+            pool_options.huge_pages = ObjectPoolOptions::HugePages::HugeTLB;
+        } else if (engine_cfg.pool_huge_pages == "thp") {
+            pool_options.huge_pages = ObjectPoolOptions::HugePages::THP;
+        }
+        pool_options.prefault = engine_cfg.pool_prefault;
+        engine.set_pool_options(pool_options);
+        engine.set_book_compaction(engine_cfg.compact_books_at_lunch);
+        LOG_MODULE_INFO(logger, MOD_ENGINE, "Order pool: huge_pages={} prefault={} compact_at_lunch={}",
+                        engine_cfg.pool_huge_pages, engine_cfg.pool_prefault, engine_cfg.compact_books_at_lunch);
+    }
+
+    // 主力资金流向：按母单原始委托金额分档统计逐笔成交
+    if (!engine_cfg.money_flow_thresholds.empty()) {
+        MoneyFlowBuckets buckets;
+        bool ok = MoneyFlowBuckets::parse(engine_cfg.money_flow_thresholds, buckets);
+        if (ok) engine.set_money_flow(buckets);
+        LOG_MODULE_INFO(logger, MOD_ENGINE, "Money flow: thresholds={} enabled={}", engine_cfg.money_flow_thresholds, ok);
+    }
+
+    // 行情接入模式 (须在行情接入前设置)
+    if (engine_cfg.ingest_mode == "spsc") {
+        engine.set_spsc_ingest(engine_cfg.ingest_producers, static_cast<size_t>(engine_cfg.ingest_ring_capacity));
+    }
+    LOG_MODULE_INFO(logger, MOD_ENGINE, "Ingest mode: {} (producers={}, ring_capacity={})",
+                    engine_cfg.ingest_mode, engine.spsc_ingest_rows(), engine_cfg.ingest_ring_capacity);
+
+    // worker 空闲等待策略与绑核 (须在 engine.start() 前设置)
+    configure_workers(engine, engine_cfg, logger);
+
+    // 证券代码表：预先登记全市场代码，入口与 worker 均按整数 ID 下标访问
+    if (!engine_cfg.symbol_list_file.empty()) {
+        size_t n = engine.symbol_table().load_csv(engine_cfg.symbol_list_file);
+        LOG_MODULE_INFO(logger, MOD_ENGINE, "Symbol table: {} symbols from {} (capacity {})",
+                        n, engine_cfg.symbol_list_file, engine.symbol_table().capacity());
+    }
+
+    // 启动追补：各 worker 先回放当日落盘逐笔，再切换到实时队列
+    if (engine_cfg.catchup_enabled) {
+        std::string day_dir = CatchupReplayer::day_dir_for(engine_cfg.persist_data_dir, get_current_date());
+        bool ok = engine.set_catchup(day_dir);
+        LOG_MODULE_INFO(logger, MOD_ENGINE, "Catch-up from persisted data: dir={} enabled={}", day_dir, ok);
+    }
     auto& factory = StrategyFactory::instance();
 
     // 有效股票列表（去重）
@@ -416,11 +525,8 @@ void run_live_mode(quill::Logger* logger,
         // 数据目录 (通过 engine.conf 配置)
         std::string data_dir = engine_cfg.persist_data_dir;
 
-        // Writer 线程绑核 (绑定到最后一个 CPU)
-        // int last_cpu = static_cast<int>(std::thread::hardware_concurrency()) - 1;
-        int last_cpu = -1;
-
-        if (!persist->init(date, data_dir, last_cpu)) {
+        // Writer 线程绑核 (engine.conf cpu_persist_writer，-1 不绑核)
+        if (!persist->init(date, data_dir, engine_cfg.cpu_persist_writer)) {
             LOG_MODULE_ERROR(logger, MOD_ENGINE, "Failed to initialize PersistLayer");
             engine.stop();
             hft::logger::shutdown();
@@ -9,7 +9,6 @@
 #include "utils/price_util.h"
 #include <nlohmann/json.hpp>
 #include <string>
-#include <unordered_map>
 #include <deque>
 
 #define LOG_MODULE MOD_STRATEGY
@@ -27,6 +26,9 @@
 //   min_bid    - 封单量下限 (默认1000)
 //   start_time - 监控开始时间 (默认"13:30")
 //
+// 封单撤单量来自订单簿的订单事件 (进入 MONITORING 时关注涨停价买方档位，
+// 离开 MONITORING 或被禁用时取消关注)，策略不再维护涨停价买单的影子副本。
+//
 // 状态机:
 //   INACTIVE --[time >= start_time AND lastpx == maxpx]--> MONITORING
 //   MONITORING --[flow_condition]--> TRIGGERED (terminal)
@@ -62,9 +64,10 @@ private:
     double cancel_weight_ = 0.2;        // 撤单量权重 (撤单量 * 权重 计入流出)
 
     // ==========================================
-    // 涨停价买单追踪
+    // 涨停价买单撤单量 (on_order_events 累计，当前消息回调中计入窗口)
     // ==========================================
-    std::unordered_map<uint64_t, uint64_t> limit_up_bid_orders_;  // orderno -> volume
+    uint64_t pending_cancel_volume_ = 0;
+    bool watching_ = false;         // 是否已在订单簿登记关注 (引用计数，须成对释放)
 
     // ==========================================
     // 200ms 滑动窗口: 封单流出事件
@@ -75,11 +78,6 @@ private:
     };
     std::deque<FlowEvent> flow_window_;
 
-    // ==========================================
-    // OrderBook 同步标记
-    // ==========================================
-    bool book_synced_ = false;  // 进入 MONITORING 后是否已从 OrderBook 同步
-
     // ==========================================
     // 统计
     // ==========================================
@@ -159,6 +157,8 @@ public:
             if (stock.mdtime >= start_time_ && limit_up_price_ > 0 &&
                 static_cast<uint32_t>(stock.lastpx) == limit_up_price_) {
                 state_ = State::MONITORING;
+                // 关注涨停价买方档位：撤单由订单簿以订单事件推送
+                watch_limit_up();
                 LOG_M_INFO("{} | INACTIVE -> MONITORING | time={} | lastpx={} | maxpx={}",
                            symbol, time_util::format_mdtime(stock.mdtime),
                            stock.lastpx, limit_up_price_);
@@ -177,7 +177,32 @@ public:
     }
 
     // ==========================================
-    // on_order: 追踪涨停价买单 + 撤单流出
+    // on_control_message: 禁用时释放订单簿关注，重新启用且仍在 MONITORING 时恢复
+    // ==========================================
+    void on_control_message(const ControlMessage& msg) override {
+        Strategy::on_control_message(msg);
+        if (!is_enabled()) {
+            unwatch_limit_up();
+        } else if (state_ == State::MONITORING) {
+            watch_limit_up();
+        }
+    }
+
+    // ==========================================
+    // on_order_events: 累计涨停价买单撤单量 (沪深撤单均由订单簿识别)
+    // ==========================================
+    void on_order_events(const OrderEvent* events, size_t count, const FastOrderBook& book) override {
+        if (!is_enabled() || state_ != State::MONITORING) return;
+        for (size_t i = 0; i < count; ++i) {
+            const OrderEvent& e = events[i];
+            if (e.type == OrderEventType::Cancelled && e.side == Side::Buy && e.price == limit_up_price_) {
+                pending_cancel_volume_ += e.volume;
+            }
+        }
+    }
+
+    // ==========================================
+    // on_order: 上海撤单流出 (ordertype == 10)
     // ==========================================
     void on_order(const MDOrderStruct& order, const FastOrderBook& book) override {
         if (!is_enabled()) return;
@@ -186,37 +211,11 @@ public:
         if (state_ != State::MONITORING) return;
         if (limit_up_price_ == 0) return;
 
-        // 首次进入 MONITORING: 从 OrderBook 同步涨停价上的已有买单
-        if (!book_synced_) sync_from_book(book);
-
-        // 买单 at 涨停价 -> 记录
-        if (order.orderbsflag == 1 &&  // 买方向
-            static_cast<uint32_t>(order.orderprice) == limit_up_price_) {
-
-            // 订单 ID: SZ 用 orderindex, SH 用 orderno（与 FastOrderBook 一致）
-            uint64_t order_id = (order.orderno != 0)
-                ? static_cast<uint64_t>(order.orderno)
-                : static_cast<uint64_t>(order.orderindex);
-
-            if (order.ordertype == 10) {
-                // 上海撤单 (ordertype == 10): 查 order_id，命中则加入 flow_window_
-                auto it = limit_up_bid_orders_.find(order_id);
-                if (it != limit_up_bid_orders_.end()) {
-                    uint64_t cancel_vol = it->second;
-                    flow_window_.push_back({order.mdtime, static_cast<uint64_t>(cancel_vol * cancel_weight_)});
-                    flow_event_count_++;
-                    limit_up_bid_orders_.erase(it);
-                    check_flow_condition(order.mdtime, book);
-                }
-            } else {
-                // 新买单: 记录到 limit_up_bid_orders_
-                limit_up_bid_orders_[order_id] = static_cast<uint64_t>(order.orderqty);
-            }
-        }
+        flush_cancel_flow(order.mdtime, book);
     }
 
     // ==========================================
-    // on_transaction: 追踪成交流出 + SZ撤单流出
+    // on_transaction: 追踪成交流出 + 深圳撤单流出
     // ==========================================
     void on_transaction(const MDTransactionStruct& txn, const FastOrderBook& book) override {
         if (!is_enabled()) return;
@@ -225,70 +224,43 @@ public:
         if (state_ != State::MONITORING) return;
         if (limit_up_price_ == 0) return;
 
-        // 首次进入 MONITORING: 从 OrderBook 同步涨停价上的已有买单
-        if (!book_synced_) sync_from_book(book);
-
         if (txn.tradetype == 0) {
             // 成交 at 涨停价 -> 加入 flow_window_
             if (static_cast<uint32_t>(txn.tradeprice) == limit_up_price_) {
                 flow_window_.push_back({txn.mdtime, static_cast<uint64_t>(txn.tradeqty)});
                 flow_event_count_++;
-
-                // 更新买单剩余量
-                auto it = limit_up_bid_orders_.find(static_cast<uint64_t>(txn.tradebuyno));
-                if (it != limit_up_bid_orders_.end()) {
-                    uint64_t traded = static_cast<uint64_t>(txn.tradeqty);
-                    if (traded >= it->second) {
-                        limit_up_bid_orders_.erase(it);
-                    } else {
-                        it->second -= traded;
-                    }
-                }
-
                 check_flow_condition(txn.mdtime, book);
             }
         } else {
-            // 深圳撤单 (tradetype != 0): 查 tradebuyno，命中则加入 flow_window_
-            auto it = limit_up_bid_orders_.find(static_cast<uint64_t>(txn.tradebuyno));
-            if (it != limit_up_bid_orders_.end()) {
-                uint64_t cancel_vol = static_cast<uint64_t>(txn.tradeqty);
-                flow_window_.push_back({txn.mdtime, static_cast<uint64_t>(cancel_vol * cancel_weight_)});
-                flow_event_count_++;
-
-                if (cancel_vol >= it->second) {
-                    limit_up_bid_orders_.erase(it);
-                } else {
-                    it->second -= cancel_vol;
-                }
-
-                check_flow_condition(txn.mdtime, book);
-            }
+            flush_cancel_flow(txn.mdtime, book);
         }
     }
 
 private:
     // ==========================================
-    // 从 OrderBook 同步涨停价上的已有买单
+    // 涨停价买方档位的订单事件关注 (工作线程内调用)
     // ==========================================
-    void sync_from_book(const FastOrderBook& book) {
-        book_synced_ = true;
-        uint64_t synced_volume = 0;
-        uint64_t book_bid_volume = book.get_bid_volume_at_price(limit_up_price_);
-        size_t synced_count = 0;
-        book.for_each_bid_order_at_price(limit_up_price_, [this, &synced_volume, &synced_count](uint64_t seq, uint32_t volume) {
-            limit_up_bid_orders_[seq] = static_cast<uint64_t>(volume);
-            synced_volume += static_cast<uint64_t>(volume);
-            ++synced_count;
-        });
-        LOG_M_INFO("{} | synced {} bid orders from OrderBook at limit_up_price={} | synced_volume={} | book_bid_volume={}",
-                   symbol, synced_count,
-                   price_util::format_price_display(limit_up_price_),
-                   synced_volume, book_bid_volume);
-        if (synced_volume != book_bid_volume) {
-            LOG_M_WARNING("{} | sync mismatch at limit_up_price={} | synced_count={} | synced_volume={} | book_bid_volume={}",
-                          symbol, price_util::format_price_display(limit_up_price_),
-                          synced_count, synced_volume, book_bid_volume);
-        }
+    void watch_limit_up() {
+        if (watching_ || !book_) return;
+        watching_ = book_->watch_orders(Side::Buy, limit_up_price_);
+    }
+
+    void unwatch_limit_up() {
+        if (!watching_) return;
+        book_->unwatch_orders(Side::Buy, limit_up_price_);
+        watching_ = false;
+        pending_cancel_volume_ = 0;
+    }
+
+    // ==========================================
+    // 本条消息的涨停价买单撤单量 * 权重 计入 flow_window_
+    // ==========================================
+    void flush_cancel_flow(int32_t current_time, const FastOrderBook& book) {
+        if (pending_cancel_volume_ == 0) return;
+        flow_window_.push_back({current_time, static_cast<uint64_t>(pending_cancel_volume_ * cancel_weight_)});
+        flow_event_count_++;
+        pending_cancel_volume_ = 0;
+        check_flow_condition(current_time, book);
     }
 
     // ==========================================
@@ -331,6 +303,7 @@ private:
         if (state_ == State::TRIGGERED) return;
 
         state_ = State::TRIGGERED;
+        unwatch_limit_up();
 
         LOG_BIZ("SIGNAL",
                 "SELL SIGNAL | {} | Time={} | Price={} | state=TRIGGERED",
@@ -0,0 +1,65 @@
+#ifndef CPU_AFFINITY_H
+#define CPU_AFFINITY_H
+
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// ==========================================
+// CPU 绑核辅助工具
+// ==========================================
+namespace cpu_affinity {
+
+// 解析 CPU 列表 ("2-5,8,10-11" -> {2,3,4,5,8,10,11})，保持书写顺序；格式错误返回 false
+inline bool parse_cpu_list(const std::string& text, std::vector<int>& out) {
+    out.clear();
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find(',', pos);
+        if (end == std::string::npos) end = text.size();
+        std::string item = text.substr(pos, end - pos);
+        pos = end + 1;
+
+        size_t first = item.find_first_not_of(" \t");
+        if (first == std::string::npos) continue;
+        item = item.substr(first, item.find_last_not_of(" \t") - first + 1);
+
+        size_t dash = item.find('-');
+        try {
+            size_t used = 0;
+            int lo = std::stoi(item.substr(0, dash), &used);
+            if (used != (dash == std::string::npos ? item.size() : dash) || lo < 0) return false;
+            int hi = lo;
+            if (dash != std::string::npos) {
+                std::string rest = item.substr(dash + 1);
+                hi = std::stoi(rest, &used);
+                if (used != rest.size() || hi < lo) return false;
+            }
+            for (int cpu = lo; cpu <= hi; ++cpu) out.push_back(cpu);
+        } catch (...) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 将当前线程绑定到指定 CPU (cpu < 0 不绑核，返回 true)
+inline bool pin_current_thread(int cpu) {
+    if (cpu < 0) return true;
+#ifdef __linux__
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu, &cpuset);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) == 0;
+#else
+    return false;
+#endif
+}
+
+} // namespace cpu_affinity
+
+#endif // CPU_AFFINITY_H
@@ -87,6 +87,36 @@ inline bool is_shenzhen(const std::string& symbol) {
     return symbol[0] != '6';
 }
 
+// 判断证券是否在上海交易所 (含基金、债券)
+// 带后缀 (.SH / .SZ) 时以后缀为准，否则按股票代码规则 (6 开头为上海)
+inline bool is_shanghai_security(const char* symbol) {
+    if (!symbol || !symbol[0]) return false;
+    for (const char* p = symbol; *p; ++p) {
+        if (*p == '.') return p[1] == 'S' && p[2] == 'H';
+    }
+    return symbol[0] == '6';
+}
+
+// ==========================================
+// 最小报价单位 (价格 * 10000)
+// ==========================================
+constexpr uint32_t STOCK_TICK_SIZE = 100;   // 股票 0.01 元
+constexpr uint32_t FUND_TICK_SIZE = 10;     // 基金 (ETF/LOF) 与可转债 0.001 元
+
+// 按代码段判断最小报价单位
+// 上海: 5xxxxx 基金, 11xxxx 可转债；深圳: 15xxxx/16xxxx 基金, 12xxxx 可转债；其余按股票
+inline uint32_t tick_size_for(const char* symbol) {
+    if (!symbol || !symbol[0] || !symbol[1]) return STOCK_TICK_SIZE;
+    char c0 = symbol[0];
+    char c1 = symbol[1];
+    if (is_shanghai_security(symbol)) {
+        if (c0 == '5' || (c0 == '1' && c1 == '1')) return FUND_TICK_SIZE;
+    } else {
+        if (c0 == '1' && (c1 == '2' || c1 == '5' || c1 == '6')) return FUND_TICK_SIZE;
+    }
+    return STOCK_TICK_SIZE;
+}
+
 // 价格转换：double 转 uint32_t（乘以 10000）
 // 用于将元为单位的价格转换为内部整数格式
 inline uint32_t price_to_int(double price) {
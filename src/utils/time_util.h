@@ -17,6 +17,17 @@ constexpr int32_t MORNING_END = 113000000;    // 11:30:00.000
 constexpr int32_t AFTERNOON_START = 130000000; // 13:00:00.000
 constexpr int64_t LUNCH_BREAK_MS = 5400000;    // 1.5小时 = 5400秒 = 5400000毫秒
 
+// 集合竞价时段（MDTime格式）：开盘 09:15-09:25，收盘 14:57-15:00
+constexpr int32_t OPEN_AUCTION_START = 91500000;
+constexpr int32_t OPEN_AUCTION_END = 92500000;
+constexpr int32_t CLOSE_AUCTION_START = 145700000;
+constexpr int32_t CLOSE_AUCTION_END = 150000000;
+
+inline bool in_call_auction(int32_t mdtime) {
+    return (mdtime >= OPEN_AUCTION_START && mdtime < OPEN_AUCTION_END) ||
+           (mdtime >= CLOSE_AUCTION_START && mdtime < CLOSE_AUCTION_END);
+}
+
 // 将 MDTime 转换为毫秒数（从午夜开始）
 // MDTime格式: HHMMSSMMM (9位数字)
 // 例如: 093015500 = 09:30:15.500
@@ -0,0 +1,267 @@
+/**
+ * @file test_auction.cpp
+ * @brief 集合竞价撮合索引 (AuctionIndex) 与 FastOrderBook 虚拟撮合测试
+ *
+ * AuctionIndex 单独验证：随机设置各档买卖量 (含区间外委托) 后，
+ * 最大成交量及成交量相同的价格区间与逐档暴力计算一致。
+ * 订单簿层面：竞价模式下随机委托/撤单流 (深圳/上海)，虚拟撮合价、成交量、
+ * 买卖累计量与不平衡量与暴力计算一致 (上海取中间价，深圳取最接近昨收的价格)；
+ * 中途进入竞价模式与从头开启结果相同；退出后不再返回结果。
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "AuctionIndex.h"
+#include "FastOrderBook.h"
+#include "ObjectPool.h"
+#include "market_data_structs_aligned.h"
+
+namespace {
+
+constexpr uint32_t MIN_PRICE = 90000;
+constexpr uint32_t MAX_PRICE = 110000;
+constexpr uint32_t PRE_CLOSE = 100000;
+
+MDOrderStruct make_order(int32_t source, uint64_t order_id, uint32_t price, uint32_t qty, int32_t side) {
+    MDOrderStruct order{};
+    std::strncpy(order.htscsecurityid, source == 101 ? "600000.SH" : "000001.SZ", sizeof(order.htscsecurityid) - 1);
+    order.securityidsource = source;
+    order.securitytype = 1;
+    order.orderindex = static_cast<int64_t>(order_id);
+    order.orderno = source == 101 ? static_cast<int64_t>(order_id) : 0;
+    order.orderprice = price;
+    order.orderqty = qty;
+    order.ordertype = 2;
+    order.orderbsflag = side;
+    order.applseqnum = static_cast<int64_t>(order_id);
+    return order;
+}
+
+MDTransactionStruct make_cancel(int32_t source, uint64_t order_id, uint32_t qty, int32_t side) {
+    MDTransactionStruct txn{};
+    std::strncpy(txn.htscsecurityid, source == 101 ? "600000.SH" : "000001.SZ", sizeof(txn.htscsecurityid) - 1);
+    txn.securityidsource = source;
+    txn.securitytype = 1;
+    txn.tradetype = 1;
+    txn.tradebsflag = side;
+    txn.tradeqty = qty;
+    if (side == 1) txn.tradebuyno = static_cast<int64_t>(order_id);
+    else txn.tradesellno = static_cast<int64_t>(order_id);
+    return txn;
+}
+
+bool expect_true(const std::string& name, bool cond) {
+    if (cond) return true;
+    std::cerr << "[FAIL] " << name << "\n";
+    return false;
+}
+
+// 暴力计算：逐档 min(D, S) 的最大值及取得最大值的价格区间
+struct Brute {
+    int32_t lo = -1, hi = -1;
+    uint64_t volume = 0;
+};
+
+Brute brute_match(const std::vector<uint64_t>& bids, const std::vector<uint64_t>& asks) {
+    Brute b;
+    size_t n = bids.size();
+    for (size_t p = 0; p < n; ++p) {
+        uint64_t d = 0, s = 0;
+        for (size_t t = p; t < n; ++t) d += bids[t];
+        for (size_t t = 0; t <= p; ++t) s += asks[t];
+        uint64_t v = d < s ? d : s;
+        if (v == 0) continue;
+        if (v > b.volume) {
+            b.volume = v;
+            b.lo = b.hi = static_cast<int32_t>(p);
+        } else if (v == b.volume) {
+            b.hi = static_cast<int32_t>(p);
+        }
+    }
+    return b;
+}
+
+bool test_index() {
+    bool ok = true;
+    std::mt19937 rng(18);
+    constexpr int32_t LO = 1000;
+    constexpr uint32_t N = 60;
+
+    for (int round = 0; round < 300 && ok; ++round) {
+        AuctionIndex idx;
+        idx.reset(LO, N);
+        std::vector<uint64_t> bids(N, 0), asks(N, 0);
+        std::vector<uint64_t> over_bid(5, 0), over_ask(5, 0);   // 区间外档位
+
+        for (int step = 0; step < 200; ++step) {
+            uint32_t r = rng() % 20;
+            uint64_t vol = (rng() % 3 == 0) ? 0 : 100 * (rng() % 10);
+            if (r == 0) {
+                // 高于区间的买单计入最高档；低于区间的买单忽略
+                size_t k = rng() % 5;
+                over_bid[k] = vol;
+                idx.set_bid(LO + static_cast<int32_t>(N) + static_cast<int32_t>(k), vol);
+                idx.set_bid(LO - 1 - static_cast<int32_t>(k), vol);
+            } else if (r == 1) {
+                size_t k = rng() % 5;
+                over_ask[k] = vol;
+                idx.set_ask(LO - 1 - static_cast<int32_t>(k), vol);
+                idx.set_ask(LO + static_cast<int32_t>(N) + static_cast<int32_t>(k), vol);
+            } else {
+                // 买单偏高、卖单偏低，制造交叉
+                uint32_t slot = rng() % N;
+                if (r & 1) {
+                    bids[slot] = vol;
+                    idx.set_bid(LO + static_cast<int32_t>(slot), vol);
+                } else {
+                    asks[slot] = vol;
+                    idx.set_ask(LO + static_cast<int32_t>(slot), vol);
+                }
+            }
+
+            std::vector<uint64_t> b = bids, a = asks;
+            for (uint64_t v : over_bid) b[N - 1] += v;
+            for (uint64_t v : over_ask) a[0] += v;
+            Brute expect = brute_match(b, a);
+            AuctionIndex::Match m;
+            bool found = idx.best_match(m);
+            bool same = found ? (expect.volume == m.volume && m.lo_tick == LO + expect.lo && m.hi_tick == LO + expect.hi)
+                              : expect.volume == 0;
+            ok &= expect_true("index round " + std::to_string(round) + " step " + std::to_string(step), same);
+            if (!ok) break;
+            if (found) {
+                int32_t mid = m.lo_tick + (m.hi_tick - m.lo_tick) / 2;
+                uint64_t d = 0, s = 0;
+                for (size_t t = static_cast<size_t>(mid - LO); t < N; ++t) d += b[t];
+                for (size_t t = 0; t <= static_cast<size_t>(mid - LO); ++t) s += a[t];
+                ok &= expect_true("demand/supply", idx.demand(mid) == d && idx.supply(mid) == s);
+            }
+        }
+    }
+    return ok;
+}
+
+// 订单簿暴力计算：按价格逐档计算，返回与 get_auction_state 相同口径的结果
+std::optional<FastOrderBook::AuctionState> brute_state(const FastOrderBook& book, bool shanghai) {
+    const uint32_t tick = book.tick_size();
+    const size_t n = (MAX_PRICE - MIN_PRICE) / tick + 1;
+    std::vector<uint64_t> bids(n, 0), asks(n, 0);
+    for (const auto& [p, v] : book.get_bid_levels(100000)) bids[(p - MIN_PRICE) / tick] = v;
+    for (const auto& [p, v] : book.get_ask_levels(100000)) asks[(p - MIN_PRICE) / tick] = v;
+    Brute b = brute_match(bids, asks);
+    if (b.volume == 0) return std::nullopt;
+
+    int32_t slot = b.lo + (b.hi - b.lo + 1) / 2;
+    if (!shanghai) {
+        int32_t ref = static_cast<int32_t>((PRE_CLOSE - MIN_PRICE) / tick);
+        slot = ref < b.lo ? b.lo : (ref > b.hi ? b.hi : ref);
+    }
+    FastOrderBook::AuctionState s{};
+    s.price = MIN_PRICE + static_cast<uint32_t>(slot) * tick;
+    s.volume = b.volume;
+    for (size_t t = static_cast<size_t>(slot); t < n; ++t) s.bid_volume += bids[t];
+    for (size_t t = 0; t <= static_cast<size_t>(slot); ++t) s.ask_volume += asks[t];
+    s.imbalance = static_cast<int64_t>(s.bid_volume) - static_cast<int64_t>(s.ask_volume);
+    return s;
+}
+
+bool same_state(const std::optional<FastOrderBook::AuctionState>& a, const std::optional<FastOrderBook::AuctionState>& b) {
+    if (!a || !b) return !a && !b;
+    return a->price == b->price && a->volume == b->volume && a->bid_volume == b->bid_volume &&
+           a->ask_volume == b->ask_volume && a->imbalance == b->imbalance;
+}
+
+bool run_book(int32_t source) {
+    const bool shanghai = source == 101;
+    const std::string name = shanghai ? "sh" : "sz";
+    ObjectPool<OrderNode> pool(1 << 14);
+    FastOrderBook book(0, pool, MIN_PRICE, MAX_PRICE, shanghai ? Exchange::Shanghai : Exchange::Shenzhen);
+    FastOrderBook late(0, pool, MIN_PRICE, MAX_PRICE, shanghai ? Exchange::Shanghai : Exchange::Shenzhen);
+    book.set_auction_mode(true, PRE_CLOSE);
+    std::mt19937 rng(static_cast<uint32_t>(source) * 3);
+    std::vector<std::tuple<uint64_t, int32_t, uint32_t>> live;
+    uint64_t next_id = 1;
+    bool ok = expect_true(name + " empty", !book.get_auction_state().has_value());
+
+    for (int step = 0; step < 4000 && ok; ++step) {
+        if (rng() % 10 < 7 || live.empty()) {
+            int32_t side = (rng() & 1) ? 1 : 2;
+            // 买卖价格区间大幅交叉，偶尔挂在涨跌停价
+            uint32_t price = 97000 + (rng() % 60) * 100;
+            if (rng() % 30 == 0) price = side == 1 ? MAX_PRICE : MIN_PRICE;
+            uint32_t qty = 100 * (1 + rng() % 50);
+            uint64_t id = next_id++;
+            book.on_order(make_order(source, id, price, qty, side));
+            late.on_order(make_order(source, id, price, qty, side));
+            live.emplace_back(id, side, qty);
+        } else {
+            size_t i = rng() % live.size();
+            auto [id, side, qty] = live[i];
+            uint32_t part = (rng() & 1) ? qty : 100;
+            book.on_transaction(make_cancel(source, id, part, side));
+            late.on_transaction(make_cancel(source, id, part, side));
+            if (part == qty) {
+                live[i] = live.back();
+                live.pop_back();
+            } else {
+                std::get<2>(live[i]) = qty - part;
+            }
+        }
+        if (step % 20 == 0) {
+            ok &= expect_true(name + " state at step " + std::to_string(step),
+                              same_state(book.get_auction_state(), brute_state(book, shanghai)));
+        }
+    }
+
+    // 中途进入竞价模式：按当前挂单全量构建，结果相同
+    late.set_auction_mode(true, PRE_CLOSE);
+    ok &= expect_true(name + " late enable", late.get_auction_state().has_value() &&
+                      same_state(late.get_auction_state(), book.get_auction_state()));
+
+    book.set_auction_mode(false);
+    ok &= expect_true(name + " disabled", !book.auction_mode() && !book.get_auction_state().has_value());
+    return ok;
+}
+
+// 价格选择：成交量相同的价格区间 [100000, 100300]
+bool test_price_choice() {
+    bool ok = true;
+    for (int32_t source : {101, 102}) {
+        ObjectPool<OrderNode> pool(64);
+        FastOrderBook book(0, pool, MIN_PRICE, MAX_PRICE, source == 101 ? Exchange::Shanghai : Exchange::Shenzhen);
+        book.set_auction_mode(true, 99000);
+        book.on_order(make_order(source, 1, 100300, 500, 1));
+        book.on_order(make_order(source, 2, 100000, 500, 2));
+        auto s = book.get_auction_state();
+        // 上海：中间价 100150 四舍五入到档位 -> 100200；深圳：最接近昨收 99000 -> 100000
+        uint32_t expect = source == 101 ? 100200 : 100000;
+        ok &= expect_true("price choice " + std::to_string(source),
+                          s && s->price == expect && s->volume == 500 && s->imbalance == 0);
+    }
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    bool ok = true;
+    ok &= test_index();
+    ok &= run_book(102);
+    ok &= run_book(101);
+    ok &= test_price_choice();
+
+    if (!ok) {
+        return 1;
+    }
+
+    std::cout << "test_auction passed\n";
+    return 0;
+}
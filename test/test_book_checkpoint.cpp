@@ -0,0 +1,218 @@
+/**
+ * @file test_book_checkpoint.cpp
+ * @brief 订单簿快照 (BookCheckpoint) 保存/恢复测试
+ *
+ * 随机构建多个订单簿 (含限价单、本方最优单、市价单)，保存快照后在新的内存池中恢复，
+ * 校验档位队列顺序、深度、最优价与通道水位一致；恢复后继续回放相同的撤单，结果仍一致。
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <tuple>
+#include <unistd.h>
+#include <vector>
+
+#include "book_checkpoint.h"
+#include "FastOrderBook.h"
+#include "ObjectPool.h"
+#include "market_data_structs_aligned.h"
+
+namespace {
+
+constexpr symbol_utils::ExchangeShardConfig LAYOUT{2, 3};
+
+using OrderTuple = std::tuple<uint64_t, uint32_t, uint32_t, uint32_t, int, int>;
+
+MDOrderStruct make_order(const char* symbol, uint64_t order_id, uint32_t price, uint32_t qty, int32_t side, int32_t type) {
+    MDOrderStruct order{};
+    std::strncpy(order.htscsecurityid, symbol, sizeof(order.htscsecurityid) - 1);
+    order.securityidsource = 102;
+    order.securitytype = 1;
+    order.orderindex = static_cast<int64_t>(order_id);
+    order.orderprice = price;
+    order.orderqty = qty;
+    order.ordertype = type;
+    order.orderbsflag = side;
+    order.applseqnum = static_cast<int64_t>(order_id);
+    order.channelno = 2011;
+    order.mddate = 20260311;
+    order.mdtime = 100000000;
+    return order;
+}
+
+MDTransactionStruct make_cancel(const char* symbol, uint64_t order_id, uint32_t qty, int32_t side) {
+    MDTransactionStruct txn{};
+    std::strncpy(txn.htscsecurityid, symbol, sizeof(txn.htscsecurityid) - 1);
+    txn.securityidsource = 102;
+    txn.securitytype = 1;
+    txn.tradebuyno = side == 1 ? order_id : 0;
+    txn.tradesellno = side == 2 ? order_id : 0;
+    txn.tradeqty = qty;
+    txn.tradetype = 1;
+    txn.tradebsflag = side;
+    txn.mddate = 20260311;
+    txn.mdtime = 100000000;
+    return txn;
+}
+
+std::vector<OrderTuple> dump_orders(const FastOrderBook& book) {
+    std::vector<OrderTuple> out;
+    book.for_each_order([&](const OrderView& n) {
+        out.emplace_back(n.seq, n.original_price, n.sort_price, n.volume,
+                         static_cast<int>(n.type), static_cast<int>(n.side));
+    });
+    return out;
+}
+
+bool expect_true(const std::string& name, bool cond) {
+    if (cond) return true;
+    std::cerr << "[FAIL] " << name << "\n";
+    return false;
+}
+
+bool same_book(const std::string& name, const FastOrderBook& a, const FastOrderBook& b) {
+    bool ok = true;
+    ok &= expect_true(name + " orders", dump_orders(a) == dump_orders(b));
+    ok &= expect_true(name + " bids", a.get_bid_levels(10) == b.get_bid_levels(10));
+    ok &= expect_true(name + " asks", a.get_ask_levels(10) == b.get_ask_levels(10));
+    ok &= expect_true(name + " best bid", a.get_best_bid() == b.get_best_bid());
+    ok &= expect_true(name + " best ask", a.get_best_ask() == b.get_best_ask());
+    ok &= expect_true(name + " count", a.order_count() == b.order_count());
+    return ok;
+}
+
+struct LiveOrder {
+    std::string symbol;
+    uint64_t id;
+    int32_t side;
+    uint32_t volume;
+};
+
+bool test_save_restore() {
+    const char* symbols[] = {"000001.SZ", "300750.SZ", "002594.SZ"};
+    ObjectPool<OrderNode> pool(4096);
+    BookCheckpoint::BookMap books;
+    for (const char* s : symbols) {
+        books[s] = std::make_unique<FastOrderBook>(0, pool, 900000, 1100000);
+    }
+
+    std::mt19937 rng(20260311);
+    std::vector<LiveOrder> live;
+    uint64_t next_id = 1;
+    ChannelWatermarks wm;
+
+    for (int step = 0; step < 5000; ++step) {
+        const char* sym = symbols[rng() % 3];
+        int32_t side = (rng() % 2) ? 1 : 2;
+        // 2=限价 为主，少量 3=本方最优、1=市价
+        uint32_t r = rng() % 20;
+        int32_t type = (r == 0) ? 1 : (r == 1 ? 3 : 2);
+        uint32_t ticks = rng() % 100;
+        uint32_t price = (side == 1) ? 1000000 - ticks * 100 : 1000100 + ticks * 100;
+        uint32_t qty = 100 * (1 + rng() % 20);
+        MDOrderStruct o = make_order(sym, next_id, price, qty, side, type);
+        books[sym]->on_order(o);
+        wm.update(o.channelno, ChannelWatermarks::ORDER, o.applseqnum);
+        live.push_back({sym, next_id, side, qty});
+        ++next_id;
+
+        if (rng() % 3 == 0) {
+            size_t pick = rng() % live.size();
+            LiveOrder& l = live[pick];
+            uint32_t q = (rng() % 2) ? l.volume : 100;
+            books[l.symbol]->on_transaction(make_cancel(l.symbol.c_str(), l.id, q, l.side));
+            l.volume -= q;
+            if (l.volume == 0) {
+                live[pick] = live.back();
+                live.pop_back();
+            }
+        }
+    }
+
+    std::string dir = "/tmp/test_book_checkpoint_" + std::to_string(::getpid());
+    ::mkdir(dir.c_str(), 0755);
+    std::string path = BookCheckpoint::path_for_shard(dir, 7);
+    bool ok = true;
+
+    ok &= expect_true("save", BookCheckpoint::save(path, 7, 20260311, 100000000, books, wm, LAYOUT));
+
+    // 分片布局不符拒绝恢复 (证券归属分片不同)
+    {
+        ObjectPool<OrderNode> pool2(16);
+        BookCheckpoint::BookMap restored;
+        ChannelWatermarks wm2;
+        symbol_utils::ExchangeShardConfig other{LAYOUT.sh_shard_count, LAYOUT.sz_shard_count + 1};
+        ok &= expect_true("reject other layout",
+                          !BookCheckpoint::load(path, 20260311, pool2, restored, wm2, nullptr, &other));
+        ok &= expect_true("reject layout leaves empty", restored.empty() && wm2.empty());
+    }
+
+    // 日期不符拒绝恢复
+    {
+        ObjectPool<OrderNode> pool2(16);
+        BookCheckpoint::BookMap restored;
+        ChannelWatermarks wm2;
+        ok &= expect_true("reject other date", !BookCheckpoint::load(path, 20260312, pool2, restored, wm2));
+        ok &= expect_true("reject leaves empty", restored.empty() && wm2.empty());
+    }
+
+    ObjectPool<OrderNode> pool2(16);
+    BookCheckpoint::BookMap restored;
+    ChannelWatermarks wm2;
+    BookCheckpoint::Header header{};
+    ok &= expect_true("load", BookCheckpoint::load(path, 20260311, pool2, restored, wm2, &header, &LAYOUT));
+    ok &= expect_true("header books", header.book_count == 3 && header.shard_id == 7);
+    ok &= expect_true("header layout", header.sh_shard_count == LAYOUT.sh_shard_count &&
+                                           header.sz_shard_count == LAYOUT.sz_shard_count);
+    ok &= expect_true("restored book count", restored.size() == books.size());
+    ok &= expect_true("watermark covers", wm2.covers(2011, ChannelWatermarks::ORDER, static_cast<int64_t>(next_id - 1)));
+    ok &= expect_true("watermark next", !wm2.covers(2011, ChannelWatermarks::ORDER, static_cast<int64_t>(next_id)));
+    ok &= expect_true("watermark stream", !wm2.covers(2011, ChannelWatermarks::TRANSACTION, 1));
+
+    for (const char* s : symbols) {
+        ok &= expect_true(std::string("restored ") + s, restored.count(s) == 1);
+    }
+    if (!ok) {
+        std::remove(path.c_str());
+        ::rmdir(dir.c_str());
+        return false;
+    }
+    for (const char* s : symbols) {
+        ok &= same_book(std::string("after restore ") + s, *books[s], *restored[s]);
+    }
+
+    // 恢复后继续撤单，两边结果保持一致 (队列顺序和索引均已还原)
+    for (size_t i = 0; i < live.size() && ok; i += 2) {
+        const LiveOrder& l = live[i];
+        MDTransactionStruct c = make_cancel(l.symbol.c_str(), l.id, l.volume, l.side);
+        bool a = books[l.symbol]->on_transaction(c);
+        bool b = restored[l.symbol]->on_transaction(c);
+        ok &= expect_true("cancel after restore " + std::to_string(l.id), a && b);
+    }
+    for (const char* s : symbols) {
+        ok &= same_book(std::string("after cancels ") + s, *books[s], *restored[s]);
+    }
+
+    std::remove(path.c_str());
+    ::rmdir(dir.c_str());
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    bool ok = true;
+    ok &= test_save_restore();
+
+    if (!ok) {
+        return 1;
+    }
+
+    std::cout << "test_book_checkpoint passed\n";
+    return 0;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file test_depth_kernels.cpp
+ * @brief 盘口深度 SIMD 内核测试
+ *
+ * 在稀疏挂单量数组上随机取区间/目标量，比对 AVX2 / AVX-512 实现与标量实现，
+ * 覆盖非 16 对齐的区间边界和不足一块的短区间。
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "DepthKernels.h"
+
+namespace {
+
+using namespace depth_kernels;
+
+struct Result {
+    int64_t idx;
+    uint64_t acc;
+    bool operator==(const Result& o) const { return idx == o.idx && acc == o.acc; }
+};
+
+bool expect_eq(const std::string& name, uint64_t actual, uint64_t expected) {
+    if (actual == expected) return true;
+    std::cerr << "[FAIL] " << name << " expected=" << expected << " actual=" << actual << "\n";
+    return false;
+}
+
+bool expect_result(const std::string& name, Result actual, Result expected) {
+    if (actual == expected) return true;
+    std::cerr << "[FAIL] " << name << " expected=(" << expected.idx << "," << expected.acc
+              << ") actual=(" << actual.idx << "," << actual.acc << ")\n";
+    return false;
+}
+
+// 模拟宽价格带：大部分档位为 0，盘口附近较密
+std::vector<uint64_t> make_sparse_volumes(size_t n, std::mt19937_64& rng) {
+    std::vector<uint64_t> v(n, 0);
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t density = (i > n / 2 - 200 && i < n / 2 + 200) ? 60 : 3;
+        if (rng() % 100 < density) v[i] = 100 * (1 + rng() % 500);
+    }
+    return v;
+}
+
+template<typename RangeSum, typename FindFwd, typename FindRev>
+bool check_impl(const std::string& impl, RangeSum range_sum_fn, FindFwd find_fn, FindRev rfind_fn) {
+    std::mt19937_64 rng(20260311);
+    bool ok = true;
+
+    for (int round = 0; round < 20 && ok; ++round) {
+        std::vector<uint64_t> v = make_sparse_volumes(4001 + rng() % 80000, rng);
+        const uint64_t* p = v.data();
+
+        for (int q = 0; q < 500 && ok; ++q) {
+            size_t a = rng() % v.size();
+            size_t b = rng() % v.size();
+            if (a > b) std::swap(a, b);
+            size_t end = (q % 5 == 0) ? std::min(v.size(), a + rng() % 20) : b + 1;
+            std::string tag = impl + " round=" + std::to_string(round) + " [" + std::to_string(a) + "," + std::to_string(end) + ")";
+
+            ok &= expect_eq("range_sum " + tag, range_sum_fn(p, a, end), range_sum_scalar(p, a, end));
+
+            uint64_t total = range_sum_scalar(p, a, end);
+            uint64_t target = (q % 7 == 0) ? total + 1 : (total ? 1 + rng() % total : 1);
+
+            Result expect_fwd{0, 0};
+            expect_fwd.idx = find_cumulative_ge_scalar(p, a, end, target, expect_fwd.acc);
+            Result got_fwd{0, 0};
+            got_fwd.idx = find_fn(p, a, end, target, got_fwd.acc);
+            ok &= expect_result("find_cumulative_ge " + tag, got_fwd, expect_fwd);
+
+            Result expect_rev{0, 0};
+            expect_rev.idx = rfind_cumulative_ge_scalar(p, a, end, target, expect_rev.acc);
+            Result got_rev{0, 0};
+            got_rev.idx = rfind_fn(p, a, end, target, got_rev.acc);
+            ok &= expect_result("rfind_cumulative_ge " + tag, got_rev, expect_rev);
+        }
+    }
+    return ok;
+}
+
+bool test_dispatch() {
+    std::vector<uint64_t> v(100, 0);
+    v[10] = 300;
+    v[40] = 500;
+    v[90] = 200;
+    bool ok = true;
+    uint64_t acc = 0;
+
+    ok &= expect_eq("dispatch range_sum", range_sum(v.data(), 0, v.size()), 1000);
+    ok &= expect_eq("dispatch empty range", range_sum(v.data(), 50, 50), 0);
+    ok &= expect_eq("dispatch find idx", static_cast<uint64_t>(find_cumulative_ge(v.data(), 0, v.size(), 700, acc)), 40);
+    ok &= expect_eq("dispatch find acc", acc, 800);
+    acc = 0;
+    ok &= expect_eq("dispatch rfind idx", static_cast<uint64_t>(rfind_cumulative_ge(v.data(), 0, v.size(), 700, acc)), 40);
+    ok &= expect_eq("dispatch rfind acc", acc, 700);
+    acc = 0;
+    ok &= expect_eq("dispatch not found", static_cast<uint64_t>(find_cumulative_ge(v.data(), 0, v.size(), 1001, acc) == -1), 1);
+    ok &= expect_eq("dispatch not found acc", acc, 1000);
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    bool ok = true;
+    ok &= test_dispatch();
+
+#if defined(DEPTH_KERNELS_X86)
+    SimdLevel level = detect_simd_level();
+    if (level >= SimdLevel::AVX2) {
+        ok &= check_impl("avx2", range_sum_avx2, find_cumulative_ge_avx2, rfind_cumulative_ge_avx2);
+    } else {
+        std::cout << "AVX2 not supported, skipped\n";
+    }
+    if (level >= SimdLevel::AVX512) {
+        ok &= check_impl("avx512", range_sum_avx512, find_cumulative_ge_avx512, rfind_cumulative_ge_avx512);
+    } else {
+        std::cout << "AVX-512 not supported, skipped\n";
+    }
+#endif
+
+    if (!ok) {
+        return 1;
+    }
+
+    std::cout << "test_depth_kernels passed\n";
+    return 0;
+}
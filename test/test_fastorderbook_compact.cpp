@@ -0,0 +1,200 @@
+/**
+ * @file test_fastorderbook_compact.cpp
+ * @brief FastOrderBook 按订单簿 slab 分配与节点整理 (compact) 测试
+ *
+ * 两个订单簿共用一个内存池交替挂单/撤单，与各自独占内存池的参考订单簿比对；
+ * compact 后队列顺序、深度、索引不变，持有的 slab 收缩到与挂单数相当，旧 slab 归还池；
+ * compact 后继续撤单，结果仍与参考一致。
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "FastOrderBook.h"
+#include "ObjectPool.h"
+#include "market_data_structs_aligned.h"
+
+namespace {
+
+using OrderTuple = std::tuple<uint64_t, uint32_t, uint32_t, uint32_t, int, int>;
+using Pool = ObjectPool<OrderNode>;
+
+MDOrderStruct make_order(uint64_t order_id, uint32_t price, uint32_t qty, int32_t side, int32_t type) {
+    MDOrderStruct order{};
+    std::strncpy(order.htscsecurityid, "000001.SZ", sizeof(order.htscsecurityid) - 1);
+    order.securityidsource = 102;
+    order.securitytype = 1;
+    order.orderindex = static_cast<int64_t>(order_id);
+    order.orderprice = price;
+    order.orderqty = qty;
+    order.ordertype = type;
+    order.orderbsflag = side;
+    order.applseqnum = static_cast<int64_t>(order_id);
+    return order;
+}
+
+MDTransactionStruct make_cancel(uint64_t order_id, uint32_t qty, int32_t side) {
+    MDTransactionStruct txn{};
+    std::strncpy(txn.htscsecurityid, "000001.SZ", sizeof(txn.htscsecurityid) - 1);
+    txn.securityidsource = 102;
+    txn.securitytype = 1;
+    txn.tradebuyno = side == 1 ? order_id : 0;
+    txn.tradesellno = side == 2 ? order_id : 0;
+    txn.tradeqty = qty;
+    txn.tradetype = 1;
+    txn.tradebsflag = side;
+    return txn;
+}
+
+std::vector<OrderTuple> dump_orders(const FastOrderBook& book) {
+    std::vector<OrderTuple> out;
+    book.for_each_order([&](const OrderView& n) {
+        out.emplace_back(n.seq, n.original_price, n.sort_price, n.volume,
+                         static_cast<int>(n.type), static_cast<int>(n.side));
+    });
+    return out;
+}
+
+bool expect_true(const std::string& name, bool cond) {
+    if (cond) return true;
+    std::cerr << "[FAIL] " << name << "\n";
+    return false;
+}
+
+bool same_book(const std::string& name, const FastOrderBook& a, const FastOrderBook& b) {
+    bool ok = true;
+    ok &= expect_true(name + " orders", dump_orders(a) == dump_orders(b));
+    ok &= expect_true(name + " bids", a.get_bid_levels(10) == b.get_bid_levels(10));
+    ok &= expect_true(name + " asks", a.get_ask_levels(10) == b.get_ask_levels(10));
+    ok &= expect_true(name + " best bid", a.get_best_bid() == b.get_best_bid());
+    ok &= expect_true(name + " best ask", a.get_best_ask() == b.get_best_ask());
+    ok &= expect_true(name + " count", a.order_count() == b.order_count());
+    return ok;
+}
+
+struct LiveOrder {
+    int book;
+    uint64_t id;
+    int32_t side;
+    uint32_t volume;
+};
+
+// 同一笔消息同时发给共享池订单簿与参考订单簿
+struct Pair {
+    FastOrderBook* shared;
+    FastOrderBook* ref;
+};
+
+bool test_compact() {
+    Pool shared_pool(16);
+    Pool ref_pool0(16);
+    Pool ref_pool1(16);
+    auto book0 = std::make_unique<FastOrderBook>(0, shared_pool, 900000, 1100000);
+    auto book1 = std::make_unique<FastOrderBook>(0, shared_pool, 900000, 1100000);
+    FastOrderBook ref0(0, ref_pool0, 900000, 1100000);
+    FastOrderBook ref1(0, ref_pool1, 900000, 1100000);
+    Pair books[2] = {{book0.get(), &ref0}, {book1.get(), &ref1}};
+
+    std::mt19937 rng(20260311);
+    std::vector<LiveOrder> live;
+    uint64_t next_id = 1;
+    bool ok = true;
+
+    auto cancel = [&](size_t pick, uint32_t q) {
+        LiveOrder& l = live[pick];
+        MDTransactionStruct c = make_cancel(l.id, q, l.side);
+        books[l.book].shared->on_transaction(c);
+        books[l.book].ref->on_transaction(c);
+        l.volume -= q;
+        if (l.volume == 0) {
+            live[pick] = live.back();
+            live.pop_back();
+        }
+    };
+
+    // 上午：两只股票交替挂单，节点在共享池中交错
+    for (int step = 0; step < 20000; ++step) {
+        int b = static_cast<int>(rng() % 2);
+        int32_t side = (rng() % 2) ? 1 : 2;
+        uint32_t r = rng() % 20;
+        int32_t type = (r == 0) ? 1 : (r == 1 ? 3 : 2);
+        uint32_t ticks = rng() % 200;
+        uint32_t price = (side == 1) ? 1000000 - ticks * 100 : 1000100 + ticks * 100;
+        uint32_t qty = 100 * (1 + rng() % 20);
+        MDOrderStruct o = make_order(next_id, price, qty, side, type);
+        books[b].shared->on_order(o);
+        books[b].ref->on_order(o);
+        live.push_back({b, next_id, side, qty});
+        ++next_id;
+    }
+    // 大量撤单，留下稀疏的节点
+    for (int i = 0; i < 18000 && !live.empty(); ++i) {
+        size_t pick = rng() % live.size();
+        cancel(pick, live[pick].volume);
+    }
+    ok &= same_book("before compact 0", *book0, ref0);
+    ok &= same_book("before compact 1", *book1, ref1);
+
+    size_t slabs_before = book0->arena_slab_count() + book1->arena_slab_count();
+    size_t free_slabs_before = shared_pool.free_slab_count();
+    size_t moved = book0->compact() + book1->compact();
+    size_t slabs_after = book0->arena_slab_count() + book1->arena_slab_count();
+
+    ok &= expect_true("moved all", moved == book0->order_count() + book1->order_count());
+    ok &= expect_true("slabs shrink", slabs_after < slabs_before);
+    ok &= expect_true("slabs fit orders",
+                      book0->arena_slab_count() <= book0->order_count() / Pool::SLAB_SIZE + 1 &&
+                      book1->arena_slab_count() <= book1->order_count() / Pool::SLAB_SIZE + 1);
+    // 每个 slab 要么被订单簿持有，要么在池的空闲 slab 列表中
+    ok &= expect_true("old slabs returned",
+                      shared_pool.free_slab_count() > free_slabs_before &&
+                      shared_pool.free_slab_count() + slabs_after == shared_pool.size() / Pool::SLAB_SIZE);
+    ok &= same_book("after compact 0", *book0, ref0);
+    ok &= same_book("after compact 1", *book1, ref1);
+
+    // 下午：继续挂单/撤单 (索引与链表均已重建)
+    for (int step = 0; step < 5000; ++step) {
+        if (!live.empty() && rng() % 2 == 0) {
+            size_t pick = rng() % live.size();
+            cancel(pick, (rng() % 2) ? live[pick].volume : 100);
+        } else {
+            int b = static_cast<int>(rng() % 2);
+            int32_t side = (rng() % 2) ? 1 : 2;
+            uint32_t price = (side == 1) ? 1000000 - (rng() % 200) * 100 : 1000100 + (rng() % 200) * 100;
+            MDOrderStruct o = make_order(next_id, price, 500, side, 2);
+            books[b].shared->on_order(o);
+            books[b].ref->on_order(o);
+            live.push_back({b, next_id, side, 500});
+            ++next_id;
+        }
+    }
+    ok &= same_book("afternoon 0", *book0, ref0);
+    ok &= same_book("afternoon 1", *book1, ref1);
+
+    // 销毁订单簿时 slab 归还共享池
+    size_t held = book0->arena_slab_count();
+    size_t free_before_destroy = shared_pool.free_slab_count();
+    book0.reset();
+    ok &= expect_true("destroy returns slabs", shared_pool.free_slab_count() == free_before_destroy + held);
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    bool ok = true;
+    ok &= test_compact();
+
+    if (!ok) {
+        return 1;
+    }
+
+    std::cout << "test_fastorderbook_compact passed\n";
+    return 0;
+}
@@ -0,0 +1,282 @@
+/**
+ * @file test_fastorderbook_depth.cpp
+ * @brief FastOrderBook 最优价游标与 N 档深度测试
+ *
+ * 使用宽价格带（±20% 高价股，上万档）随机挂单/撤单/成交，
+ * 与基于 std::map 的朴素模型逐步比对 best bid/ask、前 N 档、区间挂单量和累计深度价位，
+ * 并校验前 N 档深度缓存及其版本号。
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "FastOrderBook.h"
+#include "ObjectPool.h"
+#include "market_data_structs_aligned.h"
+
+namespace {
+
+using DepthVec = std::vector<std::pair<uint32_t, uint64_t>>;
+
+MDOrderStruct make_order(uint64_t order_id, uint32_t price, uint32_t qty, int32_t side, int32_t type) {
+    MDOrderStruct order{};
+    std::strncpy(order.htscsecurityid, "300750.SZ", sizeof(order.htscsecurityid) - 1);
+    order.securityidsource = 102;
+    order.securitytype = 1;
+    order.orderindex = static_cast<int64_t>(order_id);
+    order.orderno = 0;
+    order.orderprice = price;
+    order.orderqty = qty;
+    order.ordertype = type;
+    order.orderbsflag = side;
+    order.applseqnum = static_cast<int64_t>(order_id);
+    order.mddate = 20260311;
+    order.mdtime = 100000000;
+    return order;
+}
+
+MDTransactionStruct make_cancel(uint64_t order_id, uint32_t qty, int32_t side) {
+    MDTransactionStruct txn{};
+    std::strncpy(txn.htscsecurityid, "300750.SZ", sizeof(txn.htscsecurityid) - 1);
+    txn.securityidsource = 102;
+    txn.securitytype = 1;
+    txn.tradebuyno = side == 1 ? order_id : 0;
+    txn.tradesellno = side == 2 ? order_id : 0;
+    txn.tradeqty = qty;
+    txn.tradetype = 1;
+    txn.tradebsflag = side;
+    txn.mddate = 20260311;
+    txn.mdtime = 100000000;
+    return txn;
+}
+
+// 朴素模型：price -> volume
+struct NaiveBook {
+    std::map<uint32_t, uint64_t> bids;
+    std::map<uint32_t, uint64_t> asks;
+
+    void add(int32_t side, uint32_t price, uint64_t vol) {
+        (side == 1 ? bids : asks)[price] += vol;
+    }
+
+    void reduce(int32_t side, uint32_t price, uint64_t vol) {
+        auto& m = (side == 1 ? bids : asks);
+        auto it = m.find(price);
+        it->second -= vol;
+        if (it->second == 0) m.erase(it);
+    }
+
+    DepthVec bid_levels(int n) const {
+        DepthVec out;
+        for (auto it = bids.rbegin(); it != bids.rend() && (int)out.size() < n; ++it) out.emplace_back(*it);
+        return out;
+    }
+
+    // 从最优价起累加，返回累计量首次 >= target 的价格 (0 表示不足)
+    uint32_t ask_price_for_volume(uint64_t target) const {
+        uint64_t acc = 0;
+        for (const auto& [p, v] : asks) {
+            acc += v;
+            if (acc >= target) return p;
+        }
+        return 0;
+    }
+
+    uint32_t bid_price_for_volume(uint64_t target) const {
+        uint64_t acc = 0;
+        for (auto it = bids.rbegin(); it != bids.rend(); ++it) {
+            acc += it->second;
+            if (acc >= target) return it->first;
+        }
+        return 0;
+    }
+
+    uint64_t range_volume(const std::map<uint32_t, uint64_t>& m, uint32_t lo, uint32_t hi) const {
+        uint64_t total = 0;
+        for (auto it = m.lower_bound(lo); it != m.end() && it->first <= hi; ++it) total += it->second;
+        return total;
+    }
+
+    DepthVec ask_levels(int n) const {
+        DepthVec out;
+        for (auto it = asks.begin(); it != asks.end() && (int)out.size() < n; ++it) out.emplace_back(*it);
+        return out;
+    }
+};
+
+struct LiveOrder {
+    uint64_t id;
+    int32_t side;
+    uint32_t price;
+    uint32_t volume;
+};
+
+bool expect_depth(const std::string& name, const DepthVec& actual, const DepthVec& expected) {
+    if (actual == expected) return true;
+    std::cerr << "[FAIL] " << name << "\n  expected:";
+    for (const auto& [p, v] : expected) std::cerr << " (" << p << "," << v << ")";
+    std::cerr << "\n  actual  :";
+    for (const auto& [p, v] : actual) std::cerr << " (" << p << "," << v << ")";
+    std::cerr << "\n";
+    return false;
+}
+
+bool expect_best(const std::string& name, std::optional<uint32_t> actual, const std::map<uint32_t, uint64_t>& m, bool is_bid) {
+    std::optional<uint32_t> expected;
+    if (!m.empty()) expected = is_bid ? m.rbegin()->first : m.begin()->first;
+    if (actual == expected) return true;
+    std::cerr << "[FAIL] " << name << " expected=" << expected.value_or(0)
+              << " actual=" << actual.value_or(0) << "\n";
+    return false;
+}
+
+bool expect_value(const std::string& name, uint64_t actual, uint64_t expected) {
+    if (actual == expected) return true;
+    std::cerr << "[FAIL] " << name << " expected=" << expected << " actual=" << actual << "\n";
+    return false;
+}
+
+// 稀疏盘口：买一被打穿后游标应直接跳到远处的下一档
+bool test_sparse_sweep() {
+    ObjectPool<OrderNode> pool(64);
+    // 2000 元 ±20%：16000000 ~ 24000000，共 80001 档
+    FastOrderBook book(1, pool, 16000000, 24000000);
+    bool ok = true;
+
+    ok &= book.on_order(make_order(1, 20000000, 100, 1, 2));
+    ok &= book.on_order(make_order(2, 16000000, 200, 1, 2));   // 跌停价
+    ok &= book.on_order(make_order(3, 20000100, 300, 2, 2));
+    ok &= book.on_order(make_order(4, 24000000, 400, 2, 2));   // 涨停价
+
+    ok &= book.on_transaction(make_cancel(1, 100, 1));
+    ok &= expect_best("bid after sweep", book.get_best_bid(), {{16000000, 200}}, true);
+
+    ok &= book.on_transaction(make_cancel(3, 300, 2));
+    ok &= expect_best("ask after sweep", book.get_best_ask(), {{24000000, 400}}, false);
+
+    ok &= book.on_transaction(make_cancel(2, 200, 1));
+    ok &= book.on_transaction(make_cancel(4, 400, 2));
+    ok &= expect_best("bid empty", book.get_best_bid(), {}, true);
+    ok &= expect_best("ask empty", book.get_best_ask(), {}, false);
+    ok &= expect_depth("bid levels empty", book.get_bid_levels(10), {});
+    ok &= expect_depth("ask levels empty", book.get_ask_levels(10), {});
+    return ok;
+}
+
+DepthVec fixed_levels(const FastOrderBook& book, bool is_bid) {
+    PriceVolume buf[FastOrderBook::DEPTH_CACHE_LEVELS];
+    int n = is_bid ? book.get_bid_levels(buf, FastOrderBook::DEPTH_CACHE_LEVELS)
+                   : book.get_ask_levels(buf, FastOrderBook::DEPTH_CACHE_LEVELS);
+    return DepthVec(buf, buf + n);
+}
+
+// 随机操作与朴素模型比对 (同时驱动一个开启深度缓存的订单簿)
+bool test_random_against_model() {
+    const uint32_t min_price = 800000;    // 80 元
+    const uint32_t max_price = 1200000;   // 120 元，4001 档
+    ObjectPool<OrderNode> pool(1024);
+    FastOrderBook book(1, pool, min_price, max_price);
+    ObjectPool<OrderNode> cached_pool(1024);
+    FastOrderBook cached(1, cached_pool, min_price, max_price);
+    cached.enable_depth_cache(true);
+    NaiveBook model;
+    DepthVec last_bids, last_asks;
+    uint64_t last_bid_version = cached.bid_depth_version();
+    uint64_t last_ask_version = cached.ask_depth_version();
+    std::vector<LiveOrder> live;
+
+    std::mt19937 rng(20260311);
+    uint64_t next_id = 1;
+    bool ok = true;
+
+    for (int step = 0; step < 20000 && ok; ++step) {
+        bool do_add = live.empty() || (rng() % 100) < 55;
+        if (do_add) {
+            int32_t side = (rng() % 2) ? 1 : 2;
+            // 买单集中在 100 元以下，卖单集中在 100 元以上，偶尔远离盘口
+            uint32_t spread = (rng() % 10 == 0) ? 2000 : 50;
+            uint32_t ticks = rng() % spread;
+            uint32_t price = (side == 1) ? 1000000 - ticks * 100 : 1000100 + ticks * 100;
+            if (price < min_price) price = min_price;
+            if (price > max_price) price = max_price;
+            uint32_t qty = 100 * (1 + rng() % 50);
+            ok &= book.on_order(make_order(next_id, price, qty, side, 2));
+            ok &= cached.on_order(make_order(next_id, price, qty, side, 2));
+            model.add(side, price, qty);
+            live.push_back({next_id, side, price, qty});
+            ++next_id;
+        } else {
+            size_t pick = rng() % live.size();
+            LiveOrder& o = live[pick];
+            uint32_t qty = (rng() % 3 == 0) ? o.volume : 100 * (1 + rng() % (o.volume / 100));
+            ok &= book.on_transaction(make_cancel(o.id, qty, o.side));
+            ok &= cached.on_transaction(make_cancel(o.id, qty, o.side));
+            model.reduce(o.side, o.price, qty);
+            o.volume -= qty;
+            if (o.volume == 0) {
+                live[pick] = live.back();
+                live.pop_back();
+            }
+        }
+
+        ok &= expect_best("random best bid step " + std::to_string(step), book.get_best_bid(), model.bids, true);
+        ok &= expect_best("random best ask step " + std::to_string(step), book.get_best_ask(), model.asks, false);
+
+        // 深度缓存：每步与模型一致；版本号未变时前 N 档也不应变化
+        DepthVec bids = fixed_levels(cached, true);
+        DepthVec asks = fixed_levels(cached, false);
+        ok &= expect_depth("cached bid levels step " + std::to_string(step), bids, model.bid_levels(FastOrderBook::DEPTH_CACHE_LEVELS));
+        ok &= expect_depth("cached ask levels step " + std::to_string(step), asks, model.ask_levels(FastOrderBook::DEPTH_CACHE_LEVELS));
+        if (cached.bid_depth_version() == last_bid_version) {
+            ok &= expect_depth("bid version unchanged step " + std::to_string(step), bids, last_bids);
+        }
+        if (cached.ask_depth_version() == last_ask_version) {
+            ok &= expect_depth("ask version unchanged step " + std::to_string(step), asks, last_asks);
+        }
+        last_bids = bids;
+        last_asks = asks;
+        last_bid_version = cached.bid_depth_version();
+        last_ask_version = cached.ask_depth_version();
+        if (step % 50 == 0) {
+            ok &= expect_depth("random bid levels step " + std::to_string(step), book.get_bid_levels(10), model.bid_levels(10));
+            ok &= expect_depth("random ask levels step " + std::to_string(step), book.get_ask_levels(10), model.ask_levels(10));
+            ok &= expect_depth("fixed bid levels step " + std::to_string(step), fixed_levels(book, true), model.bid_levels(FastOrderBook::DEPTH_CACHE_LEVELS));
+
+            // 区间求和与累计深度
+            uint32_t lo = min_price + (rng() % 4001) * 100;
+            uint32_t hi = lo + (rng() % 400) * 100;
+            ok &= expect_value("ask range step " + std::to_string(step),
+                               book.get_ask_volume_in_range(lo, hi), model.range_volume(model.asks, lo, hi));
+            ok &= expect_value("bid range step " + std::to_string(step),
+                               book.get_bid_volume_in_range(lo, hi), model.range_volume(model.bids, lo, hi));
+
+            uint64_t target = 100 * (1 + rng() % 2000);
+            ok &= expect_value("ask price for volume step " + std::to_string(step),
+                               book.get_ask_price_for_volume(target).value_or(0), model.ask_price_for_volume(target));
+            ok &= expect_value("bid price for volume step " + std::to_string(step),
+                               book.get_bid_price_for_volume(target).value_or(0), model.bid_price_for_volume(target));
+        }
+    }
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    bool ok = true;
+    ok &= test_sparse_sweep();
+    ok &= test_random_against_model();
+
+    if (!ok) {
+        return 1;
+    }
+
+    std::cout << "test_fastorderbook_depth passed\n";
+    return 0;
+}
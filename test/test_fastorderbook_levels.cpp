@@ -0,0 +1,282 @@
+/**
+ * @file test_fastorderbook_levels.cpp
+ * @brief FastOrderBook 自适应档位存储 (密集窗口 + 稀疏层) 测试
+ *
+ * 宽价格区间 (超过 MAX_DENSE_LEVELS 档) 上价格随机游走，订单簿的最优价、前 N 档、
+ * 单价位/区间挂单量、累计深度查询与简单参考模型逐步比对，并检查窗口确实发生重新居中、
+ * 稀疏层被使用；compact 与开启深度缓存后结果不变。
+ * 无涨跌停订单簿接受任意正价格，窄区间订单簿保持整段预分配且不重新居中。
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "FastOrderBook.h"
+#include "ObjectPool.h"
+#include "market_data_structs_aligned.h"
+
+namespace {
+
+constexpr uint32_t TICK = 100;
+
+MDOrderStruct make_order(uint64_t order_id, uint32_t price, uint32_t qty, int32_t side, int32_t type) {
+    MDOrderStruct order{};
+    std::strncpy(order.htscsecurityid, "000001.SZ", sizeof(order.htscsecurityid) - 1);
+    order.securityidsource = 102;
+    order.securitytype = 1;
+    order.orderindex = static_cast<int64_t>(order_id);
+    order.orderprice = price;
+    order.orderqty = qty;
+    order.ordertype = type;
+    order.orderbsflag = side;
+    order.applseqnum = static_cast<int64_t>(order_id);
+    return order;
+}
+
+MDTransactionStruct make_cancel(uint64_t order_id, uint32_t qty, int32_t side) {
+    MDTransactionStruct txn{};
+    std::strncpy(txn.htscsecurityid, "000001.SZ", sizeof(txn.htscsecurityid) - 1);
+    txn.securityidsource = 102;
+    txn.tradetype = 1;
+    txn.tradebsflag = side;
+    txn.tradeqty = qty;
+    if (side == 1) txn.tradebuyno = static_cast<int64_t>(order_id);
+    else txn.tradesellno = static_cast<int64_t>(order_id);
+    return txn;
+}
+
+bool expect_true(const std::string& name, bool cond) {
+    if (cond) return true;
+    std::cerr << "[FAIL] " << name << "\n";
+    return false;
+}
+
+// 参考模型：价格 -> 挂单量
+struct Reference {
+    struct Order { int32_t side; uint32_t price; uint32_t qty; };
+    std::map<uint32_t, uint64_t> bids;
+    std::map<uint32_t, uint64_t> asks;
+    std::unordered_map<uint64_t, Order> orders;
+
+    std::map<uint32_t, uint64_t>& side_map(int32_t side) { return side == 1 ? bids : asks; }
+
+    void add(uint64_t id, int32_t side, uint32_t price, uint32_t qty) {
+        orders[id] = Order{side, price, qty};
+        side_map(side)[price] += qty;
+    }
+
+    void cancel(uint64_t id, uint32_t qty) {
+        Order& o = orders[id];
+        auto& m = side_map(o.side);
+        m[o.price] -= qty;
+        if (m[o.price] == 0) m.erase(o.price);
+        o.qty -= qty;
+        if (o.qty == 0) orders.erase(id);
+    }
+
+    std::vector<PriceVolume> bid_levels(size_t n) const {
+        std::vector<PriceVolume> out;
+        for (auto it = bids.rbegin(); it != bids.rend() && out.size() < n; ++it) out.emplace_back(it->first, it->second);
+        return out;
+    }
+
+    std::vector<PriceVolume> ask_levels(size_t n) const {
+        std::vector<PriceVolume> out;
+        for (auto it = asks.begin(); it != asks.end() && out.size() < n; ++it) out.emplace_back(it->first, it->second);
+        return out;
+    }
+
+    static uint64_t range(const std::map<uint32_t, uint64_t>& m, uint32_t lo, uint32_t hi) {
+        uint64_t total = 0;
+        for (auto it = m.lower_bound(lo); it != m.end() && it->first <= hi; ++it) total += it->second;
+        return total;
+    }
+
+    std::optional<uint32_t> ask_price_for(uint64_t target) const {
+        uint64_t acc = 0;
+        for (const auto& [p, v] : asks) {
+            acc += v;
+            if (acc >= target) return p;
+        }
+        return std::nullopt;
+    }
+
+    std::optional<uint32_t> bid_price_for(uint64_t target) const {
+        uint64_t acc = 0;
+        for (auto it = bids.rbegin(); it != bids.rend(); ++it) {
+            acc += it->second;
+            if (acc >= target) return it->first;
+        }
+        return std::nullopt;
+    }
+};
+
+bool same_as_reference(const std::string& name, const FastOrderBook& book, const Reference& ref, std::mt19937& rng,
+                       uint32_t lo_price, uint32_t hi_price) {
+    bool ok = true;
+    std::optional<uint32_t> best_bid, best_ask;
+    if (!ref.bids.empty()) best_bid = ref.bids.rbegin()->first;
+    if (!ref.asks.empty()) best_ask = ref.asks.begin()->first;
+    ok &= expect_true(name + " best", book.get_best_bid() == best_bid && book.get_best_ask() == best_ask);
+    ok &= expect_true(name + " bid levels", book.get_bid_levels(10) == ref.bid_levels(10));
+    ok &= expect_true(name + " ask levels", book.get_ask_levels(10) == ref.ask_levels(10));
+    ok &= expect_true(name + " order count", book.order_count() == ref.orders.size());
+
+    for (int i = 0; i < 8; ++i) {
+        uint32_t a = lo_price + (rng() % ((hi_price - lo_price) / TICK + 1)) * TICK;
+        uint32_t b = lo_price + (rng() % ((hi_price - lo_price) / TICK + 1)) * TICK;
+        if (a > b) std::swap(a, b);
+        auto at = [](const std::map<uint32_t, uint64_t>& m, uint32_t p) {
+            auto it = m.find(p);
+            return it == m.end() ? 0 : it->second;
+        };
+        ok &= expect_true(name + " volume at price", book.get_bid_volume_at_price(a) == at(ref.bids, a) &&
+                          book.get_ask_volume_at_price(b) == at(ref.asks, b));
+        ok &= expect_true(name + " range", book.get_bid_volume_in_range(a, b) == Reference::range(ref.bids, a, b) &&
+                          book.get_ask_volume_in_range(a, b) == Reference::range(ref.asks, a, b));
+        uint64_t target = 1 + rng() % 200000;
+        ok &= expect_true(name + " price for volume", book.get_ask_price_for_volume(target) == ref.ask_price_for(target) &&
+                          book.get_bid_price_for_volume(target) == ref.bid_price_for(target));
+    }
+    return ok;
+}
+
+// 在 [lo_price, hi_price] 上随机游走挂单/撤单，定期与参考模型比对
+bool run_random_walk(const std::string& name, FastOrderBook& book, uint32_t lo_price, uint32_t hi_price,
+                     uint32_t seed, int steps, bool expect_sparse) {
+    std::mt19937 rng(seed);
+    Reference ref;
+    std::vector<uint64_t> live;
+    uint64_t next_id = 1;
+    uint32_t mid = lo_price + ((hi_price - lo_price) / 2 / TICK) * TICK;
+    int drift = 1;
+    bool ok = true;
+    size_t max_sparse = 0;
+
+    for (int step = 0; step < steps && ok; ++step) {
+        // 中间价单向漂移，触边反向，跨越多个窗口宽度
+        if (step % 4 == 0) {
+            if (mid + 40 * TICK > hi_price) drift = -1;
+            if (mid < lo_price + 40 * TICK) drift = 1;
+            mid += drift * static_cast<int>(TICK);
+        }
+
+        if (live.empty() || rng() % 10 < 6) {
+            int32_t side = (rng() & 1) ? 1 : 2;
+            uint32_t offset = (1 + rng() % 30) * TICK;
+            uint32_t price = side == 1 ? mid - offset : mid + offset;
+            uint32_t qty = 100 * (1 + rng() % 50);
+            uint64_t id = next_id++;
+            ok &= expect_true(name + " add", book.on_order(make_order(id, price, qty, side, 2)));
+            ref.add(id, side, price, qty);
+            live.push_back(id);
+        } else {
+            // 偏向撤近期订单，让远离中间价的旧档位留在稀疏层
+            size_t n = live.size();
+            size_t i = (rng() % 4 == 0) ? rng() % n : n - 1 - rng() % std::min<size_t>(n, 200);
+            uint64_t id = live[i];
+            const auto& o = ref.orders[id];
+            uint32_t part = (rng() & 1) ? o.qty : 100;
+            int32_t side = o.side;
+            ok &= expect_true(name + " cancel", book.on_transaction(make_cancel(id, part, side)));
+            ref.cancel(id, part);
+            if (ref.orders.count(id) == 0) {
+                live[i] = live.back();
+                live.pop_back();
+            }
+        }
+
+        max_sparse = std::max(max_sparse, book.sparse_level_count());
+        if (step % 256 == 0) ok &= same_as_reference(name, book, ref, rng, lo_price, hi_price);
+        if (step == steps / 2) {
+            book.compact();
+            book.enable_depth_cache(true);
+            ok &= same_as_reference(name + " after compact", book, ref, rng, lo_price, hi_price);
+        }
+    }
+    ok &= same_as_reference(name + " final", book, ref, rng, lo_price, hi_price);
+
+    // 逐单遍历：每个限价单的 sort_price 与参考一致
+    size_t visited = 0;
+    bool views_ok = true;
+    book.for_each_order([&](const OrderView& v) {
+        auto it = ref.orders.find(v.seq);
+        views_ok &= it != ref.orders.end() && it->second.price == v.sort_price && it->second.qty == v.volume;
+        ++visited;
+    });
+    ok &= expect_true(name + " for_each_order", views_ok && visited == ref.orders.size());
+    ok &= expect_true(name + " sparse tier usage", (max_sparse > 0) == expect_sparse);
+    return ok;
+}
+
+bool test_wide_band() {
+    ObjectPool<OrderNode> pool(1 << 16);
+    // 100 ~ 300 元，20001 档
+    FastOrderBook book(0, pool, 1000000, 3000000);
+    bool ok = true;
+    ok &= expect_true("wide limited", book.price_limited() && book.min_price() == 1000000 &&
+                      book.max_price() == 3000000);
+    ok &= expect_true("wide window", book.dense_level_count() == FastOrderBook::DENSE_WINDOW_LEVELS);
+    ok &= run_random_walk("wide", book, 1000000, 3000000, 7, 120000, true);
+    ok &= expect_true("wide recentered", book.recenter_count() > 0 &&
+                      book.dense_level_count() == FastOrderBook::DENSE_WINDOW_LEVELS);
+    ok &= expect_true("out of band rejected", !book.on_order(make_order(1 << 30, 3000100, 100, 2, 2)));
+    return ok;
+}
+
+bool test_unbounded() {
+    ObjectPool<OrderNode> pool(1 << 16);
+    FastOrderBook book(0, pool, 0, 0);
+    bool ok = true;
+    ok &= expect_true("unbounded", !book.price_limited() && book.min_price() == 0 && book.max_price() == 0);
+    ok &= expect_true("lazy window", book.dense_level_count() == 0);
+
+    ok &= expect_true("first order", book.on_order(make_order(1, 500000, 100, 1, 2)));
+    ok &= expect_true("window allocated", book.dense_level_count() == FastOrderBook::DENSE_WINDOW_LEVELS);
+    ok &= expect_true("far prices", book.on_order(make_order(2, 100, 200, 1, 2)) &&
+                      book.on_order(make_order(3, 900000000, 300, 2, 2)));
+    ok &= expect_true("zero price rejected", !book.on_order(make_order(4, 0, 100, 1, 2)));
+    ok &= expect_true("far levels", book.get_bid_levels(5) == std::vector<PriceVolume>({{500000, 100}, {100, 200}}) &&
+                      book.get_best_ask() == 900000000u && book.get_bid_volume_in_range(0, 1000000) == 300);
+    ok &= expect_true("cancel far", book.on_transaction(make_cancel(1, 100, 1)) &&
+                      book.get_best_bid() == 100u && book.sparse_level_count() <= 2);
+
+    FastOrderBook walk(0, pool, 0, 0);
+    ok &= run_random_walk("unbounded", walk, 1000000, 4000000, 11, 80000, true);
+    ok &= expect_true("unbounded recentered", walk.recenter_count() > 0);
+    return ok;
+}
+
+bool test_narrow_band() {
+    ObjectPool<OrderNode> pool(1 << 16);
+    FastOrderBook book(0, pool, 90000, 110000);
+    bool ok = true;
+    ok &= expect_true("narrow dense", book.dense_level_count() == 201);
+    ok &= run_random_walk("narrow", book, 90000, 110000, 3, 20000, false);
+    ok &= expect_true("narrow fixed", book.recenter_count() == 0 && book.sparse_level_count() == 0);
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    bool ok = true;
+    ok &= test_wide_band();
+    ok &= test_unbounded();
+    ok &= test_narrow_band();
+
+    if (!ok) {
+        return 1;
+    }
+
+    std::cout << "test_fastorderbook_levels passed\n";
+    return 0;
+}
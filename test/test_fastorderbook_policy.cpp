@@ -0,0 +1,234 @@
+/**
+ * @file test_fastorderbook_policy.cpp
+ * @brief FastOrderBook 交易所策略与最小报价单位测试
+ *
+ * 验证乘法除法与 div 指令结果一致；按代码确定交易所和报价单位；
+ * 同一随机逐笔流分别喂给 Auto 与指定交易所策略的订单簿，结果完全一致；
+ * 0.001 元报价单位 (基金/可转债) 的订单簿按 10 为档位间隔挂单与查询。
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "FastOrderBook.h"
+#include "FastDivide.h"
+#include "ObjectPool.h"
+#include "market_data_structs_aligned.h"
+#include "utils/symbol_utils.h"
+
+namespace {
+
+constexpr uint32_t MIN_PRICE = 90000;
+constexpr uint32_t MAX_PRICE = 110000;
+
+bool expect_true(const std::string& name, bool cond) {
+    if (cond) return true;
+    std::cerr << "[FAIL] " << name << "\n";
+    return false;
+}
+
+MDOrderStruct make_order(int32_t source, uint64_t order_id, uint32_t price, uint32_t qty,
+                         int32_t side, int32_t type, int64_t applseqnum) {
+    MDOrderStruct order{};
+    std::strncpy(order.htscsecurityid, source == 101 ? "600000.SH" : "000001.SZ",
+                 sizeof(order.htscsecurityid) - 1);
+    order.securityidsource = source;
+    order.securitytype = 1;
+    // 上海: orderno 为委托编号，orderindex 另有取值；深圳: orderno 为 0
+    order.orderindex = source == 101 ? applseqnum : static_cast<int64_t>(order_id);
+    order.orderno = source == 101 ? static_cast<int64_t>(order_id) : 0;
+    order.orderprice = price;
+    order.orderqty = qty;
+    order.ordertype = type;
+    order.orderbsflag = side;
+    order.applseqnum = applseqnum;
+    return order;
+}
+
+MDTransactionStruct make_txn(int32_t source, uint64_t buy_no, uint64_t sell_no, uint32_t qty,
+                             int32_t trade_type, int32_t bs_flag, int64_t applseqnum) {
+    MDTransactionStruct txn{};
+    std::strncpy(txn.htscsecurityid, source == 101 ? "600000.SH" : "000001.SZ",
+                 sizeof(txn.htscsecurityid) - 1);
+    txn.securityidsource = source;
+    txn.securitytype = 1;
+    txn.tradebuyno = static_cast<int64_t>(buy_no);
+    txn.tradesellno = static_cast<int64_t>(sell_no);
+    txn.tradeqty = qty;
+    txn.tradetype = trade_type;
+    txn.tradebsflag = bs_flag;
+    txn.applseqnum = applseqnum;
+    return txn;
+}
+
+using OrderTuple = std::tuple<uint64_t, uint32_t, uint32_t, uint32_t, int, int>;
+
+std::vector<OrderTuple> dump_orders(const FastOrderBook& book) {
+    std::vector<OrderTuple> out;
+    book.for_each_order([&](const OrderView& n) {
+        out.emplace_back(n.seq, n.original_price, n.sort_price, n.volume,
+                         static_cast<int>(n.type), static_cast<int>(n.side));
+    });
+    return out;
+}
+
+bool test_fast_divide() {
+    bool ok = true;
+    const uint32_t divisors[] = {2, 3, 7, 10, 100, 1000, 12345, 0x7FFFFFFF, 0xFFFFFFFF};
+    for (uint32_t d : divisors) {
+        FastDivU32 div(d);
+        bool same = true;
+        for (uint32_t n = 0; n < 2000000; ++n) same &= (div.divide(n) == n / d);
+        for (uint32_t n = 0xFFFFFFFF; n > 0xFFFFFFFF - 100000; --n) same &= (div.divide(n) == n / d);
+        std::mt19937 rng(d);
+        for (int i = 0; i < 1000000; ++i) {
+            uint32_t n = rng();
+            same &= (div.divide(n) == n / d);
+        }
+        ok &= expect_true("divide by " + std::to_string(d), same);
+    }
+    return ok;
+}
+
+bool test_symbol_rules() {
+    bool ok = true;
+    ok &= expect_true("sh stock", symbol_utils::tick_size_for("600000.SH") == 100 &&
+                      exchange_of("600000.SH") == Exchange::Shanghai);
+    ok &= expect_true("star stock", symbol_utils::tick_size_for("688981.SH") == 100);
+    ok &= expect_true("sh etf", symbol_utils::tick_size_for("510300.SH") == 10 &&
+                      exchange_of("510300.SH") == Exchange::Shanghai);
+    ok &= expect_true("sh cb", symbol_utils::tick_size_for("113050.SH") == 10);
+    ok &= expect_true("sz stock", symbol_utils::tick_size_for("000001.SZ") == 100 &&
+                      exchange_of("000001.SZ") == Exchange::Shenzhen);
+    ok &= expect_true("chinext", symbol_utils::tick_size_for("300750.SZ") == 100);
+    ok &= expect_true("sz etf", symbol_utils::tick_size_for("159915.SZ") == 10);
+    ok &= expect_true("sz lof", symbol_utils::tick_size_for("161725.SZ") == 10);
+    ok &= expect_true("sz cb", symbol_utils::tick_size_for("123100.SZ") == 10);
+    ok &= expect_true("no suffix", exchange_of("600000") == Exchange::Shanghai &&
+                      exchange_of("000001") == Exchange::Shenzhen);
+    return ok;
+}
+
+// 同一逐笔流喂给 Auto 与指定策略的订单簿，结果应完全一致
+bool run_equivalence(int32_t source, Exchange exchange) {
+    ObjectPool<OrderNode> pool(4096);
+    FastOrderBook auto_book(0, pool, MIN_PRICE, MAX_PRICE);
+    FastOrderBook typed_book(0, pool, MIN_PRICE, MAX_PRICE, exchange);
+    std::mt19937 rng(static_cast<uint32_t>(source));
+    std::vector<std::tuple<uint64_t, int32_t, uint32_t>> live;   // (id, side, qty)
+    uint64_t next_id = 1000;
+    int64_t appl = 1;
+    bool ok = true;
+
+    auto feed_order = [&](const MDOrderStruct& o) {
+        bool a = auto_book.on_order(o);
+        bool b = typed_book.on_order(o);
+        ok &= expect_true("order result " + std::to_string(appl), a == b);
+    };
+    auto feed_txn = [&](const MDTransactionStruct& t) {
+        bool a = auto_book.on_transaction(t);
+        bool b = typed_book.on_transaction(t);
+        ok &= expect_true("txn result " + std::to_string(appl), a == b);
+    };
+
+    for (int step = 0; step < 4000 && ok; ++step) {
+        uint32_t r = rng() % 10;
+        if (r < 6 || live.size() < 4) {
+            int32_t side = (rng() & 1) ? 1 : 2;
+            uint32_t price = side == 1 ? 99000 + (rng() % 10) * 100 : 100000 + (rng() % 10) * 100;
+            int32_t type = (rng() % 20 == 0) ? 3 : 2;
+            uint32_t qty = 100 * (1 + rng() % 20);
+            uint64_t id = next_id++;
+            feed_order(make_order(source, id, price, qty, side, type, appl++));
+            live.emplace_back(id, side, qty);
+        } else {
+            size_t i = rng() % live.size();
+            auto [id, side, qty] = live[i];
+            uint32_t part = (rng() & 1) ? qty : 100;
+            if (r < 8) {
+                // 撤单
+                feed_txn(make_txn(source, side == 1 ? id : 0, side == 1 ? 0 : id, part, 1, side, appl++));
+            } else {
+                // 成交：被动方为 live[i]，主动方为新编号 (不在簿中)
+                uint64_t aggressor = next_id++;
+                int32_t bs = side == 1 ? 2 : 1;
+                feed_txn(make_txn(source, side == 1 ? id : aggressor, side == 1 ? aggressor : id, part, 0, bs, appl++));
+            }
+            if (part == qty) {
+                live[i] = live.back();
+                live.pop_back();
+            } else {
+                std::get<2>(live[i]) = qty - part;
+            }
+        }
+    }
+
+    ok &= expect_true("same orders", dump_orders(auto_book) == dump_orders(typed_book));
+    ok &= expect_true("same top", auto_book.get_bid_levels(10) == typed_book.get_bid_levels(10) &&
+                      auto_book.get_ask_levels(10) == typed_book.get_ask_levels(10));
+    ok &= expect_true("non-trivial", auto_book.order_count() > 20);
+    return ok;
+}
+
+bool test_policy_equivalence() {
+    bool ok = true;
+    ok &= run_equivalence(102, Exchange::Shenzhen);
+    ok &= run_equivalence(101, Exchange::Shanghai);
+    return ok;
+}
+
+bool test_fund_tick() {
+    ObjectPool<OrderNode> pool(1024);
+    // 3.000 ~ 3.600 元，0.001 元一档
+    FastOrderBook book(0, pool, 30000, 36000, Exchange::Shenzhen, symbol_utils::FUND_TICK_SIZE);
+    bool ok = true;
+    ok &= expect_true("tick", book.tick_size() == 10 && book.max_price() == 36000);
+
+    book.on_order(make_order(102, 1, 33330, 1000, 1, 2, 1));
+    book.on_order(make_order(102, 2, 33340, 2000, 2, 2, 2));
+    book.on_order(make_order(102, 3, 33350, 3000, 2, 2, 3));
+    book.on_order(make_order(102, 4, 33320, 4000, 1, 2, 4));
+
+    ok &= expect_true("best", book.get_best_bid() == 33330u && book.get_best_ask() == 33340u);
+    auto asks = book.get_ask_levels(5);
+    ok &= expect_true("ask levels", asks.size() == 2 && asks[0] == PriceVolume(33340, 2000) &&
+                      asks[1] == PriceVolume(33350, 3000));
+    ok &= expect_true("range", book.get_bid_volume_in_range(33320, 33330) == 5000 &&
+                      book.get_ask_volume_in_range(33350, 33360) == 3000);
+    ok &= expect_true("price for volume", book.get_ask_price_for_volume(4000) == 33350u);
+
+    book.on_transaction(make_txn(102, 1, 0, 1000, 1, 1, 5));
+    ok &= expect_true("cursor", book.get_best_bid() == 33320u);
+
+    bool threw = false;
+    try {
+        FastOrderBook bad(0, pool, 30000, 36000, Exchange::Auto, 1);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    ok &= expect_true("tick must be >= 2", threw);
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    bool ok = true;
+    ok &= test_fast_divide();
+    ok &= test_symbol_rules();
+    ok &= test_policy_equivalence();
+    ok &= test_fund_tick();
+
+    if (!ok) {
+        return 1;
+    }
+
+    std::cout << "test_fastorderbook_policy passed\n";
+    return 0;
+}
@@ -0,0 +1,231 @@
+/**
+ * @file test_flow_metrics.cpp
+ * @brief FastOrderBook 盘口流量指标 (不平衡度 / 微观价格 / OFI) 测试
+ *
+ * 随机逐笔流 (深圳双边成交、上海被动方成交、撤单) 下，参考模型只依据档位变动事件
+ * 逐条重放盘口并按定义计算 OFI；每条消息后订单簿维护的一档/五档量、不平衡度、
+ * 微观价格、累计 OFI 与滑动窗口 OFI 与参考模型一致。中途开启以当前盘口为起点，
+ * 相同窗口重复开启不清零。
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "FastOrderBook.h"
+#include "ObjectPool.h"
+#include "market_data_structs_aligned.h"
+
+namespace {
+
+constexpr uint32_t MIN_PRICE = 90000;
+constexpr uint32_t MAX_PRICE = 110000;
+constexpr uint32_t WINDOW = 37;
+
+MDOrderStruct make_order(int32_t source, uint64_t order_id, uint32_t price, uint32_t qty, int32_t side) {
+    MDOrderStruct order{};
+    std::strncpy(order.htscsecurityid, source == 101 ? "600000.SH" : "000001.SZ", sizeof(order.htscsecurityid) - 1);
+    order.securityidsource = source;
+    order.securitytype = 1;
+    order.orderindex = static_cast<int64_t>(order_id);
+    order.orderno = source == 101 ? static_cast<int64_t>(order_id) : 0;
+    order.orderprice = price;
+    order.orderqty = qty;
+    order.ordertype = 2;
+    order.orderbsflag = side;
+    order.applseqnum = static_cast<int64_t>(order_id);
+    return order;
+}
+
+MDTransactionStruct make_txn(int32_t source, uint64_t buy_no, uint64_t sell_no, uint32_t qty,
+                             int32_t trade_type, int32_t bs_flag) {
+    MDTransactionStruct txn{};
+    std::strncpy(txn.htscsecurityid, source == 101 ? "600000.SH" : "000001.SZ", sizeof(txn.htscsecurityid) - 1);
+    txn.securityidsource = source;
+    txn.securitytype = 1;
+    txn.tradebuyno = static_cast<int64_t>(buy_no);
+    txn.tradesellno = static_cast<int64_t>(sell_no);
+    txn.tradeqty = qty;
+    txn.tradetype = trade_type;
+    txn.tradebsflag = bs_flag;
+    return txn;
+}
+
+bool expect_true(const std::string& name, bool cond) {
+    if (cond) return true;
+    std::cerr << "[FAIL] " << name << "\n";
+    return false;
+}
+
+bool near(double a, double b) {
+    return std::fabs(a - b) < 1e-9;
+}
+
+// 参考模型：由档位变动事件重放的盘口 + 按定义计算的 OFI
+struct RefFlow {
+    std::map<uint32_t, uint64_t> bids;
+    std::map<uint32_t, uint64_t> asks;
+    uint32_t bp = 0, ap = 0;
+    uint64_t bq = 0, aq = 0;
+    int64_t total = 0;
+    std::vector<int64_t> events;
+
+    void top(uint32_t& b_price, uint64_t& b_vol, uint32_t& a_price, uint64_t& a_vol) const {
+        b_price = bids.empty() ? 0 : bids.rbegin()->first;
+        b_vol = bids.empty() ? 0 : bids.rbegin()->second;
+        a_price = asks.empty() ? 0 : asks.begin()->first;
+        a_vol = asks.empty() ? 0 : asks.begin()->second;
+    }
+
+    void start() { top(bp, bq, ap, aq); }
+
+    void apply(const LevelChange& c) {
+        auto& m = c.side == Side::Buy ? bids : asks;
+        if (c.volume == 0) m.erase(c.price);
+        else m[c.price] = c.volume;
+
+        uint32_t nbp, nap;
+        uint64_t nbq, naq;
+        top(nbp, nbq, nap, naq);
+        if (nbp == bp && nbq == bq && nap == ap && naq == aq) return;
+        // 卖方为空视为价格无穷大
+        uint64_t a_now = nap ? nap : (1ull << 40);
+        uint64_t a_prev = ap ? ap : (1ull << 40);
+        int64_t e = 0;
+        if (nbp >= bp) e += static_cast<int64_t>(nbq);
+        if (nbp <= bp) e -= static_cast<int64_t>(bq);
+        if (a_now <= a_prev) e -= static_cast<int64_t>(naq);
+        if (a_now >= a_prev) e += static_cast<int64_t>(aq);
+        bp = nbp; bq = nbq; ap = nap; aq = naq;
+        total += e;
+        events.push_back(e);
+    }
+
+    int64_t window_sum() const {
+        int64_t sum = 0;
+        size_t n = events.size() < WINDOW ? events.size() : WINDOW;
+        for (size_t i = events.size() - n; i < events.size(); ++i) sum += events[i];
+        return sum;
+    }
+
+    uint64_t depth(const std::map<uint32_t, uint64_t>& m, bool reverse) const {
+        uint64_t sum = 0;
+        int i = 0;
+        if (reverse) {
+            for (auto it = m.rbegin(); it != m.rend() && i < FlowMetrics::DEEP_LEVELS; ++it, ++i) sum += it->second;
+        } else {
+            for (auto it = m.begin(); it != m.end() && i < FlowMetrics::DEEP_LEVELS; ++it, ++i) sum += it->second;
+        }
+        return sum;
+    }
+};
+
+double imbalance(uint64_t b, uint64_t a) {
+    return b + a == 0 ? 0.0 : (static_cast<double>(b) - static_cast<double>(a)) / static_cast<double>(b + a);
+}
+
+bool matches(const FastOrderBook& book, const RefFlow& ref) {
+    const FlowMetrics& m = book.flow_metrics();
+    if (m.bid_price != ref.bp || m.ask_price != ref.ap || m.bid_volume != ref.bq || m.ask_volume != ref.aq) return false;
+    uint64_t b5 = ref.depth(ref.bids, true), a5 = ref.depth(ref.asks, false);
+    if (m.bid_volume_l5 != b5 || m.ask_volume_l5 != a5) return false;
+    if (!near(m.imbalance_l1(), imbalance(ref.bq, ref.aq)) || !near(m.imbalance_l5(), imbalance(b5, a5))) return false;
+    if (m.ofi_total != ref.total || m.ofi_window != ref.window_sum() || m.events != ref.events.size()) return false;
+    std::optional<double> mp = m.microprice();
+    if (ref.bp && ref.ap) {
+        double expect = (static_cast<double>(ref.bp) * ref.aq + static_cast<double>(ref.ap) * ref.bq) /
+                        static_cast<double>(ref.bq + ref.aq);
+        return mp && near(*mp, expect);
+    }
+    return !mp;
+}
+
+bool run_stream(int32_t source) {
+    const std::string name = source == 101 ? "sh" : "sz";
+    ObjectPool<OrderNode> pool(1 << 14);
+    FastOrderBook book(0, pool, MIN_PRICE, MAX_PRICE, source == 101 ? Exchange::Shanghai : Exchange::Shenzhen);
+    LevelChangeBuffer changes;
+    RefFlow ref;
+    std::mt19937 rng(static_cast<uint32_t>(source) * 17);
+    std::vector<std::tuple<uint64_t, int32_t, uint32_t>> live;   // (id, side, qty)
+    uint64_t next_id = 1;
+    bool ok = true;
+
+    for (int step = 0; step < 30000 && ok; ++step) {
+        // 中途开启：此前的盘口作为起点，不计入事件
+        if (step == 500) {
+            book.enable_flow_metrics(true, WINDOW);
+            book.set_level_change_sink(&changes);
+            for (const auto& [p, v] : book.get_bid_levels(1000)) ref.bids[p] = v;
+            for (const auto& [p, v] : book.get_ask_levels(1000)) ref.asks[p] = v;
+            ref.start();
+            ok &= expect_true(name + " start", matches(book, ref));
+        }
+
+        uint32_t r = rng() % 10;
+        if (r < 6 || live.size() < 4) {
+            int32_t side = (rng() & 1) ? 1 : 2;
+            uint32_t price = side == 1 ? 99000 + (rng() % 12) * 100 : 100000 + (rng() % 12) * 100;
+            uint32_t qty = 100 * (1 + rng() % 20);
+            uint64_t id = next_id++;
+            book.on_order(make_order(source, id, price, qty, side));
+            live.emplace_back(id, side, qty);
+        } else {
+            size_t i = rng() % live.size();
+            auto [id, side, qty] = live[i];
+            uint32_t part = (rng() & 1) ? qty : 100;
+            if (r < 8) {
+                book.on_transaction(make_txn(source, side == 1 ? id : 0, side == 1 ? 0 : id, part, 1, side));
+            } else {
+                uint64_t aggressor = next_id++;
+                int32_t bs = side == 1 ? 2 : 1;
+                book.on_transaction(make_txn(source, side == 1 ? id : aggressor, side == 1 ? aggressor : id, part, 0, bs));
+            }
+            if (part == qty) {
+                live[i] = live.back();
+                live.pop_back();
+            } else {
+                std::get<2>(live[i]) = qty - part;
+            }
+        }
+
+        if (step >= 500) {
+            for (const LevelChange& c : changes) ref.apply(c);
+            changes.clear();
+            ok &= expect_true(name + " metrics at step " + std::to_string(step), matches(book, ref));
+        }
+    }
+    ok &= expect_true(name + " events", ref.events.size() > 1000);
+
+    // 相同窗口重复开启 (另一策略)：不清零；不同窗口：以当前盘口重新开始
+    int64_t total = book.flow_metrics().ofi_total;
+    book.enable_flow_metrics(true, WINDOW);
+    ok &= expect_true(name + " idempotent", book.flow_metrics().ofi_total == total && book.flow_metrics().events > 0);
+    book.enable_flow_metrics(true, WINDOW + 1);
+    ok &= expect_true(name + " restart", book.flow_metrics().events == 0 && book.flow_metrics().ofi_window_events == WINDOW + 1 &&
+                      book.flow_metrics().bid_price == ref.bp && book.flow_metrics().ask_volume == ref.aq);
+    book.enable_flow_metrics(false);
+    ok &= expect_true(name + " disabled", !book.flow_metrics_enabled());
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    bool ok = true;
+    ok &= run_stream(102);
+    ok &= run_stream(101);
+
+    if (!ok) {
+        return 1;
+    }
+
+    std::cout << "test_flow_metrics passed\n";
+    return 0;
+}
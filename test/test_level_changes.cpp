@@ -0,0 +1,216 @@
+/**
+ * @file test_level_changes.cpp
+ * @brief FastOrderBook 档位变动事件与合成 N 档快照测试
+ *
+ * 随机逐笔流 (深圳双边成交、上海被动方成交、撤单、本方最优单) 下，
+ * 只靠变动事件维护的盘口与订单簿查询结果完全一致；每条事件的原因与消息类型一致；
+ * 合成快照的价格、量、笔数与由事件重建的前 N 档一致。未挂接缓冲区时不产生事件。
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "FastOrderBook.h"
+#include "ObjectPool.h"
+#include "market_data_structs_aligned.h"
+
+namespace {
+
+constexpr uint32_t MIN_PRICE = 90000;
+constexpr uint32_t MAX_PRICE = 110000;
+
+MDOrderStruct make_order(int32_t source, uint64_t order_id, uint32_t price, uint32_t qty, int32_t side, int32_t type) {
+    MDOrderStruct order{};
+    std::strncpy(order.htscsecurityid, source == 101 ? "600000.SH" : "000001.SZ", sizeof(order.htscsecurityid) - 1);
+    order.securityidsource = source;
+    order.securitytype = 1;
+    order.orderindex = static_cast<int64_t>(order_id);
+    order.orderno = source == 101 ? static_cast<int64_t>(order_id) : 0;
+    order.orderprice = price;
+    order.orderqty = qty;
+    order.ordertype = type;
+    order.orderbsflag = side;
+    order.applseqnum = static_cast<int64_t>(order_id);
+    return order;
+}
+
+MDTransactionStruct make_txn(int32_t source, uint64_t buy_no, uint64_t sell_no, uint32_t qty,
+                             int32_t trade_type, int32_t bs_flag) {
+    MDTransactionStruct txn{};
+    std::strncpy(txn.htscsecurityid, source == 101 ? "600000.SH" : "000001.SZ", sizeof(txn.htscsecurityid) - 1);
+    txn.securityidsource = source;
+    txn.securitytype = 1;
+    txn.tradebuyno = static_cast<int64_t>(buy_no);
+    txn.tradesellno = static_cast<int64_t>(sell_no);
+    txn.tradeqty = qty;
+    txn.tradetype = trade_type;
+    txn.tradebsflag = bs_flag;
+    return txn;
+}
+
+bool expect_true(const std::string& name, bool cond) {
+    if (cond) return true;
+    std::cerr << "[FAIL] " << name << "\n";
+    return false;
+}
+
+// 只由变动事件维护的盘口：price -> (volume, count)
+struct DeltaBook {
+    std::map<uint32_t, std::pair<uint64_t, uint32_t>> bids;
+    std::map<uint32_t, std::pair<uint64_t, uint32_t>> asks;
+
+    void apply(const LevelChange& c) {
+        auto& m = c.side == Side::Buy ? bids : asks;
+        if (c.volume == 0 && c.order_count == 0) m.erase(c.price);
+        else m[c.price] = {c.volume, c.order_count};
+    }
+};
+
+bool snapshot_matches(const FastOrderBook& book, const DeltaBook& ref) {
+    L2Snapshot snap;
+    book.build_l2_snapshot(snap);
+    int i = 0;
+    for (auto it = ref.bids.rbegin(); it != ref.bids.rend() && i < L2Snapshot::LEVELS; ++it, ++i) {
+        if (i >= snap.bid_count || snap.bids[i] != PriceVolume(it->first, it->second.first) ||
+            snap.bid_orders[i] != it->second.second) return false;
+    }
+    if (i != snap.bid_count) return false;
+    i = 0;
+    for (auto it = ref.asks.begin(); it != ref.asks.end() && i < L2Snapshot::LEVELS; ++it, ++i) {
+        if (i >= snap.ask_count || snap.asks[i] != PriceVolume(it->first, it->second.first) ||
+            snap.ask_orders[i] != it->second.second) return false;
+    }
+    return i == snap.ask_count && snap.bid_version == book.bid_depth_version() &&
+           snap.ask_version == book.ask_depth_version();
+}
+
+bool full_book_matches(const FastOrderBook& book, const DeltaBook& ref) {
+    std::vector<PriceVolume> bids, asks;
+    for (auto it = ref.bids.rbegin(); it != ref.bids.rend(); ++it) bids.emplace_back(it->first, it->second.first);
+    for (const auto& [p, vc] : ref.asks) asks.emplace_back(p, vc.first);
+    if (book.get_bid_levels(1000) != bids || book.get_ask_levels(1000) != asks) return false;
+    for (const auto& [p, vc] : ref.bids) {
+        if (book.get_bid_order_count_at_price(p) != vc.second) return false;
+    }
+    for (const auto& [p, vc] : ref.asks) {
+        if (book.get_ask_order_count_at_price(p) != vc.second) return false;
+    }
+    return true;
+}
+
+bool run_stream(int32_t source, bool depth_cache) {
+    const std::string name = std::string(source == 101 ? "sh" : "sz") + (depth_cache ? " cached" : "");
+    ObjectPool<OrderNode> pool(1 << 14);
+    FastOrderBook book(0, pool, MIN_PRICE, MAX_PRICE, source == 101 ? Exchange::Shanghai : Exchange::Shenzhen);
+    LevelChangeBuffer changes;
+    book.set_level_change_sink(&changes);
+    book.enable_depth_cache(depth_cache);
+
+    std::mt19937 rng(static_cast<uint32_t>(source) + (depth_cache ? 1 : 0));
+    std::vector<std::tuple<uint64_t, int32_t, uint32_t>> live;   // (id, side, qty)
+    DeltaBook ref;
+    uint64_t next_id = 1;
+    bool ok = true;
+
+    for (int step = 0; step < 20000 && ok; ++step) {
+        uint32_t r = rng() % 10;
+        LevelChangeCause expect_cause;
+        if (r < 6 || live.size() < 4) {
+            int32_t side = (rng() & 1) ? 1 : 2;
+            uint32_t price = side == 1 ? 99000 + (rng() % 15) * 100 : 100000 + (rng() % 15) * 100;
+            int32_t type = (rng() % 20 == 0) ? 3 : 2;
+            uint32_t qty = 100 * (1 + rng() % 20);
+            uint64_t id = next_id++;
+            book.on_order(make_order(source, id, price, qty, side, type));
+            live.emplace_back(id, side, qty);
+            expect_cause = LevelChangeCause::Add;
+        } else {
+            size_t i = rng() % live.size();
+            auto [id, side, qty] = live[i];
+            uint32_t part = (rng() & 1) ? qty : 100;
+            if (r < 8) {
+                book.on_transaction(make_txn(source, side == 1 ? id : 0, side == 1 ? 0 : id, part, 1, side));
+                expect_cause = LevelChangeCause::Cancel;
+            } else {
+                uint64_t aggressor = next_id++;
+                int32_t bs = side == 1 ? 2 : 1;
+                book.on_transaction(make_txn(source, side == 1 ? id : aggressor, side == 1 ? aggressor : id, part, 0, bs));
+                expect_cause = LevelChangeCause::Trade;
+            }
+            if (part == qty) {
+                live[i] = live.back();
+                live.pop_back();
+            } else {
+                std::get<2>(live[i]) = qty - part;
+            }
+        }
+
+        bool causes_ok = changes.size() <= 2;
+        for (const LevelChange& c : changes) {
+            causes_ok &= c.cause == expect_cause;
+            ref.apply(c);
+            uint64_t vol = c.side == Side::Buy ? book.get_bid_volume_at_price(c.price) : book.get_ask_volume_at_price(c.price);
+            uint32_t cnt = c.side == Side::Buy ? book.get_bid_order_count_at_price(c.price)
+                                               : book.get_ask_order_count_at_price(c.price);
+            causes_ok &= vol == c.volume && cnt == c.order_count;
+        }
+        ok &= expect_true(name + " change records", causes_ok);
+        changes.clear();
+
+        if (step % 200 == 0) {
+            ok &= expect_true(name + " full book", full_book_matches(book, ref));
+            ok &= expect_true(name + " snapshot", snapshot_matches(book, ref));
+        }
+    }
+    ok &= expect_true(name + " final", full_book_matches(book, ref) && snapshot_matches(book, ref));
+    return ok;
+}
+
+bool test_detached() {
+    ObjectPool<OrderNode> pool(1024);
+    FastOrderBook book(0, pool, MIN_PRICE, MAX_PRICE, Exchange::Shenzhen);
+    LevelChangeBuffer changes;
+    bool ok = true;
+
+    book.on_order(make_order(102, 1, 100000, 100, 1, 2));
+    ok &= expect_true("no sink", book.level_change_sink() == nullptr);
+
+    book.set_level_change_sink(&changes);
+    book.on_order(make_order(102, 2, 100000, 200, 1, 2));
+    ok &= expect_true("add record", changes.size() == 1 && changes[0].price == 100000 &&
+                      changes[0].volume == 300 && changes[0].order_count == 2 &&
+                      changes[0].side == Side::Buy && changes[0].cause == LevelChangeCause::Add);
+    changes.clear();
+
+    // 市价单不入档位，不产生事件
+    book.on_order(make_order(102, 3, 0, 100, 2, 1));
+    ok &= expect_true("market no record", changes.empty());
+
+    book.set_level_change_sink(nullptr);
+    book.on_transaction(make_txn(102, 1, 0, 100, 1, 1));
+    ok &= expect_true("detached", changes.empty() && book.get_bid_order_count_at_price(100000) == 1);
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    bool ok = true;
+    ok &= run_stream(102, false);
+    ok &= run_stream(102, true);
+    ok &= run_stream(101, true);
+    ok &= test_detached();
+
+    if (!ok) {
+        return 1;
+    }
+
+    std::cout << "test_level_changes passed\n";
+    return 0;
+}
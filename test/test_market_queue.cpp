@@ -0,0 +1,164 @@
+/**
+ * @file test_market_queue.cpp
+ * @brief FastOrderBook 市价单队列 (侵入式双向链表) 测试
+ *
+ * 大量市价单与本方无挂单时转入的本方最优单，按随机顺序部分/全部成交撤单后：
+ * 买卖两侧队列保持到达顺序，聚合挂单量与单数和参考模型一致；
+ * compact 与按 for_each_order 顺序 restore_order 重建后队列顺序不变。
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "FastOrderBook.h"
+#include "ObjectPool.h"
+#include "market_data_structs_aligned.h"
+
+namespace {
+
+constexpr uint32_t MIN_PRICE = 90000;
+constexpr uint32_t MAX_PRICE = 110000;
+
+MDOrderStruct make_order(uint64_t order_id, uint32_t price, uint32_t qty, int32_t side, int32_t type) {
+    MDOrderStruct order{};
+    std::strncpy(order.htscsecurityid, "000001.SZ", sizeof(order.htscsecurityid) - 1);
+    order.securityidsource = 102;
+    order.securitytype = 1;
+    order.orderindex = static_cast<int64_t>(order_id);
+    order.orderprice = price;
+    order.orderqty = qty;
+    order.ordertype = type;
+    order.orderbsflag = side;
+    order.applseqnum = static_cast<int64_t>(order_id);
+    return order;
+}
+
+MDTransactionStruct make_cancel(uint64_t order_id, uint32_t qty, int32_t side) {
+    MDTransactionStruct txn{};
+    std::strncpy(txn.htscsecurityid, "000001.SZ", sizeof(txn.htscsecurityid) - 1);
+    txn.securityidsource = 102;
+    txn.tradetype = 1;
+    txn.tradebsflag = side;
+    txn.tradeqty = qty;
+    if (side == 1) txn.tradebuyno = static_cast<int64_t>(order_id);
+    else txn.tradesellno = static_cast<int64_t>(order_id);
+    return txn;
+}
+
+bool expect_true(const std::string& name, bool cond) {
+    if (cond) return true;
+    std::cerr << "[FAIL] " << name << "\n";
+    return false;
+}
+
+struct MarketEntry {
+    uint64_t seq;
+    uint32_t volume;
+    Side side;
+};
+
+std::vector<MarketEntry> dump_market(const FastOrderBook& book) {
+    std::vector<MarketEntry> out;
+    book.for_each_order([&](const OrderView& v) {
+        if (v.sort_price == 0) out.push_back(MarketEntry{v.seq, v.volume, v.side});
+    });
+    return out;
+}
+
+bool same_entries(const std::vector<MarketEntry>& a, const std::vector<MarketEntry>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].seq != b[i].seq || a[i].volume != b[i].volume || a[i].side != b[i].side) return false;
+    }
+    return true;
+}
+
+// 参考模型：买、卖各一个 FIFO
+std::vector<MarketEntry> expected(const std::vector<MarketEntry>& buys, const std::vector<MarketEntry>& sells) {
+    std::vector<MarketEntry> out = buys;
+    out.insert(out.end(), sells.begin(), sells.end());
+    return out;
+}
+
+uint64_t total(const std::vector<MarketEntry>& q) {
+    uint64_t sum = 0;
+    for (const auto& e : q) sum += e.volume;
+    return sum;
+}
+
+bool test_market_queue() {
+    ObjectPool<OrderNode> pool(1 << 16);
+    FastOrderBook book(0, pool, MIN_PRICE, MAX_PRICE);
+    bool ok = true;
+    std::mt19937 rng(13);
+    std::vector<MarketEntry> buys, sells;
+    uint64_t next_id = 1;
+
+    // 双边均无限价挂单：市价单与本方最优单都进入市价单队列
+    for (int step = 0; step < 40000 && ok; ++step) {
+        if (rng() % 10 < 6 || (buys.empty() && sells.empty())) {
+            int32_t side = (rng() & 1) ? 1 : 2;
+            int32_t type = (rng() % 3 == 0) ? 3 : 1;
+            uint32_t qty = 100 * (1 + rng() % 20);
+            uint64_t id = next_id++;
+            ok &= expect_true("add", book.on_order(make_order(id, 100000, qty, side, type)));
+            (side == 1 ? buys : sells).push_back(MarketEntry{id, qty, side == 1 ? Side::Buy : Side::Sell});
+        } else {
+            auto& q = buys.empty() ? sells : (sells.empty() ? buys : ((rng() & 1) ? buys : sells));
+            size_t i = rng() % q.size();
+            MarketEntry& e = q[i];
+            uint32_t part = (rng() & 1) ? e.volume : 100;
+            int32_t side = e.side == Side::Buy ? 1 : 2;
+            ok &= expect_true("cancel", book.on_transaction(make_cancel(e.seq, part, side)));
+            e.volume -= part;
+            if (e.volume == 0) q.erase(q.begin() + static_cast<std::ptrdiff_t>(i));
+        }
+
+        if (step % 1000 == 0) {
+            ok &= expect_true("aggregates", book.get_market_bid_volume() == total(buys) &&
+                              book.get_market_ask_volume() == total(sells) &&
+                              book.market_order_count(Side::Buy) == buys.size() &&
+                              book.market_order_count(Side::Sell) == sells.size());
+            ok &= expect_true("fifo order", same_entries(dump_market(book), expected(buys, sells)));
+        }
+        if (step == 20000) book.compact();
+    }
+    ok &= expect_true("no limit levels", !book.get_best_bid().has_value() && !book.get_best_ask().has_value());
+    ok &= expect_true("final order", same_entries(dump_market(book), expected(buys, sells)));
+
+    // 快照式重建：按 for_each_order 顺序 restore_order，队列顺序不变
+    FastOrderBook restored(0, pool, MIN_PRICE, MAX_PRICE);
+    book.for_each_order([&](const OrderView& v) {
+        restored.restore_order(v.seq, v.type, v.side, v.original_price, v.sort_price, v.volume);
+    });
+    ok &= expect_true("restored order", same_entries(dump_market(restored), expected(buys, sells)) &&
+                      restored.get_market_bid_volume() == total(buys) &&
+                      restored.get_market_ask_volume() == total(sells));
+
+    // 本方有挂单后 Best 单挂到本方最优档，不再进入市价单队列
+    uint64_t before = restored.get_market_bid_volume();
+    restored.on_order(make_order(next_id++, 99000, 500, 1, 2));
+    restored.on_order(make_order(next_id++, 0, 300, 1, 3));
+    ok &= expect_true("best joins level", restored.get_market_bid_volume() == before &&
+                      restored.get_bid_volume_at_price(99000) == 800);
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    bool ok = true;
+    ok &= test_market_queue();
+
+    if (!ok) {
+        return 1;
+    }
+
+    std::cout << "test_market_queue passed\n";
+    return 0;
+}
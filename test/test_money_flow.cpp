@@ -0,0 +1,214 @@
+/**
+ * @file test_money_flow.cpp
+ * @brief 主力资金流向 (按母单原始规模分档) 测试
+ *
+ * 分档阈值解析与归档边界；深圳双方母单在簿时按原始委托量 (而非剩余量) 归档；
+ * 上海不入簿的主动单按已累计成交量逐笔升档，其剩余部分入簿后按 剩余 + 已成交 归档；
+ * 开启前已在簿的订单按剩余量归档。随机成交流下各档流入/流出与参考模型一致。
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "FastOrderBook.h"
+#include "MoneyFlow.h"
+#include "ObjectPool.h"
+#include "market_data_structs_aligned.h"
+
+namespace {
+
+constexpr uint32_t MIN_PRICE = 90000;
+constexpr uint32_t MAX_PRICE = 110000;
+constexpr uint32_t PRICE = 100000;   // 10.00 元
+
+MDOrderStruct make_order(int32_t source, uint64_t order_id, uint32_t price, uint32_t qty, int32_t side) {
+    MDOrderStruct order{};
+    std::strncpy(order.htscsecurityid, source == 101 ? "600000.SH" : "000001.SZ", sizeof(order.htscsecurityid) - 1);
+    order.securityidsource = source;
+    order.securitytype = 1;
+    order.orderindex = static_cast<int64_t>(order_id);
+    order.orderno = source == 101 ? static_cast<int64_t>(order_id) : 0;
+    order.orderprice = price;
+    order.orderqty = qty;
+    order.ordertype = 2;
+    order.orderbsflag = side;
+    order.applseqnum = static_cast<int64_t>(order_id);
+    return order;
+}
+
+MDTransactionStruct make_trade(int32_t source, uint64_t buy_no, uint64_t sell_no, uint32_t price, uint32_t qty,
+                               int32_t bs_flag) {
+    MDTransactionStruct txn{};
+    std::strncpy(txn.htscsecurityid, source == 101 ? "600000.SH" : "000001.SZ", sizeof(txn.htscsecurityid) - 1);
+    txn.securityidsource = source;
+    txn.securitytype = 1;
+    txn.tradebuyno = static_cast<int64_t>(buy_no);
+    txn.tradesellno = static_cast<int64_t>(sell_no);
+    txn.tradeprice = price;
+    txn.tradeqty = qty;
+    txn.tradetype = 0;
+    txn.tradebsflag = bs_flag;
+    return txn;
+}
+
+bool expect_true(const std::string& name, bool cond) {
+    if (cond) return true;
+    std::cerr << "[FAIL] " << name << "\n";
+    return false;
+}
+
+uint64_t amount(uint64_t qty, uint32_t price = PRICE) {
+    return qty * price;
+}
+
+bool test_buckets() {
+    bool ok = true;
+    MoneyFlowBuckets b;
+    ok &= expect_true("parse", MoneyFlowBuckets::parse("50000,300000,1000000", b) &&
+                      b.lower[1] == 50000 * MoneyFlowBuckets::PRICE_SCALE && b.lower[3] == 1000000 * MoneyFlowBuckets::PRICE_SCALE);
+    ok &= expect_true("classify", b.classify(0) == 0 && b.classify(b.lower[1] - 1) == 0 && b.classify(b.lower[1]) == 1 &&
+                      b.classify(b.lower[2]) == 2 && b.classify(b.lower[3] * 5) == 3);
+
+    MoneyFlowBuckets bad;
+    ok &= expect_true("parse rejects", !MoneyFlowBuckets::parse("", bad) && !MoneyFlowBuckets::parse("1,2", bad) &&
+                      !MoneyFlowBuckets::parse("3,2,5", bad) && !MoneyFlowBuckets::parse("1,x,5", bad) &&
+                      !MoneyFlowBuckets::parse("0,2,5", bad) && !MoneyFlowBuckets::parse("1,2,3,4", bad) &&
+                      !MoneyFlowBuckets::parse("1,2,", bad));
+    return ok;
+}
+
+// 深圳：双方在簿，按原始委托量归档；部分成交后仍按原始量
+bool test_shenzhen() {
+    ObjectPool<OrderNode> pool(64);
+    FastOrderBook book(0, pool, MIN_PRICE, MAX_PRICE, Exchange::Shenzhen);
+    book.on_order(make_order(102, 1, PRICE, 300, 2));   // 已在簿，开启前：按剩余量
+    book.enable_money_flow(MoneyFlowBuckets{});
+
+    book.on_order(make_order(102, 2, PRICE, 100000, 1));   // 100 万元：特大单
+    book.on_order(make_order(102, 3, PRICE, 5000, 2));     // 5 万元：中单
+    book.on_transaction(make_trade(102, 2, 1, PRICE, 300, 1));
+    bool ok = true;
+    ok &= expect_true("sz trade 1", book.money_flow().inflow[3] == amount(300) && book.money_flow().outflow[0] == amount(300));
+
+    book.on_transaction(make_trade(102, 2, 3, PRICE, 5000, 2));
+    const MoneyFlow& f = book.money_flow();
+    ok &= expect_true("sz original size", f.inflow[3] == amount(5300) && f.outflow[1] == amount(5000) &&
+                      f.inflow_volume[3] == 5300 && f.outflow_volume[1] == 5000 && f.trades == 2);
+    ok &= expect_true("sz net", f.main_net() == static_cast<int64_t>(amount(5300)) &&
+                      f.net(0) == -static_cast<int64_t>(amount(300)));
+    return ok;
+}
+
+// 上海：主动买单不入簿，按已累计成交量逐笔升档；剩余部分入簿后按原始量
+bool test_shanghai() {
+    ObjectPool<OrderNode> pool(64);
+    FastOrderBook book(0, pool, MIN_PRICE, MAX_PRICE, Exchange::Shanghai);
+    book.enable_money_flow(MoneyFlowBuckets{});
+    for (uint64_t id = 1; id <= 3; ++id) book.on_order(make_order(101, id, PRICE, 10000, 2));   // 各 10 万元
+
+    // 主动买单 100：累计 1 万 (中单)、2 万 (大单 20 万元)、3 万 (大单)
+    for (uint64_t id = 1; id <= 3; ++id) book.on_transaction(make_trade(101, 100, id, PRICE, 10000, 1));
+    bool ok = true;
+    const MoneyFlow& f = book.money_flow();
+    ok &= expect_true("sh aggressor cumulative", f.inflow[1] == amount(10000) && f.inflow[2] == amount(20000) &&
+                      f.outflow[1] == amount(30000));
+
+    // 剩余 8 万股入簿：原始 11 万股 = 110 万元 (特大单)；被主动卖单 200 成交
+    book.on_order(make_order(101, 100, PRICE, 80000, 1));
+    book.on_transaction(make_trade(101, 100, 200, PRICE, 1000, 2));
+    ok &= expect_true("sh remainder", f.inflow[3] == amount(1000) && f.outflow[0] == amount(1000));
+
+    // 另一主动单重新累计
+    book.on_transaction(make_trade(101, 100, 201, PRICE, 5000, 2));
+    ok &= expect_true("sh new aggressor", f.outflow[1] == amount(35000) && f.inflow[3] == amount(6000) && f.trades == 5);
+    return ok;
+}
+
+// 随机成交流 (深圳)：与按原始委托量计算的参考模型一致
+bool test_random() {
+    ObjectPool<OrderNode> pool(1 << 14);
+    FastOrderBook book(0, pool, MIN_PRICE, MAX_PRICE, Exchange::Shenzhen);
+    MoneyFlowBuckets buckets = MoneyFlowBuckets::from_yuan(20000, 100000, 500000);
+    book.enable_money_flow(buckets);
+    std::mt19937 rng(19);
+    std::map<uint64_t, uint32_t> original;
+    std::vector<std::tuple<uint64_t, uint32_t>> bids, asks;   // (id, 剩余量)
+    MoneyFlow ref;
+    uint64_t next_id = 1;
+    bool ok = true;
+
+    for (int step = 0; step < 20000 && ok; ++step) {
+        if (rng() % 3 != 0 || bids.empty() || asks.empty()) {
+            int32_t side = (rng() & 1) ? 1 : 2;
+            uint32_t qty = 100 * (1 + rng() % (rng() % 10 == 0 ? 5000 : 50));
+            uint32_t price = side == 1 ? 99000 + (rng() % 10) * 100 : 100000 + (rng() % 10) * 100;
+            uint64_t id = next_id++;
+            book.on_order(make_order(102, id, price, qty, side));
+            original[id] = qty;
+            (side == 1 ? bids : asks).emplace_back(id, qty);
+            continue;
+        }
+        size_t bi = rng() % bids.size(), ai = rng() % asks.size();
+        auto& [bid_id, bid_left] = bids[bi];
+        auto& [ask_id, ask_left] = asks[ai];
+        uint32_t qty = std::min(bid_left, ask_left);
+        if (rng() & 1) qty = std::min<uint32_t>(qty, 100);
+        uint32_t price = 99500 + (rng() % 10) * 100;
+        book.on_transaction(make_trade(102, bid_id, ask_id, price, qty, 1 + static_cast<int32_t>(rng() & 1)));
+
+        int in = buckets.classify(amount(original[bid_id], price));
+        int out = buckets.classify(amount(original[ask_id], price));
+        ref.inflow[in] += amount(qty, price);
+        ref.inflow_volume[in] += qty;
+        ref.outflow[out] += amount(qty, price);
+        ref.outflow_volume[out] += qty;
+        ++ref.trades;
+
+        bid_left -= qty;
+        ask_left -= qty;
+        if (bid_left == 0) {
+            bids[bi] = bids.back();
+            bids.pop_back();
+        }
+        if (ask_left == 0) {
+            asks[ai] = asks.back();
+            asks.pop_back();
+        }
+
+        const MoneyFlow& f = book.money_flow();
+        for (int b = 0; b < MoneyFlowBuckets::COUNT; ++b) {
+            ok &= expect_true("random bucket " + std::to_string(b) + " at step " + std::to_string(step),
+                              f.inflow[b] == ref.inflow[b] && f.outflow[b] == ref.outflow[b] &&
+                              f.inflow_volume[b] == ref.inflow_volume[b] && f.outflow_volume[b] == ref.outflow_volume[b]);
+        }
+        ok &= expect_true("random trades", f.trades == ref.trades);
+    }
+    for (int b = 0; b < MoneyFlowBuckets::COUNT; ++b) {
+        ok &= expect_true("random coverage " + std::to_string(b), ref.inflow[b] > 0 && ref.outflow[b] > 0);
+    }
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    bool ok = true;
+    ok &= test_buckets();
+    ok &= test_shenzhen();
+    ok &= test_shanghai();
+    ok &= test_random();
+
+    if (!ok) {
+        return 1;
+    }
+
+    std::cout << "test_money_flow passed\n";
+    return 0;
+}
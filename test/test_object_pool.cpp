@@ -0,0 +1,203 @@
+/**
+ * @file test_object_pool.cpp
+ * @brief 分段 ObjectPool 测试
+ *
+ * 验证跨块增长时已有对象地址不变、空闲链表复用、clear 后重用已映射块，
+ * 以及 THP / HugeTLB (无预留大页时回退) / 预缺页选项下均可正常分配；
+ * Arena 按 slab 分配时各自的对象落在独立连续区间，release 后 slab 被复用。
+ */
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ObjectPool.h"
+
+namespace {
+
+struct Node {
+    uint64_t seq;
+    int32_t next_idx;
+    int32_t prev_idx;
+};
+
+bool expect_true(const std::string& name, bool cond) {
+    if (cond) return true;
+    std::cerr << "[FAIL] " << name << "\n";
+    return false;
+}
+
+bool test_stable_growth() {
+    ObjectPool<Node> pool(16);
+    bool ok = true;
+    ok &= expect_true("initial chunk", pool.chunk_count() == 1 && pool.capacity() == ObjectPool<Node>::CHUNK_SIZE);
+
+    // 跨越 3 个块，记录首块对象地址
+    const size_t n = ObjectPool<Node>::CHUNK_SIZE * 2 + 100;
+    std::vector<Node*> addrs;
+    for (size_t i = 0; i < n; ++i) {
+        int32_t idx = pool.alloc();
+        ok &= expect_true("alloc " + std::to_string(i), idx == static_cast<int32_t>(i));
+        Node& node = pool[idx];
+        ok &= expect_true("zeroed " + std::to_string(i), node.seq == 0 && node.next_idx == 0);
+        node.seq = i;
+        if (i < 1000) addrs.push_back(&node);
+        if (!ok) return false;
+    }
+    ok &= expect_true("grew to 3 chunks", pool.chunk_count() == 3 && pool.size() == n);
+    for (size_t i = 0; i < addrs.size(); ++i) {
+        ok &= expect_true("stable address " + std::to_string(i),
+                          &pool[static_cast<int32_t>(i)] == addrs[i] && addrs[i]->seq == i);
+    }
+    for (size_t i = 0; i < n; i += 4099) {
+        ok &= expect_true("value " + std::to_string(i), pool.get(static_cast<int32_t>(i)).seq == i);
+    }
+
+    bool threw = false;
+    try {
+        pool.get(static_cast<int32_t>(n));
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    ok &= expect_true("get checks bounds", threw);
+    return ok;
+}
+
+bool test_free_list_and_clear() {
+    ObjectPool<Node> pool(16);
+    bool ok = true;
+    int32_t a = pool.alloc();
+    int32_t b = pool.alloc();
+    pool.free(a);
+    pool.free(-1);   // 非法下标忽略
+    pool.free(100);
+    ok &= expect_true("free count", pool.free_count() == 1);
+    ok &= expect_true("reuse freed", pool.alloc() == a);
+    ok &= expect_true("next new", pool.alloc() == b + 1);
+
+    pool.clear();
+    ok &= expect_true("clear keeps chunks", pool.size() == 0 && pool.chunk_count() == 1 && pool.free_count() == 0);
+    int32_t c = pool.alloc();
+    ok &= expect_true("alloc after clear", c == 0 && pool[c].seq == 0);
+    return ok;
+}
+
+bool test_options() {
+    bool ok = true;
+    const ObjectPoolOptions::HugePages modes[] = {
+        ObjectPoolOptions::HugePages::None,
+        ObjectPoolOptions::HugePages::THP,
+        ObjectPoolOptions::HugePages::HugeTLB,
+    };
+    for (auto mode : modes) {
+        for (bool prefault : {false, true}) {
+            ObjectPoolOptions opts;
+            opts.huge_pages = mode;
+            opts.prefault = prefault;
+            std::string tag = "mode=" + std::to_string(static_cast<int>(mode)) + " prefault=" + std::to_string(prefault);
+
+            ObjectPool<Node> pool(ObjectPool<Node>::CHUNK_SIZE + 1, opts);
+            ok &= expect_true(tag + " chunks", pool.chunk_count() == 2);
+            if (mode != ObjectPoolOptions::HugePages::HugeTLB) {
+                ok &= expect_true(tag + " no hugetlb", pool.hugetlb_chunk_count() == 0);
+            }
+            for (size_t i = 0; i < ObjectPool<Node>::CHUNK_SIZE + 10; ++i) {
+                int32_t idx = pool.alloc();
+                pool[idx].seq = i;
+            }
+            ok &= expect_true(tag + " values", pool[0].seq == 0 &&
+                              pool[static_cast<int32_t>(ObjectPool<Node>::CHUNK_SIZE + 9)].seq == ObjectPool<Node>::CHUNK_SIZE + 9);
+            ok &= expect_true(tag + " grew", pool.chunk_count() == 2);
+        }
+    }
+    return ok;
+}
+
+bool test_arena() {
+    using Pool = ObjectPool<Node>;
+    Pool pool(16);
+    Pool::Arena a, b;
+    bool ok = true;
+
+    // 交替分配：每个 Arena 的对象落在自己的 slab 内
+    std::vector<int32_t> from_a, from_b;
+    for (size_t i = 0; i < Pool::SLAB_SIZE + 10; ++i) {
+        from_a.push_back(pool.alloc(a));
+        from_b.push_back(pool.alloc(b));
+    }
+    ok &= expect_true("arena slabs", a.slab_count() == 2 && b.slab_count() == 2);
+    auto in_slabs = [](const Pool::Arena& arena, int32_t idx) {
+        for (int32_t base : arena.slabs) {
+            if (idx >= base && idx < base + static_cast<int32_t>(Pool::SLAB_SIZE)) return true;
+        }
+        return false;
+    };
+    for (size_t i = 0; i < from_a.size(); ++i) {
+        ok &= expect_true("a owns " + std::to_string(i), in_slabs(a, from_a[i]) && !in_slabs(b, from_a[i]));
+        ok &= expect_true("b owns " + std::to_string(i), in_slabs(b, from_b[i]) && !in_slabs(a, from_b[i]));
+    }
+    // 同一 slab 内连续
+    ok &= expect_true("contiguous", from_a[1] == from_a[0] + 1 && from_a[Pool::SLAB_SIZE - 1] == from_a[0] + static_cast<int32_t>(Pool::SLAB_SIZE) - 1);
+    ok &= expect_true("slab aligned", from_a[0] % static_cast<int32_t>(Pool::SLAB_SIZE) == 0);
+
+    // Arena 内复用
+    pool.free(a, from_a[5]);
+    ok &= expect_true("arena reuse", pool.alloc(a) == from_a[5]);
+
+    // 全局 alloc 与 slab 混用：slab 仍按 SLAB_SIZE 对齐
+    int32_t g = pool.alloc();
+    Pool::Arena c;
+    int32_t c0 = pool.alloc(c);
+    ok &= expect_true("mixed alignment", c0 % static_cast<int32_t>(Pool::SLAB_SIZE) == 0 && c0 > g);
+
+    // release 后 slab 归还并被下一个 Arena 复用，对象重新初始化
+    std::vector<int32_t> a_slabs = a.slabs;
+    pool[a_slabs[1]].seq = 77;
+    pool.release(a);
+    ok &= expect_true("released", a.slab_count() == 0 && pool.free_slab_count() == 2);
+    Pool::Arena d;
+    int32_t d0 = pool.alloc(d);
+    ok &= expect_true("slab recycled", d.slab_count() == 1 && d.slabs[0] == a_slabs[1] && d0 == a_slabs[1]);
+    ok &= expect_true("recycled zeroed", pool[d0].seq == 0);
+    return ok;
+}
+
+bool test_reserve() {
+    using Pool = ObjectPool<Node>;
+    Pool pool(16);
+    Pool::Arena a;
+    bool ok = expect_true("reserve", pool.reserve(a, 2 * Pool::SLAB_SIZE + 1) && a.slab_count() == 3);
+
+    // 预留范围内的分配不再向池申请 slab，且按预留顺序连续启用
+    std::vector<int32_t> got;
+    for (size_t i = 0; i < 2 * Pool::SLAB_SIZE + 1; ++i) got.push_back(pool.alloc(a));
+    ok &= expect_true("reserved slabs used", a.slab_count() == 3 && a.reserved.empty());
+    ok &= expect_true("reserved order", got[0] == a.slabs[0] && got[Pool::SLAB_SIZE] == a.slabs[1] &&
+                                            got[2 * Pool::SLAB_SIZE] == a.slabs[2]);
+
+    // 已有余量时不再申请；release 连同未启用的预留一起归还
+    ok &= expect_true("reserve covered", pool.reserve(a, Pool::SLAB_SIZE - 1) && a.slab_count() == 3);
+    ok &= expect_true("reserve more", pool.reserve(a, Pool::SLAB_SIZE) && a.slab_count() == 4 && a.reserved.size() == 1);
+    pool.release(a);
+    ok &= expect_true("release reserved", a.slab_count() == 0 && a.reserved.empty() && pool.free_slab_count() == 4);
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    bool ok = true;
+    ok &= test_stable_growth();
+    ok &= test_free_list_and_clear();
+    ok &= test_options();
+    ok &= test_arena();
+    ok &= test_reserve();
+
+    if (!ok) {
+        return 1;
+    }
+
+    std::cout << "test_object_pool passed\n";
+    return 0;
+}
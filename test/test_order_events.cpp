@@ -0,0 +1,201 @@
+/**
+ * @file test_order_events.cpp
+ * @brief FastOrderBook 订单生命周期事件 (按档位/方向关注) 测试
+ *
+ * 随机逐笔流 (深圳双边成交、上海被动方成交、撤单、市价单) 下，关注一个买方档位与整个卖方，
+ * 每条消息产生的订单事件与参考模型逐条一致 (挂入/部分成交/全部成交/撤单，变动量与剩余量)；
+ * 未关注的档位不产生事件；关注按引用计数登记与撤销。
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "FastOrderBook.h"
+#include "ObjectPool.h"
+#include "market_data_structs_aligned.h"
+
+namespace {
+
+constexpr uint32_t MIN_PRICE = 90000;
+constexpr uint32_t MAX_PRICE = 110000;
+constexpr uint32_t WATCHED_BID = 99500;
+
+MDOrderStruct make_order(int32_t source, uint64_t order_id, uint32_t price, uint32_t qty, int32_t side, int32_t type) {
+    MDOrderStruct order{};
+    std::strncpy(order.htscsecurityid, source == 101 ? "600000.SH" : "000001.SZ", sizeof(order.htscsecurityid) - 1);
+    order.securityidsource = source;
+    order.securitytype = 1;
+    order.orderindex = static_cast<int64_t>(order_id);
+    order.orderno = source == 101 ? static_cast<int64_t>(order_id) : 0;
+    order.orderprice = price;
+    order.orderqty = qty;
+    order.ordertype = type;
+    order.orderbsflag = side;
+    order.applseqnum = static_cast<int64_t>(order_id);
+    return order;
+}
+
+MDTransactionStruct make_txn(int32_t source, uint64_t buy_no, uint64_t sell_no, uint32_t qty,
+                             int32_t trade_type, int32_t bs_flag) {
+    MDTransactionStruct txn{};
+    std::strncpy(txn.htscsecurityid, source == 101 ? "600000.SH" : "000001.SZ", sizeof(txn.htscsecurityid) - 1);
+    txn.securityidsource = source;
+    txn.securitytype = 1;
+    txn.tradebuyno = static_cast<int64_t>(buy_no);
+    txn.tradesellno = static_cast<int64_t>(sell_no);
+    txn.tradeqty = qty;
+    txn.tradetype = trade_type;
+    txn.tradebsflag = bs_flag;
+    return txn;
+}
+
+bool expect_true(const std::string& name, bool cond) {
+    if (cond) return true;
+    std::cerr << "[FAIL] " << name << "\n";
+    return false;
+}
+
+bool same_event(const OrderEvent& a, const OrderEvent& b) {
+    return a.seq == b.seq && a.price == b.price && a.volume == b.volume && a.remaining == b.remaining &&
+           a.side == b.side && a.type == b.type;
+}
+
+struct LiveOrder {
+    uint64_t id;
+    int32_t side;
+    uint32_t price;   // 市价单为 0
+    uint32_t qty;
+};
+
+bool watched(const LiveOrder& o) {
+    return o.side == 2 || o.price == WATCHED_BID;
+}
+
+bool run_stream(int32_t source) {
+    const std::string name = source == 101 ? "sh" : "sz";
+    ObjectPool<OrderNode> pool(1 << 14);
+    FastOrderBook book(0, pool, MIN_PRICE, MAX_PRICE, source == 101 ? Exchange::Shanghai : Exchange::Shenzhen);
+    OrderEventBuffer events;
+    book.set_order_event_sink(&events);
+    bool ok = expect_true(name + " watch", book.watch_orders(Side::Buy, WATCHED_BID) &&
+                          !book.watch_orders(Side::Buy, MAX_PRICE + 100));
+    book.watch_side(Side::Sell);
+
+    std::mt19937 rng(static_cast<uint32_t>(source) * 7);
+    std::vector<LiveOrder> live;
+    uint64_t next_id = 1;
+    size_t total_events = 0;
+
+    for (int step = 0; step < 20000 && ok; ++step) {
+        std::vector<OrderEvent> expect;
+        uint32_t r = rng() % 10;
+        if (r < 6 || live.size() < 4) {
+            int32_t side = (rng() & 1) ? 1 : 2;
+            uint32_t price = side == 1 ? 99000 + (rng() % 10) * 100 : 100000 + (rng() % 10) * 100;
+            // 深圳市价单进入市价单队列 (价格 0)
+            int32_t type = (source == 102 && rng() % 20 == 0) ? 1 : 2;
+            if (type == 1) price = 0;
+            uint32_t qty = 100 * (1 + rng() % 20);
+            LiveOrder o{next_id++, side, price, qty};
+            book.on_order(make_order(source, o.id, price == 0 ? 100000 : price, qty, side, type));
+            if (watched(o)) {
+                expect.push_back(OrderEvent{o.id, price, qty, qty, side == 1 ? Side::Buy : Side::Sell,
+                                            OrderEventType::Added});
+            }
+            live.push_back(o);
+        } else {
+            size_t i = rng() % live.size();
+            LiveOrder& o = live[i];
+            uint32_t part = (rng() & 1) ? o.qty : 100;
+            uint32_t remaining = o.qty - part;
+            OrderEventType type;
+            if (r < 8) {
+                book.on_transaction(make_txn(source, o.side == 1 ? o.id : 0, o.side == 1 ? 0 : o.id, part, 1, o.side));
+                type = OrderEventType::Cancelled;
+            } else {
+                uint64_t aggressor = next_id++;
+                int32_t bs = o.side == 1 ? 2 : 1;
+                book.on_transaction(make_txn(source, o.side == 1 ? o.id : aggressor,
+                                             o.side == 1 ? aggressor : o.id, part, 0, bs));
+                type = remaining > 0 ? OrderEventType::PartiallyFilled : OrderEventType::Filled;
+            }
+            if (watched(o)) {
+                expect.push_back(OrderEvent{o.id, o.price, part, remaining, o.side == 1 ? Side::Buy : Side::Sell, type});
+            }
+            if (remaining == 0) {
+                live[i] = live.back();
+                live.pop_back();
+            } else {
+                o.qty = remaining;
+            }
+        }
+
+        bool same = events.size() == expect.size();
+        for (size_t k = 0; same && k < expect.size(); ++k) same = same_event(events[k], expect[k]);
+        ok &= expect_true(name + " events at step " + std::to_string(step), same);
+        total_events += events.size();
+        events.clear();
+    }
+    ok &= expect_true(name + " produced events", total_events > 1000);
+    return ok;
+}
+
+bool test_watch_registration() {
+    ObjectPool<OrderNode> pool(1024);
+    FastOrderBook book(0, pool, MIN_PRICE, MAX_PRICE, Exchange::Shenzhen);
+    OrderEventBuffer events;
+    bool ok = true;
+
+    // 有关注但未挂接缓冲区：不产生事件
+    book.watch_orders(Side::Buy, 100000);
+    book.on_order(make_order(102, 1, 100000, 100, 1, 2));
+    ok &= expect_true("no sink", book.order_event_sink() == nullptr && events.empty());
+
+    book.set_order_event_sink(&events);
+    book.on_order(make_order(102, 2, 100100, 100, 1, 2));   // 未关注档位
+    book.on_order(make_order(102, 3, 100000, 200, 2, 2));   // 同价位卖方未关注
+    ok &= expect_true("unwatched level", events.empty());
+
+    // 引用计数：两次登记，撤销一次后仍关注
+    book.watch_orders(Side::Buy, 100000);
+    book.unwatch_orders(Side::Buy, 100000);
+    ok &= expect_true("refcount", book.orders_watched(Side::Buy, 100000));
+    book.on_transaction(make_txn(102, 1, 0, 40, 1, 1));
+    ok &= expect_true("partial cancel", events.size() == 1 && events[0].type == OrderEventType::Cancelled &&
+                      events[0].volume == 40 && events[0].remaining == 60 && events[0].price == 100000);
+    events.clear();
+
+    book.unwatch_orders(Side::Buy, 100000);
+    ok &= expect_true("unwatched", !book.orders_watched(Side::Buy, 100000));
+    book.on_transaction(make_txn(102, 1, 0, 60, 1, 1));
+    ok &= expect_true("no events after unwatch", events.empty());
+
+    // 整个方向：各档位与市价单队列
+    book.watch_side(Side::Buy);
+    ok &= expect_true("side watched", book.orders_watched(Side::Buy, 100100) && !book.orders_watched(Side::Sell, 100000));
+    book.on_transaction(make_txn(102, 2, 9, 100, 0, 2));
+    ok &= expect_true("filled", events.size() == 1 && events[0].seq == 2 && events[0].type == OrderEventType::Filled &&
+                      events[0].remaining == 0 && events[0].price == 100100);
+    book.unwatch_side(Side::Buy);
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    bool ok = true;
+    ok &= run_stream(102);
+    ok &= run_stream(101);
+    ok &= test_watch_registration();
+
+    if (!ok) {
+        return 1;
+    }
+
+    std::cout << "test_order_events passed\n";
+    return 0;
+}
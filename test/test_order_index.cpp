@@ -0,0 +1,151 @@
+/**
+ * @file test_order_index.cpp
+ * @brief OrderIndexMap 开放寻址订单索引测试
+ *
+ * 与 std::unordered_map 比对随机插入/覆盖/删除，覆盖扩容与 backward-shift 删除，
+ * 并验证大量增删后探测链不退化 (无墓碑)。
+ */
+
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "OrderIndex.h"
+
+namespace {
+
+bool expect_true(const std::string& name, bool cond) {
+    if (cond) return true;
+    std::cerr << "[FAIL] " << name << "\n";
+    return false;
+}
+
+bool same_contents(const OrderIndexMap& map, const std::unordered_map<uint64_t, int32_t>& ref) {
+    if (map.size() != ref.size()) return false;
+    for (const auto& [k, v] : ref) {
+        const int32_t* p = map.find(k);
+        if (!p || *p != v) return false;
+    }
+    size_t visited = 0;
+    map.for_each([&](uint64_t, int32_t) { ++visited; });
+    return visited == ref.size();
+}
+
+bool test_basic() {
+    OrderIndexMap map(16);
+    bool ok = true;
+
+    ok &= expect_true("empty find", map.find(42) == nullptr);
+    ok &= expect_true("empty erase", !map.erase(42));
+
+    map.insert(42, 7);
+    ok &= expect_true("find after insert", map.find(42) && *map.find(42) == 7);
+    map.insert(42, 9);
+    ok &= expect_true("overwrite keeps size", map.size() == 1 && *map.find(42) == 9);
+    map.insert(42, 9, 3);
+    const OrderIndexMap::Slot* slot = map.find_slot(42);
+    ok &= expect_true("aux stored", slot && slot->value == 9 && slot->aux == 3);
+
+    ok &= expect_true("erase existing", map.erase(42));
+    ok &= expect_true("find after erase", map.find(42) == nullptr && map.empty());
+
+    // 超过 3/4 负载触发扩容
+    for (uint64_t k = 1; k <= 100; ++k) map.insert(k, static_cast<int32_t>(k), static_cast<uint32_t>(k * 2));
+    ok &= expect_true("grow capacity", map.capacity() >= 128 && map.size() == 100);
+    for (uint64_t k = 1; k <= 100; ++k) {
+        const int32_t* p = map.find(k);
+        ok &= expect_true("find after grow " + std::to_string(k), p && *p == static_cast<int32_t>(k));
+        const OrderIndexMap::Slot* s = map.find_slot(k);
+        ok &= expect_true("aux after grow " + std::to_string(k), s && s->aux == k * 2);
+    }
+
+    map.clear();
+    ok &= expect_true("clear", map.empty() && map.find(50) == nullptr);
+    return ok;
+}
+
+// 随机操作与 std::unordered_map 比对，键模拟深圳 orderindex / 上海 orderno 的稠密递增序号
+bool test_random_against_reference() {
+    OrderIndexMap map(16);
+    std::unordered_map<uint64_t, int32_t> ref;
+    std::vector<uint64_t> live;
+    std::mt19937_64 rng(20260311);
+    uint64_t next_seq = 1000000;
+    bool ok = true;
+
+    for (int step = 0; step < 200000 && ok; ++step) {
+        uint32_t op = rng() % 100;
+        if (live.empty() || op < 50) {
+            // 偶尔跳号，模拟其他股票占用的序号
+            next_seq += 1 + (rng() % 8 == 0 ? rng() % 1000 : 0);
+            int32_t v = static_cast<int32_t>(rng() % 1000000);
+            map.insert(next_seq, v);
+            ref[next_seq] = v;
+            live.push_back(next_seq);
+        } else if (op < 90) {
+            size_t pick = rng() % live.size();
+            uint64_t k = live[pick];
+            ok &= expect_true("erase live " + std::to_string(k), map.erase(k));
+            ref.erase(k);
+            live[pick] = live.back();
+            live.pop_back();
+        } else {
+            uint64_t k = rng();
+            ok &= expect_true("lookup " + std::to_string(k),
+                              (map.find(k) != nullptr) == (ref.count(k) != 0));
+        }
+
+        if (step % 5000 == 0) {
+            ok &= expect_true("contents step " + std::to_string(step), same_contents(map, ref));
+        }
+    }
+    ok &= expect_true("final contents", same_contents(map, ref));
+    return ok;
+}
+
+// 稳定挂单量下持续增删：容量不应持续增长，探测链不应因删除退化
+bool test_steady_churn() {
+    OrderIndexMap map(16);
+    std::deque<uint64_t> window;
+    uint64_t seq = 1;
+    bool ok = true;
+
+    for (int i = 0; i < 3000; ++i) {
+        map.insert(seq, i);
+        window.push_back(seq++);
+    }
+    size_t cap_before = map.capacity();
+
+    for (int i = 0; i < 500000; ++i) {
+        map.insert(seq, i);
+        window.push_back(seq++);
+        map.erase(window.front());
+        window.pop_front();
+    }
+
+    ok &= expect_true("steady size", map.size() == 3000);
+    ok &= expect_true("steady capacity", map.capacity() == cap_before);
+    ok &= expect_true("oldest evicted", map.find(1) == nullptr);
+    ok &= expect_true("newest present", map.find(seq - 1) != nullptr);
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    bool ok = true;
+    ok &= test_basic();
+    ok &= test_random_against_reference();
+    ok &= test_steady_churn();
+
+    if (!ok) {
+        return 1;
+    }
+
+    std::cout << "test_order_index passed\n";
+    return 0;
+}
@@ -0,0 +1,179 @@
+/**
+ * @file test_order_node.cpp
+ * @brief 16 字节 OrderNode 编码测试
+ *
+ * 验证节点大小、volume/type/side 打包；订单簿层面：
+ * 限价单不占用原始价旁路表，本方最优/市价单的原始价经 for_each_order 还原；
+ * seq 超过 32 位 (大基准) 与超出窗口 (旁路表) 时都能正确成交/撤单并在 compact 后保持；
+ * 越界限价单与超量订单被拒绝且不占用节点。
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "FastOrderBook.h"
+#include "ObjectPool.h"
+#include "market_data_structs_aligned.h"
+
+namespace {
+
+constexpr uint32_t MIN_PRICE = 90000;
+constexpr uint32_t MAX_PRICE = 110000;
+
+MDOrderStruct make_order(uint64_t order_id, uint32_t price, uint32_t qty, int32_t side, int32_t type) {
+    MDOrderStruct order{};
+    std::strncpy(order.htscsecurityid, "000001.SZ", sizeof(order.htscsecurityid) - 1);
+    order.securityidsource = 102;
+    order.securitytype = 1;
+    order.orderindex = static_cast<int64_t>(order_id);
+    order.orderprice = price;
+    order.orderqty = qty;
+    order.ordertype = type;
+    order.orderbsflag = side;
+    order.applseqnum = static_cast<int64_t>(order_id);
+    return order;
+}
+
+MDTransactionStruct make_cancel(uint64_t order_id, uint32_t qty, int32_t side) {
+    MDTransactionStruct txn{};
+    std::strncpy(txn.htscsecurityid, "000001.SZ", sizeof(txn.htscsecurityid) - 1);
+    txn.securityidsource = 102;
+    txn.tradetype = 1;
+    txn.tradebsflag = side;
+    txn.tradeqty = qty;
+    if (side == 1) txn.tradebuyno = static_cast<int64_t>(order_id);
+    else txn.tradesellno = static_cast<int64_t>(order_id);
+    return txn;
+}
+
+bool expect_true(const std::string& name, bool cond) {
+    if (cond) return true;
+    std::cerr << "[FAIL] " << name << "\n";
+    return false;
+}
+
+std::vector<OrderView> dump(const FastOrderBook& book) {
+    std::vector<OrderView> out;
+    book.for_each_order([&](const OrderView& v) { out.push_back(v); });
+    return out;
+}
+
+bool test_packing() {
+    bool ok = true;
+    ok &= expect_true("node size", sizeof(OrderNode) == 16 && alignof(OrderNode) == 16);
+
+    OrderNode node{};
+    node.init(123, OrderType::Best, Side::Sell, OrderNode::MAX_VOLUME, true);
+    ok &= expect_true("unpack", node.seq_delta == 123 && node.volume() == OrderNode::MAX_VOLUME &&
+                      node.type() == OrderType::Best && node.side() == Side::Sell && node.has_original_price());
+    node.set_volume(7);
+    ok &= expect_true("set volume keeps bits", node.volume() == 7 && node.type() == OrderType::Best &&
+                      node.side() == Side::Sell && node.has_original_price());
+
+    node.init(0, OrderType::Limit, Side::Buy, 0, false);
+    ok &= expect_true("limit buy", node.type() == OrderType::Limit && node.side() == Side::Buy &&
+                      !node.has_original_price() && node.volume() == 0 && node.next_idx == -1);
+    return ok;
+}
+
+bool test_original_price() {
+    ObjectPool<OrderNode> pool(1024);
+    FastOrderBook book(1, pool, MIN_PRICE, MAX_PRICE);
+    bool ok = true;
+
+    book.on_order(make_order(1, 100000, 500, 1, 2));   // 限价买
+    book.on_order(make_order(2, 101000, 300, 2, 2));   // 限价卖
+    book.on_order(make_order(3, 0, 200, 1, 3));        // 本方最优买 -> 100000
+    book.on_order(make_order(4, 99000, 100, 2, 1));    // 市价卖
+    ok &= expect_true("side table only for non-limit", book.original_price_entries() == 2);
+
+    auto orders = dump(book);
+    ok &= expect_true("order count", orders.size() == 4 && book.order_count() == 4);
+    if (orders.size() != 4) return false;
+    ok &= expect_true("limit buy view", orders[0].seq == 1 && orders[0].original_price == 100000 &&
+                      orders[0].sort_price == 100000 && orders[0].volume == 500 &&
+                      orders[0].type == OrderType::Limit && orders[0].side == Side::Buy);
+    ok &= expect_true("best view", orders[1].seq == 3 && orders[1].original_price == 0 &&
+                      orders[1].sort_price == 100000 && orders[1].type == OrderType::Best);
+    ok &= expect_true("limit sell view", orders[2].seq == 2 && orders[2].sort_price == 101000 &&
+                      orders[2].side == Side::Sell);
+    ok &= expect_true("market view", orders[3].seq == 4 && orders[3].original_price == 99000 &&
+                      orders[3].sort_price == 0 && orders[3].type == OrderType::Market);
+
+    // 完结后旁路表条目随节点回收
+    book.on_transaction(make_cancel(3, 200, 1));
+    book.on_transaction(make_cancel(4, 100, 2));
+    ok &= expect_true("side table freed", book.original_price_entries() == 0 && book.order_count() == 2);
+    ok &= expect_true("bid volume", book.get_bid_volume_at_price(100000) == 500);
+    return ok;
+}
+
+bool test_wide_seq() {
+    ObjectPool<OrderNode> pool(1024);
+    FastOrderBook book(1, pool, MIN_PRICE, MAX_PRICE);
+    bool ok = true;
+
+    // 首个 seq 已超过 32 位：由基准吸收，不进旁路表
+    const uint64_t base = (1ULL << 40) + 5;
+    book.on_order(make_order(base, 100000, 100, 1, 2));
+    book.on_order(make_order(base + 1000, 100000, 200, 1, 2));
+    // 远离窗口的 seq：完整值进旁路表
+    const uint64_t far_low = 7;
+    const uint64_t far_high = base + (1ULL << 33);
+    book.on_order(make_order(far_low, 100000, 300, 1, 2));
+    book.on_order(make_order(far_high, 101000, 400, 2, 2));
+    ok &= expect_true("wide entries", book.wide_seq_entries() == 2);
+
+    auto orders = dump(book);
+    ok &= expect_true("wide seqs restored", orders.size() == 4 && orders[0].seq == base &&
+                      orders[1].seq == base + 1000 && orders[2].seq == far_low && orders[3].seq == far_high);
+
+    std::vector<uint64_t> at_price;
+    book.for_each_bid_order_at_price(100000, [&](uint64_t seq, uint32_t) { at_price.push_back(seq); });
+    ok &= expect_true("at price seqs", at_price == std::vector<uint64_t>({base, base + 1000, far_low}));
+
+    // compact 后旁路表随节点下标迁移
+    book.compact();
+    ok &= expect_true("wide after compact", book.wide_seq_entries() == 2 && dump(book).size() == 4 &&
+                      dump(book)[2].seq == far_low);
+
+    ok &= expect_true("cancel wide", book.on_transaction(make_cancel(far_low, 300, 1)) &&
+                      book.on_transaction(make_cancel(far_high, 400, 2)));
+    ok &= expect_true("cancel based", book.on_transaction(make_cancel(base, 100, 1)));
+    ok &= expect_true("wide freed", book.wide_seq_entries() == 0 && book.order_count() == 1 &&
+                      book.get_bid_volume_at_price(100000) == 200 && !book.get_best_ask().has_value());
+    return ok;
+}
+
+bool test_rejects() {
+    ObjectPool<OrderNode> pool(1024);
+    FastOrderBook book(1, pool, MIN_PRICE, MAX_PRICE);
+    bool ok = true;
+
+    ok &= expect_true("out of range rejected", !book.on_order(make_order(1, MAX_PRICE + 100, 100, 1, 2)));
+    ok &= expect_true("oversize rejected", !book.on_order(make_order(2, 100000, OrderNode::MAX_VOLUME + 1, 1, 2)));
+    ok &= expect_true("no node held", book.order_count() == 0 && pool.size() == 0);
+    ok &= expect_true("max volume accepted", book.on_order(make_order(3, 100000, OrderNode::MAX_VOLUME, 1, 2)) &&
+                      book.get_bid_volume_at_price(100000) == OrderNode::MAX_VOLUME);
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    bool ok = true;
+    ok &= test_packing();
+    ok &= test_original_price();
+    ok &= test_wide_seq();
+    ok &= test_rejects();
+
+    if (!ok) {
+        return 1;
+    }
+
+    std::cout << "test_order_node passed\n";
+    return 0;
+}
@@ -0,0 +1,152 @@
+/**
+ * @file test_payload_slab.cpp
+ * @brief 大记录暂存槽 (PayloadSlab) 测试
+ *
+ * 单线程：取出的槽位互不重叠，归还后复用而不再分配；耗尽时按块增长。
+ * 并发：多个生产者取槽、写入记录后把指针经无锁队列交给单个消费者，
+ * 消费者校验内容完整 (槽位未被复用覆盖) 后归还；槽位总数受在途峰值约束，
+ * 归还全部走预分配的显式生产者队列块 (不分配)；预分配很小时退回慢路径并计数。
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "concurrentqueue.h"
+#include "payload_slab.h"
+
+namespace {
+
+// 模拟 Tick 大小的记录：首尾字段由序号决定
+struct Big {
+    uint64_t seq;
+    char body[2200];
+    uint64_t check;
+};
+
+void fill(Big& b, uint64_t seq) {
+    b.seq = seq;
+    std::memset(b.body, static_cast<int>(seq & 0xff), sizeof(b.body));
+    b.check = seq * 2654435761u;
+}
+
+bool intact(const Big& b) {
+    if (b.check != b.seq * 2654435761u) return false;
+    for (char c : b.body) {
+        if (static_cast<unsigned char>(c) != (b.seq & 0xff)) return false;
+    }
+    return true;
+}
+
+bool expect_true(const std::string& name, bool cond) {
+    if (cond) return true;
+    std::cerr << "[FAIL] " << name << "\n";
+    return false;
+}
+
+bool test_basic() {
+    PayloadSlab<Big> slab(8);
+    bool ok = expect_true("empty", slab.capacity() == 0);
+
+    std::set<Big*> taken;
+    for (int i = 0; i < 8; ++i) taken.insert(slab.acquire());
+    ok &= expect_true("one chunk", taken.size() == 8 && slab.capacity() == 8);
+
+    Big* extra = slab.acquire();
+    ok &= expect_true("grow", slab.capacity() == 16 && !taken.count(extra));
+
+    // 归还后复用，不再分配
+    for (Big* p : taken) slab.release(p);
+    slab.release(extra);
+    for (int round = 0; round < 100; ++round) {
+        Big* p = slab.acquire();
+        fill(*p, static_cast<uint64_t>(round));
+        ok &= expect_true("reuse intact", intact(*p));
+        slab.release(p);
+    }
+    ok &= expect_true("no growth on reuse", slab.capacity() == 16);
+    ok &= expect_true("fast release", slab.slow_release_count() == 0);
+
+    // 空闲队列预分配不足：归还仍然成功，走慢路径并计数
+    PayloadSlab<Big> tight(8, 1);
+    std::vector<Big*> many;
+    for (int i = 0; i < 200; ++i) many.push_back(tight.acquire());
+    for (Big* p : many) tight.release(p);
+    std::set<Big*> back;
+    for (int i = 0; i < 200; ++i) back.insert(tight.acquire());
+    ok &= expect_true("slow release counted", tight.slow_release_count() > 0);
+    ok &= expect_true("slow release reusable", back.size() == 200 && tight.capacity() == 200);
+    return ok;
+}
+
+bool test_concurrent() {
+    constexpr int PRODUCERS = 3;
+    constexpr uint64_t PER_PRODUCER = 20000;
+    constexpr size_t MAX_IN_FLIGHT = 256;
+
+    PayloadSlab<Big> slab(32);
+    moodycamel::ConcurrentQueue<Big*> queue;
+    std::atomic<int64_t> in_flight{0};
+    std::atomic<uint64_t> corrupt{0};
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; ++p) {
+        producers.emplace_back([&, p] {
+            moodycamel::ProducerToken token(queue);
+            for (uint64_t i = 0; i < PER_PRODUCER; ++i) {
+                // 限制在途数量，模拟 worker 跟得上的稳态
+                while (in_flight.load(std::memory_order_acquire) >= static_cast<int64_t>(MAX_IN_FLIGHT)) {
+                    std::this_thread::yield();
+                }
+                in_flight.fetch_add(1, std::memory_order_acq_rel);
+                Big* b = slab.acquire();
+                fill(*b, static_cast<uint64_t>(p) * PER_PRODUCER + i);
+                queue.enqueue(token, b);
+                if (i % 128 == 0) std::this_thread::yield();
+            }
+        });
+    }
+
+    uint64_t consumed = 0, sum = 0;
+    Big* b;
+    while (consumed < PRODUCERS * PER_PRODUCER) {
+        if (!queue.try_dequeue(b)) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (!intact(*b)) corrupt.fetch_add(1);
+        sum += b->seq;
+        slab.release(b);
+        in_flight.fetch_sub(1, std::memory_order_acq_rel);
+        ++consumed;
+    }
+    for (auto& t : producers) t.join();
+
+    const uint64_t n = PRODUCERS * PER_PRODUCER;
+    bool ok = expect_true("no corruption", corrupt.load() == 0);
+    ok &= expect_true("all consumed", sum == n * (n - 1) / 2);
+    // 生产者并发扩容时可能各追加一块
+    ok &= expect_true("bounded by in-flight peak", slab.capacity() <= MAX_IN_FLIGHT + PRODUCERS * 32 + 32);
+    ok &= expect_true("no allocating release", slab.slow_release_count() == 0);
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    bool ok = true;
+    ok &= test_basic();
+    ok &= test_concurrent();
+
+    if (!ok) {
+        return 1;
+    }
+
+    std::cout << "test_payload_slab passed\n";
+    return 0;
+}
@@ -0,0 +1,212 @@
+/**
+ * @file test_queue_position.cpp
+ * @brief 排队前缀和索引 (QueueIndex) 与 FastOrderBook 排队位置查询测试
+ *
+ * QueueIndex 单独验证追加/减量/完结、扩容与空洞过半时要求重建；
+ * 订单簿层面：同一随机流 (大量订单堆在同一价位，反复成交/撤单) 下，
+ * 开启索引的档位与沿链表遍历的结果、暴力计算的结果三者一致，compact 后仍一致。
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "FastOrderBook.h"
+#include "ObjectPool.h"
+#include "QueueIndex.h"
+#include "market_data_structs_aligned.h"
+
+namespace {
+
+constexpr uint32_t MIN_PRICE = 90000;
+constexpr uint32_t MAX_PRICE = 110000;
+constexpr uint32_t HOT_PRICE = 110000;   // 涨停价
+
+MDOrderStruct make_order(uint64_t order_id, uint32_t price, uint32_t qty, int32_t side) {
+    MDOrderStruct order{};
+    std::strncpy(order.htscsecurityid, "000001.SZ", sizeof(order.htscsecurityid) - 1);
+    order.securityidsource = 102;
+    order.securitytype = 1;
+    order.orderindex = static_cast<int64_t>(order_id);
+    order.orderprice = price;
+    order.orderqty = qty;
+    order.ordertype = 2;
+    order.orderbsflag = side;
+    order.applseqnum = static_cast<int64_t>(order_id);
+    return order;
+}
+
+MDTransactionStruct make_cancel(uint64_t order_id, uint32_t qty, int32_t side) {
+    MDTransactionStruct txn{};
+    std::strncpy(txn.htscsecurityid, "000001.SZ", sizeof(txn.htscsecurityid) - 1);
+    txn.securityidsource = 102;
+    txn.tradetype = 1;
+    txn.tradebsflag = side;
+    txn.tradeqty = qty;
+    if (side == 1) txn.tradebuyno = static_cast<int64_t>(order_id);
+    else txn.tradesellno = static_cast<int64_t>(order_id);
+    return txn;
+}
+
+bool expect_true(const std::string& name, bool cond) {
+    if (cond) return true;
+    std::cerr << "[FAIL] " << name << "\n";
+    return false;
+}
+
+bool test_queue_index() {
+    bool ok = true;
+    QueueIndex q;
+    for (uint64_t i = 0; i < 10; ++i) ok &= q.append(100 + i, (i + 1) * 100);   // 100..1000
+    ok &= expect_true("total", q.total_volume() == 5500 && q.live_count() == 10);
+    ok &= expect_true("before", q.volume_before(static_cast<uint32_t>(q.position_of(103))) == 600 &&
+                      q.count_before(static_cast<uint32_t>(q.position_of(103))) == 3);
+
+    q.reduce(101, 50, false);
+    q.reduce(102, 300, true);
+    ok &= expect_true("after reduce", q.volume_before(static_cast<uint32_t>(q.position_of(103))) == 250 &&
+                      q.count_before(static_cast<uint32_t>(q.position_of(103))) == 2 && q.position_of(102) == -1);
+    ok &= expect_true("first k", q.volume_of_first(0) == 0 && q.volume_of_first(1) == 100 &&
+                      q.volume_of_first(2) == 250 && q.volume_of_first(3) == 650 &&
+                      q.volume_of_first(100) == q.total_volume());
+
+    // 扩容：在册单数过半时原地翻倍，前缀和不变
+    QueueIndex g(QueueIndex::MIN_CAPACITY);
+    for (uint64_t i = 0; i < 1000; ++i) ok &= g.append(i, 1 + i % 7);
+    uint64_t expect = 0;
+    for (uint64_t i = 0; i < 500; ++i) expect += 1 + i % 7;
+    ok &= expect_true("grow", g.capacity() >= 1000 && g.volume_before(500) == expect && g.volume_of_first(500) == expect);
+
+    // 空洞过半：位置用满后要求重建
+    QueueIndex h(QueueIndex::MIN_CAPACITY);
+    bool refused = false;
+    for (uint64_t i = 0; i < 1000 && !refused; ++i) {
+        if (!h.append(i, 10)) refused = true;
+        else h.reduce(i, 10, true);
+    }
+    ok &= expect_true("refuse when sparse", refused && h.capacity() == QueueIndex::MIN_CAPACITY);
+    return ok;
+}
+
+// 暴力计算：按 for_each_order 的队列顺序
+bool brute_position(const FastOrderBook& book, uint64_t seq, FastOrderBook::QueuePosition& out) {
+    uint32_t sort_price = 0;
+    Side side = Side::Buy;
+    book.for_each_order([&](const OrderView& v) {
+        if (v.seq == seq) {
+            sort_price = v.sort_price;
+            side = v.side;
+        }
+    });
+    if (sort_price == 0) return false;
+    out = FastOrderBook::QueuePosition{0, 0, 0};
+    bool seen = false;
+    book.for_each_order([&](const OrderView& v) {
+        if (v.sort_price != sort_price || v.side != side || v.seq == seq) {
+            seen |= v.seq == seq;
+            return;
+        }
+        if (seen) {
+            out.volume_behind += v.volume;
+        } else {
+            out.volume_ahead += v.volume;
+            ++out.orders_ahead;
+        }
+    });
+    return true;
+}
+
+bool same_position(const std::optional<FastOrderBook::QueuePosition>& a, const FastOrderBook::QueuePosition& b) {
+    return a && a->orders_ahead == b.orders_ahead && a->volume_ahead == b.volume_ahead &&
+           a->volume_behind == b.volume_behind;
+}
+
+bool test_book_queries() {
+    ObjectPool<OrderNode> pool(1 << 16);
+    FastOrderBook tracked(0, pool, MIN_PRICE, MAX_PRICE);
+    FastOrderBook plain(0, pool, MIN_PRICE, MAX_PRICE);
+    bool ok = true;
+    std::mt19937 rng(20260311);
+    std::vector<std::pair<uint64_t, uint32_t>> live;   // (id, qty)
+    std::vector<int32_t> sides;
+    uint64_t next_id = 1;
+
+    auto add = [&](uint32_t price, int32_t side) {
+        uint32_t qty = 100 * (1 + rng() % 30);
+        uint64_t id = next_id++;
+        tracked.on_order(make_order(id, price, qty, side));
+        plain.on_order(make_order(id, price, qty, side));
+        live.emplace_back(id, qty);
+        sides.push_back(side);
+    };
+
+    // 开启前已有的排队订单由 track_queue 全量构建
+    for (int i = 0; i < 300; ++i) add(HOT_PRICE, 1);
+    ok &= expect_true("track", tracked.track_queue(Side::Buy, HOT_PRICE) &&
+                      tracked.queue_tracked(Side::Buy, HOT_PRICE) && !plain.queue_tracked(Side::Buy, HOT_PRICE));
+    ok &= expect_true("track out of range", !tracked.track_queue(Side::Buy, MAX_PRICE + 100));
+
+    for (int step = 0; step < 60000 && ok; ++step) {
+        uint32_t r = rng() % 10;
+        if (r < 5 || live.empty()) {
+            bool hot = rng() % 4 != 0;
+            add(hot ? HOT_PRICE : 100000 + (rng() % 10) * 100, hot ? 1 : 2);
+        } else {
+            size_t i = (r < 8) ? rng() % live.size() : rng() % std::min<size_t>(live.size(), 50);   // 偏向队头 (成交)
+            auto [id, qty] = live[i];
+            uint32_t part = (rng() & 1) ? qty : 100;
+            tracked.on_transaction(make_cancel(id, part, sides[i]));
+            plain.on_transaction(make_cancel(id, part, sides[i]));
+            if (part == qty) {
+                live[i] = live.back();
+                live.pop_back();
+                sides[i] = sides.back();
+                sides.pop_back();
+            } else {
+                live[i].second = qty - part;
+            }
+        }
+
+        if (step % 500 == 0 && !live.empty()) {
+            for (int c = 0; c < 5; ++c) {
+                uint64_t id = live[rng() % live.size()].first;
+                FastOrderBook::QueuePosition expect{};
+                if (!brute_position(plain, id, expect)) continue;
+                ok &= expect_true("tracked position", same_position(tracked.queue_position(id), expect));
+                ok &= expect_true("plain position", same_position(plain.queue_position(id), expect));
+                ok &= expect_true("ahead/behind", tracked.volume_ahead(id) == expect.volume_ahead &&
+                                  tracked.volume_behind(id) == expect.volume_behind);
+            }
+            uint32_t k = rng() % 400;
+            ok &= expect_true("first k", tracked.queue_volume_of_first(Side::Buy, HOT_PRICE, k) ==
+                              plain.queue_volume_of_first(Side::Buy, HOT_PRICE, k));
+        }
+        if (step == 30000) tracked.compact();
+    }
+
+    ok &= expect_true("unknown seq", !tracked.queue_position(next_id + 1).has_value());
+    ok &= expect_true("full level", tracked.queue_volume_of_first(Side::Buy, HOT_PRICE, 1u << 30) ==
+                      tracked.get_bid_volume_at_price(HOT_PRICE));
+    tracked.untrack_queue(Side::Buy, HOT_PRICE);
+    ok &= expect_true("untrack", !tracked.queue_tracked(Side::Buy, HOT_PRICE));
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    bool ok = true;
+    ok &= test_queue_index();
+    ok &= test_book_queries();
+
+    if (!ok) {
+        return 1;
+    }
+
+    std::cout << "test_queue_position passed\n";
+    return 0;
+}
@@ -0,0 +1,156 @@
+/**
+ * @file test_rcu_registry.cpp
+ * @brief RCU 策略注册表 (RcuRegistry) 测试
+ *
+ * 单线程：update 复制-修改-发布，find/snapshot 返回新内容，分片互不影响。
+ * 并发：每个分片一个读者线程 (模拟 worker) 逐轮静止点 + 查表，写者不断增删对象；
+ * 写者在 update 返回 (宽限期结束) 后把被移除的对象标记为已回收，
+ * 读者在两个静止点之间从未读到已回收的对象。离线读者不阻塞写者。
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rcu_registry.h"
+
+namespace {
+
+struct Item {
+    std::atomic<bool> alive{true};
+    int id = 0;
+};
+
+bool expect_true(const std::string& name, bool cond) {
+    if (cond) return true;
+    std::cerr << "[FAIL] " << name << "\n";
+    return false;
+}
+
+bool test_basic() {
+    RcuRegistry<Item> reg(2);
+    Item a, b;
+    a.id = 1;
+    b.id = 2;
+    bool ok = expect_true("empty", reg.find(0, 3) == nullptr && reg.snapshot(1).empty());
+
+    reg.update(0, [&](auto& m) { m.resize(4); m[3].push_back(&a); });
+    reg.update(0, [&](auto& m) { m[3].push_back(&b); });
+    const auto* list = reg.find(0, 3);
+    ok &= expect_true("update", list && list->size() == 2 && (*list)[1] == &b);
+    ok &= expect_true("untouched slot", reg.find(0, 1) && reg.find(0, 1)->empty() && !reg.find(0, 4));
+    ok &= expect_true("shard isolation", reg.find(1, 3) == nullptr);
+
+    reg.update(0, [&](auto& m) { m[3].clear(); });
+    ok &= expect_true("erase", reg.find(0, 3)->empty());
+    return ok;
+}
+
+bool test_concurrent() {
+    constexpr int SHARDS = 3;
+    constexpr int UPDATES = 3000;
+    constexpr uint32_t SYMBOLS = 4;   // 每个分片的局部 ID 数
+
+    RcuRegistry<Item> reg(SHARDS);
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> violations{0}, lookups{0};
+    std::atomic<int> started{0};
+
+    std::vector<std::thread> readers;
+    for (int shard = 0; shard < SHARDS; ++shard) {
+        readers.emplace_back([&, shard] {
+            reg.online(shard);
+            started.fetch_add(1);
+            uint64_t n = 0;
+            std::vector<Item*> held;
+            while (running.load(std::memory_order_acquire)) {
+                reg.quiescent(shard);
+                held.clear();
+                for (uint32_t sym = 0; sym < SYMBOLS; ++sym) {
+                    const auto* list = reg.find(shard, sym);
+                    if (!list) continue;
+                    held.insert(held.end(), list->begin(), list->end());
+                    ++n;
+                }
+                // 到下一个静止点之前，本轮取得的对象必须一直有效
+                for (int spin = 0; spin < 3; ++spin) {
+                    for (Item* item : held) {
+                        if (!item->alive.load(std::memory_order_acquire)) violations.fetch_add(1);
+                    }
+                    std::this_thread::yield();
+                }
+            }
+            reg.offline(shard);
+            lookups.fetch_add(n);
+        });
+    }
+
+    // 写者：随机增删；被移除的对象在宽限期结束后标记回收 (保留内存以便检测)
+    while (started.load() < SHARDS) std::this_thread::yield();
+    std::mt19937 rng(21);
+    std::vector<std::unique_ptr<Item>> graveyard;
+    std::vector<std::vector<std::pair<uint32_t, Item*>>> live(SHARDS);
+    for (int u = 0; u < UPDATES; ++u) {
+        int shard = static_cast<int>(rng() % SHARDS);
+        auto& lv = live[static_cast<size_t>(shard)];
+        if (lv.size() < 4 || rng() % 2 == 0) {
+            auto item = std::make_unique<Item>();
+            item->id = u;
+            uint32_t sym = rng() % SYMBOLS;
+            Item* raw = item.get();
+            graveyard.push_back(std::move(item));
+            reg.update(shard, [&](auto& m) {
+                if (m.size() <= sym) m.resize(sym + 1);
+                m[sym].push_back(raw);
+            });
+            lv.emplace_back(sym, raw);
+        } else {
+            size_t i = rng() % lv.size();
+            auto [sym, raw] = lv[i];
+            lv[i] = lv.back();
+            lv.pop_back();
+            reg.update(shard, [&](auto& m) {
+                auto& vec = m[sym];
+                for (size_t k = 0; k < vec.size(); ++k) {
+                    if (vec[k] == raw) {
+                        vec.erase(vec.begin() + static_cast<std::ptrdiff_t>(k));
+                        break;
+                    }
+                }
+            });
+            raw->alive.store(false, std::memory_order_release);
+        }
+        std::this_thread::yield();
+    }
+
+    running.store(false, std::memory_order_release);
+    for (auto& t : readers) t.join();
+
+    bool ok = expect_true("no reclaimed item observed", violations.load() == 0);
+    ok &= expect_true("readers ran", lookups.load() > 0);
+
+    // 所有读者离线后写者不再等待
+    reg.update(0, [&](auto& m) { m.clear(); });
+    ok &= expect_true("offline readers", reg.snapshot(0).empty());
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    bool ok = true;
+    ok &= test_basic();
+    ok &= test_concurrent();
+
+    if (!ok) {
+        return 1;
+    }
+
+    std::cout << "test_rcu_registry passed\n";
+    return 0;
+}
@@ -0,0 +1,151 @@
+/**
+ * @file test_spsc_ring.cpp
+ * @brief 有界 SPSC 环 (SpscRing) 与接入矩阵测试
+ *
+ * 单线程：容量取整到 2 的幂，满时拒绝、空时返回 0，跨越回绕后顺序不变，批量出队按上限截断。
+ * 并发矩阵：P 个生产者 x S 个消费者，每格一个环；生产者把每个通道的消息按序推入对应消费者的环
+ * (满时等待)，消费者批量轮询本列所有环。每个 (生产者, 通道) 的序号连续递增，总数无丢失。
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "spsc_ring.h"
+
+namespace {
+
+struct Msg {
+    uint32_t producer;
+    uint32_t channel;
+    uint64_t seq;
+    uint64_t check;
+};
+
+bool expect_true(const std::string& name, bool cond) {
+    if (cond) return true;
+    std::cerr << "[FAIL] " << name << "\n";
+    return false;
+}
+
+bool test_basic() {
+    SpscRing<uint64_t> ring(6);
+    bool ok = expect_true("round up", ring.capacity() == 8);
+
+    uint64_t out[16];
+    ok &= expect_true("empty", ring.pop_bulk(out, 16) == 0);
+    for (uint64_t i = 0; i < 8; ++i) ok &= expect_true("push", ring.try_push(i));
+    ok &= expect_true("full", !ring.try_push(99) && ring.size_approx() == 8);
+
+    ok &= expect_true("bulk max", ring.pop_bulk(out, 3) == 3 && out[0] == 0 && out[2] == 2);
+    ok &= expect_true("push after pop", ring.try_push(8) && ring.try_push(9) && ring.try_push(10) && !ring.try_push(11));
+
+    // 跨越回绕
+    size_t n = ring.pop_bulk(out, 16);
+    bool ordered = n == 8;
+    for (size_t i = 0; i < n; ++i) ordered &= out[i] == i + 3;
+    ok &= expect_true("wrap order", ordered && ring.pop_bulk(out, 16) == 0);
+    return ok;
+}
+
+bool test_matrix() {
+    constexpr int PRODUCERS = 4;
+    constexpr int CONSUMERS = 3;
+    constexpr int CHANNELS = 6;           // 每个生产者的通道数，按 channel % CONSUMERS 路由
+    constexpr uint64_t PER_CHANNEL = 20000;
+    constexpr size_t BATCH = 32;
+
+    // [consumer * PRODUCERS + producer]，与引擎中按分片一列的布局相同
+    std::vector<std::unique_ptr<SpscRing<Msg>>> rings;
+    for (int i = 0; i < PRODUCERS * CONSUMERS; ++i) rings.push_back(std::make_unique<SpscRing<Msg>>(64));
+
+    std::atomic<uint64_t> full_waits{0};
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; ++p) {
+        producers.emplace_back([&, p] {
+            std::vector<uint64_t> next(CHANNELS, 0);
+            for (uint64_t i = 0; i < PER_CHANNEL * CHANNELS; ++i) {
+                uint32_t ch = static_cast<uint32_t>((i * 7 + static_cast<uint64_t>(p)) % CHANNELS);
+                if (next[ch] == PER_CHANNEL) ch = 0;
+                while (next[ch] == PER_CHANNEL) ++ch;
+                Msg m{static_cast<uint32_t>(p), ch, next[ch]++, 0};
+                m.check = m.seq * 31 + m.channel * 7 + m.producer;
+                auto& ring = *rings[static_cast<size_t>((ch % CONSUMERS) * PRODUCERS + p)];
+                if (!ring.try_push(m)) {
+                    full_waits.fetch_add(1);
+                    while (!ring.try_push(m)) std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::atomic<uint64_t> disorder{0}, corrupt{0};
+    std::vector<uint64_t> received(CONSUMERS, 0);
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < CONSUMERS; ++c) {
+        consumers.emplace_back([&, c] {
+            uint64_t expected_total = 0;
+            for (int ch = 0; ch < CHANNELS; ++ch) {
+                if (ch % CONSUMERS == c) expected_total += PER_CHANNEL * PRODUCERS;
+            }
+            std::vector<std::vector<uint64_t>> next(PRODUCERS, std::vector<uint64_t>(CHANNELS, 0));
+            Msg batch[BATCH];
+            uint64_t got = 0;
+            int start = 0;
+            while (got < expected_total) {
+                size_t n = 0;
+                for (int i = 0; i < PRODUCERS && n < BATCH; ++i) {
+                    int row = (start + i) % PRODUCERS;
+                    n += rings[static_cast<size_t>(c * PRODUCERS + row)]->pop_bulk(batch + n, BATCH - n);
+                }
+                start = (start + 1) % PRODUCERS;
+                if (n == 0) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                for (size_t k = 0; k < n; ++k) {
+                    const Msg& m = batch[k];
+                    if (m.check != m.seq * 31 + m.channel * 7 + m.producer) corrupt.fetch_add(1);
+                    if (m.seq != next[m.producer][m.channel]++) disorder.fetch_add(1);
+                }
+                got += n;
+            }
+            received[static_cast<size_t>(c)] = got;
+        });
+    }
+
+    for (auto& t : producers) t.join();
+    for (auto& t : consumers) t.join();
+
+    uint64_t total = 0;
+    for (uint64_t r : received) total += r;
+    bool ok = expect_true("matrix no corruption", corrupt.load() == 0);
+    ok &= expect_true("matrix per-channel order", disorder.load() == 0);
+    ok &= expect_true("matrix complete", total == PER_CHANNEL * CHANNELS * PRODUCERS);
+    ok &= expect_true("matrix drained", [&] {
+        for (auto& r : rings) {
+            if (r->size_approx() != 0) return false;
+        }
+        return true;
+    }());
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    bool ok = true;
+    ok &= test_basic();
+    ok &= test_matrix();
+
+    if (!ok) {
+        return 1;
+    }
+
+    std::cout << "test_spsc_ring passed\n";
+    return 0;
+}
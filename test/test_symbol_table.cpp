@@ -0,0 +1,151 @@
+/**
+ * @file test_symbol_table.cpp
+ * @brief 证券代码表 (SymbolTable) 测试
+ *
+ * 登记/查找：全局 ID 稠密递增，分片与 get_exchange_shard_id 一致，分片内局部 ID 稠密；
+ * 代码列表文件加载 (表头、无后缀代码、重复行)；表满返回 INVALID_ID；
+ * 多线程并发登记同一批代码，各线程得到的 ID 一致且不重复。
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "symbol_table.h"
+
+namespace {
+
+bool expect_true(const std::string& name, bool cond) {
+    if (cond) return true;
+    std::cerr << "[FAIL] " << name << "\n";
+    return false;
+}
+
+std::string code_of(int i, bool sh) {
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), sh ? "6%05d.SH" : "0%05d.SZ", i);
+    return buf;
+}
+
+bool test_basic(const symbol_utils::ExchangeShardConfig& cfg) {
+    SymbolTable table(cfg);
+    bool ok = expect_true("empty", table.size() == 0 && table.find("600000.SH") == SymbolTable::INVALID_ID);
+
+    std::vector<std::string> codes;
+    for (int i = 0; i < 200; ++i) codes.push_back(code_of(i, i % 3 != 0));
+
+    std::vector<std::vector<uint32_t>> locals(static_cast<size_t>(cfg.total_shards()));
+    for (size_t i = 0; i < codes.size(); ++i) {
+        uint32_t id = table.intern(codes[i]);
+        ok &= expect_true("dense global id " + codes[i], id == i);
+        const auto& e = table.entry(id);
+        int shard = symbol_utils::get_exchange_shard_id(codes[i].c_str(), cfg);
+        ok &= expect_true("shard " + codes[i], e.shard == shard && codes[i] == e.symbol);
+        locals[static_cast<size_t>(shard)].push_back(e.local_id);
+    }
+    for (size_t s = 0; s < locals.size(); ++s) {
+        for (size_t k = 0; k < locals[s].size(); ++k) {
+            ok &= expect_true("dense local id shard " + std::to_string(s), locals[s][k] == k);
+        }
+    }
+
+    // 重复登记与查找返回同一 ID
+    ok &= expect_true("intern again", table.intern(codes[7]) == 7 && table.find(codes[7].c_str()) == 7);
+    ok &= expect_true("size", table.size() == codes.size());
+    ok &= expect_true("unknown", table.find("688999.SH") == SymbolTable::INVALID_ID);
+    return ok;
+}
+
+bool test_load_csv(const symbol_utils::ExchangeShardConfig& cfg) {
+    const std::string path = "/tmp/test_symbol_table.csv";
+    {
+        std::ofstream out(path);
+        out << "code,name\n600000,浦发银行\n000001\r\n300750.SZ\n\n600000\n";
+    }
+    SymbolTable table(cfg);
+    size_t added = table.load_csv(path);
+    std::remove(path.c_str());
+
+    bool ok = expect_true("csv added", added == 3 && table.size() == 3);
+    ok &= expect_true("csv suffix", table.find("600000.SH") == 0 && table.find("000001.SZ") == 1 &&
+                                        table.find("300750.SZ") == 2);
+    ok &= expect_true("csv missing file", table.load_csv("/nonexistent/symbols.csv") == 0);
+    return ok;
+}
+
+bool test_capacity(const symbol_utils::ExchangeShardConfig& cfg) {
+    SymbolTable table(cfg, 4);
+    bool ok = true;
+    for (int i = 0; i < 4; ++i) ok &= expect_true("fill", table.intern(code_of(i, true)) == static_cast<uint32_t>(i));
+    ok &= expect_true("full", table.intern(code_of(9, true)) == SymbolTable::INVALID_ID);
+    ok &= expect_true("existing when full", table.intern(code_of(2, true)) == 2 && table.size() == 4);
+    return ok;
+}
+
+bool test_concurrent(const symbol_utils::ExchangeShardConfig& cfg) {
+    constexpr int THREADS = 4;
+    constexpr int CODES = 2000;
+    SymbolTable table(cfg);
+    std::vector<std::string> codes;
+    for (int i = 0; i < CODES; ++i) codes.push_back(code_of(i, i % 2 == 0));
+
+    std::vector<std::vector<uint32_t>> ids(THREADS, std::vector<uint32_t>(CODES));
+    std::atomic<int> ready{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&, t] {
+            ready.fetch_add(1);
+            while (ready.load() < THREADS) std::this_thread::yield();
+            // 各线程以不同顺序登记 (步长与 CODES 互质，遍历全部代码)，交错插入与查找
+            static constexpr int STRIDES[THREADS] = {1, 3, 7, 11};
+            for (int k = 0; k < CODES; ++k) {
+                int i = (k * STRIDES[t] + t * 37) % CODES;
+                ids[static_cast<size_t>(t)][static_cast<size_t>(i)] = table.intern(codes[static_cast<size_t>(i)]);
+                if (k % 64 == 0) std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    bool ok = expect_true("concurrent size", table.size() == CODES);
+    std::set<uint32_t> unique(ids[0].begin(), ids[0].end());
+    ok &= expect_true("concurrent unique", unique.size() == CODES && *unique.rbegin() == CODES - 1);
+    for (int t = 1; t < THREADS; ++t) {
+        ok &= expect_true("concurrent consistent " + std::to_string(t), ids[static_cast<size_t>(t)] == ids[0]);
+    }
+    for (int i = 0; i < CODES; ++i) {
+        ok &= expect_true("concurrent entry", codes[static_cast<size_t>(i)] == table.entry(ids[0][static_cast<size_t>(i)]).symbol);
+    }
+
+    std::set<std::pair<int32_t, uint32_t>> locals;
+    for (uint32_t id = 0; id < table.size(); ++id) locals.emplace(table.entry(id).shard, table.entry(id).local_id);
+    ok &= expect_true("concurrent local ids", locals.size() == CODES);
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    symbol_utils::ExchangeShardConfig cfg;
+    cfg.sh_shard_count = 3;
+    cfg.sz_shard_count = 2;
+
+    bool ok = true;
+    ok &= test_basic(cfg);
+    ok &= test_load_csv(cfg);
+    ok &= test_capacity(cfg);
+    ok &= test_concurrent(cfg);
+
+    if (!ok) {
+        return 1;
+    }
+
+    std::cout << "test_symbol_table passed\n";
+    return 0;
+}
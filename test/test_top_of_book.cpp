@@ -0,0 +1,212 @@
+/**
+ * @file test_top_of_book.cpp
+ * @brief seqlock 一档快照 (SeqlockTopOfBook) 与 FastOrderBook 发布测试
+ *
+ * 并发：一个写者高频发布满足固定关系的记录，多个读者无锁读取，
+ * 读到的每个副本字段间关系成立 (无撕裂)，版本号单调不减。
+ * 订单簿层面：挂接时发布当前状态；每条委托/成交/撤单后的快照与订单簿一档、最近成交、
+ * 逐笔序号一致；取消挂接后不再发布。
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "FastOrderBook.h"
+#include "ObjectPool.h"
+#include "TopOfBook.h"
+#include "market_data_structs_aligned.h"
+
+namespace {
+
+constexpr uint32_t MIN_PRICE = 90000;
+constexpr uint32_t MAX_PRICE = 110000;
+
+MDOrderStruct make_order(int32_t source, uint64_t order_id, uint32_t price, uint32_t qty, int32_t side) {
+    MDOrderStruct order{};
+    std::strncpy(order.htscsecurityid, source == 101 ? "600000.SH" : "000001.SZ", sizeof(order.htscsecurityid) - 1);
+    order.securityidsource = source;
+    order.securitytype = 1;
+    order.orderindex = static_cast<int64_t>(order_id);
+    order.orderno = source == 101 ? static_cast<int64_t>(order_id) : 0;
+    order.orderprice = price;
+    order.orderqty = qty;
+    order.ordertype = 2;
+    order.orderbsflag = side;
+    order.applseqnum = static_cast<int64_t>(order_id);
+    return order;
+}
+
+MDTransactionStruct make_txn(int32_t source, uint64_t buy_no, uint64_t sell_no, uint32_t price, uint32_t qty,
+                             int32_t trade_type, int32_t bs_flag, int64_t applseqnum) {
+    MDTransactionStruct txn{};
+    std::strncpy(txn.htscsecurityid, source == 101 ? "600000.SH" : "000001.SZ", sizeof(txn.htscsecurityid) - 1);
+    txn.securityidsource = source;
+    txn.securitytype = 1;
+    txn.tradebuyno = static_cast<int64_t>(buy_no);
+    txn.tradesellno = static_cast<int64_t>(sell_no);
+    txn.tradeprice = price;
+    txn.tradeqty = qty;
+    txn.tradetype = trade_type;
+    txn.tradebsflag = bs_flag;
+    txn.applseqnum = applseqnum;
+    return txn;
+}
+
+bool expect_true(const std::string& name, bool cond) {
+    if (cond) return true;
+    std::cerr << "[FAIL] " << name << "\n";
+    return false;
+}
+
+// 写者发布 i 时所有字段由 i 决定，读者据此校验副本未撕裂
+TopOfBook record_for(uint64_t i) {
+    TopOfBook t;
+    t.bid_price = static_cast<uint32_t>(i);
+    t.ask_price = static_cast<uint32_t>(i + 100);
+    t.bid_volume = i * 3;
+    t.ask_volume = i * 5;
+    t.last_price = static_cast<uint32_t>(i + 50);
+    t.last_volume = i * 7;
+    t.applseqnum = static_cast<int64_t>(i);
+    return t;
+}
+
+bool test_concurrent() {
+    SeqlockTopOfBook top;
+    constexpr uint64_t WRITES = 2000000;
+    constexpr int READERS = 3;
+    std::atomic<bool> done{false};
+    std::atomic<int> started{0};
+    std::atomic<uint64_t> torn{0}, regress{0}, reads{0};
+
+    bool ok = expect_true("unpublished", !top.published() && top.read().version == 0);
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < READERS; ++r) {
+        readers.emplace_back([&] {
+            uint64_t last_version = 0, n = 0;
+            started.fetch_add(1, std::memory_order_release);
+            while (!done.load(std::memory_order_acquire)) {
+                TopOfBook t = top.read();
+                ++n;
+                if (t.version == 0) continue;
+                TopOfBook expect = record_for(t.bid_price);
+                if (t.ask_price != expect.ask_price || t.bid_volume != expect.bid_volume ||
+                    t.ask_volume != expect.ask_volume || t.last_price != expect.last_price ||
+                    t.last_volume != expect.last_volume || t.applseqnum != expect.applseqnum ||
+                    t.version != t.bid_price) {
+                    torn.fetch_add(1);
+                }
+                if (t.version < last_version) regress.fetch_add(1);
+                last_version = t.version;
+            }
+            reads.fetch_add(n);
+        });
+    }
+
+    // 读者全部就绪后再写，保证与写入重叠
+    while (started.load(std::memory_order_acquire) < READERS) std::this_thread::yield();
+    for (uint64_t i = 1; i <= WRITES; ++i) top.publish(record_for(i));
+    done.store(true, std::memory_order_release);
+    for (auto& t : readers) t.join();
+
+    TopOfBook final_read = top.read();
+    ok &= expect_true("no torn reads", torn.load() == 0);
+    ok &= expect_true("monotonic version", regress.load() == 0);
+    ok &= expect_true("final", final_read.version == WRITES && final_read.bid_price == WRITES && reads.load() > 0);
+    return ok;
+}
+
+bool matches(const FastOrderBook& book, const TopOfBook& t, uint32_t last_price, uint64_t last_volume, int64_t seq) {
+    auto bid = book.get_best_bid();
+    auto ask = book.get_best_ask();
+    return t.bid_price == bid.value_or(0) && t.ask_price == ask.value_or(0) &&
+           t.bid_volume == (bid ? book.get_bid_volume_at_price(*bid) : 0) &&
+           t.ask_volume == (ask ? book.get_ask_volume_at_price(*ask) : 0) &&
+           t.last_price == last_price && t.last_volume == last_volume && t.applseqnum == seq;
+}
+
+bool run_book(int32_t source) {
+    const std::string name = source == 101 ? "sh" : "sz";
+    ObjectPool<OrderNode> pool(1 << 12);
+    FastOrderBook book(0, pool, MIN_PRICE, MAX_PRICE, source == 101 ? Exchange::Shanghai : Exchange::Shenzhen);
+    book.on_order(make_order(source, 1, 99900, 500, 1));
+    book.on_order(make_order(source, 2, 100100, 700, 2));
+
+    // 挂接时发布当前状态
+    SeqlockTopOfBook top;
+    book.set_top_of_book(&top);
+    bool ok = expect_true(name + " attach", top.published() && matches(book, top.read(), 0, 0, 0));
+
+    std::mt19937 rng(static_cast<uint32_t>(source) * 20);
+    std::vector<std::tuple<uint64_t, int32_t, uint32_t>> live = {{1, 1, 500}, {2, 2, 700}};
+    uint64_t next_id = 3;
+    int64_t seq = 1000;
+    uint32_t last_price = 0;
+    uint64_t last_volume = 0;
+
+    for (int step = 0; step < 5000 && ok; ++step) {
+        uint32_t r = rng() % 10;
+        if (r < 6 || live.empty()) {
+            int32_t side = (rng() & 1) ? 1 : 2;
+            uint32_t price = side == 1 ? 99000 + (rng() % 10) * 100 : 100000 + (rng() % 10) * 100;
+            uint32_t qty = 100 * (1 + rng() % 20);
+            uint64_t id = next_id++;
+            MDOrderStruct order = make_order(source, id, price, qty, side);
+            order.applseqnum = ++seq;
+            book.on_order(order);
+            live.emplace_back(id, side, qty);
+        } else {
+            size_t i = rng() % live.size();
+            auto [id, side, qty] = live[i];
+            uint32_t part = (rng() & 1) ? qty : 100;
+            if (r < 8) {
+                book.on_transaction(make_txn(source, side == 1 ? id : 0, side == 1 ? 0 : id, 0, part, 1, side, ++seq));
+            } else {
+                uint64_t aggressor = next_id++;
+                uint32_t price = 99000 + (rng() % 20) * 100;
+                book.on_transaction(make_txn(source, side == 1 ? id : aggressor, side == 1 ? aggressor : id, price, part, 0,
+                                             side == 1 ? 2 : 1, ++seq));
+                last_price = price;
+                last_volume = part;
+            }
+            if (part == qty) {
+                live[i] = live.back();
+                live.pop_back();
+            } else {
+                std::get<2>(live[i]) = qty - part;
+            }
+        }
+        ok &= expect_true(name + " step " + std::to_string(step), matches(book, top.read(), last_price, last_volume, seq));
+    }
+
+    // 取消挂接后不再发布
+    uint64_t version = top.read().version;
+    book.set_top_of_book(nullptr);
+    book.on_order(make_order(source, next_id, 99000, 100, 1));
+    ok &= expect_true(name + " detach", top.read().version == version && !book.top_of_book());
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    bool ok = true;
+    ok &= test_concurrent();
+    ok &= run_book(102);
+    ok &= run_book(101);
+
+    if (!ok) {
+        return 1;
+    }
+
+    std::cout << "test_top_of_book passed\n";
+    return 0;
+}
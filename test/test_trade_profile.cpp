@@ -0,0 +1,198 @@
+/**
+ * @file test_trade_profile.cpp
+ * @brief 分价成交量表 (TradeProfile) 与 FastOrderBook 分价成交查询测试
+ *
+ * TradeProfile 单独验证：密集区向上/向下扩展、离群成交落入稀疏区后随扩展上浮，
+ * 单档/区间/VWAP 与暴力计算一致。
+ * 订单簿层面：随机成交流 (深圳/上海，主动方买/卖/不明) 下按主动方拆分的分价成交量、
+ * 区间成交量与 VWAP 与参考模型一致；撤单与区间外价格不计入。
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+
+#include "FastOrderBook.h"
+#include "ObjectPool.h"
+#include "TradeProfile.h"
+#include "market_data_structs_aligned.h"
+
+namespace {
+
+constexpr uint32_t MIN_PRICE = 90000;
+constexpr uint32_t MAX_PRICE = 110000;
+
+MDTransactionStruct make_txn(int32_t source, uint64_t buy_no, uint64_t sell_no, int64_t price, uint32_t qty,
+                             int32_t trade_type, int32_t bs_flag) {
+    MDTransactionStruct txn{};
+    std::strncpy(txn.htscsecurityid, source == 101 ? "600000.SH" : "000001.SZ", sizeof(txn.htscsecurityid) - 1);
+    txn.securityidsource = source;
+    txn.securitytype = 1;
+    txn.tradebuyno = static_cast<int64_t>(buy_no);
+    txn.tradesellno = static_cast<int64_t>(sell_no);
+    txn.tradeprice = price;
+    txn.tradeqty = qty;
+    txn.tradetype = trade_type;
+    txn.tradebsflag = bs_flag;
+    return txn;
+}
+
+bool expect_true(const std::string& name, bool cond) {
+    if (cond) return true;
+    std::cerr << "[FAIL] " << name << "\n";
+    return false;
+}
+
+bool same_stats(const TradeProfile::Stats& a, const TradeProfile::Stats& b) {
+    for (int k = 0; k < TradeProfile::AGGRESSOR_COUNT; ++k) {
+        if (a.volume[k] != b.volume[k] || a.count[k] != b.count[k]) return false;
+    }
+    return true;
+}
+
+// 参考模型：tick -> Stats
+using RefProfile = std::map<int32_t, TradeProfile::Stats>;
+
+TradeProfile::Stats ref_range(const RefProfile& ref, int32_t from, int32_t to) {
+    TradeProfile::Stats s;
+    for (auto it = ref.lower_bound(from); it != ref.end() && it->first <= to; ++it) s.add(it->second);
+    return s;
+}
+
+double ref_vwap_tick(const RefProfile& ref, int32_t from, int32_t to) {
+    double num = 0, den = 0;
+    for (auto it = ref.lower_bound(from); it != ref.end() && it->first <= to; ++it) {
+        num += static_cast<double>(it->first) * static_cast<double>(it->second.total_volume());
+        den += static_cast<double>(it->second.total_volume());
+    }
+    return den > 0 ? num / den : -1;
+}
+
+bool test_profile() {
+    TradeProfile p;
+    RefProfile ref;
+    bool ok = true;
+    std::mt19937 rng(16);
+
+    auto record = [&](int32_t tick, uint64_t qty, TradeProfile::Aggressor a) {
+        p.record(tick, qty, a);
+        ref[tick].volume[a] += qty;
+        ++ref[tick].count[a];
+    };
+
+    // 中心 10000 附近随机游走，偶尔出现离群价
+    int32_t center = 10000;
+    for (int i = 0; i < 50000; ++i) {
+        center += static_cast<int32_t>(rng() % 5) - 2;
+        int32_t tick = center + static_cast<int32_t>(rng() % 41) - 20;
+        if (i % 5000 == 17) tick = center + 200000;   // 离群成交：超过 MAX_DENSE_SPAN，进入稀疏区
+        record(tick, 100 * (1 + rng() % 50), static_cast<TradeProfile::Aggressor>(rng() % 3));
+    }
+    ok &= expect_true("sparse outliers", p.sparse_count() > 0 && p.dense_span() <= TradeProfile::MAX_DENSE_SPAN);
+
+    for (const auto& [tick, st] : ref) {
+        if (!same_stats(p.at(tick), st)) {
+            ok &= expect_true("at " + std::to_string(tick), false);
+            break;
+        }
+    }
+    for (int c = 0; c < 200; ++c) {
+        int32_t from = center - 500 + static_cast<int32_t>(rng() % 1000);
+        int32_t to = from + static_cast<int32_t>(rng() % (c % 10 == 0 ? 300000 : 300));
+        ok &= expect_true("range", same_stats(p.range(from, to), ref_range(ref, from, to)));
+        std::optional<double> v = p.vwap_tick(from, to);
+        double expect = ref_vwap_tick(ref, from, to);
+        ok &= expect_true("vwap", v ? std::fabs(*v - expect) < 1e-6 : expect < 0);
+    }
+
+    uint64_t total = 0;
+    for (const auto& [tick, st] : ref) total += st.total_volume();
+    ok &= expect_true("totals", p.total_volume() == total && p.total_count() == 50000 &&
+                      p.low_tick() == ref.begin()->first && p.high_tick() == ref.rbegin()->first);
+
+    // 向下扩展与稀疏档位上浮
+    TradeProfile q;
+    q.record(70000, 100, TradeProfile::BUY);
+    q.record(10000, 200, TradeProfile::SELL);   // 跨度 60000 (< MAX_DENSE_SPAN)
+    ok &= expect_true("grow down", q.sparse_count() == 0 && q.at(10000).volume[TradeProfile::SELL] == 200 &&
+                      q.at(70000).volume[TradeProfile::BUY] == 100);
+    q.record(200000, 300, TradeProfile::UNKNOWN);
+    ok &= expect_true("outlier", q.sparse_count() == 1 && q.at(200000).count[TradeProfile::UNKNOWN] == 1 &&
+                      q.range(0, 300000).total_volume() == 600);
+
+    q.reset();
+    ok &= expect_true("reset", q.total_volume() == 0 && !q.low_tick() && q.range(0, 300000).total_count() == 0);
+    return ok;
+}
+
+bool run_book(int32_t source) {
+    const std::string name = source == 101 ? "sh" : "sz";
+    ObjectPool<OrderNode> pool(1024);
+    FastOrderBook book(0, pool, MIN_PRICE, MAX_PRICE, source == 101 ? Exchange::Shanghai : Exchange::Shenzhen);
+    RefProfile ref;   // 按价格 (单位与订单簿一致)
+    std::mt19937 rng(static_cast<uint32_t>(source));
+    bool ok = true;
+
+    // 成交双方委托不在簿中时也按成交价累计 (分价成交量不依赖挂单状态)
+    for (int i = 0; i < 20000; ++i) {
+        uint32_t price = 99000 + (rng() % 40) * 100;
+        uint32_t qty = 100 * (1 + rng() % 30);
+        int32_t bs = static_cast<int32_t>(rng() % 3);   // 0 不明 / 1 买 / 2 卖
+        if (rng() % 10 == 0) {
+            // 撤单不计入
+            book.on_transaction(make_txn(source, 1, 0, price, qty, 1, 1));
+            continue;
+        }
+        book.on_transaction(make_txn(source, 1000000 + i, 2000000 + i, price, qty, 0, bs));
+        TradeProfile::Aggressor a = bs == 1 ? TradeProfile::BUY : bs == 2 ? TradeProfile::SELL : TradeProfile::UNKNOWN;
+        ref[static_cast<int32_t>(price)].volume[a] += qty;
+        ++ref[static_cast<int32_t>(price)].count[a];
+    }
+
+    // 区间外价格不计入
+    book.on_transaction(make_txn(source, 1, 2, MAX_PRICE + 100, 500, 0, 1));
+
+    for (const auto& [price, st] : ref) {
+        ok &= expect_true(name + " at price", same_stats(book.get_traded_at_price(static_cast<uint32_t>(price)), st));
+    }
+    for (int c = 0; c < 100; ++c) {
+        uint32_t lo = 98000 + (rng() % 80) * 100;
+        uint32_t hi = lo + (rng() % 30) * 100;
+        ok &= expect_true(name + " range", same_stats(book.get_traded_in_range(lo, hi),
+                                                      ref_range(ref, static_cast<int32_t>(lo), static_cast<int32_t>(hi))));
+        std::optional<double> v = book.get_vwap(lo, hi);
+        double expect = ref_vwap_tick(ref, static_cast<int32_t>(lo), static_cast<int32_t>(hi));
+        ok &= expect_true(name + " vwap", v ? std::fabs(*v - expect) < 1e-6 : expect < 0);
+    }
+
+    uint64_t total = 0, count = 0;
+    for (const auto& [price, st] : ref) {
+        total += st.total_volume();
+        count += st.total_count();
+    }
+    ok &= expect_true(name + " totals", book.get_total_traded_volume() == total && book.get_total_traded_count() == count);
+    ok &= expect_true(name + " whole band", book.get_traded_in_range(0, UINT32_MAX).total_volume() == total);
+    ok &= expect_true(name + " empty", !book.get_vwap(MIN_PRICE, 95000).has_value() &&
+                      !book.get_vwap(100000, 99000).has_value());
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    bool ok = true;
+    ok &= test_profile();
+    ok &= run_book(102);
+    ok &= run_book(101);
+
+    if (!ok) {
+        return 1;
+    }
+
+    std::cout << "test_trade_profile passed\n";
+    return 0;
+}
@@ -0,0 +1,143 @@
+/**
+ * @file test_wait_policy.cpp
+ * @brief worker 空闲等待策略 (WorkerWaiter) 与 CPU 列表解析/绑核测试
+ *
+ * 策略名解析往返；spin/spin_yield 从不要求挂起，park 在自旋轮数用尽后要求挂起。
+ * park/notify：消费者空闲时挂起，生产者入队后唤醒；乒乓往返的平均耗时远小于挂起超时
+ * (丢失唤醒时每轮都要等到超时)；生产者在消费者挂起前入队时 park 不进入睡眠。
+ * CPU 列表：区间/单值/空白，错误格式被拒绝；绑定到当前允许的 CPU 成功。
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "concurrentqueue.h"
+#include "utils/cpu_affinity.h"
+#include "wait_policy.h"
+
+namespace {
+
+bool expect_true(const std::string& name, bool cond) {
+    if (cond) return true;
+    std::cerr << "[FAIL] " << name << "\n";
+    return false;
+}
+
+bool test_modes() {
+    bool ok = true;
+    for (WaitMode m : {WaitMode::YIELD, WaitMode::SPIN, WaitMode::SPIN_YIELD, WaitMode::PARK}) {
+        WaitMode parsed;
+        ok &= expect_true(std::string("roundtrip ") + wait_mode_name(m), parse_wait_mode(wait_mode_name(m), parsed) && parsed == m);
+    }
+    WaitMode unused;
+    ok &= expect_true("unknown mode", !parse_wait_mode("sleep", unused));
+
+    WorkerWaiter w;
+    ok &= expect_true("default yield", w.mode() == WaitMode::YIELD && !w.idle(1000000));
+    w.configure(WaitMode::SPIN, 10);
+    ok &= expect_true("spin never parks", !w.idle(0) && !w.idle(1000000));
+    w.configure(WaitMode::SPIN_YIELD, 10);
+    ok &= expect_true("spin_yield never parks", !w.idle(0) && !w.idle(1000000));
+    w.configure(WaitMode::PARK, 10);
+    ok &= expect_true("park after spin", !w.idle(9) && w.idle(10));
+    return ok;
+}
+
+bool test_park_notify() {
+    constexpr int ROUNDS = 200;
+    WorkerWaiter waiter;
+    waiter.configure(WaitMode::PARK, 50);
+    moodycamel::ConcurrentQueue<int> queue;
+    std::atomic<int> acked{-1};
+    std::atomic<bool> running{true};
+
+    std::thread consumer([&] {
+        uint32_t idle_rounds = 0;
+        int v;
+        while (running.load(std::memory_order_acquire)) {
+            if (queue.try_dequeue(v)) {
+                idle_rounds = 0;
+                acked.store(v, std::memory_order_release);
+                continue;
+            }
+            if (waiter.idle(idle_rounds++)) {
+                waiter.park([&] { return queue.size_approx() != 0 || !running.load(std::memory_order_relaxed); });
+            }
+        }
+    });
+
+    // 乒乓：每轮先让消费者进入挂起，再入队唤醒并等待回应
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; ++i) {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        queue.enqueue(i);
+        waiter.notify();
+        while (acked.load(std::memory_order_acquire) != i) std::this_thread::yield();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    running.store(false, std::memory_order_release);
+    waiter.notify();
+    consumer.join();
+
+    auto avg_us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() / ROUNDS;
+    auto timeout_us = std::chrono::duration_cast<std::chrono::microseconds>(WorkerWaiter::PARK_TIMEOUT).count();
+    bool ok = expect_true("consumer parked", waiter.park_count() > 0);
+    ok &= expect_true("no lost wakeups (avg " + std::to_string(avg_us) + "us)", avg_us < timeout_us / 4);
+
+    // 挂起前已有消息：不进入睡眠
+    uint64_t parks = waiter.park_count();
+    auto t0 = std::chrono::steady_clock::now();
+    waiter.park([] { return true; });
+    ok &= expect_true("recheck skips sleep",
+                      waiter.park_count() == parks && std::chrono::steady_clock::now() - t0 < WorkerWaiter::PARK_TIMEOUT);
+    return ok;
+}
+
+bool test_cpu_list() {
+    std::vector<int> cpus;
+    bool ok = expect_true("empty", cpu_affinity::parse_cpu_list("", cpus) && cpus.empty());
+    ok &= expect_true("ranges", cpu_affinity::parse_cpu_list("2-5,8, 10-11", cpus) &&
+                                    cpus == std::vector<int>({2, 3, 4, 5, 8, 10, 11}));
+    ok &= expect_true("order kept", cpu_affinity::parse_cpu_list("7,1", cpus) && cpus == std::vector<int>({7, 1}));
+    for (const char* bad : {"3-1", "a", "1-", "2x", "-1", "1-2-3"}) {
+        ok &= expect_true(std::string("reject ") + bad, !cpu_affinity::parse_cpu_list(bad, cpus));
+    }
+
+    ok &= expect_true("no pin", cpu_affinity::pin_current_thread(-1));
+#ifdef __linux__
+    // 绑定到当前允许集合中的第一个 CPU
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        int first = -1;
+        for (int c = 0; c < CPU_SETSIZE && first < 0; ++c) {
+            if (CPU_ISSET(c, &allowed)) first = c;
+        }
+        std::thread t([&] { ok &= expect_true("pin", cpu_affinity::pin_current_thread(first) && sched_getcpu() == first); });
+        t.join();
+    }
+#endif
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    bool ok = true;
+    ok &= test_modes();
+    ok &= test_park_notify();
+    ok &= test_cpu_list();
+
+    if (!ok) {
+        return 1;
+    }
+
+    std::cout << "test_wait_policy passed\n";
+    return 0;
+}